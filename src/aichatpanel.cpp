@@ -158,30 +158,36 @@ void AIChatPanel::setupUI()
     QVBoxLayout *outputLayout = new QVBoxLayout(m_outputTab);
     outputLayout->setContentsMargins(8, 8, 8, 8);
 
+    QHBoxLayout *outputHeader = new QHBoxLayout();
     QLabel *outputLabel = new QLabel("Compiler Output", m_outputTab);
     outputLabel->setStyleSheet("font-weight: bold; font-size: 14px; color: #0078d7; margin-bottom: 8px;");
-    outputLayout->addWidget(outputLabel);
+    outputHeader->addWidget(outputLabel);
+    outputHeader->addStretch();
 
-    m_outputText = new QTextEdit(m_outputTab);
-    m_outputText->setReadOnly(true);
-    m_outputText->setFont(QFont("Consolas", 10));
-    m_outputText->setStyleSheet(R"(
-        QTextEdit {
-            background-color: #1a1a1a;
+    m_droppedLinesLabel = new QLabel(m_outputTab);
+    m_droppedLinesLabel->setStyleSheet("color: #888888; margin-bottom: 8px;");
+    outputHeader->addWidget(m_droppedLinesLabel);
+    outputLayout->addLayout(outputHeader);
+
+    m_outputConsole = new OutputConsole(m_outputTab);
+    m_outputConsole->setStyleSheet(R"(
+        QAbstractScrollArea {
             border: 1px solid #3d3d3d;
             border-radius: 6px;
-            padding: 8px;
-            font-family: 'Consolas', 'Courier New', monospace;
-            font-size: 12px;
         }
     )");
-    outputLayout->addWidget(m_outputText, 1);
+    connect(m_outputConsole, &OutputConsole::droppedLinesChanged, [this](qint64 dropped) {
+        m_droppedLinesLabel->setText(dropped > 0
+            ? QString("%1 earlier lines dropped").arg(dropped)
+            : QString());
+    });
+    outputLayout->addWidget(m_outputConsole, 1);
 
     m_clearOutputButton = new QPushButton("Clear Output", m_outputTab);
     m_clearOutputButton->setMinimumHeight(36);
     m_clearOutputButton->setStyleSheet("background-color: #4d4d4d;");
     connect(m_clearOutputButton, &QPushButton::clicked, [this]() {
-        m_outputText->clear();
+        m_outputConsole->clear();
     });
     outputLayout->addWidget(m_clearOutputButton);
 
@@ -261,17 +267,17 @@ void AIChatPanel::appendAIResponse(const QString &response)
 
 void AIChatPanel::appendOutput(const QString &output, bool isError)
 {
-    QString color = isError ? "#ff6b6b" : "#98c379";
-    QString html = QString("<pre style='color: %1; margin: 4px 0;'>%2</pre>")
-                   .arg(color, output.toHtmlEscaped());
-    m_outputText->append(html);
+    m_outputConsole->endLine();
+    m_outputConsole->appendText(output + "\n", isError ? OutputBuffer::Error : OutputBuffer::Normal);
 
     // Switch to output tab
     m_tabWidget->setCurrentWidget(m_outputTab);
+}
 
-    // Auto-scroll to bottom
-    QScrollBar *sb = m_outputText->verticalScrollBar();
-    sb->setValue(sb->maximum());
+void AIChatPanel::appendStreamOutput(const QString &text, bool isError)
+{
+    // Partial lines are fine here; the console joins them as more arrives
+    m_outputConsole->appendText(text, isError ? OutputBuffer::Error : OutputBuffer::Normal);
 }
 
 void AIChatPanel::showSuggestions(const QStringList &suggestions)
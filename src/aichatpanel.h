@@ -8,6 +8,8 @@
 #include <QListWidget>
 #include <QVBoxLayout>
 #include <QTabWidget>
+#include <QLabel>
+#include "outputconsole.h"
 
 class AIChatPanel : public QWidget
 {
@@ -18,6 +20,7 @@ public:
 
     void appendAIResponse(const QString &response);
     void appendOutput(const QString &output, bool isError);
+    void appendStreamOutput(const QString &text, bool isError);
     void showSuggestions(const QStringList &suggestions);
     void clearChat();
 
@@ -59,7 +62,8 @@ private:
 
     // Output tab (for compiler output)
     QWidget *m_outputTab;
-    QTextEdit *m_outputText;
+    OutputConsole *m_outputConsole;
+    QLabel *m_droppedLinesLabel;
     QPushButton *m_clearOutputButton;
 };
 
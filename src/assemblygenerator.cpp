@@ -0,0 +1,376 @@
+#include "assemblygenerator.h"
+#include "guardedinvoke.h"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSet>
+#include <QStandardPaths>
+#include <QTextDocument>
+#include <QThreadPool>
+#include <QTimer>
+
+namespace {
+
+const int kDebounceMs = 600;
+const int kCacheKb = 32 * 1024;
+
+bool isCompilable(const QString &filePath)
+{
+    if (filePath.isEmpty()) {
+        return true;        // an unsaved buffer
+    }
+    static const QStringList suffixes = {"cpp", "cc", "cxx", "c++", "cp"};
+    return suffixes.contains(QFileInfo(filePath).suffix().toLower());
+}
+
+// Code and data the program actually contains; debug info, unwind tables
+// and notes are noise here
+bool isListedSection(const QString &name)
+{
+    static const QRegularExpression listed(R"(^(?:\.text|\.rodata|\.data|\.bss|\.tdata|\.tbss|\.lrodata|\.ldata|__TEXT|__DATA))");
+    return listed.match(name).hasMatch();
+}
+
+// Compiler-generated labels: GCC's .L*, Clang's .L* and, on Mach-O, L*
+bool isLocalLabel(const QString &name)
+{
+    static const QRegularExpression local(R"(^(?:\.L|L(?:BB|tmp|func_end|CPI|JTI|\.str|_)))");
+    return local.match(name).hasMatch();
+}
+
+bool isDataDirective(const QString &directive)
+{
+    static const QSet<QString> data = {
+        ".string", ".ascii", ".asciz", ".byte", ".short", ".value", ".hword", ".word", ".long", ".int",
+        ".quad", ".octa", ".xword", ".2byte", ".4byte", ".8byte", ".zero", ".float", ".single", ".double"};
+    return data.contains(directive);
+}
+
+// "movl\t$0, %eax" -> "    movl    $0, %eax"
+QString formatInstruction(QString text)
+{
+    const int tab = text.indexOf('\t');
+    if (tab > 0) {
+        text = text.left(tab).leftJustified(7) + ' ' + text.mid(tab + 1);
+    }
+    return "    " + text.replace('\t', ' ');
+}
+
+// Runs the listing through c++filt when it is installed; c++filt keeps lines intact
+void demangle(QVector<AssemblyLine> &lines)
+{
+    const QString cxxfilt = QStandardPaths::findExecutable("c++filt");
+    if (cxxfilt.isEmpty() || lines.isEmpty()) {
+        return;
+    }
+    QStringList texts;
+    texts.reserve(lines.size());
+    for (const AssemblyLine &line : lines) {
+        texts << line.text;
+    }
+
+    QProcess process;
+    process.start(cxxfilt, QStringList());
+    process.write((texts.join('\n') + '\n').toUtf8());
+    process.closeWriteChannel();
+    if (!process.waitForFinished(5000)) {
+        process.kill();
+        process.waitForFinished(1000);
+        return;
+    }
+    const QStringList demangled = QString::fromUtf8(process.readAllStandardOutput()).split('\n');
+    if (demangled.size() < lines.size()) {
+        return;
+    }
+    for (int i = 0; i < lines.size(); ++i) {
+        lines[i].text = demangled.at(i);
+    }
+}
+
+} // namespace
+
+QVector<int> AssemblyListing::linesFor(int sourceLine) const
+{
+    QVector<int> indexes;
+    if (sourceLine <= 0) {
+        return indexes;
+    }
+    for (int i = 0; i < lines.size(); ++i) {
+        if (lines.at(i).sourceLine == sourceLine) {
+            indexes << i;
+        }
+    }
+    return indexes;
+}
+
+AssemblyListing AssemblyListing::parse(const QString &assembly)
+{
+    static const QRegularExpression labelLine(R"(^([A-Za-z_.$][\w.$@]*|"[^"]+"):\s*(?:#.*)?$)");
+    static const QRegularExpression fileDirective(R"(^\.file\s+(\d+)\s+"([^"]*)"(?:\s+"([^"]*)")?)");
+    static const QRegularExpression locDirective(R"(^\.loc\s+(\d+)\s+(\d+))");
+    static const QRegularExpression trailingComment(R"(\s+(?:#+|//|;|@)\s.*$)");
+    static const QRegularExpression symbol(R"([A-Za-z_.$][\w.$]*)");
+    static const QRegularExpression separator(R"([\s,])");
+
+    struct Candidate
+    {
+        AssemblyLine line;
+        QString label;              // set for label lines
+    };
+
+    AssemblyListing listing;
+    QVector<Candidate> candidates;
+    QSet<QString> referenced;
+    QSet<int> bufferFiles;          // .file numbers naming the buffer itself
+    QString section = ".text";
+    QString previousSection = section;
+    QStringList sectionStack;
+    int currentLine = 0;
+
+    auto switchSection = [&](const QString &name) {
+        previousSection = section;
+        section = name;
+    };
+    auto addReferences = [&](const QString &operands) {
+        QRegularExpressionMatchIterator it = symbol.globalMatch(operands);
+        while (it.hasNext()) {
+            referenced.insert(it.next().captured());
+        }
+    };
+
+    const QStringList rawLines = assembly.split('\n');
+    listing.rawLineCount = rawLines.size();
+    for (const QString &raw : rawLines) {
+        const QString text = raw.trimmed();
+        if (text.isEmpty() || text.startsWith('#') || text.startsWith("//") || text.startsWith(';')) {
+            continue;
+        }
+
+        const QRegularExpressionMatch label = labelLine.match(text);
+        if (label.hasMatch()) {
+            const QString name = label.captured(1);
+            if (!isLocalLabel(name)) {
+                currentLine = 0;    // a new function starts
+            }
+            if (isListedSection(section)) {
+                candidates.append({{name + ':', 0}, name});
+            }
+            continue;
+        }
+
+        if (text.startsWith('.')) {
+            const QString directive = text.section(separator, 0, 0);
+            const QString argument = text.mid(directive.size()).trimmed();
+            if (directive == ".loc") {
+                const QRegularExpressionMatch loc = locDirective.match(text);
+                currentLine = bufferFiles.contains(loc.captured(1).toInt()) ? loc.captured(2).toInt() : 0;
+            } else if (directive == ".file") {
+                // ".file 1 "name"" or, with DWARF 5, ".file 1 "dir" "name""
+                const QRegularExpressionMatch file = fileDirective.match(text);
+                const QString name = file.captured(3).isEmpty() ? file.captured(2) : file.captured(3);
+                if (file.hasMatch() && (name == "<stdin>" || name == "-")) {
+                    bufferFiles.insert(file.captured(1).toInt());
+                }
+            } else if (directive == ".text" || directive == ".data" || directive == ".bss") {
+                switchSection(directive);
+            } else if (directive == ".section" || directive == ".pushsection") {
+                if (directive == ".pushsection") {
+                    sectionStack << section;
+                }
+                switchSection(argument.section(separator, 0, 0));
+            } else if (directive == ".popsection" && !sectionStack.isEmpty()) {
+                switchSection(sectionStack.takeLast());
+            } else if (directive == ".previous") {
+                switchSection(previousSection);
+            } else if (isDataDirective(directive) && isListedSection(section)) {
+                addReferences(argument);
+                candidates.append({{formatInstruction(directive + '\t' + argument), 0}, QString()});
+            }
+            continue;
+        }
+
+        if (!isListedSection(section)) {
+            continue;
+        }
+        QString instruction = text;
+        instruction.remove(trailingComment);
+        addReferences(instruction);
+        candidates.append({{formatInstruction(instruction), currentLine}, QString()});
+        ++listing.instructionCount;
+    }
+
+    // Labels nothing jumps to or loads from are bookkeeping for the debug info
+    for (const Candidate &candidate : qAsConst(candidates)) {
+        if (!candidate.label.isEmpty()) {
+            if (isLocalLabel(candidate.label) && !referenced.contains(candidate.label)) {
+                continue;
+            }
+            if (!isLocalLabel(candidate.label) && !listing.lines.isEmpty()) {
+                listing.lines.append(AssemblyLine());
+            }
+        }
+        listing.lines.append(candidate.line);
+    }
+    return listing;
+}
+
+AssemblyGenerator::AssemblyGenerator(QObject *parent)
+    : QObject(parent)
+    , m_process(nullptr)
+    , m_generation(0)
+    , m_cache(kCacheKb)
+{
+    m_debounce = new QTimer(this);
+    m_debounce->setSingleShot(true);
+    m_debounce->setInterval(kDebounceMs);
+    connect(m_debounce, &QTimer::timeout, this, &AssemblyGenerator::startCompile);
+}
+
+AssemblyGenerator::~AssemblyGenerator()
+{
+    stopProcess();
+}
+
+void AssemblyGenerator::setCompiler(const QString &command, const QStringList &flags)
+{
+    m_command = command;
+    m_flags.clear();
+    for (const QString &flag : flags) {
+        // LTO would emit intermediate code instead of assembly
+        if (!flag.startsWith("-flto")) {
+            m_flags << flag;
+        }
+    }
+}
+
+void AssemblyGenerator::schedule(const QString &filePath, QTextDocument *document)
+{
+    if (m_command.isEmpty() || !isCompilable(filePath)) {
+        return;
+    }
+    stopProcess();
+    m_filePath = filePath;
+    m_document = document;
+    m_debounce->start();
+}
+
+void AssemblyGenerator::generateNow(const QString &filePath, QTextDocument *document)
+{
+    if (m_command.isEmpty() || !isCompilable(filePath)) {
+        return;
+    }
+    m_debounce->stop();
+    stopProcess();
+    m_filePath = filePath;
+    m_document = document;
+    startCompile();
+}
+
+void AssemblyGenerator::cancel()
+{
+    m_debounce->stop();
+    stopProcess();
+    ++m_generation;
+}
+
+void AssemblyGenerator::stopProcess()
+{
+    if (m_process) {
+        m_process->disconnect();
+        m_process->kill();
+        m_process->waitForFinished(1000);
+        m_process->deleteLater();
+        m_process = nullptr;
+    }
+}
+
+QStringList AssemblyGenerator::arguments(const QString &dir) const
+{
+    QStringList args;
+    for (const QString &flag : m_flags) {
+        // Line tables are all the mapping needs and keep the output small
+        args << (flag == "-g" ? QString("-g1") : flag);
+    }
+    if (!args.contains("-g1")) {
+        args << "-g1";
+    }
+    args << "-w" << "-iquote" << dir << "-S" << "-o" << "-" << "-x" << "c++" << "-";
+    return args;
+}
+
+void AssemblyGenerator::startCompile()
+{
+    if (!m_document) {
+        return;
+    }
+    const QByteArray source = m_document->toPlainText().toUtf8();
+    const QString dir = m_filePath.isEmpty() ? QDir::homePath() : QFileInfo(m_filePath).absolutePath();
+    const QStringList args = arguments(dir);
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(m_command.toUtf8());
+    hash.addData(args.join('\n').toUtf8());
+    hash.addData(source);
+    m_key = hash.result();
+    ++m_generation;
+
+    if (const AssemblyListing *cached = m_cache.object(m_key)) {
+        AssemblyListing listing = *cached;
+        listing.fromCache = true;
+        emit finished(m_filePath, listing);
+        return;
+    }
+
+    emit started();
+    m_process = new QProcess(this);
+    m_process->setWorkingDirectory(dir);
+    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &AssemblyGenerator::onCompileFinished);
+    connect(m_process, &QProcess::errorOccurred, [this](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            stopProcess();
+            emit failed(m_filePath, tr("Could not start %1").arg(m_command));
+        }
+    });
+
+    m_compileTimer.start();
+    m_process->start(m_command, args);
+    m_process->write(source);
+    m_process->closeWriteChannel();
+}
+
+void AssemblyGenerator::onCompileFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    const QString assembly = QString::fromUtf8(m_process->readAllStandardOutput());
+    const QString errors = QString::fromLocal8Bit(m_process->readAllStandardError());
+    m_process->deleteLater();
+    m_process = nullptr;
+
+    if (exitStatus != QProcess::NormalExit || exitCode != 0) {
+        emit failed(m_filePath, errors.replace("<stdin>", QFileInfo(m_filePath).fileName()));
+        return;
+    }
+
+    // -g output runs to megabytes once headers are involved; parse it off the UI thread
+    const qint64 compileMs = m_compileTimer.elapsed();
+    const int generation = m_generation;
+    const QString filePath = m_filePath;
+    const QByteArray key = m_key;
+    QPointer<AssemblyGenerator> guard(this);
+    QThreadPool::globalInstance()->start([guard, assembly, compileMs, generation, filePath, key]() {
+        AssemblyListing listing = AssemblyListing::parse(assembly);
+        listing.compileMs = compileMs;
+        demangle(listing.lines);
+        invokeIfAlive(guard, [guard, listing, generation, filePath, key]() {
+            qint64 bytes = 0;
+            for (const AssemblyLine &line : listing.lines) {
+                bytes += line.text.size() * qint64(sizeof(QChar));
+            }
+            guard->m_cache.insert(key, new AssemblyListing(listing), int(bytes / 1024) + 1);
+            if (generation == guard->m_generation) {
+                emit guard->finished(filePath, listing);
+            }
+        });
+    });
+}
@@ -0,0 +1,80 @@
+#ifndef ASSEMBLYGENERATOR_H
+#define ASSEMBLYGENERATOR_H
+
+#include <QObject>
+#include <QCache>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QProcess>
+#include <QStringList>
+#include <QVector>
+
+class QTextDocument;
+class QTimer;
+
+struct AssemblyLine
+{
+    QString text;
+    int sourceLine = 0;             // 1-based line of the buffer, 0 for labels and header code
+};
+
+struct AssemblyListing
+{
+    QVector<AssemblyLine> lines;
+    int instructionCount = 0;
+    int rawLineCount = 0;           // before directives and unused labels were dropped
+    qint64 compileMs = 0;
+    bool fromCache = false;
+
+    QVector<int> linesFor(int sourceLine) const;
+
+    // Keeps instructions, data and referenced labels of the code and data
+    // sections; every instruction carries the buffer line of its last .loc
+    static AssemblyListing parse(const QString &assembly);
+};
+
+// Compiles a snapshot of the editor buffer with `-S -g` on a typing pause,
+// the way Compiler Explorer does, and maps the instructions back to source
+// lines. A new edit kills the running compile; parsing happens on a worker
+// thread, and listings are cached by a hash of compiler, flags and source so
+// undoing to an earlier state shows its assembly at once.
+class AssemblyGenerator : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AssemblyGenerator(QObject *parent = nullptr);
+    ~AssemblyGenerator();
+
+    // GCC or Clang; the active build profile's flags minus -flto
+    void setCompiler(const QString &command, const QStringList &flags);
+
+    void schedule(const QString &filePath, QTextDocument *document);
+    void generateNow(const QString &filePath, QTextDocument *document);
+    void cancel();
+
+signals:
+    void started();
+    void finished(const QString &filePath, const AssemblyListing &listing);
+    void failed(const QString &filePath, const QString &output);
+
+private:
+    void startCompile();
+    void onCompileFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void stopProcess();
+    QStringList arguments(const QString &dir) const;
+
+    QString m_command;
+    QStringList m_flags;
+    QString m_filePath;
+    QPointer<QTextDocument> m_document;
+
+    QTimer *m_debounce;
+    QProcess *m_process;
+    QByteArray m_key;               // cache key of the running compile
+    QElapsedTimer m_compileTimer;
+    int m_generation;               // drops parses that finish after a newer compile started
+    QCache<QByteArray, AssemblyListing> m_cache;
+};
+
+#endif // ASSEMBLYGENERATOR_H
@@ -0,0 +1,144 @@
+#include "assemblypanel.h"
+#include <QMouseEvent>
+#include <QScrollBar>
+#include <QTextBlock>
+#include <QVBoxLayout>
+
+AssemblyPanel::AssemblyPanel(QWidget *parent)
+    : QWidget(parent)
+    , m_highlightedLine(0)
+    , m_hoveredLine(0)
+{
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(8, 8, 8, 8);
+
+    m_summaryLabel = new QLabel(tr("Assembly of the current buffer appears here"), this);
+    m_summaryLabel->setStyleSheet("color: #888;");
+    m_summaryLabel->setWordWrap(true);
+    layout->addWidget(m_summaryLabel);
+
+    m_view = new QPlainTextEdit(this);
+    m_view->setReadOnly(true);
+    m_view->setLineWrapMode(QPlainTextEdit::NoWrap);
+    m_view->setUndoRedoEnabled(false);
+    QFont font("Consolas", 10);
+    font.setStyleHint(QFont::Monospace);
+    font.setFixedPitch(true);
+    m_view->setFont(font);
+    m_view->setStyleSheet(R"(
+        QPlainTextEdit {
+            background-color: #1e1e1e;
+            color: #d4d4d4;
+            border: 1px solid #3d3d3d;
+            border-radius: 6px;
+        }
+    )");
+    m_view->viewport()->setMouseTracking(true);
+    m_view->viewport()->installEventFilter(this);
+    layout->addWidget(m_view, 1);
+}
+
+void AssemblyPanel::setListing(const AssemblyListing &listing)
+{
+    m_listing = listing;
+    m_hoveredLine = 0;
+
+    QStringList texts;
+    texts.reserve(listing.lines.size());
+    for (const AssemblyLine &line : listing.lines) {
+        texts << line.text;
+    }
+    // Keep the reader's place while the listing refreshes under them
+    const int scroll = m_view->verticalScrollBar()->value();
+    m_view->setPlainText(texts.join('\n'));
+    m_view->verticalScrollBar()->setValue(scroll);
+
+    QString summary = tr("%1 instructions (%2 of %3 lines shown)")
+                          .arg(listing.instructionCount).arg(listing.lines.size()).arg(listing.rawLineCount);
+    summary += listing.fromCache ? tr(", cached") : tr(", compiled in %1 ms").arg(listing.compileMs);
+    m_summaryLabel->setText(summary);
+
+    const int line = m_highlightedLine;
+    m_highlightedLine = 0;
+    highlightSourceLine(line);
+}
+
+void AssemblyPanel::showError(const QString &output)
+{
+    m_listing = AssemblyListing();
+    m_highlightedLine = 0;
+    m_summaryLabel->setText(tr("Compilation failed"));
+    m_view->setExtraSelections({});
+    m_view->setPlainText(output);
+}
+
+void AssemblyPanel::showMessage(const QString &message)
+{
+    m_summaryLabel->setText(message);
+}
+
+void AssemblyPanel::setBusy()
+{
+    m_summaryLabel->setText(tr("Compiling..."));
+}
+
+void AssemblyPanel::highlightSourceLine(int line)
+{
+    if (line == m_highlightedLine) {
+        return;
+    }
+    m_highlightedLine = line;
+
+    QList<QTextEdit::ExtraSelection> selections;
+    const QVector<int> indexes = m_listing.linesFor(line);
+    for (int index : indexes) {
+        QTextEdit::ExtraSelection selection;
+        selection.format.setBackground(QColor(38, 79, 120));
+        selection.format.setProperty(QTextFormat::FullWidthSelection, true);
+        selection.cursor = QTextCursor(m_view->document()->findBlockByNumber(index));
+        selections.append(selection);
+    }
+    m_view->setExtraSelections(selections);
+
+    // Bring the first instruction into view unless some already are
+    if (indexes.isEmpty()) {
+        return;
+    }
+    const int first = m_view->firstVisibleBlock().blockNumber();
+    const int visible = m_view->viewport()->height() / qMax(1, m_view->fontMetrics().height());
+    for (int index : indexes) {
+        if (index >= first && index < first + visible) {
+            return;
+        }
+    }
+    m_view->verticalScrollBar()->setValue(qMax(0, indexes.first() - visible / 3));
+}
+
+int AssemblyPanel::sourceLineAt(const QPoint &pos) const
+{
+    const int block = m_view->cursorForPosition(pos).blockNumber();
+    return block >= 0 && block < m_listing.lines.size() ? m_listing.lines.at(block).sourceLine : 0;
+}
+
+bool AssemblyPanel::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == m_view->viewport()) {
+        int line = m_hoveredLine;
+        if (event->type() == QEvent::MouseMove) {
+            line = sourceLineAt(static_cast<QMouseEvent *>(event)->pos());
+        } else if (event->type() == QEvent::Leave) {
+            line = 0;
+        } else if (event->type() == QEvent::MouseButtonDblClick) {
+            const int target = sourceLineAt(static_cast<QMouseEvent *>(event)->pos());
+            if (target > 0) {
+                emit sourceLineActivated(target);
+                return true;
+            }
+        }
+        if (line != m_hoveredLine) {
+            m_hoveredLine = line;
+            emit sourceLineHovered(line);
+        }
+    }
+    return QWidget::eventFilter(watched, event);
+}
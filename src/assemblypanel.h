@@ -0,0 +1,44 @@
+#ifndef ASSEMBLYPANEL_H
+#define ASSEMBLYPANEL_H
+
+#include <QWidget>
+#include <QLabel>
+#include <QPlainTextEdit>
+#include "assemblygenerator.h"
+
+// Read-only listing of the buffer's assembly. Hovering a source line
+// highlights its instructions here; hovering an instruction reports its
+// source line back so the editor can highlight it.
+class AssemblyPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit AssemblyPanel(QWidget *parent = nullptr);
+
+    void setListing(const AssemblyListing &listing);
+    void showError(const QString &output);
+    void showMessage(const QString &message);
+    void setBusy();
+
+    // 1-based source line, 0 clears
+    void highlightSourceLine(int line);
+
+signals:
+    void sourceLineHovered(int line);       // 0 when the mouse leaves
+    void sourceLineActivated(int line);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    int sourceLineAt(const QPoint &pos) const;
+
+    AssemblyListing m_listing;
+    QLabel *m_summaryLabel;
+    QPlainTextEdit *m_view;
+    int m_highlightedLine;
+    int m_hoveredLine;
+};
+
+#endif // ASSEMBLYPANEL_H
@@ -0,0 +1,278 @@
+#include "benchmarkrunner.h"
+#include <QFileInfo>
+#include <QProcessEnvironment>
+#include <QSettings>
+#include <QTimer>
+#include <algorithm>
+#include <cmath>
+
+BenchmarkOptions BenchmarkOptions::load()
+{
+    QSettings settings("AICodeEditor", "AICodeEditor");
+    BenchmarkOptions options;
+    options.iterations = settings.value("benchIterations", options.iterations).toInt();
+    options.warmups = settings.value("benchWarmups", options.warmups).toInt();
+    options.pinCpu = settings.value("benchPinCpu", options.pinCpu).toInt();
+    options.fixedEnvironment = settings.value("benchFixedEnvironment", options.fixedEnvironment).toBool();
+    options.hashOutput = settings.value("benchHashOutput", options.hashOutput).toBool();
+    return options;
+}
+
+void BenchmarkOptions::save() const
+{
+    QSettings settings("AICodeEditor", "AICodeEditor");
+    settings.setValue("benchIterations", iterations);
+    settings.setValue("benchWarmups", warmups);
+    settings.setValue("benchPinCpu", pinCpu);
+    settings.setValue("benchFixedEnvironment", fixedEnvironment);
+    settings.setValue("benchHashOutput", hashOutput);
+}
+
+namespace {
+
+// Linear interpolation between closest ranks; sorted must not be empty
+double quantile(const QVector<double> &sorted, double q)
+{
+    const double position = q * (sorted.size() - 1);
+    const int lower = int(std::floor(position));
+    const int upper = qMin(lower + 1, int(sorted.size()) - 1);
+    return sorted[lower] + (sorted[upper] - sorted[lower]) * (position - lower);
+}
+
+QString statsLine(const QString &label, const SampleStats &stats)
+{
+    return QString("%1 min %2 | median %3 | mean %4 ± %5 | p95 %6 | outliers %7 low, %8 high")
+        .arg(label, SampleStats::formatUs(stats.min), SampleStats::formatUs(stats.median),
+             SampleStats::formatUs(stats.mean), SampleStats::formatUs(stats.stddev),
+             SampleStats::formatUs(stats.p95))
+        .arg(stats.lowOutliers).arg(stats.highOutliers);
+}
+
+} // namespace
+
+SampleStats SampleStats::compute(QVector<double> samples)
+{
+    SampleStats stats;
+    stats.count = samples.size();
+    if (samples.isEmpty()) {
+        return stats;
+    }
+    std::sort(samples.begin(), samples.end());
+
+    double sum = 0;
+    for (double sample : samples) {
+        sum += sample;
+    }
+    stats.mean = sum / samples.size();
+    double squares = 0;
+    for (double sample : samples) {
+        squares += (sample - stats.mean) * (sample - stats.mean);
+    }
+    // Sample standard deviation
+    stats.stddev = samples.size() > 1 ? std::sqrt(squares / (samples.size() - 1)) : 0;
+
+    stats.min = samples.first();
+    stats.median = quantile(samples, 0.5);
+    stats.p95 = quantile(samples, 0.95);
+
+    // Tukey fences
+    const double q1 = quantile(samples, 0.25);
+    const double q3 = quantile(samples, 0.75);
+    const double fence = 1.5 * (q3 - q1);
+    for (double sample : samples) {
+        if (sample < q1 - fence) {
+            ++stats.lowOutliers;
+        } else if (sample > q3 + fence) {
+            ++stats.highOutliers;
+        }
+    }
+    return stats;
+}
+
+QString SampleStats::formatUs(double us)
+{
+    if (us >= 1e6) {
+        return QString("%1 s").arg(us / 1e6, 0, 'f', 3);
+    }
+    if (us >= 1e3) {
+        return QString("%1 ms").arg(us / 1e3, 0, 'f', 3);
+    }
+    return QString("%1 us").arg(us, 0, 'f', 1);
+}
+
+QString BenchmarkResult::report() const
+{
+    QStringList lines;
+    lines << QString("Benchmark of %1: %2 runs after %3 warmup%4%5")
+                 .arg(QFileInfo(executable).fileName())
+                 .arg(wallUs.size()).arg(options.warmups)
+                 .arg(options.warmups == 1 ? QString() : QString("s"))
+                 .arg(options.pinCpu >= 0 ? QString(", pinned to CPU %1").arg(options.pinCpu) : QString());
+    const SampleStats wall = SampleStats::compute(wallUs);
+    lines << statsLine("  wall:", wall);
+    lines << statsLine("  cpu: ", SampleStats::compute(cpuUs));
+    lines << QString("  peak RSS %1 MB").arg(maxRssKb / 1024.0, 0, 'f', 1);
+    if (options.hashOutput) {
+        lines << (outputStable
+                      ? QString("  output hash %1 (identical across runs)").arg(QString::fromLatin1(outputHash.toHex().left(16)))
+                      : QString("  warning: output differed between runs"));
+    }
+    if (wall.mean > 0 && wall.stddev / wall.mean > 0.05) {
+        lines << QString("  warning: wall time varies by %1%; consider pinning to a CPU or more runs")
+                     .arg(100.0 * wall.stddev / wall.mean, 0, 'f', 1);
+    }
+    return lines.join('\n');
+}
+
+BenchmarkRunner::BenchmarkRunner(QObject *parent)
+    : QObject(parent)
+    , m_process(nullptr)
+    , m_hash(QCryptographicHash::Sha1)
+    , m_outputBytes(0)
+    , m_runIndex(-1)
+{
+    m_timeout = new QTimer(this);
+    m_timeout->setSingleShot(true);
+    connect(m_timeout, &QTimer::timeout, [this]() {
+        fail(QString("Benchmark run exceeded the %1 ms timeout").arg(m_limits.wallTimeoutMs));
+    });
+}
+
+void BenchmarkRunner::start(const QString &executable, const BenchmarkOptions &options,
+                            const ExecutionLimits &limits, const QString &workingDirectory)
+{
+    cancel();
+
+    m_result = BenchmarkResult();
+    m_result.executable = executable;
+    m_result.options = options;
+    m_result.options.iterations = qMax(1, options.iterations);
+    m_result.options.warmups = qMax(0, options.warmups);
+    m_limits = limits;
+    m_limits.perfCounters = false;      // not part of the benchmark report
+    m_monitor.setCpuAffinity(options.pinCpu);
+
+    m_process = new QProcess(this);
+    m_process->setProgram(executable);
+    m_process->setWorkingDirectory(workingDirectory.isEmpty() ? QFileInfo(executable).absolutePath()
+                                                              : workingDirectory);
+    m_process->setStandardInputFile(QProcess::nullDevice());
+    m_process->setStandardErrorFile(QProcess::nullDevice());
+    if (options.hashOutput) {
+        connect(m_process, &QProcess::readyReadStandardOutput, [this]() {
+            const QByteArray data = m_process->readAllStandardOutput();
+            m_outputBytes += data.size();
+            m_hash.addData(data);
+            if (m_limits.maxOutputBytes > 0 && m_outputBytes > m_limits.maxOutputBytes) {
+                fail(QString("Benchmark run exceeded the %1 MB output limit")
+                         .arg(m_limits.maxOutputBytes / (1024 * 1024)));
+            }
+        });
+    } else {
+        m_process->setStandardOutputFile(QProcess::nullDevice());
+    }
+    if (options.fixedEnvironment) {
+        // The environment sits at the top of the stack, so its size shifts
+        // stack alignment; keep it identical between benchmarks
+        const QProcessEnvironment system = QProcessEnvironment::systemEnvironment();
+        QProcessEnvironment environment;
+        environment.insert("PATH", system.value("PATH"));
+        environment.insert("HOME", system.value("HOME"));
+        environment.insert("LANG", "C");
+        environment.insert("LC_ALL", "C");
+        environment.insert("TZ", "UTC");
+        m_process->setProcessEnvironment(environment);
+    }
+    connect(m_process, &QProcess::started, [this]() {
+        m_monitor.started();
+    });
+    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &BenchmarkRunner::onRunFinished);
+    connect(m_process, &QProcess::errorOccurred, [this](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            fail(QString("Failed to start %1: %2").arg(m_result.executable, m_process->errorString()));
+        }
+    });
+
+    m_runIndex = 0;
+    startRun();
+}
+
+void BenchmarkRunner::cancel()
+{
+    m_runIndex = -1;
+    m_timeout->stop();
+    if (m_process) {
+        m_process->disconnect();
+        m_process->kill();
+        m_process->waitForFinished(1000);
+        m_monitor.finish(0);
+        m_process->deleteLater();
+        m_process = nullptr;
+    }
+}
+
+void BenchmarkRunner::startRun()
+{
+    m_hash.reset();
+    m_outputBytes = 0;
+    m_monitor.prepare(m_process, m_limits);
+    m_timer.start();
+    m_process->start();
+    if (m_limits.wallTimeoutMs > 0) {
+        m_timeout->start(m_limits.wallTimeoutMs);
+    }
+}
+
+void BenchmarkRunner::onRunFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    m_timeout->stop();
+    if (m_result.options.hashOutput) {
+        m_hash.addData(m_process->readAllStandardOutput());
+    }
+    const ResourceUsage usage = m_monitor.finish(m_timer.nsecsElapsed() / 1000);
+
+    if (exitStatus != QProcess::NormalExit || usage.termSignal != 0) {
+        fail(QString("Benchmark run %1 crashed").arg(m_runIndex + 1));
+        return;
+    }
+    if (exitCode != 0) {
+        fail(QString("Benchmark run %1 exited with code %2").arg(m_runIndex + 1).arg(exitCode));
+        return;
+    }
+
+    const int totalRuns = m_result.options.warmups + m_result.options.iterations;
+    if (m_runIndex >= m_result.options.warmups) {
+        m_result.wallUs.append(usage.wallUs);
+        m_result.cpuUs.append(usage.userUs + usage.systemUs);
+        m_result.maxRssKb = qMax(m_result.maxRssKb, usage.maxRssKb);
+        if (m_result.options.hashOutput) {
+            const QByteArray hash = m_hash.result();
+            if (m_result.outputHash.isEmpty()) {
+                m_result.outputHash = hash;
+            } else if (hash != m_result.outputHash) {
+                m_result.outputStable = false;
+            }
+        }
+    }
+
+    ++m_runIndex;
+    emit progress(m_runIndex, totalRuns);
+    if (m_runIndex < totalRuns) {
+        startRun();
+        return;
+    }
+
+    const BenchmarkResult result = m_result;
+    cancel();
+    emit finished(result);
+}
+
+void BenchmarkRunner::fail(const QString &message)
+{
+    if (m_runIndex < 0) {
+        return;
+    }
+    cancel();
+    emit failed(message);
+}
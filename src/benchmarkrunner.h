@@ -0,0 +1,94 @@
+#ifndef BENCHMARKRUNNER_H
+#define BENCHMARKRUNNER_H
+
+#include <QObject>
+#include <QProcess>
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QString>
+#include <QVector>
+#include "executionmonitor.h"
+
+class QTimer;
+
+struct BenchmarkOptions
+{
+    int iterations = 10;
+    int warmups = 2;
+    int pinCpu = -1;                // -1 = let the scheduler choose
+    bool fixedEnvironment = true;   // run with a minimal, constant environment
+    bool hashOutput = true;         // hash stdout instead of discarding it
+
+    static BenchmarkOptions load();
+    void save() const;
+};
+
+// Summary of one series of measurements, in microseconds
+struct SampleStats
+{
+    int count = 0;
+    double min = 0;
+    double median = 0;
+    double mean = 0;
+    double stddev = 0;
+    double p95 = 0;
+    int lowOutliers = 0;            // beyond 1.5 IQR below the first quartile
+    int highOutliers = 0;           // beyond 1.5 IQR above the third quartile
+
+    static SampleStats compute(QVector<double> samples);
+    static QString formatUs(double us);
+};
+
+struct BenchmarkResult
+{
+    QString executable;
+    BenchmarkOptions options;
+    QVector<double> wallUs;         // one entry per measured run
+    QVector<double> cpuUs;          // user + sys, 0 where rusage is unavailable
+    qint64 maxRssKb = 0;
+    bool outputStable = true;       // every run produced the same stdout hash
+    QByteArray outputHash;
+
+    QString report() const;
+};
+
+// Runs a compiled program repeatedly and collects timing distributions.
+// Warmup runs are executed first and thrown away; every run goes through
+// ExecutionMonitor so CPU time comes from the kernel's rusage, not from
+// the wall clock. Program output never reaches the console, where
+// rendering it would distort the timings.
+class BenchmarkRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit BenchmarkRunner(QObject *parent = nullptr);
+
+    // Runs in the executable's directory unless workingDirectory is given
+    void start(const QString &executable, const BenchmarkOptions &options, const ExecutionLimits &limits,
+               const QString &workingDirectory = QString());
+    void cancel();
+    bool isRunning() const { return m_runIndex >= 0; }
+
+signals:
+    void progress(int finishedRuns, int totalRuns);
+    void finished(const BenchmarkResult &result);
+    void failed(const QString &message);
+
+private:
+    void startRun();
+    void onRunFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void fail(const QString &message);
+
+    QProcess *m_process;            // recreated per benchmark, as redirections stick
+    QTimer *m_timeout;
+    ExecutionMonitor m_monitor;
+    ExecutionLimits m_limits;
+    QElapsedTimer m_timer;
+    QCryptographicHash m_hash;
+    qint64 m_outputBytes;
+    BenchmarkResult m_result;
+    int m_runIndex;                 // -1 when idle; counts warmups first
+};
+
+#endif // BENCHMARKRUNNER_H
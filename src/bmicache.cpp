@@ -0,0 +1,124 @@
+#include "bmicache.h"
+#include "compilecache.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSettings>
+#include <QStandardPaths>
+
+namespace {
+
+const qint64 kDefaultMaxSizeMB = 2048;
+
+} // namespace
+
+BmiCache::BmiCache()
+{
+    m_dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/bmi";
+
+    QSettings settings("AICodeEditor", "AICodeEditor");
+    m_enabled = settings.value("compileCacheEnabled", true).toBool();
+    m_maxSize = settings.value("bmiCacheMaxMB", kDefaultMaxSizeMB).toLongLong() * 1024 * 1024;
+}
+
+QString BmiCache::key(const QByteArray &commandHash, const QString &name, const QStringList &inputs,
+                      const QStringList &importKeys)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(commandHash);
+    hash.addData(name.toUtf8());
+    for (const QString &input : inputs) {
+        QFile file(input);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return QString();
+        }
+        hash.addData(input.toUtf8());
+        hash.addData(&file);
+    }
+    // Sorted, so the order the scanner listed imports in doesn't matter
+    QStringList keys = importKeys;
+    keys.sort();
+    hash.addData(keys.join('\n').toUtf8());
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+QString BmiCache::bmiPath(const QString &key, bool clang) const
+{
+    return m_dir + "/" + key + (clang ? ".pcm" : ".gcm");
+}
+
+QString BmiCache::objectPath(const QString &key) const
+{
+    return m_dir + "/" + key + ".o";
+}
+
+bool BmiCache::contains(const QString &key, bool clang, bool withObject) const
+{
+    return m_enabled && !key.isEmpty() && QFileInfo::exists(bmiPath(key, clang))
+           && (!withObject || QFileInfo::exists(objectPath(key)));
+}
+
+bool BmiCache::store(const QString &key, bool clang, const QString &bmiFile, const QString &objectFile)
+{
+    if (!m_enabled || key.isEmpty()) {
+        return false;
+    }
+    QDir().mkpath(m_dir);
+    const QString bmi = bmiPath(key, clang);
+    QFile::remove(bmi);
+    if (!QFile::rename(bmiFile, bmi) && !QFile::copy(bmiFile, bmi)) {
+        return false;
+    }
+    if (!objectFile.isEmpty()) {
+        QFile::remove(objectPath(key));
+        if (!QFile::copy(objectFile, objectPath(key))) {
+            QFile::remove(bmi);
+            return false;
+        }
+    }
+    touch(key);
+    evict();
+    return true;
+}
+
+void BmiCache::touch(const QString &key) const
+{
+    // A marker rather than the BMI's own mtime: depfiles list BMIs, and a
+    // newer BMI would make every importer look out of date
+    if (!m_enabled) {
+        return;
+    }
+    QFile marker(m_dir + "/" + key + ".used");
+    if (marker.open(QIODevice::WriteOnly)) {
+        marker.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    }
+}
+
+void BmiCache::clear()
+{
+    QDir(m_dir).removeRecursively();
+}
+
+void BmiCache::evict()
+{
+    // Entries are named by key; the path is the key's common prefix
+    QVector<CompileCache::CacheEntry> entries;
+    QDirIterator it(m_dir, {"*.used"}, QDir::Files);
+    while (it.hasNext()) {
+        const QFileInfo marker(it.next());
+        const QString prefix = m_dir + "/" + marker.completeBaseName();
+        qint64 size = 0;
+        for (const QString &suffix : {".gcm", ".pcm", ".o"}) {
+            size += qMax<qint64>(0, QFileInfo(prefix + suffix).size());
+        }
+        entries.append(CompileCache::CacheEntry{prefix, size, marker.lastModified().toMSecsSinceEpoch()});
+    }
+    for (const CompileCache::CacheEntry &entry : CompileCache::entriesToEvict(entries, m_maxSize)) {
+        for (const QString &suffix : {".gcm", ".pcm", ".o", ".used"}) {
+            QFile::remove(entry.path + suffix);
+        }
+    }
+}
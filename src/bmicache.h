@@ -0,0 +1,45 @@
+#ifndef BMICACHE_H
+#define BMICACHE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+// Content-addressed store of built module interfaces (GCC .gcm, Clang .pcm)
+// and the objects compiled alongside them. The key covers the compiler's
+// identity and flags, the contents of the interface and the headers it includes, and
+// the keys of the BMIs it imports. An interface whose content is unchanged
+// therefore maps to the same BMI whatever its timestamps say, so its
+// importers aren't rebuilt, and switching back to an earlier branch
+// finds the earlier BMIs still here. Evicted least-recently-used.
+class BmiCache
+{
+public:
+    BmiCache();
+
+    // Shares the compile cache's switch; while off nothing is looked up or stored
+    bool isEnabled() const { return m_enabled; }
+    void setEnabled(bool enabled) { m_enabled = enabled; }
+    void clear();
+
+    // Empty when an input can't be read
+    static QString key(const QByteArray &commandHash, const QString &name, const QStringList &inputs,
+                       const QStringList &importKeys);
+
+    QString bmiPath(const QString &key, bool clang) const;
+    QString objectPath(const QString &key) const;
+    // Header units have no object
+    bool contains(const QString &key, bool clang, bool withObject) const;
+    // Moves the BMI in and copies the object; marks the entry as used
+    bool store(const QString &key, bool clang, const QString &bmiFile, const QString &objectFile);
+    void touch(const QString &key) const;
+
+private:
+    void evict();
+
+    QString m_dir;
+    bool m_enabled;
+    qint64 m_maxSize;
+};
+
+#endif // BMICACHE_H
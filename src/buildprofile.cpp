@@ -0,0 +1,97 @@
+#include "buildprofile.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QSettings>
+#include <QVariantMap>
+#include <iterator>
+
+QList<BuildProfile> BuildProfiles::all()
+{
+    return {BuildProfile::Debug, BuildProfile::Release, BuildProfile::Aggressive,
+            BuildProfile::Lto, BuildProfile::Pgo};
+}
+
+QString BuildProfiles::name(BuildProfile profile)
+{
+    switch (profile) {
+    case BuildProfile::Debug: return "Debug";
+    case BuildProfile::Release: return "Release";
+    case BuildProfile::Aggressive: return "Aggressive";
+    case BuildProfile::Lto: return "LTO";
+    case BuildProfile::Pgo: return "PGO";
+    }
+    return "Debug";
+}
+
+BuildProfile BuildProfiles::fromName(const QString &name)
+{
+    for (BuildProfile profile : all()) {
+        if (BuildProfiles::name(profile) == name) {
+            return profile;
+        }
+    }
+    return BuildProfile::Debug;
+}
+
+QStringList BuildProfiles::flags(BuildProfile profile, bool msvc)
+{
+    if (msvc) {
+        switch (profile) {
+        case BuildProfile::Debug: return {"/Od"};
+        case BuildProfile::Release: return {"/O2", "/DNDEBUG"};
+        case BuildProfile::Aggressive: return {"/O2", "/Ob3", "/DNDEBUG"};
+        case BuildProfile::Lto: return {"/O2", "/GL", "/DNDEBUG"};
+        // The PGO pipeline drives GCC/Clang only; cl gets a plain release build
+        case BuildProfile::Pgo: return {"/O2", "/DNDEBUG"};
+        }
+        return {};
+    }
+
+    // Debug info stays on in optimized builds so profiles map back to lines
+    switch (profile) {
+    case BuildProfile::Debug: return {"-g"};
+    case BuildProfile::Release: return {"-O2", "-g", "-DNDEBUG"};
+    case BuildProfile::Aggressive: return {"-O3", "-march=native", "-g", "-DNDEBUG"};
+    case BuildProfile::Lto: return {"-O2", "-flto", "-g", "-DNDEBUG"};
+    case BuildProfile::Pgo: return {"-O2", "-g", "-DNDEBUG"};
+    }
+    return {};
+}
+
+BuildProfile BuildProfiles::profileFor(const QString &path)
+{
+    QSettings settings("AICodeEditor", "AICodeEditor");
+    const QVariantMap profiles = settings.value("buildProfiles").toMap();
+    if (profiles.isEmpty() || path.isEmpty()) {
+        return BuildProfile::Debug;
+    }
+
+    QString current = QDir::cleanPath(QFileInfo(path).absoluteFilePath());
+    while (true) {
+        const auto it = profiles.constFind(current);
+        if (it != profiles.constEnd()) {
+            return fromName(it->toString());
+        }
+        const QString parent = QFileInfo(current).absolutePath();
+        if (parent == current) {
+            return BuildProfile::Debug;
+        }
+        current = parent;
+    }
+}
+
+void BuildProfiles::setProfileFor(const QString &path, BuildProfile profile)
+{
+    if (path.isEmpty()) {
+        return;
+    }
+    QSettings settings("AICodeEditor", "AICodeEditor");
+    QVariantMap profiles = settings.value("buildProfiles").toMap();
+    const QString key = QDir::cleanPath(QFileInfo(path).absoluteFilePath());
+    // Choosing for a folder replaces the choices made for files inside it
+    for (auto it = profiles.begin(); it != profiles.end();) {
+        it = it.key().startsWith(key + '/') ? profiles.erase(it) : std::next(it);
+    }
+    profiles.insert(key, name(profile));
+    settings.setValue("buildProfiles", profiles);
+}
@@ -0,0 +1,32 @@
+#ifndef BUILDPROFILE_H
+#define BUILDPROFILE_H
+
+#include <QString>
+#include <QStringList>
+
+enum class BuildProfile
+{
+    Debug,
+    Release,        // -O2
+    Aggressive,     // -O3 -march=native
+    Lto,            // -O2 with link-time optimization
+    Pgo             // instrument, train, rebuild with the profile
+};
+
+// Optimization settings chosen per file or per project folder. A file
+// without its own choice inherits the one of the nearest folder above it.
+class BuildProfiles
+{
+public:
+    static QList<BuildProfile> all();
+    static QString name(BuildProfile profile);
+    static BuildProfile fromName(const QString &name);
+
+    // Added to the base language/warning flags
+    static QStringList flags(BuildProfile profile, bool msvc);
+
+    static BuildProfile profileFor(const QString &path);
+    static void setProfileFor(const QString &path, BuildProfile profile);
+};
+
+#endif // BUILDPROFILE_H
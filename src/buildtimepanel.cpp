@@ -0,0 +1,284 @@
+#include "buildtimepanel.h"
+#include "benchmarkrunner.h"
+#include <QFileInfo>
+#include <QHeaderView>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QSortFilterProxyModel>
+#include <QSplitter>
+#include <QToolTip>
+#include <QVBoxLayout>
+
+namespace {
+
+const int kRowHeight = 18;
+const int kMargin = 6;
+// Deep template recursion would otherwise make the chart mostly empty rows
+const int kMaxRows = 16;
+
+QString labelFor(const BuildTimeEvent &event)
+{
+    if (event.name == "Source") {
+        return QFileInfo(event.detail).fileName();
+    }
+    return event.detail.isEmpty() ? event.name : event.name + ": " + event.detail;
+}
+
+} // namespace
+
+BuildTimeChart::BuildTimeChart(QWidget *parent)
+    : QWidget(parent)
+    , m_totalUs(0)
+    , m_maxDepth(0)
+{
+    setMinimumHeight(120);
+    setMouseTracking(true);
+}
+
+void BuildTimeChart::setProfile(const BuildTimeProfile &profile)
+{
+    m_events = profile.events;
+    m_totalUs = profile.totalUs;
+    m_maxDepth = 0;
+    for (const BuildTimeEvent &event : m_events) {
+        m_totalUs = qMax(m_totalUs, event.startUs + event.durationUs);
+        m_maxDepth = qMax(m_maxDepth, qMin(event.depth, kMaxRows - 1));
+    }
+    setMinimumHeight(qMax(120, (m_maxDepth + 1) * kRowHeight + 2 * kMargin));
+    update();
+}
+
+QRectF BuildTimeChart::barRect(const BuildTimeEvent &event) const
+{
+    const double scale = (width() - 2.0 * kMargin) / qMax<qint64>(1, m_totalUs);
+    return QRectF(kMargin + event.startUs * scale, kMargin + event.depth * kRowHeight,
+                  event.durationUs * scale, kRowHeight - 1);
+}
+
+int BuildTimeChart::eventAt(const QPoint &pos) const
+{
+    // Deepest first, so a header wins over the frontend span around it
+    for (int i = m_events.size() - 1; i >= 0; --i) {
+        const BuildTimeEvent &event = m_events.at(i);
+        if (event.depth < kMaxRows && barRect(event).contains(pos)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void BuildTimeChart::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(30, 30, 30));
+
+    if (m_events.isEmpty()) {
+        painter.setPen(QColor(136, 136, 136));
+        painter.drawText(rect(), Qt::AlignCenter, tr("No compile profiled yet"));
+        return;
+    }
+
+    const QFontMetrics metrics = painter.fontMetrics();
+    for (const BuildTimeEvent &event : m_events) {
+        const QRectF bar = barRect(event);
+        if (event.depth >= kMaxRows || bar.width() < 1) {
+            continue;
+        }
+        QColor color;
+        if (event.name == "Source") {
+            color = QColor(70, 130, 190);
+        } else if (event.name.startsWith("Instantiate")) {
+            color = QColor(200, 130, 60);
+        } else {
+            color = QColor::fromHsv(qHash(event.name) % 360, 90, 150);
+        }
+        painter.fillRect(bar, color);
+        if (bar.width() > 30) {
+            painter.setPen(Qt::white);
+            const QRectF textRect = bar.adjusted(3, 0, -3, 0);
+            painter.drawText(textRect, Qt::AlignLeft | Qt::AlignVCenter,
+                             metrics.elidedText(labelFor(event), Qt::ElideRight, int(textRect.width())));
+        }
+    }
+}
+
+void BuildTimeChart::mouseMoveEvent(QMouseEvent *event)
+{
+    const int index = eventAt(event->position().toPoint());
+    if (index < 0) {
+        QToolTip::hideText();
+        return;
+    }
+    const BuildTimeEvent &span = m_events.at(index);
+    QString text = span.name;
+    if (!span.detail.isEmpty()) {
+        text += "\n" + span.detail;
+    }
+    text += tr("\n%1 (%2% of the compile)")
+                .arg(SampleStats::formatUs(span.durationUs))
+                .arg(100.0 * span.durationUs / qMax<qint64>(1, m_totalUs), 0, 'f', 1);
+    QToolTip::showText(event->globalPosition().toPoint(), text, this);
+}
+
+void BuildTimeChart::mouseDoubleClickEvent(QMouseEvent *event)
+{
+    const int index = eventAt(event->position().toPoint());
+    if (index >= 0 && m_events.at(index).name == "Source") {
+        emit headerActivated(m_events.at(index).detail);
+    }
+}
+
+BuildTimeCostModel::BuildTimeCostModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+void BuildTimeCostModel::setProfile(const BuildTimeProfile &profile)
+{
+    beginResetModel();
+    m_profile = profile;
+    endResetModel();
+}
+
+int BuildTimeCostModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_profile.costs.size();
+}
+
+int BuildTimeCostModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant BuildTimeCostModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_profile.costs.size()) {
+        return QVariant();
+    }
+
+    const BuildTimeCost &cost = m_profile.costs.at(index.row());
+    const double share = m_profile.totalUs > 0 ? 100.0 * cost.durationUs / m_profile.totalUs : 0;
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case NameColumn:
+            return cost.kind == BuildTimeCost::Header ? QFileInfo(cost.name).fileName() : cost.name;
+        case KindColumn: {
+            static const QStringList kinds = {tr("Header"), tr("Template"), tr("Pass")};
+            return kinds.value(cost.kind);
+        }
+        case CountColumn: return cost.count;
+        case TimeColumn: return SampleStats::formatUs(cost.durationUs);
+        case ShareColumn: return QString("%1%").arg(share, 0, 'f', 1);
+        }
+    }
+    // Sort numerically rather than by the formatted text
+    if (role == Qt::UserRole) {
+        switch (index.column()) {
+        case CountColumn: return cost.count;
+        case TimeColumn:
+        case ShareColumn:
+            return cost.durationUs;
+        default:
+            return data(index, Qt::DisplayRole);
+        }
+    }
+    if (role == Qt::TextAlignmentRole && index.column() >= CountColumn) {
+        return int(Qt::AlignRight | Qt::AlignVCenter);
+    }
+    if (role == Qt::ToolTipRole && index.column() == NameColumn) {
+        return cost.name;
+    }
+    return QVariant();
+}
+
+QVariant BuildTimeCostModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    switch (section) {
+    case NameColumn: return tr("Header / Template / Pass");
+    case KindColumn: return tr("Kind");
+    case CountColumn: return tr("Count");
+    case TimeColumn: return tr("Time");
+    case ShareColumn: return tr("Of Compile");
+    }
+    return QVariant();
+}
+
+BuildTimePanel::BuildTimePanel(QWidget *parent)
+    : QWidget(parent)
+{
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(8, 8, 8, 8);
+
+    m_summaryLabel = new QLabel(tr("Run Build > Why Is This Slow to Compile? to profile a compile"), this);
+    m_summaryLabel->setStyleSheet("color: #888;");
+    m_summaryLabel->setWordWrap(true);
+    layout->addWidget(m_summaryLabel);
+
+    QSplitter *splitter = new QSplitter(Qt::Vertical, this);
+    m_chart = new BuildTimeChart(splitter);
+    connect(m_chart, &BuildTimeChart::headerActivated, this, &BuildTimePanel::headerActivated);
+
+    m_model = new BuildTimeCostModel(this);
+    m_proxy = new QSortFilterProxyModel(this);
+    m_proxy->setSourceModel(m_model);
+    m_proxy->setSortRole(Qt::UserRole);
+
+    m_view = new QTableView(splitter);
+    m_view->setModel(m_proxy);
+    m_view->setSortingEnabled(true);
+    m_view->sortByColumn(BuildTimeCostModel::TimeColumn, Qt::DescendingOrder);
+    m_view->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_view->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_view->setWordWrap(false);
+    m_view->setShowGrid(false);
+    m_view->verticalHeader()->hide();
+    m_view->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_view->verticalHeader()->setDefaultSectionSize(m_view->fontMetrics().height() + 6);
+    m_view->horizontalHeader()->setStretchLastSection(true);
+    m_view->horizontalHeader()->resizeSection(BuildTimeCostModel::NameColumn, 360);
+    m_view->setStyleSheet(R"(
+        QTableView {
+            background-color: #1e1e1e;
+            border: 1px solid #3d3d3d;
+            border-radius: 6px;
+        }
+        QTableView::item:selected {
+            background-color: #0078d7;
+        }
+    )");
+    connect(m_view, &QTableView::activated, [this](const QModelIndex &index) {
+        const BuildTimeCost &cost = m_model->costAt(m_proxy->mapToSource(index).row());
+        if (cost.kind == BuildTimeCost::Header) {
+            emit headerActivated(cost.name);
+        }
+    });
+
+    splitter->setStretchFactor(0, 1);
+    splitter->setStretchFactor(1, 1);
+    layout->addWidget(splitter, 1);
+}
+
+void BuildTimePanel::setProfile(const BuildTimeProfile &profile)
+{
+    m_profile = profile;
+    m_chart->setProfile(profile);
+    m_model->setProfile(profile);
+
+    qint64 headersUs = 0;
+    for (auto it = profile.includeLineUs.constBegin(); it != profile.includeLineUs.constEnd(); ++it) {
+        headersUs += it.value();
+    }
+    QString summary = tr("%1 compiled in %2").arg(QFileInfo(profile.sourceFile).fileName(),
+                                                   SampleStats::formatUs(profile.totalUs));
+    if (profile.perHeader) {
+        summary += tr(", %1 of it (%2%) in its #include lines")
+                       .arg(SampleStats::formatUs(headersUs))
+                       .arg(100.0 * headersUs / qMax<qint64>(1, profile.totalUs), 0, 'f', 0);
+    } else {
+        summary += tr(". GCC reports phases and passes only; compile with Clang for per-header costs");
+    }
+    m_summaryLabel->setText(summary);
+}
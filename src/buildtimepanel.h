@@ -0,0 +1,85 @@
+#ifndef BUILDTIMEPANEL_H
+#define BUILDTIMEPANEL_H
+
+#include <QWidget>
+#include <QAbstractTableModel>
+#include <QTableView>
+#include <QLabel>
+#include "buildtimeprofiler.h"
+
+class QSortFilterProxyModel;
+
+// Flame chart of the compile: time runs left to right and nested spans
+// stack downwards, so wide bars under the frontend are the expensive headers
+class BuildTimeChart : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit BuildTimeChart(QWidget *parent = nullptr);
+
+    void setProfile(const BuildTimeProfile &profile);
+
+signals:
+    void headerActivated(const QString &filePath);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseDoubleClickEvent(QMouseEvent *event) override;
+
+private:
+    QRectF barRect(const BuildTimeEvent &event) const;
+    int eventAt(const QPoint &pos) const;
+
+    QVector<BuildTimeEvent> m_events;
+    qint64 m_totalUs;
+    int m_maxDepth;
+};
+
+class BuildTimeCostModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column { NameColumn, KindColumn, CountColumn, TimeColumn, ShareColumn, ColumnCount };
+
+    explicit BuildTimeCostModel(QObject *parent = nullptr);
+
+    void setProfile(const BuildTimeProfile &profile);
+    const BuildTimeCost &costAt(int row) const { return m_profile.costs.at(row); }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    BuildTimeProfile m_profile;
+};
+
+// Summary, flame chart and costliest headers, templates and passes of the
+// last Build > Why Is This Slow to Compile? run
+class BuildTimePanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit BuildTimePanel(QWidget *parent = nullptr);
+
+    void setProfile(const BuildTimeProfile &profile);
+    const BuildTimeProfile &profile() const { return m_profile; }
+
+signals:
+    void headerActivated(const QString &filePath);
+
+private:
+    BuildTimeProfile m_profile;
+    QLabel *m_summaryLabel;
+    BuildTimeChart *m_chart;
+    BuildTimeCostModel *m_model;
+    QSortFilterProxyModel *m_proxy;
+    QTableView *m_view;
+};
+
+#endif // BUILDTIMEPANEL_H
@@ -0,0 +1,352 @@
+#include "buildtimeprofiler.h"
+#include "guardedinvoke.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPointer>
+#include <QRegularExpression>
+#include <QTemporaryDir>
+#include <QThreadPool>
+#include <algorithm>
+
+namespace {
+
+// Spans shorter than this are left out of Clang's trace; the default of
+// 500 µs hides most individual headers
+const int kTraceGranularityUs = 50;
+
+// Beyond this many rows per kind the table only gets slower, not clearer
+const int kMaxCostsPerKind = 1000;
+
+class CostTable
+{
+public:
+    void add(BuildTimeCost::Kind kind, const QString &name, qint64 durationUs)
+    {
+        BuildTimeCost &cost = m_costs[QString::number(kind) + '\t' + name];
+        cost.kind = kind;
+        cost.name = name;
+        cost.durationUs += durationUs;
+        ++cost.count;
+    }
+
+    QVector<BuildTimeCost> sorted() const
+    {
+        QVector<BuildTimeCost> costs = m_costs.values().toVector();
+        std::sort(costs.begin(), costs.end(), [](const BuildTimeCost &a, const BuildTimeCost &b) {
+            return a.durationUs > b.durationUs;
+        });
+        QHash<int, int> perKind;
+        QVector<BuildTimeCost> kept;
+        for (const BuildTimeCost &cost : costs) {
+            if (++perKind[cost.kind] <= kMaxCostsPerKind) {
+                kept << cost;
+            }
+        }
+        return kept;
+    }
+
+private:
+    QHash<QString, BuildTimeCost> m_costs;
+};
+
+} // namespace
+
+BuildTimeProfile BuildTimeProfile::parseTimeTrace(const QByteArray &json, const QString &sourceFile,
+                                                  const QString &sourceText)
+{
+    BuildTimeProfile profile;
+    profile.sourceFile = sourceFile;
+    profile.perHeader = true;
+
+    // Only complete ("X") events of the compiling thread; the "Total ..."
+    // summaries Clang appends are aggregates, not spans
+    const QJsonArray traceEvents = QJsonDocument::fromJson(json).object().value("traceEvents").toArray();
+    QHash<qint64, int> eventsPerThread;
+    qint64 mainThread = -1;
+    for (const QJsonValue &value : traceEvents) {
+        const QJsonObject event = value.toObject();
+        const QString name = event.value("name").toString();
+        if (event.value("ph").toString() != "X" || name.startsWith("Total ")) {
+            continue;
+        }
+        const qint64 thread = event.value("tid").toInteger();
+        ++eventsPerThread[thread];
+        if (name == "ExecuteCompiler") {
+            mainThread = thread;
+        }
+    }
+    if (mainThread < 0) {
+        for (auto it = eventsPerThread.constBegin(); it != eventsPerThread.constEnd(); ++it) {
+            if (mainThread < 0 || it.value() > eventsPerThread.value(mainThread)) {
+                mainThread = it.key();
+            }
+        }
+    }
+
+    for (const QJsonValue &value : traceEvents) {
+        const QJsonObject event = value.toObject();
+        const QString name = event.value("name").toString();
+        if (event.value("ph").toString() != "X" || name.startsWith("Total ")
+            || event.value("tid").toInteger() != mainThread) {
+            continue;
+        }
+        BuildTimeEvent span;
+        span.name = name;
+        span.detail = event.value("args").toObject().value("detail").toString();
+        span.startUs = event.value("ts").toInteger();
+        span.durationUs = event.value("dur").toInteger();
+        profile.events << span;
+    }
+    if (profile.events.isEmpty()) {
+        return profile;
+    }
+
+    // Parents before their children, then nesting depth from the spans still open
+    std::sort(profile.events.begin(), profile.events.end(), [](const BuildTimeEvent &a, const BuildTimeEvent &b) {
+        return a.startUs != b.startUs ? a.startUs < b.startUs : a.durationUs > b.durationUs;
+    });
+    const qint64 origin = profile.events.first().startUs;
+    const QString mainFile = QDir::cleanPath(sourceFile);
+    QVector<qint64> openEnds;
+    QVector<qint64> openHeaderEnds;
+    QVector<const BuildTimeEvent *> directIncludes;
+    CostTable costs;
+    for (BuildTimeEvent &span : profile.events) {
+        span.startUs -= origin;
+        const qint64 end = span.startUs + span.durationUs;
+        while (!openEnds.isEmpty() && openEnds.last() <= span.startUs) {
+            openEnds.removeLast();
+        }
+        span.depth = openEnds.size();
+        openEnds << end;
+        profile.totalUs = qMax(profile.totalUs, end);
+
+        if (span.name == "Source") {
+            span.detail = QDir::cleanPath(span.detail);
+            if (span.detail == mainFile) {
+                continue;
+            }
+            while (!openHeaderEnds.isEmpty() && openHeaderEnds.last() <= span.startUs) {
+                openHeaderEnds.removeLast();
+            }
+            if (openHeaderEnds.isEmpty()) {
+                directIncludes << &span;
+            }
+            openHeaderEnds << end;
+            costs.add(BuildTimeCost::Header, span.detail, span.durationUs);
+        } else if (span.name == "InstantiateClass" || span.name == "InstantiateFunction") {
+            costs.add(BuildTimeCost::Instantiation, span.detail, span.durationUs);
+        } else if (span.depth <= 2) {
+            // ExecuteCompiler > Frontend/Backend > their phases
+            costs.add(BuildTimeCost::Pass, span.name, span.durationUs);
+        }
+    }
+    profile.costs = costs.sorted();
+
+    // Headers enter the trace in #include order, so walk both lists together;
+    // includes skipped by the preprocessor simply find no span
+    static const QRegularExpression includePattern(R"(^\s*#\s*include\s*[<"]([^>"]+)[>"])");
+    const QStringList lines = sourceText.split('\n');
+    int next = 0;
+    for (int i = 0; i < lines.size() && next < directIncludes.size(); ++i) {
+        const QRegularExpressionMatch match = includePattern.match(lines.at(i));
+        if (!match.hasMatch()) {
+            continue;
+        }
+        const QString header = QDir::cleanPath(match.captured(1));
+        for (int j = next; j < directIncludes.size(); ++j) {
+            const QString &path = directIncludes.at(j)->detail;
+            if (path == header || path.endsWith('/' + header)) {
+                profile.includeLineUs.insert(i + 1, directIncludes.at(j)->durationUs);
+                next = j + 1;
+                break;
+            }
+        }
+    }
+    return profile;
+}
+
+BuildTimeProfile BuildTimeProfile::parseTimeReport(const QString &report, const QString &sourceFile)
+{
+    BuildTimeProfile profile;
+    profile.sourceFile = sourceFile;
+
+    // " phase parsing      :   0.33 ( 57%)   0.23 ( 82%)   0.58 ( 65%)    36M ( 68%)"
+    // usr, sys and wall seconds; "|name lookup" rows overlap the others
+    static const QRegularExpression rowPattern(
+        R"(^\s*(\|?)(.+?)\s*:\s*([\d.]+)\s*\(\s*\d+%\)\s*([\d.]+)\s*\(\s*\d+%\)\s*([\d.]+)\s*\(\s*\d+%\))");
+    static const QRegularExpression totalPattern(R"(^\s*TOTAL\s*:\s*([\d.]+)\s+([\d.]+)\s+([\d.]+))");
+
+    CostTable costs;
+    qint64 phaseStart = 0;
+    for (const QString &line : report.split('\n')) {
+        const QRegularExpressionMatch total = totalPattern.match(line);
+        if (total.hasMatch()) {
+            profile.totalUs = qRound64(total.captured(3).toDouble() * 1e6);
+            continue;
+        }
+        const QRegularExpressionMatch row = rowPattern.match(line);
+        if (!row.hasMatch() || !row.captured(1).isEmpty()) {
+            continue;
+        }
+        const QString name = row.captured(2);
+        // Wall time has 10 ms resolution; short passes still show up in CPU time
+        qint64 us = qRound64(row.captured(5).toDouble() * 1e6);
+        if (us == 0) {
+            us = qRound64((row.captured(3).toDouble() + row.captured(4).toDouble()) * 1e6);
+        }
+
+        // Phases run one after another and make up the chart
+        if (name.startsWith("phase ")) {
+            BuildTimeEvent span;
+            span.name = name.mid(6);
+            span.startUs = phaseStart;
+            span.durationUs = us;
+            profile.events << span;
+            phaseStart += us;
+        } else if (us > 0) {
+            costs.add(name == "template instantiation" ? BuildTimeCost::Instantiation : BuildTimeCost::Pass,
+                      name, us);
+        }
+    }
+    if (profile.totalUs == 0) {
+        profile.totalUs = phaseStart;
+    }
+    profile.costs = costs.sorted();
+    return profile;
+}
+
+BuildTimeProfiler::BuildTimeProfiler(QObject *parent)
+    : QObject(parent)
+    , m_clang(false)
+    , m_process(nullptr)
+    , m_outputDir(nullptr)
+    , m_analyzing(false)
+    , m_generation(0)
+{
+}
+
+BuildTimeProfiler::~BuildTimeProfiler()
+{
+    cancel();
+    delete m_outputDir;
+}
+
+void BuildTimeProfiler::start(const QString &compiler, bool clang, const QStringList &flags,
+                              const QString &sourceFile)
+{
+    cancel();
+    delete m_outputDir;
+    m_outputDir = new QTemporaryDir(QDir::tempPath() + "/aicodeeditor-buildtime-XXXXXX");
+    if (!m_outputDir->isValid()) {
+        emit failed(tr("Could not create a temporary directory: %1").arg(m_outputDir->errorString()));
+        return;
+    }
+
+    m_sourceFile = QFileInfo(sourceFile).absoluteFilePath();
+    m_clang = clang;
+    m_compilerOutput.clear();
+
+    QStringList args;
+    for (const QString &flag : flags) {
+        // LTO would move code generation out of this compile and into the link
+        if (!flag.startsWith("-flto")) {
+            args << flag;
+        }
+    }
+    if (clang) {
+        // Written next to the object file as trace.json
+        args << "-ftime-trace" << QString("-ftime-trace-granularity=%1").arg(kTraceGranularityUs);
+    } else {
+        args << "-ftime-report";
+    }
+    args << "-c" << m_sourceFile << "-o" << m_outputDir->filePath("trace.o");
+
+    m_process = new QProcess(this);
+    m_process->setWorkingDirectory(QFileInfo(m_sourceFile).absolutePath());
+    m_process->setProcessChannelMode(QProcess::MergedChannels);
+    connect(m_process, &QProcess::readyRead, [this]() {
+        m_compilerOutput += QString::fromLocal8Bit(m_process->readAll());
+    });
+    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &BuildTimeProfiler::onProcessFinished);
+    connect(m_process, &QProcess::errorOccurred, [this, compiler](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            m_process->deleteLater();
+            m_process = nullptr;
+            emit failed(tr("Failed to start %1").arg(compiler));
+        }
+    });
+    m_process->start(compiler, args);
+}
+
+void BuildTimeProfiler::cancel()
+{
+    ++m_generation;
+    m_analyzing = false;
+    if (m_process) {
+        m_process->disconnect();
+        m_process->kill();
+        m_process->waitForFinished(1000);
+        m_process->deleteLater();
+        m_process = nullptr;
+    }
+}
+
+void BuildTimeProfiler::onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    m_compilerOutput += QString::fromLocal8Bit(m_process->readAll());
+    m_process->deleteLater();
+    m_process = nullptr;
+
+    if (exitStatus != QProcess::NormalExit || exitCode != 0) {
+        emit failed(tr("The compile failed, so there is nothing to profile:\n%1").arg(m_compilerOutput.trimmed()));
+        return;
+    }
+    if (m_clang && !QFile::exists(m_outputDir->filePath("trace.json"))) {
+        emit failed(tr("The compiler wrote no time trace; -ftime-trace needs Clang 9 or newer"));
+        return;
+    }
+    analyze();
+}
+
+void BuildTimeProfiler::analyze()
+{
+    m_analyzing = true;
+    emit analyzing();
+
+    QPointer<BuildTimeProfiler> guard(this);
+    const int generation = m_generation;
+    const bool clang = m_clang;
+    const QString sourceFile = m_sourceFile;
+    const QString tracePath = m_outputDir->filePath("trace.json");
+    const QString report = m_compilerOutput;
+    QThreadPool::globalInstance()->start([guard, generation, clang, sourceFile, tracePath, report]() {
+        BuildTimeProfile profile;
+        if (clang) {
+            QFile trace(tracePath);
+            QFile source(sourceFile);
+            const QByteArray json = trace.open(QIODevice::ReadOnly) ? trace.readAll() : QByteArray();
+            const QString text = source.open(QIODevice::ReadOnly) ? QString::fromUtf8(source.readAll()) : QString();
+            profile = BuildTimeProfile::parseTimeTrace(json, sourceFile, text);
+        } else {
+            profile = BuildTimeProfile::parseTimeReport(report, sourceFile);
+        }
+
+        invokeIfAlive(guard, [guard, generation, profile]() {
+            if (generation != guard->m_generation) {
+                return;
+            }
+            guard->m_analyzing = false;
+            if (profile.events.isEmpty()) {
+                emit guard->failed(tr("The compiler's timing report could not be read"));
+            } else {
+                emit guard->finished(profile);
+            }
+        });
+    });
+}
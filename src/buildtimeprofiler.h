@@ -0,0 +1,84 @@
+#ifndef BUILDTIMEPROFILER_H
+#define BUILDTIMEPROFILER_H
+
+#include <QObject>
+#include <QProcess>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class QTemporaryDir;
+
+// One timed span of the compile, e.g. parsing a header or running the backend
+struct BuildTimeEvent
+{
+    QString name;                   // "Source", "InstantiateClass", "Backend", ...
+    QString detail;                 // header path, template or function name
+    qint64 startUs = 0;
+    qint64 durationUs = 0;
+    int depth = 0;                  // nesting level, 0 for the outermost spans
+};
+
+// Summed cost of one header, template instantiation or compiler pass
+struct BuildTimeCost
+{
+    enum Kind { Header, Instantiation, Pass };
+    Kind kind = Header;
+    QString name;
+    qint64 durationUs = 0;
+    int count = 0;
+};
+
+struct BuildTimeProfile
+{
+    QString sourceFile;
+    qint64 totalUs = 0;
+    bool perHeader = false;                 // Clang's trace; GCC only reports phases and passes
+    QVector<BuildTimeEvent> events;         // sorted by start time
+    QVector<BuildTimeCost> costs;           // sorted by duration, descending
+    QHash<int, qint64> includeLineUs;       // 1-based #include line -> time spent in what it pulled in
+
+    // Clang -ftime-trace JSON; sourceText locates the #include lines
+    static BuildTimeProfile parseTimeTrace(const QByteArray &json, const QString &sourceFile,
+                                           const QString &sourceText);
+    // GCC -ftime-report table from stderr
+    static BuildTimeProfile parseTimeReport(const QString &report, const QString &sourceFile);
+};
+
+// Compiles one file to a throwaway object with Clang's -ftime-trace (or
+// GCC's -ftime-report) and works out where the time went. The trace is
+// parsed on a worker thread: each header's parse time includes everything
+// it includes and instantiates in turn, so the direct includes of the file
+// show what each #include line really costs.
+class BuildTimeProfiler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit BuildTimeProfiler(QObject *parent = nullptr);
+    ~BuildTimeProfiler();
+
+    void start(const QString &compiler, bool clang, const QStringList &flags, const QString &sourceFile);
+    void cancel();
+    bool isRunning() const { return m_process != nullptr || m_analyzing; }
+
+signals:
+    void analyzing();
+    void finished(const BuildTimeProfile &profile);
+    void failed(const QString &message);
+
+private:
+    void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void analyze();
+
+    QString m_sourceFile;
+    bool m_clang;
+    QProcess *m_process;
+    QTemporaryDir *m_outputDir;
+    QString m_compilerOutput;
+    bool m_analyzing;
+    int m_generation;               // drops results of cancelled analyses
+};
+
+#endif // BUILDTIMEPROFILER_H
@@ -1,16 +1,48 @@
 #include "codeeditor.h"
-#include "syntaxhighlighter.h"
 #include <QPainter>
 #include <QTextBlock>
 #include <QKeyEvent>
+#include <QMouseEvent>
+#include <QHelpEvent>
 #include <QScrollBar>
+#include <QCompleter>
+#include <QStringListModel>
+#include <QAbstractItemView>
+#include <QToolTip>
+
+namespace {
+// Underlining thousands of ranges makes every repaint crawl
+const int kMaxDiagnosticSelections = 1000;
+const int kGutterMarkerWidth = 12;
+
+QColor severityColor(int severity)
+{
+    switch (severity) {
+    case Diagnostic::Error: return QColor(244, 71, 71);
+    case Diagnostic::Warning: return QColor(220, 180, 60);
+    default: return QColor(90, 160, 220);
+    }
+}
+}
 
 CodeEditor::CodeEditor(QWidget *parent)
     : QPlainTextEdit(parent)
+    , m_hoveredLine(0)
+    , m_annotationWidth(0)
+    , m_annotatedBlockCount(0)
 {
     m_lineNumberArea = new LineNumberArea(this);
     m_highlighter = new SyntaxHighlighter(document());
 
+    m_completionModel = new QStringListModel(this);
+    m_completer = new QCompleter(m_completionModel, this);
+    m_completer->setWidget(this);
+    m_completer->setCompletionMode(QCompleter::PopupCompletion);
+    m_completer->setCaseSensitivity(Qt::CaseInsensitive);
+    m_completer->setMaxVisibleItems(12);
+    connect(m_completer, QOverload<const QString &>::of(&QCompleter::activated),
+            this, &CodeEditor::insertCompletion);
+
     // Set font
     QFont font("Consolas", 11);
     font.setStyleHint(QFont::Monospace);
@@ -24,6 +56,7 @@ CodeEditor::CodeEditor(QWidget *parent)
     // Editor settings
     setLineWrapMode(QPlainTextEdit::NoWrap);
     setWordWrapMode(QTextOption::NoWrap);
+    viewport()->setMouseTracking(true);
 
     // Connect signals
     connect(this, &CodeEditor::blockCountChanged,
@@ -49,13 +82,241 @@ int CodeEditor::lineNumberAreaWidth()
         ++digits;
     }
 
-    int space = 15 + fontMetrics().horizontalAdvance(QLatin1Char('9')) * digits;
-    return space;
+    int space = 15 + kGutterMarkerWidth + fontMetrics().horizontalAdvance(QLatin1Char('9')) * digits;
+    return space + m_annotationWidth;
+}
+
+void CodeEditor::goToLine(int line, int column)
+{
+    QTextBlock block = document()->findBlockByNumber(qMax(0, line - 1));
+    if (!block.isValid()) {
+        return;
+    }
+    QTextCursor cursor(block);
+    cursor.movePosition(QTextCursor::Right, QTextCursor::MoveAnchor,
+                        qMin(column, block.length() - 1));
+    setTextCursor(cursor);
+    centerCursor();
+    setFocus();
+}
+
+QString CodeEditor::symbolUnderCursor(const QTextCursor &cursor) const
+{
+    const QString text = cursor.block().text();
+    const int pos = cursor.positionInBlock();
+
+    auto isSymbolChar = [&text](int i) {
+        return i >= 0 && i < text.size()
+            && (text[i].isLetterOrNumber() || text[i] == '_' || text[i] == ':');
+    };
+
+    int start = pos;
+    while (isSymbolChar(start - 1)) {
+        --start;
+    }
+    int end = pos;
+    while (isSymbolChar(end)) {
+        ++end;
+    }
+
+    QString symbol = text.mid(start, end - start);
+    while (symbol.startsWith(':')) {
+        symbol.remove(0, 1);
+    }
+    while (symbol.endsWith(':')) {
+        symbol.chop(1);
+    }
+    return symbol;
+}
+
+void CodeEditor::setDiagnostics(const QString &source, const QVector<Diagnostic> &diagnostics)
+{
+    if (diagnostics.isEmpty()) {
+        m_diagnostics.remove(source);
+    } else {
+        m_diagnostics.insert(source, diagnostics);
+    }
+    rebuildDiagnosticSelections();
+}
+
+void CodeEditor::clearDiagnostics()
+{
+    m_diagnostics.clear();
+    rebuildDiagnosticSelections();
+}
+
+void CodeEditor::rebuildDiagnosticSelections()
+{
+    m_diagnosticSelections.clear();
+
+    for (const QVector<Diagnostic> &diagnostics : qAsConst(m_diagnostics)) {
+        for (const Diagnostic &diagnostic : diagnostics) {
+            if (m_diagnosticSelections.size() >= kMaxDiagnosticSelections) {
+                break;
+            }
+            QTextBlock block = document()->findBlockByNumber(diagnostic.line - 1);
+            if (!block.isValid()) {
+                continue;
+            }
+
+            QTextCursor cursor(block);
+            const int start = qBound(0, diagnostic.column - 1, block.length() - 1);
+            cursor.setPosition(block.position() + start);
+            QTextBlock endBlock = diagnostic.endLine > 0
+                ? document()->findBlockByNumber(diagnostic.endLine - 1) : block;
+            if (endBlock.isValid() && (diagnostic.endLine > diagnostic.line || diagnostic.endColumn > diagnostic.column)) {
+                const int end = qBound(0, diagnostic.endColumn - 1, endBlock.length() - 1);
+                cursor.setPosition(endBlock.position() + end, QTextCursor::KeepAnchor);
+            } else {
+                // Point diagnostics underline the word they start at
+                cursor.movePosition(QTextCursor::EndOfWord, QTextCursor::KeepAnchor);
+                if (!cursor.hasSelection()) {
+                    cursor.movePosition(QTextCursor::Right, QTextCursor::KeepAnchor);
+                }
+            }
+
+            QTextEdit::ExtraSelection selection;
+            selection.cursor = cursor;
+            selection.format.setUnderlineStyle(QTextCharFormat::WaveUnderline);
+            selection.format.setUnderlineColor(severityColor(diagnostic.severity));
+            selection.format.setToolTip(diagnostic.message);
+            selection.format.setProperty(QTextFormat::UserProperty, int(diagnostic.severity));
+            m_diagnosticSelections.append(selection);
+        }
+    }
+
+    highlightCurrentLine();
+    m_lineNumberArea->update();
+}
+
+void CodeEditor::setSemanticTokens(const QHash<int, QVector<SemanticToken>> &tokensByLine)
+{
+    m_highlighter->setSemanticTokens(tokensByLine);
+}
+
+QString CodeEditor::completionPrefix() const
+{
+    QTextCursor cursor = textCursor();
+    const QString text = cursor.block().text();
+    int start = cursor.positionInBlock();
+    while (start > 0 && (text[start - 1].isLetterOrNumber() || text[start - 1] == '_')) {
+        --start;
+    }
+    return text.mid(start, cursor.positionInBlock() - start);
+}
+
+void CodeEditor::requestCompletionAtCursor()
+{
+    const QTextCursor cursor = textCursor();
+    emit completionRequested(cursor.blockNumber(), cursor.positionInBlock());
+}
+
+void CodeEditor::showCompletions(const QStringList &items, int line, int character)
+{
+    // The user may have moved on while the server was thinking
+    const QTextCursor cursor = textCursor();
+    const int wordStart = cursor.positionInBlock() - completionPrefix().size();
+    if (items.isEmpty() || cursor.blockNumber() != line
+        || character < wordStart || character > cursor.positionInBlock()) {
+        return;
+    }
+
+    m_completionModel->setStringList(items);
+    m_completer->setCompletionPrefix(completionPrefix());
+    if (m_completer->completionCount() == 0) {
+        m_completer->popup()->hide();
+        return;
+    }
+
+    QRect rect = cursorRect();
+    rect.setWidth(m_completer->popup()->sizeHintForColumn(0)
+                  + m_completer->popup()->verticalScrollBar()->sizeHint().width());
+    m_completer->popup()->setCurrentIndex(m_completer->completionModel()->index(0, 0));
+    m_completer->complete(rect);
+}
+
+void CodeEditor::insertCompletion(const QString &completion)
+{
+    if (m_completer->widget() != this) {
+        return;
+    }
+    QTextCursor cursor = textCursor();
+    cursor.movePosition(QTextCursor::Left, QTextCursor::KeepAnchor, completionPrefix().size());
+    cursor.insertText(completion);
+    setTextCursor(cursor);
+}
+
+bool CodeEditor::event(QEvent *event)
+{
+    if (event->type() == QEvent::ToolTip) {
+        QHelpEvent *helpEvent = static_cast<QHelpEvent *>(event);
+        const QTextCursor cursor = cursorForPosition(viewport()->mapFromGlobal(helpEvent->globalPos()));
+
+        // Diagnostics under the mouse win over hover info
+        for (const QTextEdit::ExtraSelection &selection : qAsConst(m_diagnosticSelections)) {
+            if (cursor.position() >= selection.cursor.selectionStart()
+                && cursor.position() <= selection.cursor.selectionEnd()) {
+                QToolTip::showText(helpEvent->globalPos(), selection.format.toolTip(), this);
+                return true;
+            }
+        }
+
+        QToolTip::hideText();
+        emit hoverRequested(cursor.blockNumber(), cursor.positionInBlock(), helpEvent->globalPos());
+        return true;
+    }
+    return QPlainTextEdit::event(event);
 }
 
 void CodeEditor::updateLineNumberAreaWidth(int /* newBlockCount */)
 {
+    // Annotations are keyed by line number, which an inserted or removed line invalidates
+    if (!m_lineAnnotations.isEmpty() && blockCount() != m_annotatedBlockCount) {
+        clearLineAnnotations();
+        return;
+    }
+    setViewportMargins(lineNumberAreaWidth(), 0, 0, 0);
+}
+
+void CodeEditor::setLineAnnotations(const QHash<int, LineAnnotation> &annotations)
+{
+    m_lineAnnotations.clear();
+    m_annotationWidth = 0;
+    for (auto it = annotations.constBegin(); it != annotations.constEnd(); ++it) {
+        m_lineAnnotations.insert(it.key() - 1, it.value());
+        m_annotationWidth = qMax(m_annotationWidth, fontMetrics().horizontalAdvance(it.value().text) + 8);
+    }
+    m_annotatedBlockCount = blockCount();
+    setViewportMargins(lineNumberAreaWidth(), 0, 0, 0);
+    m_lineNumberArea->update();
+}
+
+void CodeEditor::clearLineAnnotations()
+{
+    if (m_lineAnnotations.isEmpty()) {
+        return;
+    }
+    m_lineAnnotations.clear();
+    m_annotationWidth = 0;
     setViewportMargins(lineNumberAreaWidth(), 0, 0, 0);
+    m_lineNumberArea->update();
+}
+
+void CodeEditor::setLinkedLines(const QSet<int> &lines)
+{
+    m_linkedSelections.clear();
+    for (int line : lines) {
+        const QTextBlock block = document()->findBlockByNumber(line - 1);
+        if (!block.isValid()) {
+            continue;
+        }
+        QTextEdit::ExtraSelection selection;
+        selection.format.setBackground(QColor(38, 79, 120));
+        selection.format.setProperty(QTextFormat::FullWidthSelection, true);
+        selection.cursor = QTextCursor(block);
+        m_linkedSelections.append(selection);
+    }
+    highlightCurrentLine();
 }
 
 void CodeEditor::updateLineNumberArea(const QRect &rect, int dy)
@@ -93,6 +354,8 @@ void CodeEditor::highlightCurrentLine()
         extraSelections.append(selection);
     }
 
+    extraSelections.append(m_linkedSelections);
+    extraSelections.append(m_diagnosticSelections);
     setExtraSelections(extraSelections);
 }
 
@@ -101,6 +364,18 @@ void CodeEditor::lineNumberAreaPaintEvent(QPaintEvent *event)
     QPainter painter(m_lineNumberArea);
     painter.fillRect(event->rect(), QColor(30, 30, 30));
 
+    // Worst severity per line; the selection cursors follow edits, so the
+    // markers stay on their lines while typing
+    QHash<int, int> lineSeverity;
+    for (const QTextEdit::ExtraSelection &selection : qAsConst(m_diagnosticSelections)) {
+        const int line = document()->findBlock(selection.cursor.selectionStart()).blockNumber();
+        const int severity = selection.format.property(QTextFormat::UserProperty).toInt();
+        auto it = lineSeverity.find(line);
+        if (it == lineSeverity.end() || severity < it.value()) {
+            lineSeverity.insert(line, severity);
+        }
+    }
+
     QTextBlock block = firstVisibleBlock();
     int blockNumber = block.blockNumber();
     int top = qRound(blockBoundingGeometry(block).translated(contentOffset()).top());
@@ -108,6 +383,16 @@ void CodeEditor::lineNumberAreaPaintEvent(QPaintEvent *event)
 
     while (block.isValid() && top <= event->rect().bottom()) {
         if (block.isVisible() && bottom >= event->rect().top()) {
+            auto annotation = m_lineAnnotations.constFind(blockNumber);
+            if (annotation != m_lineAnnotations.constEnd()) {
+                QColor heat(244, 71, 71);
+                heat.setAlphaF(0.15 + 0.6 * qBound(0.0, annotation->heat, 1.0));
+                painter.fillRect(0, top, m_lineNumberArea->width(), bottom - top, heat);
+                painter.setPen(QColor(230, 230, 230));
+                painter.drawText(kGutterMarkerWidth, top, m_annotationWidth, fontMetrics().height(),
+                                 Qt::AlignLeft, annotation->text);
+            }
+
             QString number = QString::number(blockNumber + 1);
             painter.setPen(QColor(100, 100, 100));
 
@@ -118,6 +403,16 @@ void CodeEditor::lineNumberAreaPaintEvent(QPaintEvent *event)
             painter.drawText(0, top, m_lineNumberArea->width() - 8,
                            fontMetrics().height(),
                            Qt::AlignRight, number);
+
+            auto severity = lineSeverity.constFind(blockNumber);
+            if (severity != lineSeverity.constEnd()) {
+                const int size = qMin(8, fontMetrics().height() - 4);
+                painter.setRenderHint(QPainter::Antialiasing);
+                painter.setPen(Qt::NoPen);
+                painter.setBrush(severityColor(severity.value()));
+                painter.drawEllipse(3, top + (fontMetrics().height() - size) / 2, size, size);
+                painter.setRenderHint(QPainter::Antialiasing, false);
+            }
         }
 
         block = block.next();
@@ -127,8 +422,61 @@ void CodeEditor::lineNumberAreaPaintEvent(QPaintEvent *event)
     }
 }
 
+void CodeEditor::mouseReleaseEvent(QMouseEvent *event)
+{
+    QPlainTextEdit::mouseReleaseEvent(event);
+
+    // Ctrl+click jumps to the definition
+    if (event->button() == Qt::LeftButton && (event->modifiers() & Qt::ControlModifier)) {
+        const QString symbol = symbolUnderCursor(cursorForPosition(event->pos()));
+        if (!symbol.isEmpty()) {
+            emit definitionRequested(symbol);
+        }
+    }
+}
+
+void CodeEditor::mouseMoveEvent(QMouseEvent *event)
+{
+    QPlainTextEdit::mouseMoveEvent(event);
+
+    const int line = cursorForPosition(event->pos()).blockNumber() + 1;
+    if (line != m_hoveredLine) {
+        m_hoveredLine = line;
+        emit lineHovered(line);
+    }
+}
+
+bool CodeEditor::viewportEvent(QEvent *event)
+{
+    if (event->type() == QEvent::Leave && m_hoveredLine != 0) {
+        m_hoveredLine = 0;
+        emit lineHovered(0);
+    }
+    return QPlainTextEdit::viewportEvent(event);
+}
+
 void CodeEditor::keyPressEvent(QKeyEvent *event)
 {
+    // Let the completion popup handle its own navigation keys
+    if (m_completer->popup()->isVisible()) {
+        switch (event->key()) {
+        case Qt::Key_Enter:
+        case Qt::Key_Return:
+        case Qt::Key_Escape:
+        case Qt::Key_Tab:
+        case Qt::Key_Backtab:
+            event->ignore();
+            return;
+        default:
+            break;
+        }
+    }
+
+    if (event->key() == Qt::Key_Space && (event->modifiers() & Qt::ControlModifier)) {
+        requestCompletionAtCursor();
+        return;
+    }
+
     // Auto-indentation
     if (event->key() == Qt::Key_Return || event->key() == Qt::Key_Enter) {
         QTextCursor cursor = textCursor();
@@ -199,4 +547,19 @@ void CodeEditor::keyPressEvent(QKeyEvent *event)
     }
 
     QPlainTextEdit::keyPressEvent(event);
+
+    // Member access and scope operators trigger completion on their own
+    const QString typed = event->text();
+    const QString before = textCursor().block().text().left(textCursor().positionInBlock());
+    if (typed == "." || (typed == ">" && before.endsWith("->")) || (typed == ":" && before.endsWith("::"))) {
+        requestCompletionAtCursor();
+    } else if (m_completer->popup()->isVisible()) {
+        const QString prefix = completionPrefix();
+        if (prefix.isEmpty() && !typed.isEmpty() && !typed.at(0).isLetterOrNumber()) {
+            m_completer->popup()->hide();
+        } else {
+            m_completer->setCompletionPrefix(prefix);
+            m_completer->popup()->setCurrentIndex(m_completer->completionModel()->index(0, 0));
+        }
+    }
 }
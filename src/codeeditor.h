@@ -3,9 +3,22 @@
 
 #include <QPlainTextEdit>
 #include <QWidget>
+#include <QHash>
+#include <QSet>
+#include "diagnostic.h"
+#include "syntaxhighlighter.h"
 
 class LineNumberArea;
-class SyntaxHighlighter;
+
+// Short gutter label for a line, e.g. a profiler's sample share
+struct LineAnnotation
+{
+    QString text;
+    double heat = 0;        // 0..1, tints the gutter behind the line
+};
+
+class QCompleter;
+class QStringListModel;
 
 class CodeEditor : public QPlainTextEdit
 {
@@ -16,19 +29,56 @@ public:
 
     void lineNumberAreaPaintEvent(QPaintEvent *event);
     int lineNumberAreaWidth();
+    void goToLine(int line, int column = 0);
+    QString symbolUnderCursor(const QTextCursor &cursor) const;
+
+    // Diagnostics are kept per source (e.g. "clangd") so providers don't clobber each other
+    void setDiagnostics(const QString &source, const QVector<Diagnostic> &diagnostics);
+    void clearDiagnostics();
+    void setSemanticTokens(const QHash<int, QVector<SemanticToken>> &tokensByLine);
+    void showCompletions(const QStringList &items, int line, int character);
+    // Keyed by 1-based line; dropped once lines are inserted or removed
+    void setLineAnnotations(const QHash<int, LineAnnotation> &annotations);
+    void clearLineAnnotations();
+    // Tints 1-based lines tied to something under the mouse elsewhere, e.g. an instruction
+    void setLinkedLines(const QSet<int> &lines);
+
+signals:
+    void definitionRequested(const QString &symbol);
+    void completionRequested(int line, int character);     // 0-based
+    void hoverRequested(int line, int character, const QPoint &globalPos);
+    void lineHovered(int line);         // 1-based, 0 when the mouse leaves
 
 protected:
+    bool event(QEvent *event) override;
     void resizeEvent(QResizeEvent *event) override;
     void keyPressEvent(QKeyEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    bool viewportEvent(QEvent *event) override;
 
 private slots:
     void updateLineNumberAreaWidth(int newBlockCount);
     void highlightCurrentLine();
     void updateLineNumberArea(const QRect &rect, int dy);
+    void insertCompletion(const QString &completion);
 
 private:
+    void rebuildDiagnosticSelections();
+    QString completionPrefix() const;
+    void requestCompletionAtCursor();
+
     LineNumberArea *m_lineNumberArea;
     SyntaxHighlighter *m_highlighter;
+    QCompleter *m_completer;
+    QStringListModel *m_completionModel;
+    QHash<QString, QVector<Diagnostic>> m_diagnostics;
+    QList<QTextEdit::ExtraSelection> m_diagnosticSelections;
+    QList<QTextEdit::ExtraSelection> m_linkedSelections;
+    int m_hoveredLine;
+    QHash<int, LineAnnotation> m_lineAnnotations;      // 0-based block number
+    int m_annotationWidth;
+    int m_annotatedBlockCount;
 };
 
 class LineNumberArea : public QWidget
@@ -0,0 +1,397 @@
+#include "compilecache.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QSaveFile>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <algorithm>
+
+namespace {
+
+const int kManifestVersion = 1;
+const int kMaxManifestEntries = 8;
+const qint64 kDefaultMaxSizeMB = 1024;
+
+qint64 modificationTime(const QFileInfo &info)
+{
+    return info.lastModified().toMSecsSinceEpoch();
+}
+
+} // namespace
+
+CompileCache::CompileCache()
+{
+    m_dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/compile";
+
+    QSettings settings("AICodeEditor", "AICodeEditor");
+    m_enabled = settings.value("compileCacheEnabled", true).toBool();
+    m_maxSize = settings.value("compileCacheMaxMB", kDefaultMaxSizeMB).toLongLong() * 1024 * 1024;
+}
+
+void CompileCache::setEnabled(bool enabled)
+{
+    m_enabled = enabled;
+    QSettings settings("AICodeEditor", "AICodeEditor");
+    settings.setValue("compileCacheEnabled", enabled);
+}
+
+QByteArray CompileCache::compilerIdentity(const QString &compilerPath)
+{
+    // Reinstalling or upgrading the compiler changes its size or mtime, so
+    // "--version" only has to run once per binary
+    const QFileInfo info(compilerPath);
+    const QString statKey = QString("%1|%2|%3").arg(info.canonicalFilePath())
+                                .arg(info.size()).arg(modificationTime(info));
+    auto it = m_compilerIds.constFind(statKey);
+    if (it != m_compilerIds.constEnd()) {
+        return it.value();
+    }
+
+    QProcess process;
+    process.start(compilerPath, {"--version"});
+    if (!process.waitForFinished(5000) || process.exitStatus() != QProcess::NormalExit) {
+        process.kill();
+        return QByteArray();
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(statKey.toUtf8());
+    hash.addData(process.readAllStandardOutput());
+    const QByteArray identity = hash.result();
+    m_compilerIds.insert(statKey, identity);
+    return identity;
+}
+
+QString CompileCache::directKey(const QString &compilerPath, const QStringList &arguments,
+                                const QString &sourceFile)
+{
+    if (!m_enabled || compilerPath.isEmpty()) {
+        return QString();
+    }
+    const QByteArray identity = compilerIdentity(compilerPath);
+    QFile source(sourceFile);
+    if (identity.isEmpty() || !source.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray::number(kManifestVersion));
+    hash.addData(identity);
+    for (const QString &argument : arguments) {
+        hash.addData(argument.toUtf8());
+        hash.addData("\0", 1);
+    }
+    // Debug info embeds the source path, so the same text elsewhere is a different object
+    hash.addData(QFileInfo(sourceFile).absoluteFilePath().toUtf8());
+    hash.addData(&source);
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+QString CompileCache::manifestPath(const QString &directKey) const
+{
+    return m_dir + "/manifests/" + directKey.left(2) + "/" + directKey;
+}
+
+QString CompileCache::resultPath(const QString &resultKey) const
+{
+    return m_dir + "/results/" + resultKey.left(2) + "/" + resultKey;
+}
+
+QString CompileCache::depFilePath(const QString &directKey) const
+{
+    QDir().mkpath(m_dir + "/tmp");
+    return m_dir + "/tmp/" + directKey + ".d";
+}
+
+QByteArray CompileCache::hashFile(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(&file);
+    return hash.result().toHex();
+}
+
+QVector<CompileCache::ManifestEntry> CompileCache::readManifest(const QString &directKey) const
+{
+    QVector<ManifestEntry> entries;
+    QFile file(manifestPath(directKey));
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return entries;
+    }
+
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        const QString line = in.readLine();
+        const QStringList fields = line.split('\t');
+        if (fields.size() == 2 && fields[0] == "result") {
+            ManifestEntry entry;
+            entry.resultKey = fields[1];
+            entries.append(entry);
+        } else if (fields.size() == 5 && fields[0] == "dep" && !entries.isEmpty()) {
+            Dependency dependency;
+            dependency.hash = fields[1].toLatin1();
+            dependency.size = fields[2].toLongLong();
+            dependency.mtime = fields[3].toLongLong();
+            dependency.path = fields[4];
+            entries.last().dependencies.append(dependency);
+        }
+    }
+    return entries;
+}
+
+void CompileCache::writeManifest(const QString &directKey, const QVector<ManifestEntry> &entries) const
+{
+    const QString path = manifestPath(directKey);
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return;
+    }
+    QTextStream out(&file);
+    for (const ManifestEntry &entry : entries) {
+        out << "result\t" << entry.resultKey << "\n";
+        for (const Dependency &dependency : entry.dependencies) {
+            out << "dep\t" << dependency.hash << "\t" << dependency.size << "\t"
+                << dependency.mtime << "\t" << dependency.path << "\n";
+        }
+    }
+    out.flush();
+    file.commit();
+}
+
+bool CompileCache::dependenciesMatch(const QVector<Dependency> &dependencies) const
+{
+    for (const Dependency &dependency : dependencies) {
+        const QFileInfo info(dependency.path);
+        if (!info.exists()) {
+            return false;
+        }
+        // Unchanged size and mtime is trusted; otherwise fall back to the content
+        // (e.g. after a checkout touched the header without editing it)
+        if (info.size() == dependency.size && modificationTime(info) == dependency.mtime) {
+            continue;
+        }
+        if (info.size() != dependency.size || hashFile(dependency.path) != dependency.hash) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CompileCache::lookup(const QString &directKey, const QString &outputPath, QString *output)
+{
+    if (directKey.isEmpty()) {
+        return false;
+    }
+
+    for (const ManifestEntry &entry : readManifest(directKey)) {
+        if (!dependenciesMatch(entry.dependencies)) {
+            continue;
+        }
+
+        const QString result = resultPath(entry.resultKey);
+        QFile artifact(result + "/artifact");
+        QFile log(result + "/output");
+        if (!artifact.exists() || !log.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            continue;
+        }
+
+        QFile::remove(outputPath);
+        if (!artifact.copy(outputPath)) {
+            return false;
+        }
+        QFile::setPermissions(outputPath, artifact.permissions());
+        if (output) {
+            *output = QString::fromUtf8(log.readAll());
+        }
+
+        // Touch the artifact so eviction sees it as recently used
+        if (artifact.open(QIODevice::ReadOnly)) {
+            artifact.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+        }
+        return true;
+    }
+    return false;
+}
+
+QStringList CompileCache::parseDepFile(const QByteArray &contents)
+{
+    // Make-style: "target: dep dep \<newline> dep", spaces in names escaped as "\ "
+    QString text = QString::fromLocal8Bit(contents);
+    text.replace("\\\r\n", " ");
+    text.replace("\\\n", " ");
+
+    QStringList tokens;
+    QString current;
+    for (int i = 0; i < text.size(); ++i) {
+        const QChar c = text[i];
+        if (c == '\\' && i + 1 < text.size() && text[i + 1] == ' ') {
+            current += ' ';
+            ++i;
+        } else if (c.isSpace()) {
+            if (!current.isEmpty()) {
+                tokens.append(current);
+                current.clear();
+            }
+        } else {
+            current += c;
+        }
+    }
+    if (!current.isEmpty()) {
+        tokens.append(current);
+    }
+
+    // Skip the target (which may itself contain a drive letter colon)
+    QStringList dependencies;
+    bool pastTarget = false;
+    for (const QString &token : qAsConst(tokens)) {
+        if (!pastTarget) {
+            pastTarget = token.endsWith(':');
+            continue;
+        }
+        if (token.endsWith(':')) {
+            break;  // phony targets from -MP
+        }
+        dependencies.append(token);
+    }
+    return dependencies;
+}
+
+void CompileCache::store(const QString &directKey, const QString &workingDir,
+                         const QString &artifactPath, const QString &output)
+{
+    if (directKey.isEmpty()) {
+        return;
+    }
+
+    const QString depFile = depFilePath(directKey);
+    QFile deps(depFile);
+    if (!deps.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    const QStringList paths = parseDepFile(deps.readAll());
+    deps.close();
+    QFile::remove(depFile);
+
+    ManifestEntry entry;
+    QCryptographicHash resultHash(QCryptographicHash::Sha1);
+    resultHash.addData(directKey.toLatin1());
+    const QDir base(workingDir);
+    for (const QString &path : paths) {
+        const QFileInfo info(base.absoluteFilePath(path));
+        Dependency dependency;
+        dependency.path = QDir::cleanPath(info.absoluteFilePath());
+        dependency.size = info.size();
+        dependency.mtime = modificationTime(info);
+        dependency.hash = hashFile(dependency.path);
+        if (dependency.hash.isEmpty()) {
+            return;
+        }
+        resultHash.addData(dependency.path.toUtf8());
+        resultHash.addData(dependency.hash);
+        entry.dependencies.append(dependency);
+    }
+    entry.resultKey = QString::fromLatin1(resultHash.result().toHex());
+
+    // Stage the result next to its final place and rename it in, so a crash
+    // never leaves a half-written artifact behind a valid key
+    const QString result = resultPath(entry.resultKey);
+    if (!QFileInfo::exists(result)) {
+        const QString staging = result + ".tmp";
+        QDir(staging).removeRecursively();
+        QDir().mkpath(staging);
+
+        QFile log(staging + "/output");
+        if (!QFile::copy(artifactPath, staging + "/artifact")
+            || !log.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            QDir(staging).removeRecursively();
+            return;
+        }
+        log.write(output.toUtf8());
+        log.close();
+        if (!QDir().rename(staging, result)) {
+            QDir(staging).removeRecursively();
+            return;
+        }
+    }
+
+    QVector<ManifestEntry> entries = readManifest(directKey);
+    entries.erase(std::remove_if(entries.begin(), entries.end(), [&entry](const ManifestEntry &existing) {
+        return existing.resultKey == entry.resultKey;
+    }), entries.end());
+    entries.prepend(entry);
+    entries.resize(qMin(int(entries.size()), kMaxManifestEntries));
+    writeManifest(directKey, entries);
+
+    evict();
+}
+
+qint64 CompileCache::totalSize() const
+{
+    qint64 total = 0;
+    QDirIterator it(m_dir + "/results", QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        total += it.fileInfo().size();
+    }
+    return total;
+}
+
+QVector<CompileCache::CacheEntry> CompileCache::entriesToEvict(QVector<CacheEntry> entries, qint64 maxSize)
+{
+    qint64 total = 0;
+    for (const CacheEntry &entry : qAsConst(entries)) {
+        total += entry.size;
+    }
+    QVector<CacheEntry> evicted;
+    if (total <= maxSize) {
+        return evicted;
+    }
+
+    // Trim to 90% so the next few stores don't each pay for a scan and delete
+    std::sort(entries.begin(), entries.end(), [](const CacheEntry &a, const CacheEntry &b) {
+        return a.lastUsed < b.lastUsed;
+    });
+    const qint64 target = maxSize / 10 * 9;
+    for (const CacheEntry &entry : qAsConst(entries)) {
+        if (total <= target) {
+            break;
+        }
+        evicted.append(entry);
+        total -= entry.size;
+    }
+    return evicted;
+}
+
+void CompileCache::evict()
+{
+    QVector<CacheEntry> results;
+    QDirIterator buckets(m_dir + "/results", QDir::Dirs | QDir::NoDotAndDotDot);
+    while (buckets.hasNext()) {
+        QDirIterator entries(buckets.next(), QDir::Dirs | QDir::NoDotAndDotDot);
+        while (entries.hasNext()) {
+            const QString path = entries.next();
+            const QFileInfo artifact(path + "/artifact");
+            const qint64 size = artifact.size() + QFileInfo(path + "/output").size();
+            results.append(CacheEntry{path, size, modificationTime(artifact)});
+        }
+    }
+    for (const CacheEntry &result : entriesToEvict(results, m_maxSize)) {
+        QDir(result.path).removeRecursively();
+    }
+}
+
+void CompileCache::clear()
+{
+    QDir(m_dir).removeRecursively();
+}
@@ -0,0 +1,84 @@
+#ifndef COMPILECACHE_H
+#define COMPILECACHE_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QByteArray>
+#include <QVector>
+
+// ccache-style store for compiler outputs. A job is first keyed on the
+// compiler identity, its arguments and the source text ("direct key"); the
+// manifest under that key lists the headers the last compiles pulled in,
+// with their hashes, and which result each include set produced. Results
+// live outside the source tree and are evicted least-recently-used.
+class CompileCache
+{
+public:
+    CompileCache();
+
+    bool isEnabled() const { return m_enabled; }
+    void setEnabled(bool enabled);
+    void setMaxSize(qint64 bytes) { m_maxSize = bytes; }
+    QString cacheDir() const { return m_dir; }
+
+    // Empty when the job can't be cached (unknown compiler, unreadable source)
+    QString directKey(const QString &compilerPath, const QStringList &arguments,
+                      const QString &sourceFile);
+    QString depFilePath(const QString &directKey) const;
+
+    // On a hit the cached artifact is copied to outputPath
+    bool lookup(const QString &directKey, const QString &outputPath, QString *output);
+    void store(const QString &directKey, const QString &workingDir,
+               const QString &artifactPath, const QString &output);
+
+    void clear();
+    qint64 totalSize() const;
+
+    // Dependencies listed in a make-style depfile, as written by -MD/-MMD
+    static QStringList parseDepFile(const QByteArray &contents);
+
+    // Hash of the binary's path, size, mtime and --version output; empty
+    // for a compiler that doesn't answer --version
+    QByteArray compilerIdentity(const QString &compilerPath);
+
+    // One evictable unit of a size-bounded cache
+    struct CacheEntry
+    {
+        QString path;
+        qint64 size = 0;
+        qint64 lastUsed = 0;    // ms since epoch
+    };
+    // Least recently used entries to delete once their total exceeds maxSize
+    static QVector<CacheEntry> entriesToEvict(QVector<CacheEntry> entries, qint64 maxSize);
+
+private:
+    struct Dependency
+    {
+        QString path;
+        qint64 size = 0;
+        qint64 mtime = 0;
+        QByteArray hash;
+    };
+
+    struct ManifestEntry
+    {
+        QString resultKey;
+        QVector<Dependency> dependencies;
+    };
+
+    QString manifestPath(const QString &directKey) const;
+    QString resultPath(const QString &resultKey) const;
+    QVector<ManifestEntry> readManifest(const QString &directKey) const;
+    void writeManifest(const QString &directKey, const QVector<ManifestEntry> &entries) const;
+    bool dependenciesMatch(const QVector<Dependency> &dependencies) const;
+    static QByteArray hashFile(const QString &path);
+    void evict();
+
+    QString m_dir;
+    bool m_enabled;
+    qint64 m_maxSize;
+    QHash<QString, QByteArray> m_compilerIds;   // "path|size|mtime" -> identity hash
+};
+
+#endif // COMPILECACHE_H
@@ -1,23 +1,153 @@
 #include "compilerservice.h"
+#include <QFile>
 #include <QFileInfo>
+#include <QCryptographicHash>
+#include <QDateTime>
 #include <QDir>
 #include <QSettings>
+#include <QStandardPaths>
+#include <QTimer>
+#include "diagnosticparser.h"
 
 CompilerService::CompilerService(QObject *parent)
     : QObject(parent)
-    , m_runAfterCompile(false)
+    , m_runOutputBytes(0)
+    , m_currentProfile(BuildProfile::Debug)
+    , m_afterBuild(NoAction)
+    , m_buildJob(0)
+    , m_executionJob(0)
+    , m_buildTimeJob(0)
 {
+    m_scheduler = new JobScheduler(this);
     m_compileProcess = new QProcess(this);
     m_runProcess = new QProcess(this);
 
+    // Diagnostics are parsed as the compiler prints them, not after it exits
+    m_compileProcess->setProcessChannelMode(QProcess::MergedChannels);
+    connect(m_compileProcess, &QProcess::readyReadStandardOutput,
+            this, &CompilerService::onCompileOutputReady);
     connect(m_compileProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
             this, &CompilerService::onCompileProcessFinished);
     connect(m_runProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
             this, &CompilerService::onRunProcessFinished);
+    connect(m_runProcess, &QProcess::readyReadStandardOutput, [this]() {
+        onRunOutputReady(QProcess::StandardOutput);
+    });
+    connect(m_runProcess, &QProcess::readyReadStandardError, [this]() {
+        onRunOutputReady(QProcess::StandardError);
+    });
+    connect(m_runProcess, &QProcess::started, [this]() {
+        m_monitor.started();
+    });
+    connect(m_runProcess, &QProcess::errorOccurred, [this](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            m_runTimeout->stop();
+            m_monitor.finish(0);
+            const JobId job = m_executionJob;
+            m_executionJob = 0;
+            emit executionFinished(QString("[Failed to start: %1]").arg(m_runProcess->errorString()));
+            m_scheduler->finish(job, false);
+        }
+    });
+
+    m_benchmarkOptions = BenchmarkOptions::load();
+    m_benchmarkRunner = new BenchmarkRunner(this);
+    connect(m_benchmarkRunner, &BenchmarkRunner::progress, [this](int done, int total) {
+        m_scheduler->setProgress(m_executionJob, done, total);
+        emit benchmarkProgress(done, total);
+    });
+    connect(m_benchmarkRunner, &BenchmarkRunner::finished, [this](const BenchmarkResult &result) {
+        emit benchmarkFinished(result);
+        recordRun("benchmark", result.wallUs, result.cpuUs, result.maxRssKb);
+        finishExecution(true);
+    });
+    connect(m_benchmarkRunner, &BenchmarkRunner::failed, [this](const QString &message) {
+        emit benchmarkFailed(message);
+        finishExecution(false);
+    });
+
+    m_perfProfiler = new PerfProfiler(this);
+    connect(m_perfProfiler, &PerfProfiler::output, this, &CompilerService::executionOutput);
+    connect(m_perfProfiler, &PerfProfiler::analyzing, this, &CompilerService::profileAnalyzing);
+    connect(m_perfProfiler, &PerfProfiler::finished, [this](const ProfileResult &result) {
+        emit profileFinished(result);
+        finishExecution(true);
+    });
+    connect(m_perfProfiler, &PerfProfiler::failed, [this](const QString &message) {
+        emit profileFailed(message);
+        finishExecution(false);
+    });
+
+    m_heapProfiler = new HeapProfiler(this);
+    connect(m_heapProfiler, &HeapProfiler::output, this, &CompilerService::executionOutput);
+    connect(m_heapProfiler, &HeapProfiler::analyzing, this, &CompilerService::memoryProfileAnalyzing);
+    connect(m_heapProfiler, &HeapProfiler::finished, [this](const HeapProfile &profile) {
+        emit memoryProfileFinished(profile);
+        finishExecution(true);
+    });
+    connect(m_heapProfiler, &HeapProfiler::failed, [this](const QString &message) {
+        emit memoryProfileFailed(message);
+        finishExecution(false);
+    });
+
+    m_buildTimeProfiler = new BuildTimeProfiler(this);
+    connect(m_buildTimeProfiler, &BuildTimeProfiler::analyzing, this, &CompilerService::buildTimeProfileAnalyzing);
+    connect(m_buildTimeProfiler, &BuildTimeProfiler::finished, [this](const BuildTimeProfile &profile) {
+        emit buildTimeProfileFinished(profile);
+        m_scheduler->finish(m_buildTimeJob, true);
+    });
+    connect(m_buildTimeProfiler, &BuildTimeProfiler::failed, [this](const QString &message) {
+        emit buildTimeProfileFailed(message);
+        m_scheduler->finish(m_buildTimeJob, false);
+    });
+
+    m_testRunner = new TestRunner(this);
+    connect(m_testRunner, &TestRunner::discovered, this, &CompilerService::testsDiscovered);
+    connect(m_testRunner, &TestRunner::testChanged, this, &CompilerService::testChanged);
+    connect(m_testRunner, &TestRunner::progress, [this](int done, int total) {
+        m_scheduler->setProgress(m_executionJob, done, total);
+        emit testProgress(done, total);
+    });
+    connect(m_testRunner, &TestRunner::finished, [this](int passed, int failed) {
+        emit testsFinished(passed, failed);
+        finishExecution(failed == 0);
+    });
+    connect(m_testRunner, &TestRunner::failed, [this](const QString &message) {
+        emit testsFailed(message);
+        finishExecution(false);
+    });
+
+    m_limits = ExecutionLimits::load();
+    m_runTimeout = new QTimer(this);
+    m_runTimeout->setSingleShot(true);
+    connect(m_runTimeout, &QTimer::timeout, [this]() {
+        killRun(QString("wall-clock timeout of %1 ms exceeded").arg(m_limits.wallTimeoutMs));
+    });
+
+    m_pchCache = new PchCache(this);
+    m_pgoPipeline = new PgoPipeline(this);
+    connect(m_pgoPipeline, &PgoPipeline::stageStarted, this, &CompilerService::buildStageChanged);
+    connect(m_pgoPipeline, &PgoPipeline::diagnosticsFound, this, &CompilerService::diagnosticsFound);
+    connect(m_pgoPipeline, &PgoPipeline::finished, this, &CompilerService::finishCompilation);
+    m_projectBuilder = new ProjectBuilder(this);
+    connect(m_projectBuilder, &ProjectBuilder::progress, [this](int done, int total) {
+        m_scheduler->setProgress(m_buildJob, done, total);
+        emit buildProgress(done, total);
+    });
+    connect(m_projectBuilder, &ProjectBuilder::stageChanged, this, &CompilerService::buildStageChanged);
+    connect(m_projectBuilder, &ProjectBuilder::diagnosticsFound, this, &CompilerService::diagnosticsFound);
+    connect(m_projectBuilder, &ProjectBuilder::finished,
+            [this](bool success, const QString &output, const QString &executablePath) {
+        if (success) {
+            m_currentOutputPath = executablePath;
+        }
+        finishCompilation(success, output);
+    });
 
     // Load saved compiler or default to g++
     QSettings settings("AICodeEditor", "AICodeEditor");
     m_compiler = settings.value("compiler", "g++").toString();
+    m_languageStandard = settings.value("languageStandard", "c++17").toString();
 }
 
 void CompilerService::setCompiler(const QString &compiler)
@@ -27,30 +157,78 @@ void CompilerService::setCompiler(const QString &compiler)
     settings.setValue("compiler", compiler);
 }
 
+QString CompilerService::standardFlag(const QString &standard, bool msvc)
+{
+    if (!msvc) {
+        return "-std=" + standard;
+    }
+    // cl has no /std:c++23 yet; its latest is the closest
+    return "/std:" + (standard == "c++23" ? QString("c++latest") : standard);
+}
+
+void CompilerService::setCacheEnabled(bool enabled)
+{
+    m_cache.setEnabled(enabled);
+    m_projectBuilder->setCacheEnabled(enabled);
+}
+
+void CompilerService::clearCache()
+{
+    m_cache.clear();
+    m_projectBuilder->clearCache();
+}
+
+void CompilerService::setLanguageStandard(const QString &standard)
+{
+    m_languageStandard = standard;
+    QSettings settings("AICodeEditor", "AICodeEditor");
+    settings.setValue("languageStandard", standard);
+}
+
+void CompilerService::setExecutionLimits(const ExecutionLimits &limits)
+{
+    m_limits = limits;
+    m_limits.save();
+}
+
+void CompilerService::setBenchmarkOptions(const BenchmarkOptions &options)
+{
+    m_benchmarkOptions = options;
+    m_benchmarkOptions.save();
+}
+
 QString CompilerService::getCompilerCommand() const
 {
-    if (m_compiler == "g++" || m_compiler == "mingw-g++") {
+    // "mingw-g++" is what older settings saved for MinGW's g++
+    if (m_compiler.isEmpty() || m_compiler == "mingw-g++") {
         return "g++";
-    } else if (m_compiler == "clang++") {
-        return "clang++";
-    } else if (m_compiler == "cl") {
-        return "cl";
     }
-    return "g++";
+    return m_compiler;
+}
+
+bool CompilerService::isMsvc() const
+{
+    return m_compiler == "cl";
 }
 
-QStringList CompilerService::getCompilerFlags() const
+bool CompilerService::isClang() const
+{
+    return QFileInfo(m_compiler).fileName().contains("clang");
+}
+
+QStringList CompilerService::getCompilerFlags(BuildProfile profile) const
 {
     QStringList flags;
 
-    if (m_compiler == "cl") {
+    if (isMsvc()) {
         // MSVC flags
-        flags << "/EHsc" << "/W4" << "/std:c++17";
+        flags << "/EHsc" << "/W4" << standardFlag(m_languageStandard, true);
     } else {
         // GCC/Clang flags
-        flags << "-std=c++17" << "-Wall" << "-Wextra" << "-g";
+        flags << standardFlag(m_languageStandard, false) << "-Wall" << "-Wextra";
     }
 
+    flags << BuildProfiles::flags(profile, isMsvc());
     return flags;
 }
 
@@ -69,14 +247,114 @@ QString CompilerService::getOutputPath(const QString &sourceFile) const
 
 void CompilerService::compile(const QString &sourceFile)
 {
-    m_runAfterCompile = false;
+    submitBuild(sourceFile, NoAction, false);
+}
+
+void CompilerService::submitBuild(const QString &path, AfterBuild afterBuild, bool project,
+                                  const QStringList &tests)
+{
+    JobScheduler::JobSpec spec;
+    spec.description = (project ? tr("Build project %1") : tr("Build %1")).arg(QFileInfo(path).fileName());
+    // One compiler process and one set of build state
+    spec.resource = "build";
+    // Building the same file or project again makes the running build stale
+    spec.supersedeKey = "build:" + QFileInfo(path).absoluteFilePath();
+    spec.priority = JobScheduler::Interactive;
+    m_scheduler->submit(spec, [this, path, afterBuild, project, tests](JobId id) {
+        m_buildJob = id;
+        m_afterBuild = afterBuild;
+        m_afterBuildTests = tests;
+        if (project) {
+            startProjectBuild(path);
+        } else {
+            startCompile(path);
+        }
+    }, [this]() {
+        cancelBuild();
+    });
+}
+
+void CompilerService::cancelBuild()
+{
+    m_buildJob = 0;
+    m_pgoPipeline->cancel();
+    m_projectBuilder->cancel();
+    if (m_compileProcess->state() != QProcess::NotRunning) {
+        // The output handlers see no current job and drop what's left
+        m_compileProcess->kill();
+        m_compileProcess->waitForFinished(1000);
+    }
+    if (!m_cacheKey.isEmpty()) {
+        QFile::remove(m_cache.depFilePath(m_cacheKey));
+        m_cacheKey.clear();
+    }
+    m_pchKey.clear();
+    m_compileOutput.clear();
+    emit compilationCancelled();
+}
+
+void CompilerService::startCompile(const QString &sourceFile)
+{
     m_currentSourceFile = sourceFile;
     m_currentOutputPath = getOutputPath(sourceFile);
 
     QString compiler = getCompilerCommand();
-    QStringList args = getCompilerFlags();
+    m_currentProfile = BuildProfiles::profileFor(sourceFile);
+    QStringList args = getCompilerFlags(m_currentProfile);
+    if (!isMsvc()) {
+        args << DiagnosticParser::gccFlags();
+    }
+
+    m_compileOutput.clear();
+    m_compileDecoder = QStringDecoder(QStringDecoder::System);
+    m_diagnosticParser.reset();
+    m_diagnosticParser.setWorkingDirectory(QFileInfo(sourceFile).absolutePath());
+    emit compilationStarted();
+
+    // PGO runs its own staged, cached pipeline; cl falls back to a release build
+    if (m_currentProfile == BuildProfile::Pgo && !isMsvc()) {
+        m_pgoPipeline->start(compiler, isClang(), args, sourceFile, m_currentOutputPath,
+                             PgoTrainingInput::load(), m_limits.wallTimeoutMs);
+        return;
+    }
 
-    if (m_compiler == "cl") {
+    // Leading system includes come from a precompiled header once one is built
+    m_pchKey.clear();
+    if (!isMsvc()) {
+        const QString pchKey = m_pchCache->prepare(QStandardPaths::findExecutable(compiler),
+                                                   isClang(), args, sourceFile);
+        const QStringList pchArgs = m_pchCache->usageArguments(pchKey);
+        if (!pchArgs.isEmpty()) {
+            m_pchKey = pchKey;
+            args << pchArgs;
+        }
+    }
+
+    // The cache tracks headers through GCC/Clang depfiles; MSVC builds always run
+    m_cacheKey.clear();
+    if (!isMsvc()) {
+        m_cacheKey = m_cache.directKey(QStandardPaths::findExecutable(compiler), args, sourceFile);
+        QString cachedOutput;
+        if (m_cache.lookup(m_cacheKey, m_currentOutputPath, &cachedOutput)) {
+            m_cacheKey.clear();
+            // Stay asynchronous so callers see the same signal order as a real build
+            const JobId job = m_buildJob;
+            QTimer::singleShot(0, this, [this, cachedOutput, job]() {
+                if (job != m_buildJob) {
+                    return;
+                }
+                const QVector<Diagnostic> diagnostics = DiagnosticParser::parse(
+                    cachedOutput, QFileInfo(m_currentSourceFile).absolutePath());
+                if (!diagnostics.isEmpty()) {
+                    emit diagnosticsFound(diagnostics);
+                }
+                finishCompilation(true, cachedOutput + "\n[compile cache hit]");
+            });
+            return;
+        }
+    }
+
+    if (isMsvc()) {
         // MSVC uses /Fe for output
         args << "/Fe:" + m_currentOutputPath;
         args << sourceFile;
@@ -84,6 +362,11 @@ void CompilerService::compile(const QString &sourceFile)
         // GCC/Clang use -o for output
         args << "-o" << m_currentOutputPath;
         args << sourceFile;
+        // Link order matters: libraries come after the source that uses them
+        args << TestRunner::linkFlags(sourceFile);
+        if (!m_cacheKey.isEmpty()) {
+            args << "-MD" << "-MF" << m_cache.depFilePath(m_cacheKey);
+        }
     }
 
     m_compileProcess->setWorkingDirectory(QFileInfo(sourceFile).absolutePath());
@@ -92,69 +375,386 @@ void CompilerService::compile(const QString &sourceFile)
 
 void CompilerService::run()
 {
-    if (m_currentOutputPath.isEmpty() || !QFileInfo::exists(m_currentOutputPath)) {
-        emit executionFinished("Error: No compiled executable found. Please compile first.");
+    submitExecution(RunAfterBuild);
+}
+
+void CompilerService::submitExecution(AfterBuild kind, const QStringList &tests)
+{
+    const RunTarget target{m_currentOutputPath, m_currentSourceFile, m_currentProfile, tests};
+    if (target.executable.isEmpty() || !QFileInfo::exists(target.executable)) {
+        const QString message = "Error: No compiled executable found. Please compile first.";
+        switch (kind) {
+        case RunAfterBuild: emit executionFinished(message); break;
+        case BenchmarkAfterBuild: emit benchmarkFailed(message); break;
+        case ProfileAfterBuild: emit profileFailed(message); break;
+        case MemoryProfileAfterBuild: emit memoryProfileFailed(message); break;
+        case TestAfterBuild: emit testsFailed(message); break;
+        case NoAction: break;
+        }
         return;
     }
 
-    m_runProcess->setWorkingDirectory(QFileInfo(m_currentOutputPath).absolutePath());
-    m_runProcess->start(m_currentOutputPath, QStringList());
+    static const QStringList verbs = {QString(), tr("Run %1"), tr("Benchmark %1"), tr("Profile %1"),
+                                      tr("Profile memory of %1"), tr("Test %1")};
+    JobScheduler::JobSpec spec;
+    spec.description = verbs.value(kind).arg(QFileInfo(target.executable).fileName());
+    // One program at a time, so runs don't disturb benchmarks and profiles
+    spec.resource = "execution";
+    // Starting the same kind again replaces the one in flight
+    spec.supersedeKey = "execution:" + QString::number(kind);
+    spec.priority = kind == RunAfterBuild ? JobScheduler::Interactive : JobScheduler::Normal;
+    m_scheduler->submit(spec, [this, kind, target](JobId id) {
+        m_executionJob = id;
+        m_runTarget = target;
+        switch (kind) {
+        case RunAfterBuild:
+            startRun();
+            break;
+        case BenchmarkAfterBuild:
+            emit benchmarkStarted();
+            m_benchmarkRunner->start(target.executable, m_benchmarkOptions, m_limits);
+            break;
+        case ProfileAfterBuild:
+            emit profileStarted();
+            m_perfProfiler->start(target.executable, m_limits.wallTimeoutMs);
+            break;
+        case MemoryProfileAfterBuild:
+            emit memoryProfileStarted();
+            m_heapProfiler->start(target.executable, m_limits);
+            break;
+        case TestAfterBuild:
+            emit testsStarted();
+            // The run-time limit applies to each test case rather than the whole run
+            m_testRunner->start(target.executable, target.tests, m_limits.wallTimeoutMs);
+            break;
+        case NoAction:
+            finishExecution(false);
+            break;
+        }
+    }, [this, kind]() {
+        cancelExecution(kind);
+    });
+}
+
+void CompilerService::cancelExecution(AfterBuild kind)
+{
+    m_executionJob = 0;
+    switch (kind) {
+    case RunAfterBuild:
+        // The finished handler still reports the kill
+        killRun("cancelled");
+        m_runProcess->waitForFinished(1000);
+        break;
+    case BenchmarkAfterBuild:
+        m_benchmarkRunner->cancel();
+        emit benchmarkFailed("Benchmark cancelled");
+        break;
+    case ProfileAfterBuild:
+        m_perfProfiler->cancel();
+        emit profileFailed("Profile cancelled");
+        break;
+    case MemoryProfileAfterBuild:
+        m_heapProfiler->cancel();
+        emit memoryProfileFailed("Memory profile cancelled");
+        break;
+    case TestAfterBuild:
+        m_testRunner->cancel();
+        emit testsFailed("Test run cancelled");
+        break;
+    case NoAction:
+        break;
+    }
+}
+
+void CompilerService::finishExecution(bool success)
+{
+    const JobId job = m_executionJob;
+    m_executionJob = 0;
+    m_scheduler->finish(job, success);
+}
+
+void CompilerService::startRun()
+{
+    m_stdoutDecoder = QStringDecoder(QStringDecoder::System);
+    m_stderrDecoder = QStringDecoder(QStringDecoder::System);
+    m_runOutputBytes = 0;
+    m_runKillReason.clear();
+    emit executionStarted();
+
+    m_monitor.prepare(m_runProcess, m_limits);
+    m_runProcess->setWorkingDirectory(QFileInfo(m_runTarget.executable).absolutePath());
+    m_runTimer.start();
+    m_runProcess->start(m_runTarget.executable, QStringList());
+    if (m_limits.wallTimeoutMs > 0) {
+        m_runTimeout->start(m_limits.wallTimeoutMs);
+    }
+}
+
+void CompilerService::killRun(const QString &reason)
+{
+    if (m_runProcess->state() == QProcess::NotRunning || !m_runKillReason.isEmpty()) {
+        return;
+    }
+    m_runKillReason = reason;
+    m_runProcess->kill();
 }
 
 void CompilerService::compileAndRun(const QString &sourceFile)
 {
-    m_runAfterCompile = true;
-    m_currentSourceFile = sourceFile;
-    m_currentOutputPath = getOutputPath(sourceFile);
+    submitBuild(sourceFile, RunAfterBuild, false);
+}
 
-    compile(sourceFile);
+void CompilerService::benchmark()
+{
+    submitExecution(BenchmarkAfterBuild);
 }
 
-void CompilerService::onCompileProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
+void CompilerService::compileAndBenchmark(const QString &sourceFile)
 {
-    Q_UNUSED(exitStatus);
+    submitBuild(sourceFile, BenchmarkAfterBuild, false);
+}
+
+void CompilerService::profile()
+{
+    submitExecution(ProfileAfterBuild);
+}
+
+void CompilerService::compileAndProfile(const QString &sourceFile)
+{
+    submitBuild(sourceFile, ProfileAfterBuild, false);
+}
+
+void CompilerService::profileMemory()
+{
+    submitExecution(MemoryProfileAfterBuild);
+}
 
-    QString output;
-    QString stdOut = m_compileProcess->readAllStandardOutput();
-    QString stdErr = m_compileProcess->readAllStandardError();
+void CompilerService::compileAndProfileMemory(const QString &sourceFile)
+{
+    submitBuild(sourceFile, MemoryProfileAfterBuild, false);
+}
+
+void CompilerService::runTests(const QStringList &onlyTests)
+{
+    submitExecution(TestAfterBuild, onlyTests);
+}
 
-    if (!stdOut.isEmpty()) {
-        output += stdOut;
+void CompilerService::compileAndRunTests(const QString &sourceFile, const QStringList &onlyTests)
+{
+    submitBuild(sourceFile, TestAfterBuild, false, onlyTests);
+}
+
+void CompilerService::stopTests()
+{
+    if (m_testRunner->isRunning()) {
+        m_scheduler->cancel(m_executionJob);
     }
-    if (!stdErr.isEmpty()) {
-        if (!output.isEmpty()) output += "\n";
-        output += stdErr;
+}
+
+void CompilerService::profileBuildTime(const QString &sourceFile)
+{
+    if (isMsvc()) {
+        emit buildTimeProfileFailed(tr("Compile-time profiling needs GCC or Clang"));
+        return;
     }
 
+    JobScheduler::JobSpec spec;
+    spec.description = tr("Profile compile of %1").arg(QFileInfo(sourceFile).fileName());
+    // Another compile competing for the CPU would inflate every number
+    spec.resource = "build";
+    spec.supersedeKey = "buildtime";
+    m_scheduler->submit(spec, [this, sourceFile](JobId id) {
+        m_buildTimeJob = id;
+        emit buildTimeProfileStarted();
+        m_buildTimeProfiler->start(getCompilerCommand(), isClang(),
+                                   getCompilerFlags(BuildProfiles::profileFor(sourceFile)), sourceFile);
+    }, [this]() {
+        m_buildTimeJob = 0;
+        m_buildTimeProfiler->cancel();
+        emit buildTimeProfileFailed(tr("Compile-time profile cancelled"));
+    });
+}
+
+void CompilerService::buildProject(const QString &rootPath)
+{
+    submitBuild(rootPath, NoAction, true);
+}
+
+void CompilerService::buildAndRunProject(const QString &rootPath)
+{
+    submitBuild(rootPath, RunAfterBuild, true);
+}
+
+void CompilerService::startProjectBuild(const QString &rootPath)
+{
+    m_currentSourceFile = rootPath;
+    // Project builds apply the PGO profile's release flags without training
+    m_currentProfile = BuildProfiles::profileFor(rootPath);
+    QStringList flags = getCompilerFlags(m_currentProfile);
+    if (!isMsvc()) {
+        flags << DiagnosticParser::gccFlags();
+    }
+    emit compilationStarted();
+    const QString compiler = getCompilerCommand();
+    m_projectBuilder->build(rootPath, compiler, m_cache.compilerIdentity(QStandardPaths::findExecutable(compiler)),
+                            flags, isMsvc(), isClang());
+}
+
+void CompilerService::onCompileOutputReady()
+{
+    if (m_buildJob == 0) {
+        return;     // a cancelled build
+    }
+    const QString text = m_compileDecoder.decode(m_compileProcess->readAllStandardOutput());
+    if (text.isEmpty()) {
+        return;
+    }
+    m_compileOutput += text;
+    m_diagnosticParser.feed(text);
+
+    const QVector<Diagnostic> diagnostics = m_diagnosticParser.takeDiagnostics();
+    if (!diagnostics.isEmpty()) {
+        emit diagnosticsFound(diagnostics);
+    }
+}
+
+void CompilerService::onCompileProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if (m_buildJob == 0) {
+        return;
+    }
+    onCompileOutputReady();
+    m_diagnosticParser.finish();
+    const QVector<Diagnostic> diagnostics = m_diagnosticParser.takeDiagnostics();
+    if (!diagnostics.isEmpty()) {
+        emit diagnosticsFound(diagnostics);
+    }
+
+    QString output = m_compileOutput.trimmed();
+    m_compileOutput.clear();
+
     if (output.isEmpty() && exitCode == 0) {
         output = "Build completed successfully.";
     }
 
-    bool success = (exitCode == 0);
+    bool success = (exitCode == 0 && exitStatus == QProcess::NormalExit);
+    if (success && !m_cacheKey.isEmpty()) {
+        m_cache.store(m_cacheKey, m_compileProcess->workingDirectory(), m_currentOutputPath, output);
+    } else if (!m_cacheKey.isEmpty()) {
+        QFile::remove(m_cache.depFilePath(m_cacheKey));
+    }
+    m_cacheKey.clear();
+
+    // A stale or incompatible PCH (e.g. headers updated underneath it) fails
+    // the whole compile; drop it and retry once without
+    if (!success && !m_pchKey.isEmpty()
+        && (output.contains("precompiled header") || output.contains(".gch") || output.contains(".pch"))) {
+        m_pchCache->discard(m_pchKey);
+        startCompile(m_currentSourceFile);
+        return;
+    }
+
+    finishCompilation(success, output);
+}
+
+void CompilerService::finishCompilation(bool success, const QString &output)
+{
+    if (m_buildJob == 0) {
+        return;
+    }
+    const JobId job = m_buildJob;
+    m_buildJob = 0;
     emit compilationFinished(success, output);
 
-    if (success && m_runAfterCompile) {
-        run();
+    // Queued while this build still owns the output path; finishing the job
+    // may start the next build straight away
+    if (success && m_afterBuild != NoAction) {
+        submitExecution(m_afterBuild, m_afterBuildTests);
     }
+    m_scheduler->finish(job, success);
+}
+
+void CompilerService::onRunOutputReady(QProcess::ProcessChannel channel)
+{
+    // Decoders keep state so a UTF-8 sequence split across reads survives
+    m_runProcess->setReadChannel(channel);
+    const QByteArray data = m_runProcess->readAll();
+    if (data.isEmpty()) {
+        return;
+    }
+    // Pipes aren't covered by RLIMIT_FSIZE, so the output cap is enforced here
+    if (!m_runKillReason.isEmpty()) {
+        return;
+    }
+    m_runOutputBytes += data.size();
+    if (m_limits.maxOutputBytes > 0 && m_runOutputBytes > m_limits.maxOutputBytes) {
+        killRun(QString("output limit of %1 MB exceeded").arg(m_limits.maxOutputBytes / (1024 * 1024)));
+        return;
+    }
+    const bool isError = channel == QProcess::StandardError;
+    QStringDecoder &decoder = isError ? m_stderrDecoder : m_stdoutDecoder;
+    emit executionOutput(decoder.decode(data), isError);
 }
 
 void CompilerService::onRunProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
 {
-    Q_UNUSED(exitStatus);
+    m_runTimeout->stop();
+    onRunOutputReady(QProcess::StandardOutput);
+    onRunOutputReady(QProcess::StandardError);
 
-    QString output;
-    QString stdOut = m_runProcess->readAllStandardOutput();
-    QString stdErr = m_runProcess->readAllStandardError();
+    const ResourceUsage usage = m_monitor.finish(m_runTimer.nsecsElapsed() / 1000);
 
-    if (!stdOut.isEmpty()) {
-        output += stdOut;
+    QString status;
+    if (!m_runKillReason.isEmpty()) {
+        status = QString("[Process killed: %1]").arg(m_runKillReason);
+    } else if (usage.cpuLimitExceeded) {
+        status = QString("[Process killed: CPU time limit of %1 s exceeded]").arg(m_limits.cpuSeconds);
+    } else if (usage.termSignal != 0) {
+        status = QString("[Process terminated by signal %1]").arg(usage.termSignal);
+    } else if (exitStatus == QProcess::CrashExit) {
+        status = "[Process crashed]";
+    } else {
+        status = QString("[Process exited with code %1]").arg(exitCode);
     }
-    if (!stdErr.isEmpty()) {
-        if (!output.isEmpty()) output += "\n";
-        output += "Errors:\n" + stdErr;
+    const bool completed = m_runKillReason.isEmpty() && usage.termSignal == 0 && exitStatus == QProcess::NormalExit;
+    m_runKillReason.clear();
+    const JobId job = m_executionJob;
+    m_executionJob = 0;
+
+    QString report = status + "\n[" + usage.summary() + "]";
+    const QString counters = usage.counters.summary();
+    if (!counters.isEmpty()) {
+        report += "\n[" + counters + "]";
     }
+    emit executionFinished(report);
+    if (completed && usage.valid && job != 0) {
+        recordRun("run", {double(usage.wallUs)}, {double(usage.userUs + usage.systemUs)}, usage.maxRssKb);
+    }
+    m_scheduler->finish(job, completed);
+}
 
-    output += QString("\n\n[Process exited with code %1]").arg(exitCode);
+void CompilerService::recordRun(const QString &kind, const QVector<double> &wallUs,
+                                const QVector<double> &cpuUs, qint64 maxRssKb)
+{
+    RunRecord record;
+    record.timestamp = QDateTime::currentDateTime();
+    record.kind = kind;
+    record.program = m_runTarget.executable;
+    record.source = m_runTarget.source;
+    record.compiler = m_compiler;
+    record.flags = getCompilerFlags(m_runTarget.profile);
+    record.wallUs = wallUs;
+    record.cpuUs = cpuUs;
+    record.maxRssKb = maxRssKb;
+
+    QFile source(m_runTarget.source);
+    if (QFileInfo(m_runTarget.source).isFile() && source.open(QIODevice::ReadOnly)) {
+        record.sourceHash = QString::fromLatin1(QCryptographicHash::hash(source.readAll(),
+                                                                         QCryptographicHash::Sha1).toHex());
+    }
 
-    emit executionFinished(output);
+    const RunComparison comparison = m_history.record(record);
+    if (comparison.comparable) {
+        emit performanceCompared(comparison.describe(), comparison.slower);
+    }
 }
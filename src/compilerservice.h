@@ -4,6 +4,24 @@
 #include <QObject>
 #include <QProcess>
 #include <QString>
+#include <QStringDecoder>
+#include <QElapsedTimer>
+#include "compilecache.h"
+#include "projectbuilder.h"
+#include "pchcache.h"
+#include "diagnosticparser.h"
+#include "executionmonitor.h"
+#include "benchmarkrunner.h"
+#include "runhistory.h"
+#include "buildprofile.h"
+#include "pgopipeline.h"
+#include "perfprofiler.h"
+#include "heapprofiler.h"
+#include "jobscheduler.h"
+#include "buildtimeprofiler.h"
+#include "testrunner.h"
+
+class QTimer;
 
 class CompilerService : public QObject
 {
@@ -14,30 +32,169 @@ public:
 
     void setCompiler(const QString &compiler);
     QString currentCompiler() const { return m_compiler; }
+    bool isMsvc() const;
+    bool isClang() const;
+    // "c++17", "c++20" or "c++23"; C++20 modules need c++20 or later
+    QString languageStandard() const { return m_languageStandard; }
+    void setLanguageStandard(const QString &standard);
+    // "-std=c++20", or "/std:c++20" for cl
+    static QString standardFlag(const QString &standard, bool msvc);
 
     void compile(const QString &sourceFile);
     void run();
     void compileAndRun(const QString &sourceFile);
+    void benchmark();
+    void compileAndBenchmark(const QString &sourceFile);
+    void profile();
+    void compileAndProfile(const QString &sourceFile);
+    void profileMemory();
+    void compileAndProfileMemory(const QString &sourceFile);
+    // Where the compiler spends its time on this file, per phase and header
+    void profileBuildTime(const QString &sourceFile);
+    // Unit tests of the built binary, sharded across cores; onlyTests
+    // narrows the run, e.g. to the previous failures
+    void runTests(const QStringList &onlyTests = QStringList());
+    void compileAndRunTests(const QString &sourceFile, const QStringList &onlyTests = QStringList());
+    void stopTests();
+
+    // Multi-file builds of every source under rootPath
+    void buildProject(const QString &rootPath);
+    void buildAndRunProject(const QString &rootPath);
+
+    QString getCompilerCommand() const;
+    QStringList getCompilerFlags(BuildProfile profile = BuildProfile::Debug) const;
+
+    bool isCacheEnabled() const { return m_cache.isEnabled(); }
+    // Both apply to module BMIs as well as compiled files
+    void setCacheEnabled(bool enabled);
+    void clearCache();
+    bool isPchEnabled() const { return m_pchCache->isEnabled(); }
+    void setPchEnabled(bool enabled) { m_pchCache->setEnabled(enabled); }
+
+    ExecutionLimits executionLimits() const { return m_limits; }
+    void setExecutionLimits(const ExecutionLimits &limits);
+    QString executablePath() const { return m_currentOutputPath; }
+    // Source of the program the current or last run executes
+    QString runSource() const { return m_runTarget.source; }
+    QVector<RunRecord> runHistory(const QString &program) const { return m_history.recordsFor(program); }
+
+    BenchmarkOptions benchmarkOptions() const { return m_benchmarkOptions; }
+    void setBenchmarkOptions(const BenchmarkOptions &options);
+
+    // Every build and run above is a job here; cancelAll() is Build > Stop
+    JobScheduler *scheduler() const { return m_scheduler; }
 
 signals:
+    void compilationStarted();
     void compilationFinished(bool success, const QString &output);
+    void compilationCancelled();
+    void diagnosticsFound(const QVector<Diagnostic> &diagnostics);
+    void executionStarted();
+    void executionOutput(const QString &text, bool isError);  // streamed while the program runs
     void executionFinished(const QString &output);
+    void buildProgress(int finishedJobs, int totalJobs);
+    void buildStageChanged(const QString &description);
+    void benchmarkStarted();
+    void benchmarkProgress(int finishedRuns, int totalRuns);
+    void benchmarkFinished(const BenchmarkResult &result);
+    void benchmarkFailed(const QString &message);
+    void profileStarted();
+    void profileAnalyzing();
+    void profileFinished(const ProfileResult &result);
+    void profileFailed(const QString &message);
+    void memoryProfileStarted();
+    void memoryProfileAnalyzing();
+    void memoryProfileFinished(const HeapProfile &profile);
+    void memoryProfileFailed(const QString &message);
+    void buildTimeProfileStarted();
+    void buildTimeProfileAnalyzing();
+    void buildTimeProfileFinished(const BuildTimeProfile &profile);
+    void buildTimeProfileFailed(const QString &message);
+    void testsStarted();
+    void testsDiscovered(const QVector<TestCase> &tests);
+    void testChanged(int index, const TestCase &test);
+    void testProgress(int finishedTests, int totalTests);
+    void testsFinished(int passed, int failed);
+    void testsFailed(const QString &message);
+    // A timed run compared with the previous one of the same program
+    void performanceCompared(const QString &message, bool regression);
 
 private slots:
+    void onCompileOutputReady();
     void onCompileProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
     void onRunProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onRunOutputReady(QProcess::ProcessChannel channel);
 
 private:
-    QString getCompilerCommand() const;
+    // What to do with the executable once the current build succeeds; also
+    // the kind of an execution job
+    enum AfterBuild { NoAction, RunAfterBuild, BenchmarkAfterBuild, ProfileAfterBuild, MemoryProfileAfterBuild,
+                      TestAfterBuild };
+
+    // The program an execution job runs, fixed when the job is submitted
+    struct RunTarget
+    {
+        QString executable;
+        QString source;
+        BuildProfile profile = BuildProfile::Debug;
+        QStringList tests;      // TestAfterBuild: the cases to run, empty for all
+    };
+
     QString getOutputPath(const QString &sourceFile) const;
-    QStringList getCompilerFlags() const;
+    void submitBuild(const QString &path, AfterBuild afterBuild, bool project,
+                     const QStringList &tests = QStringList());
+    void cancelBuild();
+    void startCompile(const QString &sourceFile);
+    void startProjectBuild(const QString &rootPath);
+    void finishCompilation(bool success, const QString &output);
+    void submitExecution(AfterBuild kind, const QStringList &tests = QStringList());
+    void cancelExecution(AfterBuild kind);
+    void finishExecution(bool success);
+    void startRun();
+    void killRun(const QString &reason);
+    void recordRun(const QString &kind, const QVector<double> &wallUs,
+                   const QVector<double> &cpuUs, qint64 maxRssKb);
 
     QProcess *m_compileProcess;
+    QString m_compileOutput;
+    QStringDecoder m_compileDecoder;
+    DiagnosticParser m_diagnosticParser;
     QProcess *m_runProcess;
+    QStringDecoder m_stdoutDecoder;
+    QStringDecoder m_stderrDecoder;
+    ExecutionLimits m_limits;
+    ExecutionMonitor m_monitor;
+    QTimer *m_runTimeout;
+    QElapsedTimer m_runTimer;
+    qint64 m_runOutputBytes;
+    QString m_runKillReason;
+    BenchmarkRunner *m_benchmarkRunner;
+    PerfProfiler *m_perfProfiler;
+    HeapProfiler *m_heapProfiler;
+    BuildTimeProfiler *m_buildTimeProfiler;
+    TestRunner *m_testRunner;
+    BenchmarkOptions m_benchmarkOptions;
+    RunHistory m_history;
     QString m_compiler;
+    QString m_languageStandard;
     QString m_currentOutputPath;
     QString m_currentSourceFile;
-    bool m_runAfterCompile;
+    BuildProfile m_currentProfile;
+    AfterBuild m_afterBuild;
+    QStringList m_afterBuildTests;
+
+    JobScheduler *m_scheduler;
+    JobId m_buildJob;       // 0 when no build is running
+    JobId m_executionJob;   // the running run, benchmark, profile or test run
+    JobId m_buildTimeJob;
+    RunTarget m_runTarget;
+
+    ProjectBuilder *m_projectBuilder;
+    PgoPipeline *m_pgoPipeline;
+    PchCache *m_pchCache;
+    QString m_pchKey;       // PCH used by the running compile, empty if none
+    CompileCache m_cache;
+    QString m_cacheKey;     // direct key of the running compile, empty if uncached
 };
 
 #endif // COMPILERSERVICE_H
@@ -0,0 +1,33 @@
+#ifndef DIAGNOSTIC_H
+#define DIAGNOSTIC_H
+
+#include <QMetaType>
+#include <QString>
+#include <QVector>
+
+struct DiagnosticFixIt
+{
+    int line = 0;           // 1-based
+    int column = 0;         // 1-based
+    int endLine = 0;
+    int endColumn = 0;
+    QString replacement;
+};
+
+struct Diagnostic
+{
+    enum Severity { Error, Warning, Note };
+
+    QString filePath;
+    int line = 0;           // 1-based
+    int column = 0;         // 1-based, 0 when unknown
+    int endLine = 0;        // 0 when the range is a single position
+    int endColumn = 0;
+    Severity severity = Error;
+    QString message;
+    QString code;
+    QVector<DiagnosticFixIt> fixIts;
+};
+Q_DECLARE_METATYPE(Diagnostic)
+
+#endif // DIAGNOSTIC_H
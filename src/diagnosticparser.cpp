@@ -0,0 +1,231 @@
+#include "diagnosticparser.h"
+#include <QDir>
+#include <QRegularExpression>
+#include <QStringList>
+
+namespace {
+
+Diagnostic::Severity severityFor(QStringView word)
+{
+    if (word.endsWith(QLatin1String("error"))) {
+        return Diagnostic::Error;
+    }
+    if (word == QLatin1String("warning")) {
+        return Diagnostic::Warning;
+    }
+    return Diagnostic::Note;
+}
+
+// Undo the C-style escaping GCC and Clang use inside fix-it strings
+QString unescape(QStringView text)
+{
+    QString result;
+    result.reserve(text.size());
+    for (int i = 0; i < text.size(); ++i) {
+        if (text[i] != '\\' || i + 1 == text.size()) {
+            result += text[i];
+            continue;
+        }
+        const QChar next = text[++i];
+        if (next == 'n') {
+            result += '\n';
+        } else if (next == 't') {
+            result += '\t';
+        } else if (next >= '0' && next <= '7') {
+            int value = 0;
+            int digits = 0;
+            while (digits < 3 && i < text.size() && text[i] >= '0' && text[i] <= '7') {
+                value = value * 8 + (text[i].unicode() - '0');
+                ++i;
+                ++digits;
+            }
+            --i;
+            result += QChar(value);
+        } else {
+            result += next;
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+DiagnosticParser::DiagnosticParser(const QString &workingDir)
+    : m_workingDir(workingDir)
+    , m_hasCurrent(false)
+{
+}
+
+QStringList DiagnosticParser::gccFlags()
+{
+    return {"-fdiagnostics-parseable-fixits", "-fdiagnostics-color=never"};
+}
+
+void DiagnosticParser::reset()
+{
+    m_partial.clear();
+    m_ready.clear();
+    m_hasCurrent = false;
+}
+
+void DiagnosticParser::feed(const QString &text)
+{
+    int start = 0;
+    int newline = text.indexOf('\n');
+    if (newline < 0) {
+        m_partial += text;
+        return;
+    }
+
+    // The first line may complete a partial one from the previous chunk
+    if (!m_partial.isEmpty()) {
+        m_partial += QStringView(text).left(newline);
+        parseLine(m_partial);
+        m_partial.clear();
+        start = newline + 1;
+        newline = text.indexOf('\n', start);
+    }
+
+    while (newline >= 0) {
+        parseLine(QStringView(text).mid(start, newline - start));
+        start = newline + 1;
+        newline = text.indexOf('\n', start);
+    }
+    m_partial = text.mid(start);
+}
+
+void DiagnosticParser::finish()
+{
+    if (!m_partial.isEmpty()) {
+        parseLine(m_partial);
+        m_partial.clear();
+    }
+    if (m_hasCurrent) {
+        m_ready.append(m_current);
+        m_hasCurrent = false;
+    }
+}
+
+QVector<Diagnostic> DiagnosticParser::takeDiagnostics()
+{
+    QVector<Diagnostic> diagnostics;
+    diagnostics.swap(m_ready);
+    return diagnostics;
+}
+
+QVector<Diagnostic> DiagnosticParser::parse(const QString &output, const QString &workingDir)
+{
+    DiagnosticParser parser(workingDir);
+    parser.feed(output);
+    parser.finish();
+    return parser.takeDiagnostics();
+}
+
+QString DiagnosticParser::absolutePath(const QString &path) const
+{
+    if (m_workingDir.isEmpty()) {
+        return QDir::cleanPath(path);
+    }
+    return QDir::cleanPath(QDir(m_workingDir).absoluteFilePath(path));
+}
+
+void DiagnosticParser::startDiagnostic(const Diagnostic &diagnostic)
+{
+    if (m_hasCurrent) {
+        m_ready.append(m_current);
+    }
+    m_current = diagnostic;
+    m_hasCurrent = true;
+}
+
+void DiagnosticParser::parseLine(QStringView line)
+{
+    if (line.endsWith(QChar('\r'))) {
+        line.chop(1);
+    }
+    // Template floods are mostly source excerpts and caret lines; reject
+    // those with a cheap check before any regex runs
+    if (line.size() < 8 || line.front().isSpace() || line.front() == '|') {
+        return;
+    }
+    if (line.startsWith(QLatin1String("fix-it:"))) {
+        parseFixIt(line);
+        return;
+    }
+    if (!parseGccLine(line)) {
+        parseMsvcLine(line);
+    }
+}
+
+bool DiagnosticParser::parseGccLine(QStringView line)
+{
+    static const QRegularExpression re(
+        "^(.+?):(\\d+):(?:(\\d+):)?\\s*(fatal error|error|warning|note|remark):\\s*(.*)$");
+    if (!line.contains(QLatin1String(": "))) {
+        return false;
+    }
+    const QRegularExpressionMatch match = re.match(line);
+    if (!match.hasMatch()) {
+        return false;
+    }
+
+    Diagnostic diagnostic;
+    diagnostic.filePath = absolutePath(match.captured(1));
+    diagnostic.line = match.captured(2).toInt();
+    diagnostic.column = match.captured(3).toInt();
+    diagnostic.severity = severityFor(match.capturedView(4));
+
+    QString message = match.captured(5);
+    static const QRegularExpression flagRe("\\s*\\[(-W[^\\]]+|-f[^\\]]+)\\]$");
+    const QRegularExpressionMatch flag = flagRe.match(message);
+    if (flag.hasMatch()) {
+        diagnostic.code = flag.captured(1);
+        message.truncate(flag.capturedStart());
+    }
+    diagnostic.message = message;
+    startDiagnostic(diagnostic);
+    return true;
+}
+
+bool DiagnosticParser::parseMsvcLine(QStringView line)
+{
+    static const QRegularExpression re(
+        "^(.+?)\\((\\d+)(?:,(\\d+))?\\)\\s*:\\s*(fatal error|error|warning|note)\\s*([A-Z]+\\d+)?\\s*:\\s*(.*)$");
+    if (!line.contains(QChar('('))) {
+        return false;
+    }
+    const QRegularExpressionMatch match = re.match(line);
+    if (!match.hasMatch()) {
+        return false;
+    }
+
+    Diagnostic diagnostic;
+    diagnostic.filePath = absolutePath(match.captured(1).trimmed());
+    diagnostic.line = match.captured(2).toInt();
+    diagnostic.column = match.captured(3).toInt();
+    diagnostic.severity = severityFor(match.capturedView(4));
+    diagnostic.code = match.captured(5);
+    diagnostic.message = match.captured(6);
+    startDiagnostic(diagnostic);
+    return true;
+}
+
+bool DiagnosticParser::parseFixIt(QStringView line)
+{
+    // fix-it:"file":{line:col-line:col}:"replacement"
+    static const QRegularExpression re(
+        "^fix-it:\"((?:[^\"\\\\]|\\\\.)*)\":\\{(\\d+):(\\d+)-(\\d+):(\\d+)\\}:\"((?:[^\"\\\\]|\\\\.)*)\"$");
+    const QRegularExpressionMatch match = re.match(line);
+    if (!match.hasMatch() || !m_hasCurrent) {
+        return false;
+    }
+
+    DiagnosticFixIt fixIt;
+    fixIt.line = match.captured(2).toInt();
+    fixIt.column = match.captured(3).toInt();
+    fixIt.endLine = match.captured(4).toInt();
+    fixIt.endColumn = match.captured(5).toInt();
+    fixIt.replacement = unescape(match.capturedView(6));
+    m_current.fixIts.append(fixIt);
+    return true;
+}
@@ -0,0 +1,49 @@
+#ifndef DIAGNOSTICPARSER_H
+#define DIAGNOSTICPARSER_H
+
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+#include <QVector>
+#include "diagnostic.h"
+
+// Incremental parser for compiler output. Understands the GCC/Clang text
+// format plus -fdiagnostics-parseable-fixits lines, and MSVC's
+// "file(line,col): error C1234:" form. Output can be fed in arbitrary
+// chunks while the compiler is still running.
+class DiagnosticParser
+{
+public:
+    explicit DiagnosticParser(const QString &workingDir = QString());
+
+    void setWorkingDirectory(const QString &workingDir) { m_workingDir = workingDir; }
+    void reset();
+
+    void feed(const QString &text);
+    void finish();
+
+    // Diagnostics completed so far; a diagnostic is held back until the next
+    // one starts, since its fix-its follow it
+    QVector<Diagnostic> takeDiagnostics();
+
+    static QVector<Diagnostic> parse(const QString &output, const QString &workingDir);
+
+    // Extra compiler arguments that make GCC/Clang output parseable
+    static QStringList gccFlags();
+
+private:
+    void parseLine(QStringView line);
+    bool parseGccLine(QStringView line);
+    bool parseMsvcLine(QStringView line);
+    bool parseFixIt(QStringView line);
+    void startDiagnostic(const Diagnostic &diagnostic);
+    QString absolutePath(const QString &path) const;
+
+    QString m_workingDir;
+    QString m_partial;
+    QVector<Diagnostic> m_ready;
+    Diagnostic m_current;
+    bool m_hasCurrent;
+};
+
+#endif // DIAGNOSTICPARSER_H
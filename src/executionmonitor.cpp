@@ -0,0 +1,558 @@
+#include "executionmonitor.h"
+#include <QFile>
+#include <QProcess>
+#include <QSettings>
+#include <QStringList>
+
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef Q_OS_LINUX
+#include <linux/perf_event.h>
+#include <sched.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+ExecutionLimits ExecutionLimits::load()
+{
+    QSettings settings("AICodeEditor", "AICodeEditor");
+    ExecutionLimits limits;
+    limits.wallTimeoutMs = settings.value("execTimeoutMs", limits.wallTimeoutMs).toInt();
+    limits.cpuSeconds = settings.value("execCpuSeconds", limits.cpuSeconds).toInt();
+    limits.memoryBytes = settings.value("execMemoryMB", 0).toLongLong() * 1024 * 1024;
+    limits.maxOutputBytes = settings.value("execMaxOutputMB", 64).toLongLong() * 1024 * 1024;
+    limits.perfCounters = settings.value("execPerfCounters", limits.perfCounters).toBool();
+    return limits;
+}
+
+void ExecutionLimits::save() const
+{
+    QSettings settings("AICodeEditor", "AICodeEditor");
+    settings.setValue("execTimeoutMs", wallTimeoutMs);
+    settings.setValue("execCpuSeconds", cpuSeconds);
+    settings.setValue("execMemoryMB", memoryBytes / (1024 * 1024));
+    settings.setValue("execMaxOutputMB", maxOutputBytes / (1024 * 1024));
+    settings.setValue("execPerfCounters", perfCounters);
+}
+
+namespace {
+
+QString formatCount(qint64 count)
+{
+    if (count >= 1000000000) {
+        return QString("%1 G").arg(count / 1e9, 0, 'f', 2);
+    }
+    if (count >= 1000000) {
+        return QString("%1 M").arg(count / 1e6, 0, 'f', 2);
+    }
+    if (count >= 1000) {
+        return QString("%1 K").arg(count / 1e3, 0, 'f', 1);
+    }
+    return QString::number(count);
+}
+
+} // namespace
+
+double PerfCounters::ipc() const
+{
+    return cycles > 0 && instructions >= 0 ? double(instructions) / cycles : 0;
+}
+
+QString PerfCounters::summary() const
+{
+    QStringList parts;
+    if (cycles >= 0) {
+        parts << QString("cycles %1").arg(formatCount(cycles));
+    }
+    if (instructions >= 0) {
+        parts << QString("instructions %1").arg(formatCount(instructions));
+    }
+    if (cycles > 0 && instructions >= 0) {
+        parts << QString("IPC %1").arg(ipc(), 0, 'f', 2);
+    }
+    if (l1dMisses >= 0) {
+        parts << QString("L1d misses %1").arg(formatCount(l1dMisses));
+    }
+    if (llcMisses >= 0) {
+        parts << QString("LLC misses %1").arg(formatCount(llcMisses));
+    }
+    if (branchMisses >= 0) {
+        parts << QString("branch misses %1").arg(formatCount(branchMisses));
+    }
+    if (taskClockNs >= 0) {
+        parts << QString("task-clock %1 ms").arg(taskClockNs / 1e6, 0, 'f', 3);
+    }
+    if (scaled && !parts.isEmpty()) {
+        parts.last() += " (multiplexed, scaled)";
+    }
+    if (!note.isEmpty()) {
+        parts << note;
+    }
+    return parts.join(" | ");
+}
+
+QString ResourceUsage::summary() const
+{
+    const QString wall = QString("wall %1 s").arg(wallUs / 1e6, 0, 'f', 3);
+    if (!valid) {
+        return wall;
+    }
+    return QString("%1 | user %2 s | sys %3 s | peak RSS %4 MB | page faults %5 minor, %6 major"
+                   " | context switches %7 voluntary, %8 involuntary")
+        .arg(wall)
+        .arg(userUs / 1e6, 0, 'f', 3)
+        .arg(systemUs / 1e6, 0, 'f', 3)
+        .arg(maxRssKb / 1024.0, 0, 'f', 1)
+        .arg(minorFaults).arg(majorFaults)
+        .arg(voluntarySwitches).arg(involuntarySwitches);
+}
+
+#ifdef Q_OS_UNIX
+
+namespace {
+
+enum Counter { Cycles, Instructions, BranchMisses, L1dMisses, LlcMisses, TaskClock, CounterCount };
+
+struct CounterReport
+{
+    bool requested;
+    quint64 value[CounterCount];
+    quint64 enabledNs[CounterCount];
+    quint64 runningNs[CounterCount];
+    int error[CounterCount];            // errno of perf_event_open, 0 if it opened
+};
+
+struct UsageReport
+{
+    struct rusage usage;
+    int status;
+    qint64 wallNs;
+    CounterReport counters;
+};
+
+// Only touched in the forked intermediate process
+volatile pid_t g_monitoredChild = 0;
+
+void forwardSignal(int signal)
+{
+    if (g_monitoredChild > 0) {
+        kill(g_monitoredChild, signal);
+    }
+}
+
+qint64 monotonicNs()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return qint64(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+void setLimit(int resource, rlim_t value)
+{
+    struct rlimit limit;
+    limit.rlim_cur = value;
+    limit.rlim_max = value;
+    setrlimit(resource, &limit);
+}
+
+#ifdef Q_OS_LINUX
+
+constexpr quint64 cacheMiss(quint64 cache)
+{
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+struct CounterSpec
+{
+    quint32 type;
+    quint64 config;
+    int leader;                         // group leader's index, -1 for a leader
+};
+
+// Two hardware groups, so each fits the PMU's general-purpose counters
+// and is scheduled as a unit; task-clock is the software fallback
+const CounterSpec kCounters[CounterCount] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, -1},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, Cycles},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, Cycles},
+    {PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_L1D), -1},
+    {PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_LL), L1dMisses},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK, -1},
+};
+
+// Async-signal-safe: runs in the forked intermediate
+void openCounters(pid_t child, int fds[CounterCount], CounterReport &report)
+{
+    for (int i = 0; i < CounterCount; ++i) {
+        const int leader = kCounters[i].leader;
+        if (leader >= 0 && fds[leader] < 0) {
+            report.error[i] = report.error[leader];
+            continue;
+        }
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = kCounters[i].type;
+        attr.config = kCounters[i].config;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attr.inherit = 1;               // include the program's threads and children
+        // User-space only, which perf_event_paranoid=2 still allows
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        if (leader < 0) {
+            // Members follow the leader, which starts counting at exec
+            attr.disabled = 1;
+            attr.enable_on_exec = 1;
+        }
+        fds[i] = int(syscall(SYS_perf_event_open, &attr, child, -1, leader >= 0 ? fds[leader] : -1,
+                             PERF_FLAG_FD_CLOEXEC));
+        report.error[i] = fds[i] < 0 ? errno : 0;
+    }
+}
+
+void readCounters(int fds[CounterCount], CounterReport &report)
+{
+    for (int i = 0; i < CounterCount; ++i) {
+        if (fds[i] < 0) {
+            continue;
+        }
+        quint64 values[3];
+        if (::read(fds[i], values, sizeof(values)) == ssize_t(sizeof(values))) {
+            report.value[i] = values[0];
+            report.enabledNs[i] = values[1];
+            report.runningNs[i] = values[2];
+        }
+        ::close(fds[i]);
+    }
+}
+
+QString counterError(int error)
+{
+    if (error == EACCES || error == EPERM) {
+        QFile paranoid("/proc/sys/kernel/perf_event_paranoid");
+        const QString level = paranoid.open(QIODevice::ReadOnly) ? QString::fromLatin1(paranoid.readAll()).trimmed()
+                                                                  : QString("?");
+        return QString("blocked by perf_event_paranoid=%1 (allow with: sudo sysctl kernel.perf_event_paranoid=2)")
+            .arg(level);
+    }
+    if (error == ENOENT || error == EOPNOTSUPP || error == ENODEV) {
+        return "not supported by this CPU or VM";
+    }
+    return QString::fromLocal8Bit(strerror(error));
+}
+
+#endif
+
+// Each counter scaled for the share of the run it was actually scheduled
+PerfCounters toPerfCounters(const CounterReport &report)
+{
+    PerfCounters counters;
+#ifdef Q_OS_LINUX
+    qint64 values[CounterCount];
+    for (int i = 0; i < CounterCount; ++i) {
+        values[i] = -1;
+        if (report.error[i] != 0 || report.runningNs[i] == 0) {
+            continue;
+        }
+        values[i] = qint64(report.value[i]);
+        if (report.runningNs[i] < report.enabledNs[i]) {
+            values[i] = qint64(double(report.value[i]) * report.enabledNs[i] / report.runningNs[i]);
+            counters.scaled = true;
+        }
+    }
+    counters.cycles = values[Cycles];
+    counters.instructions = values[Instructions];
+    counters.branchMisses = values[BranchMisses];
+    counters.l1dMisses = values[L1dMisses];
+    counters.llcMisses = values[LlcMisses];
+    counters.taskClockNs = values[TaskClock];
+    counters.hardware = counters.cycles >= 0 && counters.instructions >= 0;
+
+    if (report.error[Cycles] != 0) {
+        counters.note = report.error[TaskClock] == 0
+            ? "hardware counters " + counterError(report.error[Cycles]) + "; software counters only"
+            : "performance counters " + counterError(report.error[TaskClock]);
+    } else if (report.error[L1dMisses] != 0) {
+        counters.note = "cache counters " + counterError(report.error[L1dMisses]);
+    }
+#else
+    Q_UNUSED(report);
+#endif
+    return counters;
+}
+
+} // namespace
+
+ExecutionMonitor::ExecutionMonitor()
+    : m_readFd(-1)
+    , m_writeFd(-1)
+    , m_cpuSeconds(0)
+    , m_cpu(-1)
+    , m_inheritedFd(-1)
+    , m_perfCounters(false)
+{
+}
+
+ExecutionMonitor::~ExecutionMonitor()
+{
+    closePipe();
+}
+
+void ExecutionMonitor::closePipe()
+{
+    if (m_readFd >= 0) {
+        ::close(m_readFd);
+        m_readFd = -1;
+    }
+    if (m_writeFd >= 0) {
+        ::close(m_writeFd);
+        m_writeFd = -1;
+    }
+}
+
+void ExecutionMonitor::prepare(QProcess *process, const ExecutionLimits &limits)
+{
+    closePipe();
+    m_cpuSeconds = limits.cpuSeconds;
+#ifdef Q_OS_LINUX
+    m_perfCounters = limits.perfCounters;
+#endif
+
+    int fds[2];
+    if (::pipe(fds) != 0) {
+        process->setChildProcessModifier({});
+        return;
+    }
+    // CLOEXEC keeps the pipe out of the user's program
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    m_readFd = fds[0];
+    m_writeFd = fds[1];
+
+    const int writeFd = m_writeFd;
+    const int readFd = m_readFd;
+    const rlim_t cpuSeconds = rlim_t(limits.cpuSeconds);
+    const rlim_t memoryBytes = rlim_t(limits.memoryBytes);
+    const rlim_t fileBytes = rlim_t(limits.maxOutputBytes);
+    const int cpu = m_cpu;
+    const bool perfCounters = m_perfCounters;
+    const int inheritedFd = m_inheritedFd;
+
+    // Runs in the forked child before exec: async-signal-safe calls only
+    process->setChildProcessModifier([writeFd, readFd, cpuSeconds, memoryBytes, fileBytes, cpu, perfCounters,
+                                      inheritedFd]() {
+        ::close(readFd);
+        const pid_t intermediate = getpid();
+        const qint64 startNs = monotonicNs();
+
+        // The grandchild holds off its exec until the counters are attached
+        int go[2] = {-1, -1};
+#ifdef Q_OS_LINUX
+        if (perfCounters && pipe2(go, O_CLOEXEC) != 0) {
+            go[0] = go[1] = -1;
+        }
+#else
+        Q_UNUSED(perfCounters);
+#endif
+
+        const pid_t child = fork();
+        if (child == 0) {
+            if (go[0] >= 0) {
+                ::close(go[1]);
+                char ready;
+                while (::read(go[0], &ready, 1) < 0 && errno == EINTR) {
+                }
+                ::close(go[0]);
+            }
+#ifdef Q_OS_LINUX
+            // Die with the intermediate, e.g. when QProcess::kill() hits it
+            prctl(PR_SET_PDEATHSIG, SIGKILL);
+            if (getppid() != intermediate) {
+                _exit(127);
+            }
+            if (cpu >= 0) {
+                cpu_set_t cpus;
+                CPU_ZERO(&cpus);
+                CPU_SET(cpu, &cpus);
+                sched_setaffinity(0, sizeof(cpus), &cpus);
+            }
+#else
+            Q_UNUSED(cpu);
+#endif
+            if (cpuSeconds > 0) {
+                // Soft limit sends SIGXCPU, the hard limit a second later SIGKILL
+                struct rlimit limit;
+                limit.rlim_cur = cpuSeconds;
+                limit.rlim_max = cpuSeconds + 1;
+                setrlimit(RLIMIT_CPU, &limit);
+            }
+            if (memoryBytes > 0) {
+                setLimit(RLIMIT_AS, memoryBytes);
+            }
+            if (fileBytes > 0) {
+                setLimit(RLIMIT_FSIZE, fileBytes);
+            }
+            if (inheritedFd >= 0) {
+                fcntl(inheritedFd, F_SETFD, 0);
+            }
+            return;     // QProcess goes on to exec the program
+        }
+        if (child < 0) {
+            return;     // run unmonitored rather than not at all
+        }
+
+        // Intermediate: drop every inherited descriptor but the report pipe and
+        // stdio, in particular the one QProcess watches to learn that exec
+        // succeeded, which only the program's exec should close
+        struct rlimit files;
+        const int maxFd = getrlimit(RLIMIT_NOFILE, &files) == 0 && files.rlim_cur != RLIM_INFINITY
+            ? int(qMin<rlim_t>(files.rlim_cur, 65536)) : 4096;
+        for (int fd = 3; fd < maxFd; ++fd) {
+            if (fd != writeFd && fd != go[1]) {
+                ::close(fd);
+            }
+        }
+
+        UsageReport report;
+        memset(&report, 0, sizeof(report));
+        int counterFds[CounterCount];
+        for (int &fd : counterFds) {
+            fd = -1;
+        }
+#ifdef Q_OS_LINUX
+        if (go[1] >= 0) {
+            report.counters.requested = true;
+            openCounters(child, counterFds, report.counters);
+            ssize_t ignored = ::write(go[1], "", 1);
+            Q_UNUSED(ignored);
+            ::close(go[1]);
+        }
+#endif
+
+        g_monitoredChild = child;
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_handler = forwardSignal;
+        sigaction(SIGTERM, &action, nullptr);
+        sigaction(SIGINT, &action, nullptr);
+        sigaction(SIGHUP, &action, nullptr);
+
+        while (wait4(child, &report.status, 0, &report.usage) < 0 && errno == EINTR) {
+        }
+        report.wallNs = monotonicNs() - startNs;
+#ifdef Q_OS_LINUX
+        readCounters(counterFds, report.counters);
+#endif
+        ssize_t ignored = ::write(writeFd, &report, sizeof(report));
+        Q_UNUSED(ignored);
+        ::close(writeFd);
+
+        if (WIFEXITED(report.status)) {
+            _exit(WEXITSTATUS(report.status));
+        }
+        // Die the same way so QProcess still reports a crash
+        const int signal = WTERMSIG(report.status);
+        setLimit(RLIMIT_CORE, 0);
+        action.sa_handler = SIG_DFL;
+        sigaction(signal, &action, nullptr);
+        sigset_t unblock;
+        sigemptyset(&unblock);
+        sigaddset(&unblock, signal);
+        sigprocmask(SIG_UNBLOCK, &unblock, nullptr);
+        kill(intermediate, signal);
+        _exit(128 + signal);
+    });
+}
+
+void ExecutionMonitor::started()
+{
+    if (m_writeFd >= 0) {
+        ::close(m_writeFd);
+        m_writeFd = -1;
+    }
+}
+
+ResourceUsage ExecutionMonitor::finish(qint64 fallbackWallUs)
+{
+    started();
+
+    ResourceUsage usage;
+    usage.wallUs = fallbackWallUs;
+
+    UsageReport report;
+    if (m_readFd >= 0 && ::read(m_readFd, &report, sizeof(report)) == ssize_t(sizeof(report))) {
+        usage.valid = true;
+        usage.wallUs = report.wallNs / 1000;
+        usage.userUs = qint64(report.usage.ru_utime.tv_sec) * 1000000 + report.usage.ru_utime.tv_usec;
+        usage.systemUs = qint64(report.usage.ru_stime.tv_sec) * 1000000 + report.usage.ru_stime.tv_usec;
+#ifdef Q_OS_MACOS
+        usage.maxRssKb = report.usage.ru_maxrss / 1024;    // bytes on macOS
+#else
+        usage.maxRssKb = report.usage.ru_maxrss;
+#endif
+        usage.minorFaults = report.usage.ru_minflt;
+        usage.majorFaults = report.usage.ru_majflt;
+        usage.voluntarySwitches = report.usage.ru_nvcsw;
+        usage.involuntarySwitches = report.usage.ru_nivcsw;
+        usage.termSignal = WIFSIGNALED(report.status) ? WTERMSIG(report.status) : 0;
+        // SIGXCPU at the soft limit, or SIGKILL at the hard one if it was ignored
+        usage.cpuLimitExceeded = m_cpuSeconds > 0
+            && (usage.termSignal == SIGXCPU
+                || (usage.termSignal == SIGKILL && usage.userUs + usage.systemUs >= m_cpuSeconds * 1000000LL));
+        if (report.counters.requested) {
+            usage.counters = toPerfCounters(report.counters);
+        }
+    }
+    closePipe();
+    return usage;
+}
+
+#else
+
+ExecutionMonitor::ExecutionMonitor()
+    : m_readFd(-1)
+    , m_writeFd(-1)
+    , m_cpuSeconds(0)
+    , m_cpu(-1)
+    , m_inheritedFd(-1)
+    , m_perfCounters(false)
+{
+}
+
+ExecutionMonitor::~ExecutionMonitor()
+{
+}
+
+void ExecutionMonitor::closePipe()
+{
+}
+
+void ExecutionMonitor::prepare(QProcess *process, const ExecutionLimits &limits)
+{
+    // No rlimits here; the wall-clock timeout and output cap still apply
+    Q_UNUSED(process);
+    Q_UNUSED(limits);
+}
+
+void ExecutionMonitor::started()
+{
+}
+
+ResourceUsage ExecutionMonitor::finish(qint64 fallbackWallUs)
+{
+    ResourceUsage usage;
+    usage.wallUs = fallbackWallUs;
+    return usage;
+}
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef EXECUTIONMONITOR_H
+#define EXECUTIONMONITOR_H
+
+#include <QString>
+#include <QtGlobal>
+
+class QProcess;
+
+struct ExecutionLimits
+{
+    int wallTimeoutMs = 10000;          // 0 = unlimited
+    int cpuSeconds = 0;                 // RLIMIT_CPU, 0 = unlimited
+    qint64 memoryBytes = 0;             // RLIMIT_AS, 0 = unlimited
+    qint64 maxOutputBytes = 64 * 1024 * 1024;
+    bool perfCounters = true;           // perf_event_open counters, Linux only
+
+    static ExecutionLimits load();
+    void save() const;
+};
+
+// Counters of one run, scaled up where the kernel had to multiplex them
+struct PerfCounters
+{
+    bool hardware = false;              // cycles and instructions were counted
+    bool scaled = false;
+    qint64 cycles = -1;                 // -1 = not counted
+    qint64 instructions = -1;
+    qint64 l1dMisses = -1;
+    qint64 llcMisses = -1;
+    qint64 branchMisses = -1;
+    qint64 taskClockNs = -1;
+    QString note;                       // why some counters are missing
+
+    double ipc() const;
+    QString summary() const;            // empty if nothing was requested
+};
+
+struct ResourceUsage
+{
+    bool valid = false;                 // false where wait4 isn't available
+    qint64 wallUs = 0;
+    qint64 userUs = 0;
+    qint64 systemUs = 0;
+    qint64 maxRssKb = 0;
+    qint64 minorFaults = 0;
+    qint64 majorFaults = 0;
+    qint64 voluntarySwitches = 0;
+    qint64 involuntarySwitches = 0;
+    int termSignal = 0;                 // signal that ended the program, 0 if it exited
+    bool cpuLimitExceeded = false;
+    PerfCounters counters;
+
+    QString summary() const;
+};
+
+// Runs a QProcess under rlimits and collects its rusage. On Unix the child
+// forks once more: the grandchild applies the limits and execs the program,
+// while the intermediate process reaps it with wait4() and reports the usage
+// back through a pipe before exiting with the same status. On Linux the
+// intermediate can also attach perf_event_open counters to the grandchild
+// while it waits to exec, so they cover exactly the user's program.
+class ExecutionMonitor
+{
+public:
+    ExecutionMonitor();
+    ~ExecutionMonitor();
+
+    // Pins the program to one CPU (Linux only); -1 leaves it unpinned
+    void setCpuAffinity(int cpu) { m_cpu = cpu; }
+    // Keeps a descriptor open across the program's exec (Unix only); -1 for none
+    void setInheritedFd(int fd) { m_inheritedFd = fd; }
+
+    // Call before QProcess::start()
+    void prepare(QProcess *process, const ExecutionLimits &limits);
+    // Call once the process has started, so the parent drops its write end
+    void started();
+    // Call from the finished handler; wallUs is the fallback wall time
+    ResourceUsage finish(qint64 fallbackWallUs);
+
+private:
+    void closePipe();
+
+    int m_readFd;
+    int m_writeFd;
+    int m_cpuSeconds;
+    int m_cpu;
+    int m_inheritedFd;
+    bool m_perfCounters;
+};
+
+#endif // EXECUTIONMONITOR_H
@@ -0,0 +1,193 @@
+#include "filesearchpanel.h"
+#include <QDir>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+
+FileSearchResultModel::FileSearchResultModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+void FileSearchResultModel::appendMatches(const QVector<SearchMatch> &matches)
+{
+    if (matches.isEmpty()) {
+        return;
+    }
+    beginInsertRows(QModelIndex(), m_matches.size(), m_matches.size() + matches.size() - 1);
+    m_matches += matches;
+    endInsertRows();
+}
+
+void FileSearchResultModel::clear()
+{
+    beginResetModel();
+    m_matches.clear();
+    m_matches.squeeze();
+    endResetModel();
+}
+
+int FileSearchResultModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_matches.size();
+}
+
+QVariant FileSearchResultModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_matches.size()) {
+        return QVariant();
+    }
+
+    const SearchMatch &match = m_matches.at(index.row());
+    if (role == Qt::DisplayRole) {
+        QString path = m_rootPath.isEmpty()
+            ? match.filePath
+            : QDir(m_rootPath).relativeFilePath(match.filePath);
+        return QString("%1:%2: %3").arg(path).arg(match.line).arg(match.lineText.trimmed());
+    }
+    if (role == Qt::ToolTipRole) {
+        return match.filePath;
+    }
+    return QVariant();
+}
+
+FileSearchPanel::FileSearchPanel(QWidget *parent)
+    : QWidget(parent)
+{
+    m_searchService = new FileSearchService(this);
+    m_resultModel = new FileSearchResultModel(this);
+
+    connect(m_searchService, &FileSearchService::matchesFound,
+            this, &FileSearchPanel::onMatchesFound);
+    connect(m_searchService, &FileSearchService::searchFinished,
+            this, &FileSearchPanel::onSearchFinished);
+    connect(m_searchService, &FileSearchService::searchFailed, this, [this](const QString &error) {
+        m_statusLabel->setText(QString("Invalid pattern: %1").arg(error));
+    });
+
+    // Restart the search shortly after the query stops changing
+    m_debounceTimer = new QTimer(this);
+    m_debounceTimer->setSingleShot(true);
+    m_debounceTimer->setInterval(250);
+    connect(m_debounceTimer, &QTimer::timeout, this, &FileSearchPanel::startSearch);
+
+    setupUI();
+}
+
+void FileSearchPanel::setupUI()
+{
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(8, 8, 8, 8);
+
+    QHBoxLayout *queryLayout = new QHBoxLayout();
+    m_queryInput = new QLineEdit(this);
+    m_queryInput->setPlaceholderText("Search in files...");
+    m_queryInput->setClearButtonEnabled(true);
+    connect(m_queryInput, &QLineEdit::textChanged, [this]() {
+        m_debounceTimer->start();
+    });
+    connect(m_queryInput, &QLineEdit::returnPressed, this, &FileSearchPanel::startSearch);
+    queryLayout->addWidget(m_queryInput, 1);
+
+    m_filterInput = new QLineEdit(this);
+    m_filterInput->setPlaceholderText("*.cpp *.h");
+    m_filterInput->setMaximumWidth(160);
+    connect(m_filterInput, &QLineEdit::returnPressed, this, &FileSearchPanel::startSearch);
+    queryLayout->addWidget(m_filterInput);
+
+    m_caseCheck = new QCheckBox("Aa", this);
+    m_caseCheck->setToolTip("Match case");
+    m_caseCheck->setChecked(true);
+    connect(m_caseCheck, &QCheckBox::toggled, this, &FileSearchPanel::startSearch);
+    queryLayout->addWidget(m_caseCheck);
+
+    m_regexCheck = new QCheckBox(".*", this);
+    m_regexCheck->setToolTip("Regular expression");
+    connect(m_regexCheck, &QCheckBox::toggled, this, &FileSearchPanel::startSearch);
+    queryLayout->addWidget(m_regexCheck);
+
+    layout->addLayout(queryLayout);
+
+    // Uniform item sizes let QListView lay out only the visible rows
+    m_resultView = new QListView(this);
+    m_resultView->setModel(m_resultModel);
+    m_resultView->setUniformItemSizes(true);
+    m_resultView->setLayoutMode(QListView::Batched);
+    m_resultView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_resultView->setFont(QFont("Consolas", 10));
+    m_resultView->setStyleSheet(R"(
+        QListView {
+            background-color: #1e1e1e;
+            border: 1px solid #3d3d3d;
+            border-radius: 6px;
+        }
+        QListView::item:selected {
+            background-color: #0078d7;
+        }
+    )");
+    connect(m_resultView, &QListView::activated, [this](const QModelIndex &index) {
+        const SearchMatch &match = m_resultModel->matchAt(index.row());
+        emit matchActivated(match.filePath, match.line, match.column);
+    });
+    layout->addWidget(m_resultView, 1);
+
+    m_statusLabel = new QLabel(this);
+    m_statusLabel->setStyleSheet("color: #888;");
+    layout->addWidget(m_statusLabel);
+}
+
+void FileSearchPanel::setRootPath(const QString &rootPath)
+{
+    if (m_rootPath == rootPath) {
+        return;
+    }
+    m_rootPath = rootPath;
+    m_searchService->cancel();
+    m_resultModel->clear();
+}
+
+void FileSearchPanel::focusSearch(const QString &initialText)
+{
+    if (!initialText.isEmpty()) {
+        m_queryInput->setText(initialText);
+    }
+    m_queryInput->setFocus();
+    m_queryInput->selectAll();
+}
+
+void FileSearchPanel::startSearch()
+{
+    m_debounceTimer->stop();
+    m_resultModel->clear();
+    m_resultModel->setRootPath(m_rootPath);
+
+    const QString pattern = m_queryInput->text();
+    if (pattern.isEmpty() || m_rootPath.isEmpty()) {
+        m_searchService->cancel();
+        m_statusLabel->clear();
+        return;
+    }
+
+    SearchOptions options;
+    options.regex = m_regexCheck->isChecked();
+    options.caseSensitive = m_caseCheck->isChecked();
+    options.nameFilters = m_filterInput->text().split(' ', Qt::SkipEmptyParts);
+
+    m_statusLabel->setText("Searching...");
+    m_searchTimer.start();
+    m_searchService->search(m_rootPath, pattern, options);
+}
+
+void FileSearchPanel::onMatchesFound(const QVector<SearchMatch> &matches)
+{
+    m_resultModel->appendMatches(matches);
+    m_statusLabel->setText(QString("Searching... %1 matches").arg(m_resultModel->rowCount()));
+}
+
+void FileSearchPanel::onSearchFinished(int filesSearched, int matchCount, bool cancelled)
+{
+    if (cancelled) {
+        return;
+    }
+    m_statusLabel->setText(QString("%1 matches in %2 files (%3 ms)")
+                           .arg(matchCount).arg(filesSearched).arg(m_searchTimer.elapsed()));
+}
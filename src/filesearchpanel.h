@@ -0,0 +1,69 @@
+#ifndef FILESEARCHPANEL_H
+#define FILESEARCHPANEL_H
+
+#include <QWidget>
+#include <QAbstractListModel>
+#include <QLineEdit>
+#include <QCheckBox>
+#include <QListView>
+#include <QLabel>
+#include <QTimer>
+#include <QElapsedTimer>
+#include "filesearchservice.h"
+
+class FileSearchResultModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    explicit FileSearchResultModel(QObject *parent = nullptr);
+
+    void setRootPath(const QString &rootPath) { m_rootPath = rootPath; }
+    void appendMatches(const QVector<SearchMatch> &matches);
+    void clear();
+    const SearchMatch &matchAt(int row) const { return m_matches.at(row); }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+private:
+    QString m_rootPath;
+    QVector<SearchMatch> m_matches;
+};
+
+class FileSearchPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit FileSearchPanel(QWidget *parent = nullptr);
+
+    void setRootPath(const QString &rootPath);
+    void focusSearch(const QString &initialText = QString());
+
+signals:
+    void matchActivated(const QString &filePath, int line, int column);
+
+private slots:
+    void startSearch();
+    void onMatchesFound(const QVector<SearchMatch> &matches);
+    void onSearchFinished(int filesSearched, int matchCount, bool cancelled);
+
+private:
+    void setupUI();
+
+    FileSearchService *m_searchService;
+    FileSearchResultModel *m_resultModel;
+    QString m_rootPath;
+
+    QLineEdit *m_queryInput;
+    QLineEdit *m_filterInput;
+    QCheckBox *m_regexCheck;
+    QCheckBox *m_caseCheck;
+    QListView *m_resultView;
+    QLabel *m_statusLabel;
+    QTimer *m_debounceTimer;
+    QElapsedTimer m_searchTimer;
+};
+
+#endif // FILESEARCHPANEL_H
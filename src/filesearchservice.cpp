@@ -0,0 +1,415 @@
+#include "filesearchservice.h"
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QThread>
+#include <QThreadPool>
+#include <atomic>
+#include <climits>
+#include <cstring>
+
+namespace {
+
+const int kBatchSize = 32;
+const int kBinaryProbeBytes = 8192;
+const int kMaxLineTextLength = 300;
+
+// Rough byte frequency in source code; the literal matcher scans for the
+// rarest byte of the needle with memchr (SIMD in every mainstream libc)
+// and only verifies candidates around it.
+int byteRank(unsigned char c)
+{
+    static const char common[] = " etaoinsrlcdu_()\n\t;,.=*phmfgb";
+    const char *pos = static_cast<const char *>(std::memchr(common, c, sizeof(common) - 1));
+    if (pos) {
+        return 255 - int(pos - common);
+    }
+    if (c >= 'a' && c <= 'z') return 120;
+    if (c >= '0' && c <= '9') return 100;
+    if (c >= 'A' && c <= 'Z') return 80;
+    return 10;
+}
+
+int rarestByteOffset(const QByteArray &needle)
+{
+    int best = 0;
+    for (int i = 1; i < needle.size(); ++i) {
+        if (byteRank(uchar(needle[i])) < byteRank(uchar(needle[best]))) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+// Tracks the current line while scanning forward through a buffer
+struct LineTracker
+{
+    const char *scanned;
+    const char *lineStart;
+    int line = 1;
+
+    explicit LineTracker(const char *begin) : scanned(begin), lineStart(begin) {}
+
+    void advanceTo(const char *pos)
+    {
+        while (scanned < pos) {
+            const char *nl = static_cast<const char *>(std::memchr(scanned, '\n', pos - scanned));
+            if (!nl) {
+                break;
+            }
+            ++line;
+            lineStart = nl + 1;
+            scanned = nl + 1;
+        }
+        scanned = pos;
+    }
+};
+
+QString lineTextAt(const char *lineStart, const char *end)
+{
+    const char *nl = static_cast<const char *>(std::memchr(lineStart, '\n', end - lineStart));
+    const char *lineEnd = nl ? nl : end;
+    if (lineEnd > lineStart && lineEnd[-1] == '\r') {
+        --lineEnd;
+    }
+    QString text = QString::fromUtf8(lineStart, int(qMin<qint64>(lineEnd - lineStart, 4 * kMaxLineTextLength)));
+    if (text.size() > kMaxLineTextLength) {
+        text.truncate(kMaxLineTextLength);
+    }
+    return text;
+}
+
+} // namespace
+
+struct FileSearchService::SearchState
+{
+    QString rootPath;
+    QByteArray literal;
+    int literalLength = 0;
+    int anchorOffset = 0;
+    bool useRegex = false;
+    QRegularExpression regex;
+    QVector<QRegularExpression> nameFilters;
+    int maxMatches = 0;
+
+    std::atomic<bool> cancelled{false};
+    std::atomic<int> pendingTasks{0};
+    std::atomic<int> filesSearched{0};
+    std::atomic<int> matchCount{0};
+
+    bool shouldStop() const
+    {
+        return cancelled.load(std::memory_order_relaxed)
+            || matchCount.load(std::memory_order_relaxed) >= maxMatches;
+    }
+
+    bool acceptsFile(const QString &fileName) const
+    {
+        if (nameFilters.isEmpty()) {
+            return true;
+        }
+        for (const QRegularExpression &filter : nameFilters) {
+            if (filter.match(fileName).hasMatch()) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+FileSearchService::FileSearchService(QObject *parent)
+    : QObject(parent)
+{
+    m_pool = new QThreadPool(this);
+    m_pool->setMaxThreadCount(qMax(2, QThread::idealThreadCount()));
+}
+
+FileSearchService::~FileSearchService()
+{
+    if (m_state) {
+        m_state->cancelled = true;
+    }
+    m_pool->waitForDone();
+}
+
+bool FileSearchService::isIgnoredDirectory(const QString &name)
+{
+    static const QStringList ignored = {
+        "node_modules", "build", "_build", "out", "CMakeFiles", "__pycache__"
+    };
+    return name.startsWith('.') || ignored.contains(name);
+}
+
+QStringList FileSearchService::listWorkspaceFiles(const QString &rootPath, const QStringList &suffixes)
+{
+    QStringList files;
+    QStringList pendingDirs{rootPath};
+
+    while (!pendingDirs.isEmpty()) {
+        QDirIterator it(pendingDirs.takeLast(),
+                        QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks);
+        while (it.hasNext()) {
+            it.next();
+            const QFileInfo fi = it.fileInfo();
+            if (fi.isDir()) {
+                if (!isIgnoredDirectory(fi.fileName())) {
+                    pendingDirs.append(fi.filePath());
+                }
+            } else if (suffixes.isEmpty() || suffixes.contains(fi.suffix(), Qt::CaseInsensitive)) {
+                files.append(fi.filePath());
+            }
+        }
+    }
+    return files;
+}
+
+bool FileSearchService::looksBinary(const char *data, qint64 size)
+{
+    // Same heuristic as grep: a NUL byte near the start means binary
+    return std::memchr(data, 0, size_t(qMin<qint64>(size, kBinaryProbeBytes))) != nullptr;
+}
+
+bool FileSearchService::isSearching() const
+{
+    return m_state != nullptr;
+}
+
+void FileSearchService::search(const QString &rootPath, const QString &pattern, const SearchOptions &options)
+{
+    cancel();
+    if (pattern.isEmpty()) {
+        return;
+    }
+
+    auto state = std::make_shared<SearchState>();
+    state->rootPath = rootPath;
+    state->maxMatches = options.maxMatches;
+
+    // Case-sensitive literals take the fast byte path; everything else
+    // goes through QRegularExpression on the decoded text
+    if (!options.regex && options.caseSensitive) {
+        state->literal = pattern.toUtf8();
+        state->literalLength = pattern.size();
+        state->anchorOffset = rarestByteOffset(state->literal);
+    } else {
+        QRegularExpression::PatternOptions patternOptions = QRegularExpression::MultilineOption;
+        if (!options.caseSensitive) {
+            patternOptions |= QRegularExpression::CaseInsensitiveOption;
+        }
+        const QString source = options.regex ? pattern : QRegularExpression::escape(pattern);
+        state->regex = QRegularExpression(source, patternOptions);
+        if (!state->regex.isValid()) {
+            emit searchFailed(state->regex.errorString());
+            return;
+        }
+        state->regex.optimize();
+        state->useRegex = true;
+    }
+
+    for (const QString &filter : options.nameFilters) {
+        state->nameFilters.append(QRegularExpression(
+            QRegularExpression::wildcardToRegularExpression(filter),
+            QRegularExpression::CaseInsensitiveOption));
+    }
+
+    m_state = state;
+    state->pendingTasks = 1;
+    m_pool->start([this, state]() { walk(state); });
+}
+
+void FileSearchService::cancel()
+{
+    if (!m_state) {
+        return;
+    }
+    auto state = m_state;
+    state->cancelled = true;
+    m_state.reset();
+    emit searchFinished(state->filesSearched, state->matchCount, true);
+}
+
+void FileSearchService::walk(std::shared_ptr<SearchState> state)
+{
+    QStringList pendingDirs{state->rootPath};
+    QStringList batch;
+
+    while (!pendingDirs.isEmpty() && !state->shouldStop()) {
+        QDirIterator it(pendingDirs.takeLast(),
+                        QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks);
+        while (it.hasNext()) {
+            it.next();
+            const QFileInfo fi = it.fileInfo();
+            if (fi.isDir()) {
+                if (!isIgnoredDirectory(fi.fileName())) {
+                    pendingDirs.append(fi.filePath());
+                }
+                continue;
+            }
+            if (!state->acceptsFile(fi.fileName())) {
+                continue;
+            }
+
+            batch.append(fi.filePath());
+            if (batch.size() >= kBatchSize) {
+                state->pendingTasks++;
+                m_pool->start([this, state, batch]() { searchBatch(state, batch); });
+                batch.clear();
+            }
+        }
+    }
+
+    if (!batch.isEmpty() && !state->shouldStop()) {
+        state->pendingTasks++;
+        m_pool->start([this, state, batch]() { searchBatch(state, batch); });
+    }
+
+    taskDone(state);
+}
+
+void FileSearchService::searchBatch(std::shared_ptr<SearchState> state, const QStringList &files)
+{
+    QVector<SearchMatch> matches;
+    for (const QString &filePath : files) {
+        if (state->shouldStop()) {
+            break;
+        }
+        searchFile(*state, filePath, matches);
+    }
+
+    if (!matches.isEmpty() && !state->cancelled) {
+        QMetaObject::invokeMethod(this, [this, state, matches]() {
+            if (state == m_state) {
+                emit matchesFound(matches);
+            }
+        }, Qt::QueuedConnection);
+    }
+
+    taskDone(state);
+}
+
+void FileSearchService::taskDone(std::shared_ptr<SearchState> state)
+{
+    if (--state->pendingTasks > 0) {
+        return;
+    }
+
+    QMetaObject::invokeMethod(this, [this, state]() {
+        if (state != m_state) {
+            return;
+        }
+        m_state.reset();
+        emit searchFinished(state->filesSearched, qMin(int(state->matchCount), state->maxMatches), false);
+    }, Qt::QueuedConnection);
+}
+
+void FileSearchService::searchFile(SearchState &state, const QString &filePath, QVector<SearchMatch> &out)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    const qint64 size = file.size();
+    if (size <= 0) {
+        return;
+    }
+    uchar *mapped = file.map(0, size);
+    if (!mapped) {
+        return;
+    }
+
+    const char *begin = reinterpret_cast<const char *>(mapped);
+    const char *end = begin + size;
+    if (looksBinary(begin, size)) {
+        file.unmap(mapped);
+        return;
+    }
+    state.filesSearched++;
+
+    if (!state.useRegex) {
+        const QByteArray &needle = state.literal;
+        const int n = needle.size();
+        // Too short to match; lastAnchor would point before the mapping
+        if (size < n) {
+            file.unmap(mapped);
+            return;
+        }
+        const int k = state.anchorOffset;
+        const char anchor = needle[k];
+        LineTracker tracker(begin);
+
+        const char *p = begin + k;
+        const char *lastAnchor = end - (n - k);
+        while (p <= lastAnchor) {
+            p = static_cast<const char *>(std::memchr(p, anchor, size_t(lastAnchor - p + 1)));
+            if (!p) {
+                break;
+            }
+            const char *candidate = p - k;
+            if (std::memcmp(candidate, needle.constData(), size_t(n)) != 0) {
+                ++p;
+                continue;
+            }
+
+            tracker.advanceTo(candidate);
+            SearchMatch match;
+            match.filePath = filePath;
+            match.line = tracker.line;
+            match.column = QString::fromUtf8(tracker.lineStart, int(candidate - tracker.lineStart)).size();
+            match.length = state.literalLength;
+            match.lineText = lineTextAt(tracker.lineStart, end);
+            out.append(match);
+            if (++state.matchCount >= state.maxMatches) {
+                break;
+            }
+
+            // One hit per line, like grep
+            const char *nl = static_cast<const char *>(std::memchr(candidate, '\n', end - candidate));
+            if (!nl) {
+                break;
+            }
+            p = nl + 1 + k;
+        }
+    } else {
+        const QString text = QString::fromUtf8(begin, int(qMin<qint64>(size, INT_MAX)));
+        int line = 1;
+        int lineStart = 0;
+        int scanned = 0;
+        int lastLine = 0;
+
+        QRegularExpressionMatchIterator it = state.regex.globalMatch(text);
+        while (it.hasNext()) {
+            const QRegularExpressionMatch m = it.next();
+            const int start = m.capturedStart();
+            for (int nl = text.indexOf('\n', scanned); nl >= 0 && nl < start; nl = text.indexOf('\n', nl + 1)) {
+                ++line;
+                lineStart = nl + 1;
+            }
+            scanned = start;
+            if (line == lastLine || m.capturedLength() == 0) {
+                continue;
+            }
+            lastLine = line;
+
+            int lineEnd = text.indexOf('\n', lineStart);
+            if (lineEnd < 0) {
+                lineEnd = text.size();
+            }
+            SearchMatch match;
+            match.filePath = filePath;
+            match.line = line;
+            match.column = start - lineStart;
+            match.length = m.capturedLength();
+            match.lineText = text.mid(lineStart, qMin(lineEnd - lineStart, kMaxLineTextLength));
+            if (match.lineText.endsWith('\r')) {
+                match.lineText.chop(1);
+            }
+            out.append(match);
+            if (++state.matchCount >= state.maxMatches || state.cancelled) {
+                break;
+            }
+        }
+    }
+
+    file.unmap(mapped);
+}
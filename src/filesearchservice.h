@@ -0,0 +1,66 @@
+#ifndef FILESEARCHSERVICE_H
+#define FILESEARCHSERVICE_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QMetaType>
+#include <memory>
+
+class QThreadPool;
+
+struct SearchMatch
+{
+    QString filePath;
+    int line = 0;       // 1-based
+    int column = 0;     // 0-based, in characters
+    int length = 0;
+    QString lineText;
+};
+Q_DECLARE_METATYPE(SearchMatch)
+
+struct SearchOptions
+{
+    bool regex = false;
+    bool caseSensitive = true;
+    QStringList nameFilters;    // e.g. "*.cpp", empty = all files
+    int maxMatches = 100000;
+};
+
+class FileSearchService : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FileSearchService(QObject *parent = nullptr);
+    ~FileSearchService();
+
+    void search(const QString &rootPath, const QString &pattern, const SearchOptions &options);
+    void cancel();
+    bool isSearching() const;
+
+    static bool isIgnoredDirectory(const QString &name);
+    static QStringList listWorkspaceFiles(const QString &rootPath,
+                                          const QStringList &suffixes = QStringList());
+    static bool looksBinary(const char *data, qint64 size);
+
+signals:
+    void matchesFound(const QVector<SearchMatch> &matches);
+    void searchFinished(int filesSearched, int matchCount, bool cancelled);
+    // The pattern didn't compile, e.g. "foo(" typed halfway
+    void searchFailed(const QString &error);
+
+private:
+    struct SearchState;
+
+    void walk(std::shared_ptr<SearchState> state);
+    void searchBatch(std::shared_ptr<SearchState> state, const QStringList &files);
+    void searchFile(SearchState &state, const QString &filePath, QVector<SearchMatch> &out);
+    void taskDone(std::shared_ptr<SearchState> state);
+
+    QThreadPool *m_pool;
+    std::shared_ptr<SearchState> m_state;
+};
+
+#endif // FILESEARCHSERVICE_H
@@ -0,0 +1,209 @@
+#include "fuzzyfinder.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const int kMatchScore = 10;
+const int kBoundaryBonus = 8;
+const int kCamelCaseBonus = 7;
+const int kConsecutiveBonus = 6;
+const int kMaxGapPenalty = 5;
+const int kBaseNameBonus = 20;
+
+inline char toLowerAscii(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? char(c + ('a' - 'A')) : c;
+}
+
+inline bool isSeparator(char c)
+{
+    return c == '/' || c == '\\' || c == '_' || c == '-' || c == '.' || c == ' ';
+}
+
+// One bit per character class: a query can only match a path whose mask
+// covers every bit of the query mask. This rejects most paths with a
+// single AND before the subsequence scan runs.
+inline quint64 charBit(char c)
+{
+    const unsigned char u = static_cast<unsigned char>(c);
+    if (u >= 'a' && u <= 'z') return quint64(1) << (u - 'a');
+    if (u >= '0' && u <= '9') return quint64(1) << (26 + u - '0');
+    return quint64(1) << (36 + u % 28);
+}
+
+} // namespace
+
+void FuzzyFinder::clear()
+{
+    m_text.clear();
+    m_lower.clear();
+    m_offsets.clear();
+    m_baseNames.clear();
+    m_masks.clear();
+    m_candidates.clear();
+    m_nextCandidates.clear();
+    m_previousQuery.clear();
+    m_results.clear();
+}
+
+void FuzzyFinder::setPaths(const QStringList &paths)
+{
+    clear();
+
+    m_offsets.reserve(paths.size() + 1);
+    m_baseNames.reserve(paths.size());
+    m_masks.reserve(paths.size());
+
+    for (const QString &path : paths) {
+        const QByteArray utf8 = path.toUtf8();
+        m_offsets.append(m_text.size());
+
+        quint64 mask = 0;
+        int baseName = 0;
+        for (int i = 0; i < utf8.size(); ++i) {
+            const char lower = toLowerAscii(utf8[i]);
+            mask |= charBit(lower);
+            if (utf8[i] == '/' || utf8[i] == '\\') {
+                baseName = i + 1;
+            }
+            m_lower.append(lower);
+        }
+        m_text.append(utf8);
+        m_masks.append(mask);
+        m_baseNames.append(baseName);
+    }
+    m_offsets.append(m_text.size());
+
+    m_candidates.reserve(paths.size());
+    m_nextCandidates.reserve(paths.size());
+}
+
+QString FuzzyFinder::pathAt(int index) const
+{
+    const int begin = m_offsets.at(index);
+    return QString::fromUtf8(m_text.constData() + begin, m_offsets.at(index + 1) - begin);
+}
+
+int FuzzyFinder::scoreFrom(const char *lower, const char *text, int length, int start) const
+{
+    int score = 0;
+    int previous = -1;
+    int pos = start;
+
+    for (const char qc : m_query) {
+        const void *hit = std::memchr(lower + pos, qc, size_t(length - pos));
+        if (!hit) {
+            return -1;
+        }
+        const int i = int(static_cast<const char *>(hit) - lower);
+
+        int bonus = 0;
+        if (i == 0 || isSeparator(text[i - 1])) {
+            bonus = kBoundaryBonus;
+        } else if (text[i] >= 'A' && text[i] <= 'Z' && text[i - 1] >= 'a' && text[i - 1] <= 'z') {
+            bonus = kCamelCaseBonus;
+        }
+        if (previous >= 0) {
+            bonus += (i == previous + 1) ? kConsecutiveBonus : -qMin(i - previous - 1, kMaxGapPenalty);
+        }
+
+        score += kMatchScore + bonus;
+        previous = i;
+        pos = i + 1;
+    }
+    return score;
+}
+
+int FuzzyFinder::scorePath(int index) const
+{
+    const int begin = m_offsets[index];
+    const int length = m_offsets[index + 1] - begin;
+    const char *lower = m_lower.constData() + begin;
+    const char *text = m_text.constData() + begin;
+
+    int best = scoreFrom(lower, text, length, 0);
+    if (best < 0) {
+        return -1;
+    }
+
+    // Prefer alignments that fall entirely inside the file name
+    const int baseName = m_baseNames[index];
+    if (baseName == 0) {
+        best += kBaseNameBonus;
+    } else {
+        const int inBaseName = scoreFrom(lower, text, length, baseName);
+        if (inBaseName >= 0) {
+            best = qMax(best, inBaseName + kBaseNameBonus);
+        }
+    }
+    return best - length / 8;
+}
+
+const QVector<FuzzyFinder::Result> &FuzzyFinder::match(const QString &query, int maxResults)
+{
+    m_results.resize(0);
+    m_results.reserve(maxResults);
+
+    m_query = query.toUtf8();
+    m_queryMask = 0;
+    for (char &c : m_query) {
+        c = toLowerAscii(c);
+        m_queryMask |= charBit(c);
+    }
+
+    const int count = pathCount();
+    if (m_query.isEmpty()) {
+        for (int i = 0; i < count && i < maxResults; ++i) {
+            m_results.append({i, 0});
+        }
+        m_previousQuery.clear();
+        return m_results;
+    }
+
+    auto worse = [](const Result &a, const Result &b) {
+        return a.score > b.score || (a.score == b.score && a.index < b.index);
+    };
+
+    auto consider = [&](int index) {
+        if (m_queryMask & ~m_masks[index]) {
+            return;
+        }
+        const int score = scorePath(index);
+        if (score < 0) {
+            return;
+        }
+        m_nextCandidates.append(index);
+
+        // Bounded min-heap of the current top-k
+        if (m_results.size() < maxResults) {
+            m_results.append({index, score});
+            std::push_heap(m_results.begin(), m_results.end(), worse);
+        } else if (score > m_results.front().score) {
+            std::pop_heap(m_results.begin(), m_results.end(), worse);
+            m_results.back() = {index, score};
+            std::push_heap(m_results.begin(), m_results.end(), worse);
+        }
+    };
+
+    // Typing another character can only shrink the match set, so only
+    // the survivors of the previous query need to be rescored
+    m_nextCandidates.resize(0);
+    const bool narrowing = !m_previousQuery.isEmpty() && m_query.startsWith(m_previousQuery);
+    if (narrowing) {
+        for (int index : qAsConst(m_candidates)) {
+            consider(index);
+        }
+    } else {
+        for (int index = 0; index < count; ++index) {
+            consider(index);
+        }
+    }
+    m_candidates.swap(m_nextCandidates);
+    m_previousQuery = m_query;
+
+    std::sort(m_results.begin(), m_results.end(), [](const Result &a, const Result &b) {
+        return a.score > b.score || (a.score == b.score && a.index < b.index);
+    });
+    return m_results;
+}
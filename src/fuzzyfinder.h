@@ -0,0 +1,49 @@
+#ifndef FUZZYFINDER_H
+#define FUZZYFINDER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Fuzzy subsequence matcher over a flat arena of paths. All paths live in
+// one contiguous buffer; per-path data is kept in parallel arrays so the
+// filter pass streams through memory linearly.
+class FuzzyFinder
+{
+public:
+    struct Result
+    {
+        int index;
+        int score;
+    };
+
+    void setPaths(const QStringList &paths);
+    void clear();
+
+    int pathCount() const { return m_offsets.isEmpty() ? 0 : m_offsets.size() - 1; }
+    QString pathAt(int index) const;
+
+    // Returns the best matches, highest score first. Buffers are reused
+    // between calls, so filtering does not allocate once warmed up.
+    const QVector<Result> &match(const QString &query, int maxResults);
+
+private:
+    int scorePath(int index) const;
+    int scoreFrom(const char *lower, const char *text, int length, int start) const;
+
+    QByteArray m_text;          // original bytes, for display and camelCase bonus
+    QByteArray m_lower;         // ASCII-lowercased copy, same offsets
+    QVector<int> m_offsets;     // pathCount + 1 entries
+    QVector<int> m_baseNames;   // offset of the file name within each path
+    QVector<quint64> m_masks;   // character-class bitmask per path
+
+    QByteArray m_query;
+    quint64 m_queryMask = 0;
+    QByteArray m_previousQuery;
+    QVector<int> m_candidates;
+    QVector<int> m_nextCandidates;
+    QVector<Result> m_results;
+};
+
+#endif // FUZZYFINDER_H
@@ -0,0 +1,23 @@
+#ifndef GUARDEDINVOKE_H
+#define GUARDEDINVOKE_H
+
+#include <QCoreApplication>
+#include <QMetaObject>
+#include <QPointer>
+
+// Hands a worker thread's result back to the GUI thread, where function runs
+// only if guard's object still exists. The call is posted to the application
+// object, which outlives every worker, and guard is only tested on the GUI
+// thread; posting to guard.data() from the worker races with the receiver
+// being deleted.
+template <typename T, typename Function>
+void invokeIfAlive(const QPointer<T> &guard, Function function)
+{
+    QMetaObject::invokeMethod(QCoreApplication::instance(), [guard, function]() {
+        if (guard) {
+            function();
+        }
+    }, Qt::QueuedConnection);
+}
+
+#endif // GUARDEDINVOKE_H
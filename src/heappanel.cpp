@@ -0,0 +1,240 @@
+#include "heappanel.h"
+#include <QFileInfo>
+#include <QHeaderView>
+#include <QPainter>
+#include <QPainterPath>
+#include <QSortFilterProxyModel>
+#include <QSplitter>
+#include <QVBoxLayout>
+
+HeapChart::HeapChart(QWidget *parent)
+    : QWidget(parent)
+    , m_peakBytes(0)
+{
+    setMinimumHeight(120);
+}
+
+void HeapChart::setProfile(const HeapProfile &profile)
+{
+    m_timeline = profile.timeline;
+    m_peakBytes = profile.peakBytes;
+    for (const HeapSnapshot &snapshot : m_timeline) {
+        m_peakBytes = qMax(m_peakBytes, snapshot.liveBytes);
+    }
+    update();
+}
+
+void HeapChart::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.fillRect(rect(), QColor(30, 30, 30));
+
+    const QRectF plot(70, 12, width() - 84, height() - 36);
+    painter.setPen(QColor(80, 80, 80));
+    painter.drawLine(plot.bottomLeft(), plot.bottomRight());
+    painter.drawLine(plot.bottomLeft(), plot.topLeft());
+
+    if (m_timeline.isEmpty() || m_peakBytes <= 0) {
+        painter.setPen(QColor(136, 136, 136));
+        painter.drawText(rect(), Qt::AlignCenter, tr("No heap samples yet"));
+        return;
+    }
+
+    const double duration = qMax<qint64>(1, m_timeline.last().timeNs);
+    auto pointFor = [&](qint64 timeNs, qint64 bytes) {
+        return QPointF(plot.left() + plot.width() * timeNs / duration,
+                       plot.bottom() - plot.height() * double(bytes) / m_peakBytes);
+    };
+
+    painter.setPen(QColor(136, 136, 136));
+    painter.drawText(QRectF(0, plot.top() - 6, plot.left() - 6, 14), Qt::AlignRight,
+                     HeapPanel::formatBytes(m_peakBytes));
+    painter.drawText(QRectF(0, plot.bottom() - 8, plot.left() - 6, 14), Qt::AlignRight, "0");
+    painter.drawText(QRectF(plot.left(), plot.bottom() + 4, plot.width(), 16), Qt::AlignRight,
+                     QString("%1 ms").arg(duration / 1e6, 0, 'f', 1));
+
+    // Live bytes hold until the next snapshot, so draw steps
+    QPainterPath path(plot.bottomLeft());
+    qint64 previous = 0;
+    for (const HeapSnapshot &snapshot : m_timeline) {
+        path.lineTo(pointFor(snapshot.timeNs, previous));
+        path.lineTo(pointFor(snapshot.timeNs, snapshot.liveBytes));
+        previous = snapshot.liveBytes;
+    }
+    path.lineTo(pointFor(m_timeline.last().timeNs, 0));
+    path.closeSubpath();
+    painter.fillPath(path, QColor(90, 160, 220, 80));
+    painter.setPen(QPen(QColor(90, 160, 220), 1.5));
+    painter.drawPath(path);
+}
+
+AllocationSiteModel::AllocationSiteModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+void AllocationSiteModel::setProfile(const HeapProfile &profile)
+{
+    beginResetModel();
+    m_profile = profile;
+    endResetModel();
+}
+
+int AllocationSiteModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_profile.sites.size();
+}
+
+int AllocationSiteModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant AllocationSiteModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_profile.sites.size()) {
+        return QVariant();
+    }
+
+    const AllocationSite &site = m_profile.sites.at(index.row());
+    const qint64 average = site.allocations > 0 ? site.bytes / site.allocations : 0;
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case FunctionColumn: return site.function;
+        case AllocationsColumn: return HeapPanel::formatCount(site.allocations);
+        case BytesColumn: return HeapPanel::formatBytes(site.bytes);
+        case AverageColumn: return HeapPanel::formatBytes(average);
+        case LocationColumn:
+            return site.line > 0 ? QString("%1:%2").arg(QFileInfo(site.filePath).fileName()).arg(site.line)
+                                 : QString();
+        }
+    }
+    // Sort numerically rather than by the formatted text
+    if (role == Qt::UserRole) {
+        switch (index.column()) {
+        case AllocationsColumn: return site.allocations;
+        case BytesColumn: return site.bytes;
+        case AverageColumn: return average;
+        default: return data(index, Qt::DisplayRole);
+        }
+    }
+    if (role == Qt::TextAlignmentRole && index.column() != FunctionColumn && index.column() != LocationColumn) {
+        return int(Qt::AlignRight | Qt::AlignVCenter);
+    }
+    if (role == Qt::ToolTipRole && site.line > 0) {
+        return QString("%1:%2").arg(site.filePath).arg(site.line);
+    }
+    return QVariant();
+}
+
+QVariant AllocationSiteModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    switch (section) {
+    case FunctionColumn: return tr("Allocated From");
+    case AllocationsColumn: return tr("Allocations");
+    case BytesColumn: return tr("Bytes");
+    case AverageColumn: return tr("Average");
+    case LocationColumn: return tr("Line");
+    }
+    return QVariant();
+}
+
+HeapPanel::HeapPanel(QWidget *parent)
+    : QWidget(parent)
+{
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(8, 8, 8, 8);
+
+    m_summaryLabel = new QLabel(tr("Run Build > Profile Memory to track allocations"), this);
+    m_summaryLabel->setStyleSheet("color: #888;");
+    m_summaryLabel->setWordWrap(true);
+    layout->addWidget(m_summaryLabel);
+
+    QSplitter *splitter = new QSplitter(Qt::Horizontal, this);
+    m_chart = new HeapChart(splitter);
+
+    m_model = new AllocationSiteModel(this);
+    m_proxy = new QSortFilterProxyModel(this);
+    m_proxy->setSourceModel(m_model);
+    m_proxy->setSortRole(Qt::UserRole);
+
+    m_view = new QTableView(splitter);
+    m_view->setModel(m_proxy);
+    m_view->setSortingEnabled(true);
+    m_view->sortByColumn(AllocationSiteModel::AllocationsColumn, Qt::DescendingOrder);
+    m_view->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_view->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_view->setWordWrap(false);
+    m_view->setShowGrid(false);
+    m_view->verticalHeader()->hide();
+    m_view->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_view->verticalHeader()->setDefaultSectionSize(m_view->fontMetrics().height() + 6);
+    m_view->horizontalHeader()->setStretchLastSection(true);
+    m_view->horizontalHeader()->resizeSection(AllocationSiteModel::FunctionColumn, 240);
+    m_view->setStyleSheet(R"(
+        QTableView {
+            background-color: #1e1e1e;
+            border: 1px solid #3d3d3d;
+            border-radius: 6px;
+        }
+        QTableView::item:selected {
+            background-color: #0078d7;
+        }
+    )");
+    connect(m_view, &QTableView::activated, [this](const QModelIndex &index) {
+        const AllocationSite &site = m_model->siteAt(m_proxy->mapToSource(index).row());
+        if (site.line > 0) {
+            emit siteActivated(site.filePath, site.line);
+        }
+    });
+
+    splitter->setStretchFactor(0, 1);
+    splitter->setStretchFactor(1, 2);
+    layout->addWidget(splitter, 1);
+}
+
+void HeapPanel::setProfile(const HeapProfile &profile)
+{
+    m_profile = profile;
+    m_chart->setProfile(profile);
+    m_model->setProfile(profile);
+
+    QString summary = tr("%1 allocations, %2 frees, %3 allocated in total, peak heap %4")
+                          .arg(formatCount(profile.allocations), formatCount(profile.frees),
+                               formatBytes(profile.allocatedBytes), formatBytes(profile.peakBytes));
+    if (profile.complete) {
+        summary += tr(", %1 still allocated at exit").arg(formatBytes(profile.liveBytesAtExit));
+    } else {
+        summary += tr(" (incomplete: the program did not exit normally)");
+    }
+    m_summaryLabel->setText(summary);
+}
+
+QString HeapPanel::formatBytes(qint64 bytes)
+{
+    if (bytes >= 1024 * 1024 * 1024) {
+        return QString("%1 GB").arg(bytes / (1024.0 * 1024 * 1024), 0, 'f', 2);
+    }
+    if (bytes >= 1024 * 1024) {
+        return QString("%1 MB").arg(bytes / (1024.0 * 1024), 0, 'f', 1);
+    }
+    if (bytes >= 1024) {
+        return QString("%1 KB").arg(bytes / 1024.0, 0, 'f', 1);
+    }
+    return QString("%1 B").arg(bytes);
+}
+
+QString HeapPanel::formatCount(qint64 count)
+{
+    if (count >= 1000000) {
+        return QString("%1M").arg(count / 1e6, 0, 'f', 1);
+    }
+    if (count >= 10000) {
+        return QString("%1K").arg(count / 1e3, 0, 'f', 0);
+    }
+    return QString::number(count);
+}
@@ -0,0 +1,77 @@
+#ifndef HEAPPANEL_H
+#define HEAPPANEL_H
+
+#include <QWidget>
+#include <QAbstractTableModel>
+#include <QTableView>
+#include <QLabel>
+#include "heapprofiler.h"
+
+class QSortFilterProxyModel;
+
+// Live heap bytes over the run, as a filled step chart
+class HeapChart : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit HeapChart(QWidget *parent = nullptr);
+
+    void setProfile(const HeapProfile &profile);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    QVector<HeapSnapshot> m_timeline;
+    qint64 m_peakBytes;
+};
+
+class AllocationSiteModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column { FunctionColumn, AllocationsColumn, BytesColumn, AverageColumn, LocationColumn, ColumnCount };
+
+    explicit AllocationSiteModel(QObject *parent = nullptr);
+
+    void setProfile(const HeapProfile &profile);
+    const AllocationSite &siteAt(int row) const { return m_profile.sites.at(row); }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    HeapProfile m_profile;
+};
+
+// Totals, heap-over-time chart and top allocation sites of the last memory profile
+class HeapPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit HeapPanel(QWidget *parent = nullptr);
+
+    void setProfile(const HeapProfile &profile);
+    const HeapProfile &profile() const { return m_profile; }
+
+    static QString formatBytes(qint64 bytes);
+    static QString formatCount(qint64 count);
+
+signals:
+    void siteActivated(const QString &filePath, int line);
+
+private:
+    HeapProfile m_profile;
+    QLabel *m_summaryLabel;
+    HeapChart *m_chart;
+    AllocationSiteModel *m_model;
+    QSortFilterProxyModel *m_proxy;
+    QTableView *m_view;
+};
+
+#endif // HEAPPANEL_H
@@ -0,0 +1,403 @@
+#include "heapprofiler.h"
+#include "guardedinvoke.h"
+#include "heaptrackerprotocol.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QPointer>
+#include <QSet>
+#include <QSocketNotifier>
+#include <QThreadPool>
+#include <QTimer>
+#include <algorithm>
+#include <cstring>
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Innermost frames of the executable kept per sample; enough to step out of
+// inlined library templates into the user's code
+const int kStackDepth = 8;
+// Older snapshots are thinned out beyond this, the chart can't show more
+const int kMaxSnapshots = 8192;
+
+bool isSystemLocation(const QString &filePath)
+{
+    return filePath.isEmpty() || filePath.startsWith("??") || filePath.startsWith("/usr/")
+        || filePath.startsWith("/opt/");
+}
+
+struct Location
+{
+    QString function;
+    QString filePath;
+    int line = 0;
+};
+
+// `addr2line -a -f -i -C` prints each address followed by function/file:line
+// pairs for every inlined level, innermost first
+QHash<quint64, QVector<Location>> resolveAddresses(const QString &executable, const QList<quint64> &addresses)
+{
+    QHash<quint64, QVector<Location>> resolved;
+    QProcess addr2line;
+    addr2line.start("addr2line", {"-a", "-f", "-i", "-C", "-e", executable});
+    if (!addr2line.waitForStarted()) {
+        return resolved;
+    }
+    QByteArray input;
+    for (quint64 address : addresses) {
+        input += "0x" + QByteArray::number(address, 16) + '\n';
+    }
+    addr2line.write(input);
+    addr2line.closeWriteChannel();
+    addr2line.waitForFinished(-1);
+
+    const QStringList lines = QString::fromLocal8Bit(addr2line.readAllStandardOutput()).split('\n');
+    quint64 current = 0;
+    bool haveAddress = false;
+    for (int i = 0; i < lines.size(); ++i) {
+        const QString &line = lines[i];
+        if (line.startsWith("0x")) {
+            bool ok = false;
+            current = line.mid(2).toULongLong(&ok, 16);
+            haveAddress = ok;
+            continue;
+        }
+        if (!haveAddress || line.isEmpty() || i + 1 >= lines.size()) {
+            continue;
+        }
+        // "file:line" or "file:line (discriminator 2)"
+        QString source = lines[++i].section(" (", 0, 0);
+        Location location;
+        location.function = line;
+        const int colon = source.lastIndexOf(':');
+        location.filePath = colon > 0 ? QDir::cleanPath(source.left(colon)) : source;
+        location.line = colon > 0 ? source.mid(colon + 1).toInt() : 0;
+        resolved[current].append(location);
+    }
+    return resolved;
+}
+
+} // namespace
+
+QHash<int, qint64> HeapProfile::lineAllocations(const QString &filePath) const
+{
+    QHash<int, qint64> lines;
+    const QString path = QDir::cleanPath(filePath);
+    for (const AllocationSite &site : sites) {
+        if (site.line > 0 && site.filePath == path) {
+            lines[site.line] += site.allocations;
+        }
+    }
+    return lines;
+}
+
+HeapProfiler::HeapProfiler(QObject *parent)
+    : QObject(parent)
+    , m_process(nullptr)
+    , m_notifier(nullptr)
+    , m_socket(-1)
+    , m_loadBias(0)
+    , m_imageStart(0)
+    , m_imageEnd(0)
+    , m_analyzing(false)
+    , m_generation(0)
+{
+    m_timeout = new QTimer(this);
+    m_timeout->setSingleShot(true);
+    connect(m_timeout, &QTimer::timeout, [this]() {
+        if (m_process) {
+            m_killReason = tr("wall-clock timeout exceeded");
+            m_process->kill();
+        }
+    });
+}
+
+HeapProfiler::~HeapProfiler()
+{
+    cancel();
+}
+
+QString HeapProfiler::trackerPath()
+{
+    const QString dir = QCoreApplication::applicationDirPath();
+    for (const QString &candidate : {dir + "/libheaptracker.so", dir + "/../lib/libheaptracker.so"}) {
+        if (QFileInfo::exists(candidate)) {
+            return QFileInfo(candidate).canonicalFilePath();
+        }
+    }
+    return QString();
+}
+
+void HeapProfiler::start(const QString &executable, const ExecutionLimits &limits)
+{
+    cancel();
+
+#ifdef Q_OS_LINUX
+    const QString tracker = trackerPath();
+    if (tracker.isEmpty()) {
+        emit failed(tr("libheaptracker.so was not found next to the editor; rebuild the editor to profile memory"));
+        return;
+    }
+
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fds) != 0) {
+        emit failed(tr("Could not create the heap tracker socket: %1").arg(QString::fromLocal8Bit(strerror(errno))));
+        return;
+    }
+    fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    m_socket = fds[0];
+
+    m_executable = executable;
+    m_profile = HeapProfile();
+    m_profile.executable = executable;
+    m_stacks.clear();
+    m_loadBias = m_imageStart = m_imageEnd = 0;
+    m_killReason.clear();
+    m_stdoutDecoder = QStringDecoder(QStringDecoder::System);
+    m_stderrDecoder = QStringDecoder(QStringDecoder::System);
+
+    m_notifier = new QSocketNotifier(m_socket, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &HeapProfiler::readEvents);
+
+    m_process = new QProcess(this);
+    m_process->setProgram(executable);
+    m_process->setWorkingDirectory(QFileInfo(executable).absolutePath());
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    const QString preload = environment.value("LD_PRELOAD");
+    environment.insert("LD_PRELOAD", preload.isEmpty() ? tracker : tracker + ' ' + preload);
+    environment.insert(HeapTrace::kFdVariable, QString::number(fds[1]));
+    m_process->setProcessEnvironment(environment);
+    connect(m_process, &QProcess::readyReadStandardOutput, [this]() {
+        emit output(m_stdoutDecoder.decode(m_process->readAllStandardOutput()), false);
+    });
+    connect(m_process, &QProcess::readyReadStandardError, [this]() {
+        emit output(m_stderrDecoder.decode(m_process->readAllStandardError()), true);
+    });
+    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &HeapProfiler::onProcessFinished);
+    connect(m_process, &QProcess::errorOccurred, [this](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            const QString message = tr("Failed to start %1: %2").arg(m_executable, m_process->errorString());
+            m_timeout->stop();
+            m_monitor.finish(0);
+            m_process->deleteLater();
+            m_process = nullptr;
+            closeSocket();
+            emit failed(message);
+        }
+    });
+
+    ExecutionLimits runLimits = limits;
+    runLimits.perfCounters = false;
+    m_monitor.setInheritedFd(fds[1]);
+    m_monitor.prepare(m_process, runLimits);
+    m_process->start();
+    m_monitor.started();
+    // Only the program may hold the write end, so EOF means it is done
+    ::close(fds[1]);
+    if (limits.wallTimeoutMs > 0) {
+        m_timeout->start(limits.wallTimeoutMs);
+    }
+#else
+    Q_UNUSED(executable);
+    Q_UNUSED(limits);
+    emit failed(tr("Memory profiling needs Linux (glibc) for its LD_PRELOAD tracker"));
+#endif
+}
+
+void HeapProfiler::cancel()
+{
+    ++m_generation;
+    m_analyzing = false;
+    m_timeout->stop();
+    if (m_process) {
+        m_process->disconnect();
+        m_process->kill();
+        m_process->waitForFinished(1000);
+        m_monitor.finish(0);
+        m_process->deleteLater();
+        m_process = nullptr;
+    }
+    closeSocket();
+}
+
+void HeapProfiler::closeSocket()
+{
+    if (m_notifier) {
+        m_notifier->setEnabled(false);
+        m_notifier->deleteLater();
+        m_notifier = nullptr;
+    }
+#ifdef Q_OS_LINUX
+    if (m_socket >= 0) {
+        ::close(m_socket);
+        m_socket = -1;
+    }
+#endif
+}
+
+void HeapProfiler::readEvents()
+{
+#ifdef Q_OS_LINUX
+    HeapTrace::Sample buffer;
+    while (m_socket >= 0) {
+        const ssize_t size = recv(m_socket, &buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (size > 0) {
+            handleEvent(reinterpret_cast<const char *>(&buffer), int(size));
+        } else if (size == 0 || (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK)) {
+            // Every writer is gone; keep the socket until the process is reaped
+            m_notifier->setEnabled(false);
+            return;
+        } else if (errno != EINTR) {
+            return;
+        }
+    }
+#endif
+}
+
+void HeapProfiler::handleEvent(const char *data, int size)
+{
+    quint32 type;
+    if (size < int(sizeof(type))) {
+        return;
+    }
+    memcpy(&type, data, sizeof(type));
+
+    if (type == HeapTrace::StartEvent && size == int(sizeof(HeapTrace::Start))) {
+        HeapTrace::Start start;
+        memcpy(&start, data, sizeof(start));
+        m_loadBias = start.loadBias;
+        m_imageStart = start.imageStart;
+        m_imageEnd = start.imageEnd;
+    } else if (type == HeapTrace::SampleEvent && size >= int(offsetof(HeapTrace::Sample, frames))) {
+        HeapTrace::Sample sample;
+        memcpy(&sample, data, size);
+        const int frameCount = qMin<int>(sample.frameCount, (size - int(offsetof(HeapTrace::Sample, frames))) / 8);
+        // Return addresses point past the call; step back into it
+        QVector<quint64> stack;
+        for (int i = 0; i < frameCount && stack.size() < kStackDepth; ++i) {
+            if (sample.frames[i] > m_imageStart && sample.frames[i] <= m_imageEnd) {
+                stack.append(sample.frames[i] - 1 - m_loadBias);
+            }
+        }
+        StackStats &stats = m_stacks[stack];
+        stats.allocations += qint64(sample.weight);
+        stats.bytes += qint64(sample.weight * sample.size);
+    } else if (type == HeapTrace::SnapshotEvent && size == int(sizeof(HeapTrace::Snapshot))) {
+        HeapTrace::Snapshot snapshot;
+        memcpy(&snapshot, data, sizeof(snapshot));
+        m_profile.allocations = qint64(snapshot.allocations);
+        m_profile.frees = qint64(snapshot.frees);
+        m_profile.allocatedBytes = qint64(snapshot.allocatedBytes);
+        m_profile.peakBytes = qint64(snapshot.peakBytes);
+        m_profile.liveBytesAtExit = qMax<qint64>(0, snapshot.liveBytes);
+        m_profile.complete = snapshot.final != 0;
+        if (m_profile.timeline.size() >= kMaxSnapshots) {
+            QVector<HeapSnapshot> thinned;
+            for (int i = 0; i < m_profile.timeline.size(); i += 2) {
+                thinned.append(m_profile.timeline[i]);
+            }
+            m_profile.timeline = thinned;
+        }
+        m_profile.timeline.append({qint64(snapshot.timeNs), m_profile.liveBytesAtExit});
+    }
+}
+
+void HeapProfiler::onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    m_timeout->stop();
+    readEvents();
+    const ResourceUsage usage = m_monitor.finish(0);
+    m_process->deleteLater();
+    m_process = nullptr;
+    closeSocket();
+
+    if (!m_killReason.isEmpty()) {
+        emit output(tr("\n[Process killed: %1; showing the profile so far]\n").arg(m_killReason), true);
+    } else if (usage.termSignal != 0 || exitStatus == QProcess::CrashExit) {
+        emit output(tr("\n[Process crashed; showing the profile so far]\n"), true);
+    } else {
+        emit output(tr("\n[Process exited with code %1]\n").arg(exitCode), false);
+    }
+
+    if (m_imageEnd == 0) {
+        emit failed(tr("The heap tracker did not report; the program may be statically linked or not use glibc"));
+        return;
+    }
+    analyze();
+}
+
+void HeapProfiler::analyze()
+{
+    m_analyzing = true;
+    emit analyzing();
+
+    QPointer<HeapProfiler> guard(this);
+    const int generation = m_generation;
+    const QString executable = m_executable;
+    const HeapProfile base = m_profile;
+    const QHash<QVector<quint64>, StackStats> stacks = m_stacks;
+    QThreadPool::globalInstance()->start([guard, generation, executable, base, stacks]() {
+        QSet<quint64> unique;
+        for (auto it = stacks.constBegin(); it != stacks.constEnd(); ++it) {
+            for (quint64 address : it.key()) {
+                unique.insert(address);
+            }
+        }
+        const QHash<quint64, QVector<Location>> resolved = resolveAddresses(executable, unique.values());
+
+        // Charge each stack to its innermost location in the user's own code
+        QHash<QString, AllocationSite> sites;
+        for (auto it = stacks.constBegin(); it != stacks.constEnd(); ++it) {
+            Location site;
+            bool found = false;
+            for (quint64 address : it.key()) {
+                for (const Location &location : resolved.value(address)) {
+                    if (!isSystemLocation(location.filePath) && location.line > 0) {
+                        site = location;
+                        found = true;
+                        break;
+                    }
+                }
+                if (found) {
+                    break;
+                }
+            }
+            if (!found) {
+                site.function = it.key().isEmpty() ? QString("[outside the executable]")
+                                                   : QString("0x%1").arg(it.key().first(), 0, 16);
+                if (!it.key().isEmpty() && !resolved.value(it.key().first()).isEmpty()) {
+                    site.function = resolved.value(it.key().first()).first().function;
+                }
+            }
+            const QString key = site.filePath + ':' + QString::number(site.line) + '\t' + site.function;
+            AllocationSite &entry = sites[key];
+            entry.function = site.function;
+            entry.filePath = site.filePath;
+            entry.line = site.line;
+            entry.allocations += it.value().allocations;
+            entry.bytes += it.value().bytes;
+        }
+
+        HeapProfile profile = base;
+        profile.sites = sites.values();
+        std::sort(profile.sites.begin(), profile.sites.end(), [](const AllocationSite &a, const AllocationSite &b) {
+            return a.allocations > b.allocations;
+        });
+
+        invokeIfAlive(guard, [guard, generation, profile]() {
+            if (generation != guard->m_generation) {
+                return;
+            }
+            guard->m_analyzing = false;
+            emit guard->finished(profile);
+        });
+    });
+}
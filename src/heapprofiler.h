@@ -0,0 +1,104 @@
+#ifndef HEAPPROFILER_H
+#define HEAPPROFILER_H
+
+#include <QObject>
+#include <QProcess>
+#include <QHash>
+#include <QString>
+#include <QStringDecoder>
+#include <QVector>
+#include "executionmonitor.h"
+
+class QSocketNotifier;
+class QTimer;
+
+struct HeapSnapshot
+{
+    qint64 timeNs = 0;
+    qint64 liveBytes = 0;
+};
+
+// Source line that allocations were made from; counts are estimated from samples
+struct AllocationSite
+{
+    QString function;
+    QString filePath;
+    int line = 0;
+    qint64 allocations = 0;
+    qint64 bytes = 0;
+};
+
+struct HeapProfile
+{
+    QString executable;
+    qint64 allocations = 0;
+    qint64 frees = 0;
+    qint64 allocatedBytes = 0;
+    qint64 peakBytes = 0;
+    qint64 liveBytesAtExit = 0;
+    bool complete = false;                  // the tracker's exit snapshot arrived
+    QVector<HeapSnapshot> timeline;
+    QVector<AllocationSite> sites;          // sorted by allocations, descending
+
+    // Estimated allocations per 1-based line of one file
+    QHash<int, qint64> lineAllocations(const QString &filePath) const;
+};
+
+// Runs a program with the heaptracker library preloaded. The tracker sends
+// exact totals and sampled call stacks over a SOCK_SEQPACKET socket; once
+// the program exits the stacks are resolved with addr2line on a worker
+// thread and attributed to the innermost frame in the user's own sources.
+class HeapProfiler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit HeapProfiler(QObject *parent = nullptr);
+    ~HeapProfiler();
+
+    void start(const QString &executable, const ExecutionLimits &limits);
+    void cancel();
+    bool isRunning() const { return m_process != nullptr || m_analyzing; }
+
+    // The preload library, installed next to the editor or in ../lib
+    static QString trackerPath();
+
+signals:
+    void output(const QString &text, bool isError);     // the program's own output
+    void analyzing();
+    void finished(const HeapProfile &profile);
+    void failed(const QString &message);
+
+private:
+    struct StackStats
+    {
+        qint64 allocations = 0;
+        qint64 bytes = 0;
+    };
+
+    void readEvents();
+    void handleEvent(const char *data, int size);
+    void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void closeSocket();
+    void analyze();
+
+    QString m_executable;
+    QProcess *m_process;
+    ExecutionMonitor m_monitor;
+    QTimer *m_timeout;
+    QSocketNotifier *m_notifier;
+    int m_socket;
+    QStringDecoder m_stdoutDecoder;
+    QStringDecoder m_stderrDecoder;
+
+    HeapProfile m_profile;
+    quint64 m_loadBias;
+    quint64 m_imageStart;
+    quint64 m_imageEnd;
+    QHash<QVector<quint64>, StackStats> m_stacks;      // frames inside the executable only
+    QString m_killReason;
+    bool m_analyzing;
+    int m_generation;               // drops results of cancelled analyses
+};
+
+#endif // HEAPPROFILER_H
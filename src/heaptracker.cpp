@@ -0,0 +1,269 @@
+// LD_PRELOAD allocation tracker used by Build > Profile Memory. It is built
+// as its own shared library, links nothing but libc and must never allocate
+// through the functions it wraps. Totals are exact; call stacks are sampled
+// (every allocation of at least kLargeAllocation, one in kSampleStride of
+// the rest) to keep the event stream small for allocation-heavy programs.
+// operator new/delete in libstdc++ call malloc/free, so they are covered too.
+//
+// glibc only: the real allocator is reached through its __libc_* entry
+// points, which avoids the dlsym(RTLD_NEXT) bootstrap problem.
+
+#include "heaptrackerprotocol.h"
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <link.h>
+#include <malloc.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void __libc_free(void *ptr);
+}
+
+namespace {
+
+const uint32_t kSampleStride = 509;                 // prime, so loops don't alias with it
+const size_t kLargeAllocation = 256 * 1024;
+const uint64_t kSnapshotIntervalNs = 5 * 1000 * 1000;
+const uint32_t kSnapshotCheckEvery = 64;            // allocations between clock reads
+
+int g_fd = -1;
+uint64_t g_startNs = 0;
+std::atomic<uint64_t> g_allocations{0};
+std::atomic<uint64_t> g_frees{0};
+std::atomic<uint64_t> g_allocatedBytes{0};
+std::atomic<int64_t> g_liveBytes{0};
+std::atomic<uint64_t> g_peakBytes{0};
+std::atomic<uint64_t> g_lastSnapshotNs{0};
+
+// Built with -ftls-model=initial-exec: dynamic TLS could call malloc
+thread_local bool t_busy = false;                   // inside the tracker on this thread
+thread_local uint32_t t_untilSample = 0;
+thread_local uint32_t t_untilSnapshotCheck = 0;
+
+uint64_t monotonicNs()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return uint64_t(now.tv_sec) * 1000000000 + uint64_t(now.tv_nsec);
+}
+
+void sendEvent(const void *event, size_t size)
+{
+    const int fd = g_fd;
+    if (fd < 0) {
+        return;
+    }
+    while (send(fd, event, size, MSG_NOSIGNAL) < 0) {
+        if (errno != EINTR) {
+            g_fd = -1;          // the editor went away; keep running untracked
+            return;
+        }
+    }
+}
+
+void sendSnapshot(bool final)
+{
+    HeapTrace::Snapshot snapshot;
+    memset(&snapshot, 0, sizeof(snapshot));
+    snapshot.type = HeapTrace::SnapshotEvent;
+    snapshot.final = final ? 1 : 0;
+    snapshot.timeNs = monotonicNs() - g_startNs;
+    snapshot.allocations = g_allocations.load(std::memory_order_relaxed);
+    snapshot.frees = g_frees.load(std::memory_order_relaxed);
+    snapshot.allocatedBytes = g_allocatedBytes.load(std::memory_order_relaxed);
+    snapshot.liveBytes = g_liveBytes.load(std::memory_order_relaxed);
+    snapshot.peakBytes = g_peakBytes.load(std::memory_order_relaxed);
+    sendEvent(&snapshot, sizeof(snapshot));
+}
+
+void maybeSnapshot()
+{
+    if (t_untilSnapshotCheck-- > 0) {
+        return;
+    }
+    t_untilSnapshotCheck = kSnapshotCheckEvery;
+    const uint64_t now = monotonicNs();
+    uint64_t last = g_lastSnapshotNs.load(std::memory_order_relaxed);
+    // Only the thread that wins the exchange sends this interval's snapshot
+    if (now - last >= kSnapshotIntervalNs
+        && g_lastSnapshotNs.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+        sendSnapshot(false);
+    }
+}
+
+void sendSample(size_t size, uint64_t weight)
+{
+    HeapTrace::Sample sample;
+    sample.type = HeapTrace::SampleEvent;
+    sample.size = size;
+    sample.weight = weight;
+    const int frames = backtrace(reinterpret_cast<void **>(sample.frames), HeapTrace::kMaxFrames);
+    sample.frameCount = uint32_t(frames > 0 ? frames : 0);
+    sendEvent(&sample, offsetof(HeapTrace::Sample, frames) + sample.frameCount * sizeof(uint64_t));
+}
+
+void recordAllocation(void *ptr, size_t requested)
+{
+    if (!ptr || g_fd < 0 || t_busy) {
+        return;
+    }
+    t_busy = true;
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocatedBytes.fetch_add(requested, std::memory_order_relaxed);
+    // Usable sizes on both sides keep the live total consistent
+    const int64_t size = int64_t(malloc_usable_size(ptr));
+    const int64_t live = g_liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    uint64_t peak = g_peakBytes.load(std::memory_order_relaxed);
+    while (live > int64_t(peak)
+           && !g_peakBytes.compare_exchange_weak(peak, uint64_t(live), std::memory_order_relaxed)) {
+    }
+
+    if (requested >= kLargeAllocation) {
+        sendSample(requested, 1);
+    } else if (t_untilSample-- == 0) {
+        t_untilSample = kSampleStride - 1;
+        sendSample(requested, kSampleStride);
+    }
+    maybeSnapshot();
+    t_busy = false;
+}
+
+void recordFree(size_t usableSize)
+{
+    if (g_fd < 0 || t_busy) {
+        return;
+    }
+    g_frees.fetch_add(1, std::memory_order_relaxed);
+    g_liveBytes.fetch_sub(int64_t(usableSize), std::memory_order_relaxed);
+}
+
+int findMainImage(dl_phdr_info *info, size_t, void *data)
+{
+    // The main program is always reported first
+    HeapTrace::Start *start = static_cast<HeapTrace::Start *>(data);
+    uint64_t low = UINT64_MAX;
+    uint64_t high = 0;
+    for (int i = 0; i < info->dlpi_phnum; ++i) {
+        const ElfW(Phdr) &header = info->dlpi_phdr[i];
+        if (header.p_type == PT_LOAD) {
+            low = header.p_vaddr < low ? header.p_vaddr : low;
+            high = header.p_vaddr + header.p_memsz > high ? header.p_vaddr + header.p_memsz : high;
+        }
+    }
+    start->loadBias = info->dlpi_addr;
+    start->imageStart = low == UINT64_MAX ? 0 : info->dlpi_addr + low;
+    start->imageEnd = info->dlpi_addr + high;
+    return 1;
+}
+
+__attribute__((constructor)) void startTracker()
+{
+    const char *fdText = getenv(HeapTrace::kFdVariable);
+    if (!fdText) {
+        return;
+    }
+    const int fd = atoi(fdText);
+    // Programs this one execs or forks are not part of the profile
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    unsetenv(HeapTrace::kFdVariable);
+    unsetenv("LD_PRELOAD");
+
+    // The first backtrace() loads the unwinder, which allocates
+    t_busy = true;
+    void *warmup[2];
+    backtrace(warmup, 2);
+    t_busy = false;
+
+    g_startNs = monotonicNs();
+    g_lastSnapshotNs.store(g_startNs, std::memory_order_relaxed);
+
+    HeapTrace::Start start;
+    memset(&start, 0, sizeof(start));
+    start.type = HeapTrace::StartEvent;
+    start.sampleStride = kSampleStride;
+    dl_iterate_phdr(findMainImage, &start);
+    g_fd = fd;
+    sendEvent(&start, sizeof(start));
+}
+
+__attribute__((destructor)) void stopTracker()
+{
+    sendSnapshot(true);
+    g_fd = -1;
+}
+
+} // namespace
+
+extern "C" {
+
+void *malloc(size_t size)
+{
+    void *ptr = __libc_malloc(size);
+    recordAllocation(ptr, size);
+    return ptr;
+}
+
+void *calloc(size_t count, size_t size)
+{
+    void *ptr = __libc_calloc(count, size);
+    recordAllocation(ptr, count * size);
+    return ptr;
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    const size_t oldSize = ptr ? malloc_usable_size(ptr) : 0;
+    void *result = __libc_realloc(ptr, size);
+    // realloc(ptr, 0) frees; a failed realloc leaves the old block alone
+    if (ptr && (result || size == 0)) {
+        recordFree(oldSize);
+    }
+    recordAllocation(result, size);
+    return result;
+}
+
+void free(void *ptr)
+{
+    if (ptr) {
+        recordFree(malloc_usable_size(ptr));
+    }
+    __libc_free(ptr);
+}
+
+void *memalign(size_t alignment, size_t size)
+{
+    void *ptr = __libc_memalign(alignment, size);
+    recordAllocation(ptr, size);
+    return ptr;
+}
+
+void *aligned_alloc(size_t alignment, size_t size)
+{
+    return memalign(alignment, size);
+}
+
+int posix_memalign(void **result, size_t alignment, size_t size)
+{
+    if (alignment < sizeof(void *) || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    void *ptr = memalign(alignment, size);
+    if (!ptr) {
+        return ENOMEM;
+    }
+    *result = ptr;
+    return 0;
+}
+
+} // extern "C"
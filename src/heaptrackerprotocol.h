@@ -0,0 +1,58 @@
+#ifndef HEAPTRACKERPROTOCOL_H
+#define HEAPTRACKERPROTOCOL_H
+
+#include <cstdint>
+
+// Wire format between the LD_PRELOAD heap tracker and HeapProfiler. Every
+// event is one SOCK_SEQPACKET message, so threads never interleave and the
+// reader gets whole events. Both ends are built from this header together.
+namespace HeapTrace {
+
+// Environment variable holding the socket descriptor the tracker writes to
+constexpr const char *kFdVariable = "AICODEEDITOR_HEAP_FD";
+
+constexpr int kMaxFrames = 32;
+
+enum EventType : uint32_t
+{
+    StartEvent = 1,
+    SampleEvent = 2,
+    SnapshotEvent = 3,
+};
+
+// Sent once when the tracker loads: where the main executable is mapped
+struct Start
+{
+    uint32_t type;
+    uint32_t sampleStride;          // one small allocation in this many is sampled
+    uint64_t loadBias;              // subtract from an address for addr2line
+    uint64_t imageStart;
+    uint64_t imageEnd;
+};
+
+// A sampled allocation; only the first frameCount frames are sent
+struct Sample
+{
+    uint32_t type;
+    uint32_t frameCount;
+    uint64_t size;
+    uint64_t weight;                // allocations this sample stands for
+    uint64_t frames[kMaxFrames];    // return addresses, innermost first
+};
+
+// Exact totals, sent at most every few milliseconds and once at exit
+struct Snapshot
+{
+    uint32_t type;
+    uint32_t final;
+    uint64_t timeNs;                // since the tracker loaded
+    uint64_t allocations;
+    uint64_t frees;
+    uint64_t allocatedBytes;
+    int64_t liveBytes;
+    uint64_t peakBytes;
+};
+
+} // namespace HeapTrace
+
+#endif // HEAPTRACKERPROTOCOL_H
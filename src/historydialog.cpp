@@ -0,0 +1,188 @@
+#include "historydialog.h"
+#include <QFileInfo>
+#include <QHeaderView>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QVBoxLayout>
+#include <algorithm>
+
+namespace {
+
+double medianOf(QVector<double> samples)
+{
+    if (samples.isEmpty()) {
+        return 0;
+    }
+    std::sort(samples.begin(), samples.end());
+    const int middle = samples.size() / 2;
+    return samples.size() % 2 ? samples[middle] : (samples[middle - 1] + samples[middle]) / 2;
+}
+
+QString formatMs(double us)
+{
+    return QString("%1 ms").arg(us / 1000.0, 0, 'f', 3);
+}
+
+} // namespace
+
+TimelineChart::TimelineChart(QWidget *parent)
+    : QWidget(parent)
+    , m_maxUs(0)
+    , m_currentIndex(-1)
+{
+    setMinimumHeight(180);
+}
+
+void TimelineChart::setRecords(const QVector<RunRecord> &records)
+{
+    m_records = records;
+    m_medians.clear();
+    m_maxUs = 0;
+    for (const RunRecord &record : m_records) {
+        m_medians.append(record.medianWallUs());
+        for (double sample : record.wallUs) {
+            m_maxUs = qMax(m_maxUs, sample);
+        }
+    }
+    update();
+}
+
+void TimelineChart::setCurrentIndex(int index)
+{
+    m_currentIndex = index;
+    update();
+}
+
+QRectF TimelineChart::plotRect() const
+{
+    return QRectF(70, 12, width() - 84, height() - 36);
+}
+
+QPointF TimelineChart::pointFor(int index, double valueUs) const
+{
+    const QRectF plot = plotRect();
+    const double x = m_records.size() > 1
+        ? plot.left() + plot.width() * index / (m_records.size() - 1)
+        : plot.center().x();
+    const double y = m_maxUs > 0 ? plot.bottom() - plot.height() * valueUs / m_maxUs : plot.bottom();
+    return QPointF(x, y);
+}
+
+void TimelineChart::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.fillRect(rect(), QColor(30, 30, 30));
+
+    const QRectF plot = plotRect();
+    painter.setPen(QColor(80, 80, 80));
+    painter.drawLine(plot.bottomLeft(), plot.bottomRight());
+    painter.drawLine(plot.bottomLeft(), plot.topLeft());
+
+    if (m_records.isEmpty()) {
+        painter.setPen(QColor(136, 136, 136));
+        painter.drawText(rect(), Qt::AlignCenter, tr("No recorded runs yet"));
+        return;
+    }
+
+    painter.setPen(QColor(136, 136, 136));
+    painter.drawText(QRectF(0, plot.top() - 6, plot.left() - 6, 14), Qt::AlignRight, formatMs(m_maxUs));
+    painter.drawText(QRectF(0, plot.bottom() - 8, plot.left() - 6, 14), Qt::AlignRight, formatMs(0));
+    painter.drawText(QRectF(plot.left(), plot.bottom() + 4, plot.width(), 16), Qt::AlignLeft,
+                     m_records.first().timestamp.toString("yyyy-MM-dd hh:mm"));
+    painter.drawText(QRectF(plot.left(), plot.bottom() + 4, plot.width(), 16), Qt::AlignRight,
+                     m_records.last().timestamp.toString("yyyy-MM-dd hh:mm"));
+
+    // Whiskers from fastest to slowest sample
+    painter.setPen(QPen(QColor(90, 160, 220, 120), 1));
+    for (int i = 0; i < m_records.size(); ++i) {
+        const QVector<double> &samples = m_records[i].wallUs;
+        if (samples.size() > 1) {
+            const auto range = std::minmax_element(samples.begin(), samples.end());
+            painter.drawLine(pointFor(i, *range.first), pointFor(i, *range.second));
+        }
+    }
+
+    painter.setPen(QPen(QColor(90, 160, 220), 2));
+    for (int i = 1; i < m_records.size(); ++i) {
+        painter.drawLine(pointFor(i - 1, m_medians[i - 1]), pointFor(i, m_medians[i]));
+    }
+    for (int i = 0; i < m_records.size(); ++i) {
+        const bool current = i == m_currentIndex;
+        painter.setBrush(current ? QColor(255, 255, 255) : QColor(90, 160, 220));
+        painter.drawEllipse(pointFor(i, m_medians[i]), current ? 5 : 3, current ? 5 : 3);
+    }
+}
+
+void TimelineChart::mousePressEvent(QMouseEvent *event)
+{
+    int nearest = -1;
+    double nearestDistance = 12;
+    for (int i = 0; i < m_records.size(); ++i) {
+        const double distance = qAbs(pointFor(i, m_medians[i]).x() - event->position().x());
+        if (distance < nearestDistance) {
+            nearest = i;
+            nearestDistance = distance;
+        }
+    }
+    if (nearest >= 0) {
+        setCurrentIndex(nearest);
+        emit pointClicked(nearest);
+    }
+}
+
+HistoryDialog::HistoryDialog(const QString &program, const QVector<RunRecord> &records, QWidget *parent)
+    : QDialog(parent)
+{
+    setWindowTitle(tr("Performance History - %1").arg(QFileInfo(program).fileName()));
+    resize(900, 560);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+
+    m_chart = new TimelineChart(this);
+    m_chart->setRecords(records);
+    layout->addWidget(m_chart, 1);
+
+    m_table = new QTableWidget(records.size(), 7, this);
+    m_table->setHorizontalHeaderLabels({tr("Time"), tr("Kind"), tr("Runs"), tr("Median Wall"),
+                                        tr("Median CPU"), tr("Change"), tr("Source / Compiler")});
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_table->verticalHeader()->hide();
+    m_table->horizontalHeader()->setStretchLastSection(true);
+
+    double previousMedian = 0;
+    for (int row = 0; row < records.size(); ++row) {
+        const RunRecord &record = records[row];
+        const double median = record.medianWallUs();
+        QString change;
+        if (previousMedian > 0) {
+            const double percent = (median / previousMedian - 1.0) * 100.0;
+            change = QString("%1%2%").arg(percent >= 0 ? QString("+") : QString()).arg(percent, 0, 'f', 1);
+        }
+        previousMedian = median;
+
+        m_table->setItem(row, 0, new QTableWidgetItem(record.timestamp.toString("yyyy-MM-dd hh:mm:ss")));
+        m_table->setItem(row, 1, new QTableWidgetItem(record.kind));
+        m_table->setItem(row, 2, new QTableWidgetItem(QString::number(record.wallUs.size())));
+        m_table->setItem(row, 3, new QTableWidgetItem(formatMs(median)));
+        m_table->setItem(row, 4, new QTableWidgetItem(formatMs(medianOf(record.cpuUs))));
+        m_table->setItem(row, 5, new QTableWidgetItem(change));
+        QTableWidgetItem *sourceItem = new QTableWidgetItem(
+            QString("%1 | %2 %3").arg(record.sourceHash.left(10), record.compiler, record.flags.join(' ')));
+        sourceItem->setToolTip(record.source);
+        m_table->setItem(row, 6, sourceItem);
+    }
+    m_table->resizeColumnsToContents();
+    layout->addWidget(m_table, 1);
+
+    connect(m_chart, &TimelineChart::pointClicked, m_table, &QTableWidget::selectRow);
+    connect(m_table, &QTableWidget::currentCellChanged, m_chart, [this](int row) {
+        m_chart->setCurrentIndex(row);
+    });
+
+    if (!records.isEmpty()) {
+        m_table->selectRow(records.size() - 1);
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef HISTORYDIALOG_H
+#define HISTORYDIALOG_H
+
+#include <QDialog>
+#include <QWidget>
+#include <QTableWidget>
+#include "runhistory.h"
+
+// Median wall time of each record over time, with a min..max whisker
+class TimelineChart : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit TimelineChart(QWidget *parent = nullptr);
+
+    void setRecords(const QVector<RunRecord> &records);
+    void setCurrentIndex(int index);
+
+signals:
+    void pointClicked(int index);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+
+private:
+    QRectF plotRect() const;
+    QPointF pointFor(int index, double valueUs) const;
+
+    QVector<RunRecord> m_records;
+    QVector<double> m_medians;
+    double m_maxUs;
+    int m_currentIndex;
+};
+
+// Timeline of a program's recorded runs and benchmarks
+class HistoryDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    HistoryDialog(const QString &program, const QVector<RunRecord> &records, QWidget *parent = nullptr);
+
+private:
+    TimelineChart *m_chart;
+    QTableWidget *m_table;
+};
+
+#endif // HISTORYDIALOG_H
@@ -0,0 +1,141 @@
+#include "hotspotpanel.h"
+#include <QFileInfo>
+#include <QHeaderView>
+#include <QSortFilterProxyModel>
+#include <QVBoxLayout>
+
+HotspotModel::HotspotModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+void HotspotModel::setResult(const ProfileResult &result)
+{
+    beginResetModel();
+    m_result = result;
+    endResetModel();
+}
+
+int HotspotModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_result.hotspots.size();
+}
+
+int HotspotModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant HotspotModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_result.hotspots.size()) {
+        return QVariant();
+    }
+
+    const Hotspot &hotspot = m_result.hotspots.at(index.row());
+    const double percent = m_result.totalSamples > 0 ? 100.0 * hotspot.samples / m_result.totalSamples : 0;
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case FunctionColumn: return hotspot.symbol;
+        case ModuleColumn: return hotspot.module;
+        case SamplesColumn: return hotspot.samples;
+        case PercentColumn: return QString("%1%").arg(percent, 0, 'f', 1);
+        case LocationColumn:
+            return hotspot.line > 0
+                ? QString("%1:%2").arg(QFileInfo(hotspot.filePath).fileName()).arg(hotspot.line)
+                : QString();
+        }
+    }
+    // Sort numerically rather than by the formatted text
+    if (role == Qt::UserRole) {
+        switch (index.column()) {
+        case SamplesColumn:
+        case PercentColumn:
+            return hotspot.samples;
+        default:
+            return data(index, Qt::DisplayRole);
+        }
+    }
+    if (role == Qt::TextAlignmentRole && (index.column() == SamplesColumn || index.column() == PercentColumn)) {
+        return int(Qt::AlignRight | Qt::AlignVCenter);
+    }
+    if (role == Qt::ToolTipRole && hotspot.line > 0) {
+        return QString("%1:%2").arg(hotspot.filePath).arg(hotspot.line);
+    }
+    return QVariant();
+}
+
+QVariant HotspotModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    switch (section) {
+    case FunctionColumn: return tr("Function");
+    case ModuleColumn: return tr("Module");
+    case SamplesColumn: return tr("Samples");
+    case PercentColumn: return tr("Self %");
+    case LocationColumn: return tr("Hottest Line");
+    }
+    return QVariant();
+}
+
+HotspotPanel::HotspotPanel(QWidget *parent)
+    : QWidget(parent)
+{
+    m_model = new HotspotModel(this);
+    m_proxy = new QSortFilterProxyModel(this);
+    m_proxy->setSourceModel(m_model);
+    m_proxy->setSortRole(Qt::UserRole);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(8, 8, 8, 8);
+
+    m_view = new QTableView(this);
+    m_view->setModel(m_proxy);
+    m_view->setSortingEnabled(true);
+    m_view->sortByColumn(HotspotModel::SamplesColumn, Qt::DescendingOrder);
+    m_view->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_view->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_view->setWordWrap(false);
+    m_view->setShowGrid(false);
+    m_view->verticalHeader()->hide();
+    m_view->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_view->verticalHeader()->setDefaultSectionSize(m_view->fontMetrics().height() + 6);
+    m_view->horizontalHeader()->setStretchLastSection(true);
+    m_view->horizontalHeader()->resizeSection(HotspotModel::FunctionColumn, 260);
+    m_view->horizontalHeader()->resizeSection(HotspotModel::ModuleColumn, 120);
+    m_view->horizontalHeader()->resizeSection(HotspotModel::SamplesColumn, 70);
+    m_view->horizontalHeader()->resizeSection(HotspotModel::PercentColumn, 70);
+    m_view->setStyleSheet(R"(
+        QTableView {
+            background-color: #1e1e1e;
+            border: 1px solid #3d3d3d;
+            border-radius: 6px;
+        }
+        QTableView::item:selected {
+            background-color: #0078d7;
+        }
+    )");
+    connect(m_view, &QTableView::activated, [this](const QModelIndex &index) {
+        const Hotspot &hotspot = m_model->hotspotAt(m_proxy->mapToSource(index).row());
+        if (hotspot.line > 0) {
+            emit hotspotActivated(hotspot.filePath, hotspot.line);
+        }
+    });
+    layout->addWidget(m_view, 1);
+
+    m_summaryLabel = new QLabel(tr("Run Build > Profile to collect samples"), this);
+    m_summaryLabel->setStyleSheet("color: #888;");
+    layout->addWidget(m_summaryLabel);
+}
+
+void HotspotPanel::setResult(const ProfileResult &result)
+{
+    m_result = result;
+    m_model->setResult(result);
+    m_summaryLabel->setText(tr("%1 samples of %2, %3 functions")
+                                .arg(result.totalSamples)
+                                .arg(QFileInfo(result.executable).fileName())
+                                .arg(result.hotspots.size()));
+}
@@ -0,0 +1,55 @@
+#ifndef HOTSPOTPANEL_H
+#define HOTSPOTPANEL_H
+
+#include <QWidget>
+#include <QAbstractTableModel>
+#include <QTableView>
+#include <QLabel>
+#include "perfprofiler.h"
+
+class QSortFilterProxyModel;
+
+class HotspotModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column { FunctionColumn, ModuleColumn, SamplesColumn, PercentColumn, LocationColumn, ColumnCount };
+
+    explicit HotspotModel(QObject *parent = nullptr);
+
+    void setResult(const ProfileResult &result);
+    const Hotspot &hotspotAt(int row) const { return m_result.hotspots.at(row); }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    ProfileResult m_result;
+};
+
+// Function-level view of the last CPU profile
+class HotspotPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit HotspotPanel(QWidget *parent = nullptr);
+
+    void setResult(const ProfileResult &result);
+    const ProfileResult &result() const { return m_result; }
+
+signals:
+    void hotspotActivated(const QString &filePath, int line);
+
+private:
+    ProfileResult m_result;
+    HotspotModel *m_model;
+    QSortFilterProxyModel *m_proxy;
+    QTableView *m_view;
+    QLabel *m_summaryLabel;
+};
+
+#endif // HOTSPOTPANEL_H
@@ -0,0 +1,173 @@
+#include "jobscheduler.h"
+#include <QSet>
+#include <QThread>
+
+JobScheduler::JobScheduler(QObject *parent)
+    : QObject(parent)
+    , m_nextId(1)
+    , m_maxConcurrent(qMax(2, QThread::idealThreadCount()))
+    , m_dispatching(false)
+{
+}
+
+JobScheduler::~JobScheduler()
+{
+    // Owners tear their work down themselves; their cancel functions may
+    // already point at destroyed members
+    qDeleteAll(m_jobs);
+}
+
+JobId JobScheduler::submit(const JobSpec &spec, std::function<void(JobId)> start, std::function<void()> cancel)
+{
+    if (!spec.supersedeKey.isEmpty()) {
+        const QList<Job *> jobs = m_jobs;
+        for (Job *job : jobs) {
+            if (job->spec.supersedeKey == spec.supersedeKey) {
+                end(job, Cancelled);
+            }
+        }
+    }
+
+    Job *job = new Job;
+    job->spec = spec;
+    job->info.id = m_nextId++;
+    job->info.description = spec.description;
+    job->start = std::move(start);
+    job->cancel = std::move(cancel);
+    m_jobs.append(job);
+
+    const JobId id = job->info.id;
+    emit jobQueued(id, spec.description);
+    emit activeJobsChanged(m_jobs.size());
+    dispatch();
+    return id;
+}
+
+void JobScheduler::setProgress(JobId id, int done, int total)
+{
+    Job *job = find(id);
+    if (!job || job->info.state != Running) {
+        return;
+    }
+    job->info.done = done;
+    job->info.total = total;
+    emit jobProgress(id, done, total);
+}
+
+void JobScheduler::finish(JobId id, bool success)
+{
+    Job *job = find(id);
+    if (job && job->info.state == Running) {
+        end(job, success ? Succeeded : Failed);
+    }
+}
+
+void JobScheduler::cancel(JobId id)
+{
+    if (Job *job = find(id)) {
+        end(job, Cancelled);
+    }
+}
+
+void JobScheduler::cancelAll()
+{
+    // Queued jobs first, so cancelling a running one doesn't start them
+    const QList<Job *> jobs = m_jobs;
+    for (Job *job : jobs) {
+        if (job->info.state == Queued) {
+            end(job, Cancelled);
+        }
+    }
+    const QList<Job *> running = m_jobs;
+    for (Job *job : running) {
+        end(job, Cancelled);
+    }
+}
+
+bool JobScheduler::isActive(JobId id) const
+{
+    return find(id) != nullptr;
+}
+
+QVector<JobScheduler::JobInfo> JobScheduler::activeJobs() const
+{
+    QVector<JobInfo> jobs;
+    for (const Job *job : m_jobs) {
+        jobs << job->info;
+    }
+    return jobs;
+}
+
+void JobScheduler::setMaxConcurrentJobs(int count)
+{
+    m_maxConcurrent = qMax(1, count);
+    dispatch();
+}
+
+JobScheduler::Job *JobScheduler::find(JobId id) const
+{
+    for (Job *job : m_jobs) {
+        if (job->info.id == id) {
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+JobScheduler::Job *JobScheduler::nextRunnable() const
+{
+    int running = 0;
+    QSet<QString> busy;
+    for (const Job *job : m_jobs) {
+        if (job->info.state == Running) {
+            ++running;
+            if (!job->spec.resource.isEmpty()) {
+                busy.insert(job->spec.resource);
+            }
+        }
+    }
+    if (running >= m_maxConcurrent) {
+        return nullptr;
+    }
+
+    // m_jobs is in submission order, so the first of the highest priority wins
+    Job *next = nullptr;
+    for (Job *job : m_jobs) {
+        if (job->info.state == Queued && !busy.contains(job->spec.resource)
+            && (!next || job->spec.priority > next->spec.priority)) {
+            next = job;
+        }
+    }
+    return next;
+}
+
+void JobScheduler::dispatch()
+{
+    // A start function may finish its job, or submit another, before returning
+    if (m_dispatching) {
+        return;
+    }
+    m_dispatching = true;
+    while (Job *job = nextRunnable()) {
+        job->info.state = Running;
+        const JobId id = job->info.id;
+        emit jobStarted(id, job->spec.description);
+        job->start(id);
+    }
+    m_dispatching = false;
+}
+
+void JobScheduler::end(Job *job, State state)
+{
+    const bool wasRunning = job->info.state == Running;
+    const JobId id = job->info.id;
+    m_jobs.removeOne(job);
+    if (wasRunning && state == Cancelled && job->cancel) {
+        job->cancel();
+    }
+    delete job;
+
+    emit jobFinished(id, state);
+    emit activeJobsChanged(m_jobs.size());
+    dispatch();
+}
@@ -0,0 +1,92 @@
+#ifndef JOBSCHEDULER_H
+#define JOBSCHEDULER_H
+
+#include <QObject>
+#include <QList>
+#include <QString>
+#include <QVector>
+#include <functional>
+
+// Never reused within a session; 0 means "no job"
+using JobId = quint64;
+
+// Queues builds, runs, benchmarks and background checks and decides when
+// each may start. A job names a resource it needs exclusively (e.g. the
+// compiler process) and, optionally, a supersede key: submitting a job
+// with the key of a queued or running one cancels the older job, so a new
+// compile of a file replaces a stale compile of the same file. Queued
+// jobs start by priority, then in submission order, up to a limit of
+// concurrently running jobs.
+//
+// A job's start function kicks off asynchronous work and must eventually
+// call finish() with the id it was given; its cancel function stops that
+// work without reporting back. Calls for jobs that are no longer running
+// are ignored, so late signals from cancelled work are harmless.
+class JobScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Priority { Background, Normal, Interactive };
+    enum State { Queued, Running, Succeeded, Failed, Cancelled };
+
+    struct JobSpec
+    {
+        QString description;            // e.g. "Build main.cpp"
+        QString resource;               // jobs with the same resource never overlap
+        QString supersedeKey;           // empty: never superseded
+        Priority priority = Normal;
+    };
+
+    struct JobInfo
+    {
+        JobId id = 0;
+        QString description;
+        State state = Queued;
+        int done = 0;                   // progress, when total > 0
+        int total = 0;
+    };
+
+    explicit JobScheduler(QObject *parent = nullptr);
+    ~JobScheduler();
+
+    JobId submit(const JobSpec &spec, std::function<void(JobId)> start, std::function<void()> cancel);
+    void setProgress(JobId id, int done, int total);
+    void finish(JobId id, bool success);
+    void cancel(JobId id);
+    void cancelAll();
+
+    bool isActive(JobId id) const;      // queued or running
+    QVector<JobInfo> activeJobs() const;
+
+    int maxConcurrentJobs() const { return m_maxConcurrent; }
+    void setMaxConcurrentJobs(int count);
+
+signals:
+    void jobQueued(JobId id, const QString &description);
+    void jobStarted(JobId id, const QString &description);
+    void jobProgress(JobId id, int done, int total);
+    void jobFinished(JobId id, JobScheduler::State state);
+    void activeJobsChanged(int count);
+
+private:
+    struct Job
+    {
+        JobSpec spec;
+        JobInfo info;
+        std::function<void(JobId)> start;
+        std::function<void()> cancel;
+    };
+
+    Job *find(JobId id) const;
+    Job *nextRunnable() const;
+    void dispatch();
+    void end(Job *job, State state);
+
+    QList<Job *> m_jobs;                // queued and running, in submission order
+    JobId m_nextId;
+    int m_maxConcurrent;
+    bool m_dispatching;
+};
+
+#endif // JOBSCHEDULER_H
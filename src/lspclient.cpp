@@ -0,0 +1,667 @@
+#include "lspclient.h"
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QStandardPaths>
+#include <QTextCursor>
+#include <QUrl>
+#include <algorithm>
+
+namespace {
+
+const int kChangeDebounceMs = 50;
+const int kHoverDebounceMs = 350;
+const int kTokensDebounceMs = 300;
+const int kMaxCompletionItems = 200;
+
+SemanticKind semanticKindFor(const QString &tokenType)
+{
+    static const QHash<QString, SemanticKind> kinds = {
+        {"class", SemanticKind::Type}, {"struct", SemanticKind::Type},
+        {"enum", SemanticKind::Type}, {"type", SemanticKind::Type},
+        {"typeParameter", SemanticKind::Type}, {"concept", SemanticKind::Type},
+        {"interface", SemanticKind::Type}, {"function", SemanticKind::Function},
+        {"method", SemanticKind::Function}, {"macro", SemanticKind::Macro},
+        {"namespace", SemanticKind::Namespace}, {"enumMember", SemanticKind::EnumMember},
+        {"property", SemanticKind::Field}, {"parameter", SemanticKind::Parameter},
+        {"variable", SemanticKind::Variable}
+    };
+    return kinds.value(tokenType, SemanticKind::Other);
+}
+
+QString markupToText(const QJsonValue &contents)
+{
+    if (contents.isString()) {
+        return contents.toString();
+    }
+    if (contents.isObject()) {
+        return contents.toObject().value("value").toString();
+    }
+    if (contents.isArray()) {
+        QStringList parts;
+        for (const QJsonValue &part : contents.toArray()) {
+            parts.append(markupToText(part));
+        }
+        return parts.join("\n");
+    }
+    return QString();
+}
+
+} // namespace
+
+LspClient::LspClient(QObject *parent)
+    : QObject(parent)
+    , m_state(Stopped)
+    , m_nextId(1)
+    , m_version(0)
+    , m_documentOpen(false)
+    , m_completionRequest(0)
+    , m_hoverRequest(0)
+    , m_tokensRequest(0)
+    , m_hoverLine(0)
+    , m_hoverCharacter(0)
+    , m_tokensDelta(false)
+{
+    m_process = new QProcess(this);
+    // clangd logs heavily to stderr; an undrained pipe would stall it
+    m_process->setStandardErrorFile(QProcess::nullDevice());
+    connect(m_process, &QProcess::readyReadStandardOutput, this, &LspClient::onReadyRead);
+    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &LspClient::onProcessFinished);
+    connect(m_process, &QProcess::started, this, &LspClient::initialize);
+    connect(m_process, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            m_state = Stopped;
+            emit statusChanged(tr("Failed to start clangd"));
+        }
+    });
+
+    m_changeTimer = new QTimer(this);
+    m_changeTimer->setSingleShot(true);
+    m_changeTimer->setInterval(kChangeDebounceMs);
+    connect(m_changeTimer, &QTimer::timeout, this, &LspClient::flushChanges);
+
+    m_hoverTimer = new QTimer(this);
+    m_hoverTimer->setSingleShot(true);
+    m_hoverTimer->setInterval(kHoverDebounceMs);
+    connect(m_hoverTimer, &QTimer::timeout, this, &LspClient::sendHover);
+
+    m_tokensTimer = new QTimer(this);
+    m_tokensTimer->setSingleShot(true);
+    m_tokensTimer->setInterval(kTokensDebounceMs);
+    connect(m_tokensTimer, &QTimer::timeout, this, &LspClient::requestSemanticTokens);
+}
+
+LspClient::~LspClient()
+{
+    if (m_process->state() != QProcess::NotRunning) {
+        sendNotification("exit", QJsonObject());
+        m_process->waitForFinished(500);
+        m_process->kill();
+        m_process->waitForFinished(500);
+    }
+}
+
+QString LspClient::findServer()
+{
+    QString path = QStandardPaths::findExecutable("clangd");
+    for (int version = 20; path.isEmpty() && version >= 12; --version) {
+        path = QStandardPaths::findExecutable(QString("clangd-%1").arg(version));
+    }
+    return path;
+}
+
+bool LspClient::start(const QString &rootPath, const QStringList &fallbackFlags)
+{
+    if (isRunning() && rootPath == m_rootPath) {
+        return true;
+    }
+    stop();
+
+    const QString server = findServer();
+    if (server.isEmpty()) {
+        emit statusChanged(tr("clangd not found"));
+        return false;
+    }
+
+    // Asynchronous: initialize() goes out once the process has started, and
+    // a failure to start is reported from errorOccurred
+    m_rootPath = rootPath;
+    m_fallbackFlags = fallbackFlags;
+    m_state = Initializing;
+    emit statusChanged(tr("clangd starting..."));
+    m_process->setWorkingDirectory(rootPath);
+    m_process->start(server, {"--background-index", "--header-insertion=never"});
+    return true;
+}
+
+void LspClient::initialize()
+{
+    QJsonObject capabilities{
+        {"textDocument", QJsonObject{
+            {"synchronization", QJsonObject{{"didSave", false}, {"dynamicRegistration", false}}},
+            {"completion", QJsonObject{
+                {"completionItem", QJsonObject{{"snippetSupport", false}}}}},
+            {"hover", QJsonObject{{"contentFormat", QJsonArray{"plaintext", "markdown"}}}},
+            {"publishDiagnostics", QJsonObject{
+                {"relatedInformation", false}, {"codeActionsInline", true}}},
+            {"semanticTokens", QJsonObject{
+                {"requests", QJsonObject{{"full", QJsonObject{{"delta", true}}}}},
+                {"tokenTypes", QJsonArray{"namespace", "type", "class", "enum", "interface",
+                                          "struct", "typeParameter", "parameter", "variable",
+                                          "property", "enumMember", "function", "method",
+                                          "macro", "concept"}},
+                {"tokenModifiers", QJsonArray()},
+                {"formats", QJsonArray{"relative"}}}}
+        }}
+    };
+
+    QJsonObject params{
+        {"processId", qint64(QCoreApplication::applicationPid())},
+        {"rootUri", QUrl::fromLocalFile(m_rootPath).toString()},
+        {"capabilities", capabilities},
+        {"clientInfo", QJsonObject{{"name", "AICodeEditor"}}},
+        {"initializationOptions", QJsonObject{
+            {"fallbackFlags", QJsonArray::fromStringList(m_fallbackFlags)}}}
+    };
+
+    sendRequest("initialize", params, [this](const QJsonValue &result, const QJsonObject &error) {
+        if (!error.isEmpty()) {
+            emit statusChanged(tr("clangd: %1").arg(error.value("message").toString()));
+            return;
+        }
+        const QJsonObject provider = result.toObject().value("capabilities").toObject()
+                                         .value("semanticTokensProvider").toObject();
+        m_tokenTypes.clear();
+        for (const QJsonValue &type : provider.value("legend").toObject().value("tokenTypes").toArray()) {
+            m_tokenTypes.append(type.toString());
+        }
+        const QJsonValue full = provider.value("full");
+        m_tokensDelta = full.isObject() && full.toObject().value("delta").toBool();
+
+        sendNotification("initialized", QJsonObject());
+        m_state = Ready;
+        emit statusChanged(tr("clangd ready"));
+        if (m_document && !m_documentOpen) {
+            sendDidOpen();
+        }
+    });
+}
+
+void LspClient::stop()
+{
+    if (m_process->state() == QProcess::NotRunning) {
+        m_state = Stopped;
+        return;
+    }
+    if (m_process->state() == QProcess::Starting) {
+        // Nothing to shut down politely yet
+        m_process->kill();
+        m_process->waitForFinished(500);
+        m_state = Stopped;
+        return;
+    }
+    sendRequest("shutdown", QJsonObject(), [this](const QJsonValue &, const QJsonObject &) {
+        sendNotification("exit", QJsonObject());
+    });
+    if (!m_process->waitForFinished(1000)) {
+        m_process->kill();
+        m_process->waitForFinished(500);
+    }
+    m_state = Stopped;
+}
+
+void LspClient::onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    Q_UNUSED(exitCode);
+    const bool crashed = exitStatus == QProcess::CrashExit;
+    m_state = Stopped;
+    m_pending.clear();
+    m_readBuffer.clear();
+    m_documentOpen = false;
+    m_completionRequest = m_hoverRequest = m_tokensRequest = 0;
+    m_tokensResultId.clear();
+    m_tokensData.clear();
+    emit statusChanged(crashed ? tr("clangd crashed") : tr("clangd stopped"));
+}
+
+void LspClient::openDocument(const QString &filePath, QTextDocument *document)
+{
+    closeDocument();
+
+    m_document = document;
+    m_filePath = filePath;
+    m_uri = QUrl::fromLocalFile(filePath).toString();
+    connect(document, &QTextDocument::contentsChange, this, &LspClient::onContentsChange);
+
+    if (m_state == Ready) {
+        sendDidOpen();
+    }
+}
+
+void LspClient::closeDocument()
+{
+    if (m_document) {
+        disconnect(m_document, &QTextDocument::contentsChange, this, &LspClient::onContentsChange);
+    }
+    // Edits queued for the old document must not reach the server under its URI
+    m_pendingChanges = QJsonArray();
+    m_changeTimer->stop();
+    m_tokensTimer->stop();
+    m_hoverTimer->stop();
+    cancelRequest(m_completionRequest);
+    cancelRequest(m_hoverRequest);
+    cancelRequest(m_tokensRequest);
+
+    if (m_documentOpen && m_state == Ready) {
+        sendNotification("textDocument/didClose", QJsonObject{{"textDocument", QJsonObject{{"uri", m_uri}}}});
+    }
+    m_documentOpen = false;
+    m_document = nullptr;
+    m_filePath.clear();
+    m_uri.clear();
+    m_shadow.clear();
+    m_tokensResultId.clear();
+    m_tokensData.clear();
+}
+
+QString LspClient::documentText() const
+{
+    return m_document ? m_document->toPlainText() : QString();
+}
+
+void LspClient::sendDidOpen()
+{
+    const QString suffix = QFileInfo(m_filePath).suffix().toLower();
+    m_shadow = documentText();
+    m_version = 1;
+    sendNotification("textDocument/didOpen", QJsonObject{
+        {"textDocument", QJsonObject{
+            {"uri", m_uri},
+            {"languageId", suffix == "c" ? "c" : "cpp"},
+            {"version", m_version},
+            {"text", m_shadow}}}
+    });
+    m_documentOpen = true;
+    m_tokensTimer->start();
+}
+
+QJsonObject LspClient::documentIdentifier() const
+{
+    return QJsonObject{{"uri", m_uri}};
+}
+
+QJsonObject LspClient::positionAt(int offset) const
+{
+    // LSP positions are (line, UTF-16 column), which is what QString indexes
+    const QStringView before = QStringView(m_shadow).left(offset);
+    const int line = int(before.count(QChar('\n')));
+    const int lineStart = int(before.lastIndexOf(QChar('\n'))) + 1;
+    return QJsonObject{{"line", line}, {"character", offset - lineStart}};
+}
+
+void LspClient::resyncDocument()
+{
+    m_shadow = documentText();
+    m_pendingChanges = QJsonArray{QJsonObject{{"text", m_shadow}}};
+    m_changeTimer->start();
+}
+
+void LspClient::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    if (!m_documentOpen || !m_document) {
+        return;
+    }
+
+    // QTextDocument sometimes reports ranges past the end (e.g. after
+    // setPlainText); send the whole text rather than a wrong delta
+    if (position + charsRemoved > m_shadow.size()) {
+        resyncDocument();
+        return;
+    }
+
+    QTextCursor cursor(m_document);
+    cursor.setPosition(position);
+    cursor.setPosition(qMin(position + charsAdded, m_document->characterCount() - 1), QTextCursor::KeepAnchor);
+    QString added = cursor.selectedText();
+    added.replace(QChar::ParagraphSeparator, QChar('\n'));
+    added.replace(QChar::LineSeparator, QChar('\n'));
+
+    // Format-only changes (e.g. from the highlighter) carry identical text
+    if (QStringView(m_shadow).mid(position, charsRemoved) == added) {
+        return;
+    }
+
+    m_pendingChanges.append(QJsonObject{
+        {"range", QJsonObject{{"start", positionAt(position)},
+                              {"end", positionAt(position + charsRemoved)}}},
+        {"text", added}
+    });
+    m_shadow.replace(position, charsRemoved, added);
+
+    if (m_shadow.size() != m_document->characterCount() - 1) {
+        resyncDocument();
+        return;
+    }
+    m_changeTimer->start();
+}
+
+void LspClient::flushChanges()
+{
+    m_changeTimer->stop();
+    if (m_pendingChanges.isEmpty() || !m_documentOpen || m_state != Ready) {
+        return;
+    }
+
+    ++m_version;
+    sendNotification("textDocument/didChange", QJsonObject{
+        {"textDocument", QJsonObject{{"uri", m_uri}, {"version", m_version}}},
+        {"contentChanges", m_pendingChanges}
+    });
+    m_pendingChanges = QJsonArray();
+
+    // Results for the old version are stale now
+    cancelRequest(m_hoverRequest);
+    m_tokensTimer->start();
+}
+
+void LspClient::requestCompletion(int line, int character)
+{
+    if (!m_documentOpen || m_state != Ready) {
+        return;
+    }
+    flushChanges();
+    cancelRequest(m_completionRequest);
+
+    const QJsonObject params{
+        {"textDocument", documentIdentifier()},
+        {"position", QJsonObject{{"line", line}, {"character", character}}}
+    };
+    m_completionRequest = sendRequest("textDocument/completion", params,
+        [this, line, character](const QJsonValue &result, const QJsonObject &error) {
+            m_completionRequest = 0;
+            if (!error.isEmpty()) {
+                return;
+            }
+            const QJsonArray items = result.isArray()
+                ? result.toArray()
+                : result.toObject().value("items").toArray();
+
+            QStringList completions;
+            for (const QJsonValue &value : items) {
+                const QJsonObject item = value.toObject();
+                QString text = item.value("textEdit").toObject().value("newText").toString();
+                if (text.isEmpty()) text = item.value("insertText").toString();
+                if (text.isEmpty()) text = item.value("label").toString().trimmed();
+                if (!text.isEmpty() && !completions.contains(text)) {
+                    completions.append(text);
+                }
+                if (completions.size() >= kMaxCompletionItems) {
+                    break;
+                }
+            }
+            emit completionsReady(completions, line, character);
+        });
+}
+
+void LspClient::requestHover(int line, int character, const QPoint &globalPos)
+{
+    m_hoverLine = line;
+    m_hoverCharacter = character;
+    m_hoverPos = globalPos;
+    m_hoverTimer->start();
+}
+
+void LspClient::sendHover()
+{
+    if (!m_documentOpen || m_state != Ready) {
+        return;
+    }
+    flushChanges();
+    cancelRequest(m_hoverRequest);
+
+    const QJsonObject params{
+        {"textDocument", documentIdentifier()},
+        {"position", QJsonObject{{"line", m_hoverLine}, {"character", m_hoverCharacter}}}
+    };
+    const QPoint pos = m_hoverPos;
+    m_hoverRequest = sendRequest("textDocument/hover", params,
+        [this, pos](const QJsonValue &result, const QJsonObject &error) {
+            m_hoverRequest = 0;
+            if (!error.isEmpty() || !result.isObject()) {
+                return;
+            }
+            QString text = markupToText(result.toObject().value("contents")).trimmed();
+            text.remove(QStringLiteral("```cpp\n"));
+            text.remove(QStringLiteral("```"));
+            if (!text.isEmpty()) {
+                emit hoverReady(text.trimmed(), pos);
+            }
+        });
+}
+
+void LspClient::requestSemanticTokens()
+{
+    if (!m_documentOpen || m_state != Ready || m_tokenTypes.isEmpty()) {
+        return;
+    }
+    flushChanges();
+    cancelRequest(m_tokensRequest);
+
+    QString method = "textDocument/semanticTokens/full";
+    QJsonObject params{{"textDocument", documentIdentifier()}};
+    if (m_tokensDelta && !m_tokensResultId.isEmpty()) {
+        method = "textDocument/semanticTokens/full/delta";
+        params.insert("previousResultId", m_tokensResultId);
+    }
+
+    const int version = m_version;
+    m_tokensRequest = sendRequest(method, params,
+        [this, version](const QJsonValue &result, const QJsonObject &error) {
+            m_tokensRequest = 0;
+            if (!error.isEmpty()) {
+                // The server may have dropped our previous result; start over
+                m_tokensResultId.clear();
+                return;
+            }
+            handleSemanticTokens(result.toObject(), version);
+        });
+}
+
+void LspClient::handleSemanticTokens(const QJsonObject &result, int version)
+{
+    if (result.contains("edits")) {
+        // Apply delta edits back to front so earlier offsets stay valid
+        QVector<QJsonObject> edits;
+        for (const QJsonValue &edit : result.value("edits").toArray()) {
+            edits.append(edit.toObject());
+        }
+        std::sort(edits.begin(), edits.end(), [](const QJsonObject &a, const QJsonObject &b) {
+            return a.value("start").toInt() > b.value("start").toInt();
+        });
+        for (const QJsonObject &edit : qAsConst(edits)) {
+            const int start = qBound(0, edit.value("start").toInt(), int(m_tokensData.size()));
+            const int deleteCount = qBound(0, edit.value("deleteCount").toInt(), int(m_tokensData.size()) - start);
+            m_tokensData.remove(start, deleteCount);
+            const QJsonArray data = edit.value("data").toArray();
+            QVector<quint32> inserted;
+            inserted.reserve(data.size());
+            for (const QJsonValue &value : data) {
+                inserted.append(quint32(value.toInt()));
+            }
+            m_tokensData.insert(start, inserted.size(), 0);
+            std::copy(inserted.cbegin(), inserted.cend(), m_tokensData.begin() + start);
+        }
+    } else {
+        const QJsonArray data = result.value("data").toArray();
+        m_tokensData.clear();
+        m_tokensData.reserve(data.size());
+        for (const QJsonValue &value : data) {
+            m_tokensData.append(quint32(value.toInt()));
+        }
+    }
+    m_tokensResultId = result.value("resultId").toString();
+
+    // Positions in a result for an older version would land on the wrong text
+    if (version != m_version || !m_pendingChanges.isEmpty()) {
+        m_tokensTimer->start();
+        return;
+    }
+
+    QHash<int, QVector<SemanticToken>> tokensByLine;
+    int line = 0;
+    int start = 0;
+    for (int i = 0; i + 5 <= m_tokensData.size(); i += 5) {
+        const int deltaLine = int(m_tokensData[i]);
+        const int deltaStart = int(m_tokensData[i + 1]);
+        line += deltaLine;
+        start = deltaLine == 0 ? start + deltaStart : deltaStart;
+
+        const int typeIndex = int(m_tokensData[i + 3]);
+        const SemanticKind kind = typeIndex < m_tokenTypes.size()
+            ? semanticKindFor(m_tokenTypes[typeIndex])
+            : SemanticKind::Other;
+        if (kind != SemanticKind::Variable && kind != SemanticKind::Other) {
+            tokensByLine[line].append(SemanticToken{start, int(m_tokensData[i + 2]), kind});
+        }
+    }
+    emit semanticTokensReady(tokensByLine);
+}
+
+void LspClient::handleDiagnostics(const QJsonObject &params)
+{
+    const QString filePath = QUrl(params.value("uri").toString()).toLocalFile();
+    QVector<Diagnostic> diagnostics;
+
+    for (const QJsonValue &value : params.value("diagnostics").toArray()) {
+        const QJsonObject object = value.toObject();
+        const QJsonObject range = object.value("range").toObject();
+        const QJsonObject start = range.value("start").toObject();
+        const QJsonObject end = range.value("end").toObject();
+
+        Diagnostic diagnostic;
+        diagnostic.filePath = filePath;
+        diagnostic.line = start.value("line").toInt() + 1;
+        diagnostic.column = start.value("character").toInt() + 1;
+        diagnostic.endLine = end.value("line").toInt() + 1;
+        diagnostic.endColumn = end.value("character").toInt() + 1;
+        diagnostic.message = object.value("message").toString();
+        diagnostic.code = object.value("code").toVariant().toString();
+        switch (object.value("severity").toInt(1)) {
+        case 1: diagnostic.severity = Diagnostic::Error; break;
+        case 2: diagnostic.severity = Diagnostic::Warning; break;
+        default: diagnostic.severity = Diagnostic::Note; break;
+        }
+
+        // clangd's inline code actions carry the compiler's fix-its
+        for (const QJsonValue &action : object.value("codeActions").toArray()) {
+            const QJsonObject changes = action.toObject().value("edit").toObject().value("changes").toObject();
+            for (const QJsonValue &edit : changes.value(params.value("uri").toString()).toArray()) {
+                const QJsonObject editRange = edit.toObject().value("range").toObject();
+                DiagnosticFixIt fixIt;
+                fixIt.line = editRange.value("start").toObject().value("line").toInt() + 1;
+                fixIt.column = editRange.value("start").toObject().value("character").toInt() + 1;
+                fixIt.endLine = editRange.value("end").toObject().value("line").toInt() + 1;
+                fixIt.endColumn = editRange.value("end").toObject().value("character").toInt() + 1;
+                fixIt.replacement = edit.toObject().value("newText").toString();
+                diagnostic.fixIts.append(fixIt);
+            }
+        }
+        diagnostics.append(diagnostic);
+    }
+
+    emit diagnosticsPublished(filePath, diagnostics);
+}
+
+int LspClient::sendRequest(const QString &method, const QJsonObject &params, ResponseHandler handler)
+{
+    const int id = m_nextId++;
+    m_pending.insert(id, handler);
+    send(QJsonObject{{"jsonrpc", "2.0"}, {"id", id}, {"method", method}, {"params", params}});
+    return id;
+}
+
+void LspClient::sendNotification(const QString &method, const QJsonObject &params)
+{
+    send(QJsonObject{{"jsonrpc", "2.0"}, {"method", method}, {"params", params}});
+}
+
+void LspClient::cancelRequest(int &requestId)
+{
+    if (requestId == 0) {
+        return;
+    }
+    if (m_pending.remove(requestId) && m_state == Ready) {
+        sendNotification("$/cancelRequest", QJsonObject{{"id", requestId}});
+    }
+    requestId = 0;
+}
+
+void LspClient::send(const QJsonObject &message)
+{
+    if (m_process->state() != QProcess::Running) {
+        return;
+    }
+    const QByteArray body = QJsonDocument(message).toJson(QJsonDocument::Compact);
+    m_process->write("Content-Length: " + QByteArray::number(body.size()) + "\r\n\r\n");
+    m_process->write(body);
+}
+
+void LspClient::onReadyRead()
+{
+    m_readBuffer += m_process->readAllStandardOutput();
+
+    // Frames are "Content-Length: N\r\n...\r\n\r\n" followed by N bytes of JSON
+    while (true) {
+        const int headerEnd = m_readBuffer.indexOf("\r\n\r\n");
+        if (headerEnd < 0) {
+            return;
+        }
+
+        int contentLength = -1;
+        const QList<QByteArray> headers = m_readBuffer.left(headerEnd).split('\n');
+        for (const QByteArray &header : headers) {
+            if (header.toLower().startsWith("content-length:")) {
+                contentLength = header.mid(15).trimmed().toInt();
+            }
+        }
+        if (contentLength < 0) {
+            // Garbage before a header; drop it and resync
+            m_readBuffer.remove(0, headerEnd + 4);
+            continue;
+        }
+        if (m_readBuffer.size() < headerEnd + 4 + contentLength) {
+            return;
+        }
+
+        const QByteArray body = m_readBuffer.mid(headerEnd + 4, contentLength);
+        m_readBuffer.remove(0, headerEnd + 4 + contentLength);
+        const QJsonDocument document = QJsonDocument::fromJson(body);
+        if (document.isObject()) {
+            handleMessage(document.object());
+        }
+    }
+}
+
+void LspClient::handleMessage(const QJsonObject &message)
+{
+    const QString method = message.value("method").toString();
+    const bool hasId = message.contains("id");
+
+    if (method.isEmpty() && hasId) {
+        const int id = message.value("id").toInt();
+        const ResponseHandler handler = m_pending.take(id);
+        if (handler) {
+            handler(message.value("result"), message.value("error").toObject());
+        }
+        return;
+    }
+
+    if (method == "textDocument/publishDiagnostics") {
+        handleDiagnostics(message.value("params").toObject());
+    } else if (hasId) {
+        // Server-to-client requests (progress tokens, configuration...):
+        // acknowledge so the server does not wait on us
+        send(QJsonObject{{"jsonrpc", "2.0"}, {"id", message.value("id")}, {"result", QJsonValue()}});
+    }
+}
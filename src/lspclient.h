@@ -0,0 +1,115 @@
+#ifndef LSPCLIENT_H
+#define LSPCLIENT_H
+
+#include <QObject>
+#include <QProcess>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QJsonValue>
+#include <QHash>
+#include <QPointer>
+#include <QPoint>
+#include <QTimer>
+#include <QTextDocument>
+#include <functional>
+#include "diagnostic.h"
+#include "syntaxhighlighter.h"
+
+// Language Server Protocol client for a local clangd speaking JSON-RPC over
+// stdio. It mirrors one open QTextDocument and forwards each edit as an
+// incremental didChange range, batched over a short debounce window.
+class LspClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LspClient(QObject *parent = nullptr);
+    ~LspClient();
+
+    static QString findServer();
+
+    // False only when clangd isn't installed; a failed launch is reported
+    // through statusChanged
+    bool start(const QString &rootPath, const QStringList &fallbackFlags);
+    void stop();
+    bool isRunning() const { return m_state != Stopped; }
+    QString rootPath() const { return m_rootPath; }
+
+    void openDocument(const QString &filePath, QTextDocument *document);
+    void closeDocument();
+    QString documentPath() const { return m_filePath; }
+
+    void requestCompletion(int line, int character);
+    void requestHover(int line, int character, const QPoint &globalPos);
+
+signals:
+    void statusChanged(const QString &status);
+    void completionsReady(const QStringList &items, int line, int character);
+    void hoverReady(const QString &text, const QPoint &globalPos);
+    void diagnosticsPublished(const QString &filePath, const QVector<Diagnostic> &diagnostics);
+    void semanticTokensReady(const QHash<int, QVector<SemanticToken>> &tokensByLine);
+
+private slots:
+    void onReadyRead();
+    void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+    void flushChanges();
+    void sendHover();
+    void requestSemanticTokens();
+
+private:
+    using ResponseHandler = std::function<void(const QJsonValue &result, const QJsonObject &error)>;
+
+    enum State { Stopped, Initializing, Ready };
+
+    void initialize();
+
+    int sendRequest(const QString &method, const QJsonObject &params, ResponseHandler handler);
+    void sendNotification(const QString &method, const QJsonObject &params);
+    void cancelRequest(int &requestId);
+    void send(const QJsonObject &message);
+    void handleMessage(const QJsonObject &message);
+    void handleDiagnostics(const QJsonObject &params);
+    void handleSemanticTokens(const QJsonObject &result, int version);
+    void sendDidOpen();
+    void resyncDocument();
+    QJsonObject documentIdentifier() const;
+    QJsonObject positionAt(int offset) const;
+    QString documentText() const;
+
+    QProcess *m_process;
+    QByteArray m_readBuffer;
+    State m_state;
+    QString m_rootPath;
+    QStringList m_fallbackFlags;
+    int m_nextId;
+    QHash<int, ResponseHandler> m_pending;
+
+    // Open document, as the server currently sees it
+    QPointer<QTextDocument> m_document;
+    QString m_filePath;
+    QString m_uri;
+    QString m_shadow;
+    int m_version;
+    bool m_documentOpen;
+    QJsonArray m_pendingChanges;
+    QTimer *m_changeTimer;
+
+    // In-flight requests; a newer request of the same kind cancels the older
+    int m_completionRequest;
+    int m_hoverRequest;
+    int m_tokensRequest;
+
+    QTimer *m_hoverTimer;
+    int m_hoverLine;
+    int m_hoverCharacter;
+    QPoint m_hoverPos;
+
+    QTimer *m_tokensTimer;
+    QStringList m_tokenTypes;
+    bool m_tokensDelta;
+    QString m_tokensResultId;
+    QVector<quint32> m_tokensData;
+};
+
+#endif // LSPCLIENT_H
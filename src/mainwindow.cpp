@@ -12,6 +12,21 @@
 #include <QApplication>
 #include <QCloseEvent>
 #include <QTextStream>
+#include <QDir>
+#include <QToolTip>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QSpinBox>
+#include <QCheckBox>
+#include <QThread>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QSignalBlocker>
+#include <QActionGroup>
+#include <QTableWidget>
+#include <QHeaderView>
+#include "historydialog.h"
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -24,22 +39,113 @@ MainWindow::MainWindow(QWidget *parent)
     // Initialize services
     m_compilerService = new CompilerService(this);
     m_aiService = new AIService(this);
+    m_symbolIndex = new SymbolIndex(this);
+    m_lspClient = new LspClient(this);
+    m_syntaxChecker = new SyntaxChecker(this);
+    m_toolchainProbe = new ToolchainProbe(this);
+    m_assemblyGenerator = new AssemblyGenerator(this);
+    m_matrixDialog = nullptr;
+    m_watchMode = new WatchMode(m_compilerService, this);
 
     // Connect service signals
     connect(m_compilerService, &CompilerService::compilationFinished,
             this, &MainWindow::onCompilationFinished);
+    // In watch mode runs are shown as a diff against the previous one instead
+    // (WatchMode connected first, so it has already claimed or skipped the run)
+    connect(m_compilerService, &CompilerService::executionStarted, [this]() {
+        if (!m_watchMode->isWatchedRun()) {
+            m_aiChatPanel->appendOutput("Program output:", false);
+        }
+    });
+    connect(m_compilerService, &CompilerService::executionOutput,
+            [this](const QString &text, bool isError) {
+        if (!m_watchMode->isWatchedRun()) {
+            m_aiChatPanel->appendStreamOutput(text, isError);
+        }
+    });
     connect(m_compilerService, &CompilerService::executionFinished,
             this, &MainWindow::onExecutionFinished);
+    connect(m_watchMode, &WatchMode::watching, [this](int fileCount) {
+        m_statusLabel->setText(tr("Watching %1 files").arg(fileCount));
+    });
+    connect(m_watchMode, &WatchMode::triggered, [this](const QStringList &changedFiles) {
+        if (!changedFiles.isEmpty()) {
+            m_statusLabel->setText(tr("%1 changed, rebuilding...").arg(QFileInfo(changedFiles.first()).fileName()));
+        }
+    });
+    connect(m_watchMode, &WatchMode::runCompared, this, &MainWindow::showWatchRun);
     connect(m_aiService, &AIService::responseReceived,
             this, &MainWindow::onAIResponseReceived);
     connect(m_aiService, &AIService::suggestionsReceived,
             this, &MainWindow::onAISuggestionsReceived);
+    connect(m_compilerService, &CompilerService::benchmarkStarted, [this]() {
+        m_aiChatPanel->appendOutput("Benchmarking...", false);
+    });
+    connect(m_compilerService, &CompilerService::benchmarkProgress, [this](int done, int total) {
+        m_statusLabel->setText(tr("Benchmarking... %1/%2").arg(done).arg(total));
+    });
+    connect(m_compilerService, &CompilerService::benchmarkFinished, [this](const BenchmarkResult &result) {
+        m_statusLabel->setText(tr("Benchmark finished"));
+        m_aiChatPanel->appendOutput(result.report(), false);
+    });
+    connect(m_compilerService, &CompilerService::benchmarkFailed, [this](const QString &message) {
+        m_statusLabel->setText(tr("Benchmark failed"));
+        m_aiChatPanel->appendOutput(message, true);
+    });
+    connect(m_compilerService, &CompilerService::performanceCompared,
+            [this](const QString &message, bool regression) {
+        m_aiChatPanel->appendOutput(message, regression);
+    });
+    connect(m_compilerService, &CompilerService::compilationCancelled, [this]() {
+        m_statusLabel->setText(tr("Build cancelled"));
+        m_aiChatPanel->appendOutput("Build cancelled", true);
+    });
+    connect(m_compilerService, &CompilerService::buildStageChanged, [this](const QString &description) {
+        m_statusLabel->setText(description);
+    });
+    connect(m_compilerService, &CompilerService::buildProgress, [this](int done, int total) {
+        m_statusLabel->setText(tr("Building project... %1/%2").arg(done).arg(total));
+    });
+    connect(m_symbolIndex, &SymbolIndex::indexingProgress, [this](int done, int total) {
+        m_statusLabel->setText(tr("Indexing symbols... %1/%2").arg(done).arg(total));
+    });
+    connect(m_symbolIndex, &SymbolIndex::indexingFinished, [this](int fileCount, int reparsedCount) {
+        m_statusLabel->setText(tr("Indexed %1 files (%2 reparsed)").arg(fileCount).arg(reparsedCount));
+    });
 
     setupUI();
+
+    connect(m_lspClient, &LspClient::statusChanged, [this](const QString &status) {
+        m_statusLabel->setText(status);
+    });
+    connect(m_lspClient, &LspClient::diagnosticsPublished,
+            [this](const QString &filePath, const QVector<Diagnostic> &diagnostics) {
+        if (QFileInfo(filePath) == QFileInfo(m_currentFilePath)) {
+            m_codeEditor->setDiagnostics("clangd", diagnostics);
+        }
+    });
+    connect(m_lspClient, &LspClient::semanticTokensReady, m_codeEditor, &CodeEditor::setSemanticTokens);
+    connect(m_syntaxChecker, &SyntaxChecker::checked,
+            [this](const QString &filePath, const QVector<Diagnostic> &diagnostics) {
+        if (filePath == m_currentFilePath) {
+            m_codeEditor->setDiagnostics("syntax", diagnostics);
+        }
+    });
+    connect(m_lspClient, &LspClient::completionsReady, m_codeEditor, &CodeEditor::showCompletions);
+    connect(m_lspClient, &LspClient::hoverReady, [this](const QString &text, const QPoint &pos) {
+        QToolTip::showText(pos, text, m_codeEditor);
+    });
+    connect(m_codeEditor, &CodeEditor::completionRequested, m_lspClient, &LspClient::requestCompletion);
+    connect(m_codeEditor, &CodeEditor::hoverRequested, m_lspClient, &LspClient::requestHover);
+
     createMenus();
     createToolBar();
     createStatusBar();
     loadSettings();
+
+    // The selector starts from the cached probe; a fresh scan refills it
+    connect(m_toolchainProbe, &ToolchainProbe::finished, this, &MainWindow::populateCompilerSelector);
+    m_toolchainProbe->start();
 }
 
 MainWindow::~MainWindow()
@@ -58,9 +164,13 @@ void MainWindow::setupUI()
     connect(m_codeEditor, &QPlainTextEdit::textChanged, [this]() {
         m_isModified = true;
         updateStatusBar();
+        scheduleSyntaxCheck();
+        scheduleAssembly();
     });
     connect(m_codeEditor, &QPlainTextEdit::cursorPositionChanged,
             this, &MainWindow::updateStatusBar);
+    connect(m_codeEditor, &CodeEditor::definitionRequested,
+            this, &MainWindow::goToDefinition);
 
     // AI Chat Panel
     m_aiChatPanel = new AIChatPanel(this);
@@ -81,6 +191,239 @@ void MainWindow::setupUI()
     m_mainSplitter->setSizes({700, 500});
 
     setCentralWidget(m_mainSplitter);
+
+    // Find in Files dock
+    m_fileSearchPanel = new FileSearchPanel(this);
+    connect(m_fileSearchPanel, &FileSearchPanel::matchActivated,
+            this, &MainWindow::openLocation);
+
+    m_searchDock = new QDockWidget(tr("Find in Files"), this);
+    m_searchDock->setObjectName("searchDock");
+    m_searchDock->setWidget(m_fileSearchPanel);
+    addDockWidget(Qt::BottomDockWidgetArea, m_searchDock);
+    m_searchDock->hide();
+
+    // Problems dock, fed by the compiler's diagnostics as they stream in
+    m_problemsPanel = new ProblemsPanel(this);
+    connect(m_problemsPanel, &ProblemsPanel::problemActivated,
+            this, &MainWindow::openLocation);
+
+    m_problemsDock = new QDockWidget(tr("Problems"), this);
+    m_problemsDock->setObjectName("problemsDock");
+    m_problemsDock->setWidget(m_problemsPanel);
+    addDockWidget(Qt::BottomDockWidgetArea, m_problemsDock);
+    tabifyDockWidget(m_searchDock, m_problemsDock);
+    m_problemsDock->hide();
+
+    // CPU profile hotspots, filled by Build > Profile
+    m_hotspotPanel = new HotspotPanel(this);
+    connect(m_hotspotPanel, &HotspotPanel::hotspotActivated, [this](const QString &filePath, int line) {
+        openLocation(filePath, line);
+    });
+
+    m_hotspotDock = new QDockWidget(tr("Hotspots"), this);
+    m_hotspotDock->setObjectName("hotspotDock");
+    m_hotspotDock->setWidget(m_hotspotPanel);
+    addDockWidget(Qt::BottomDockWidgetArea, m_hotspotDock);
+    tabifyDockWidget(m_problemsDock, m_hotspotDock);
+    m_hotspotDock->hide();
+
+    connect(m_compilerService, &CompilerService::profileStarted, [this]() {
+        m_statusLabel->setText(tr("Profiling..."));
+        m_aiChatPanel->appendOutput("Program output (under perf record):", false);
+    });
+    connect(m_compilerService, &CompilerService::profileAnalyzing, [this]() {
+        m_statusLabel->setText(tr("Analyzing profile..."));
+    });
+    connect(m_compilerService, &CompilerService::profileFinished, [this](const ProfileResult &result) {
+        m_statusLabel->setText(tr("Profile finished: %1 samples").arg(result.totalSamples));
+        m_hotspotPanel->setResult(result);
+        m_hotspotDock->show();
+        m_hotspotDock->raise();
+        m_gutterAnnotations = CpuProfileAnnotations;
+        showProfileAnnotations();
+    });
+    connect(m_compilerService, &CompilerService::profileFailed, [this](const QString &message) {
+        m_statusLabel->setText(tr("Profile failed"));
+        m_aiChatPanel->appendOutput(message, true);
+    });
+
+    // Heap profile, filled by Build > Profile Memory
+    m_heapPanel = new HeapPanel(this);
+    connect(m_heapPanel, &HeapPanel::siteActivated, [this](const QString &filePath, int line) {
+        openLocation(filePath, line);
+    });
+
+    m_heapDock = new QDockWidget(tr("Heap"), this);
+    m_heapDock->setObjectName("heapDock");
+    m_heapDock->setWidget(m_heapPanel);
+    addDockWidget(Qt::BottomDockWidgetArea, m_heapDock);
+    tabifyDockWidget(m_hotspotDock, m_heapDock);
+    m_heapDock->hide();
+    m_gutterAnnotations = CpuProfileAnnotations;
+
+    connect(m_compilerService, &CompilerService::memoryProfileStarted, [this]() {
+        m_statusLabel->setText(tr("Profiling memory..."));
+        m_aiChatPanel->appendOutput("Program output (allocations tracked):", false);
+    });
+    connect(m_compilerService, &CompilerService::memoryProfileAnalyzing, [this]() {
+        m_statusLabel->setText(tr("Resolving allocation sites..."));
+    });
+    connect(m_compilerService, &CompilerService::memoryProfileFinished, [this](const HeapProfile &profile) {
+        m_statusLabel->setText(tr("Memory profile finished: %1 allocations, peak heap %2")
+                                   .arg(HeapPanel::formatCount(profile.allocations),
+                                        HeapPanel::formatBytes(profile.peakBytes)));
+        m_heapPanel->setProfile(profile);
+        m_heapDock->show();
+        m_heapDock->raise();
+        m_gutterAnnotations = HeapProfileAnnotations;
+        showProfileAnnotations();
+    });
+    connect(m_compilerService, &CompilerService::memoryProfileFailed, [this](const QString &message) {
+        m_statusLabel->setText(tr("Memory profile failed"));
+        m_aiChatPanel->appendOutput(message, true);
+    });
+
+    // Compile-time profile, filled by Build > Why Is This Slow to Compile?
+    m_buildTimePanel = new BuildTimePanel(this);
+    connect(m_buildTimePanel, &BuildTimePanel::headerActivated, [this](const QString &filePath) {
+        openLocation(filePath, 1);
+    });
+
+    m_buildTimeDock = new QDockWidget(tr("Build Time"), this);
+    m_buildTimeDock->setObjectName("buildTimeDock");
+    m_buildTimeDock->setWidget(m_buildTimePanel);
+    addDockWidget(Qt::BottomDockWidgetArea, m_buildTimeDock);
+    tabifyDockWidget(m_heapDock, m_buildTimeDock);
+    m_buildTimeDock->hide();
+
+    connect(m_compilerService, &CompilerService::buildTimeProfileStarted, [this]() {
+        m_statusLabel->setText(tr("Profiling compile..."));
+    });
+    connect(m_compilerService, &CompilerService::buildTimeProfileAnalyzing, [this]() {
+        m_statusLabel->setText(tr("Analyzing compile trace..."));
+    });
+    connect(m_compilerService, &CompilerService::buildTimeProfileFinished, [this](const BuildTimeProfile &profile) {
+        m_statusLabel->setText(tr("Compile took %1").arg(SampleStats::formatUs(profile.totalUs)));
+        m_buildTimePanel->setProfile(profile);
+        m_buildTimeDock->show();
+        m_buildTimeDock->raise();
+        m_gutterAnnotations = BuildTimeAnnotations;
+        showProfileAnnotations();
+    });
+    connect(m_compilerService, &CompilerService::buildTimeProfileFailed, [this](const QString &message) {
+        m_statusLabel->setText(tr("Compile-time profile failed"));
+        m_aiChatPanel->appendOutput(message, true);
+    });
+
+    // Unit test results, filled by Build > Run Tests
+    m_testPanel = new TestPanel(this);
+    connect(m_testPanel, &TestPanel::locationActivated, [this](const QString &filePath, int line) {
+        openLocation(filePath, line);
+    });
+    connect(m_testPanel, &TestPanel::runAllRequested, [this]() { runTests(); });
+    connect(m_testPanel, &TestPanel::runFailedRequested, this, &MainWindow::runTests);
+    connect(m_testPanel, &TestPanel::stopRequested, m_compilerService, &CompilerService::stopTests);
+
+    m_testDock = new QDockWidget(tr("Tests"), this);
+    m_testDock->setObjectName("testDock");
+    m_testDock->setWidget(m_testPanel);
+    addDockWidget(Qt::BottomDockWidgetArea, m_testDock);
+    tabifyDockWidget(m_buildTimeDock, m_testDock);
+    m_testDock->hide();
+
+    connect(m_compilerService, &CompilerService::testsStarted, [this]() {
+        m_statusLabel->setText(tr("Listing tests..."));
+        m_testPanel->setRunning(true);
+        m_testDock->show();
+        m_testDock->raise();
+    });
+    connect(m_compilerService, &CompilerService::testsDiscovered, m_testPanel, &TestPanel::setTests);
+    connect(m_compilerService, &CompilerService::testChanged, m_testPanel, &TestPanel::updateTest);
+    connect(m_compilerService, &CompilerService::testProgress, [this](int done, int total) {
+        m_statusLabel->setText(tr("Running tests... %1/%2").arg(done).arg(total));
+    });
+    connect(m_compilerService, &CompilerService::testsFinished, [this](int passed, int failed) {
+        m_statusLabel->setText(failed > 0 ? tr("Tests finished: %1 failed, %2 passed").arg(failed).arg(passed)
+                                          : tr("Tests finished: all %1 passed").arg(passed));
+        m_testPanel->setRunning(false);
+    });
+    connect(m_compilerService, &CompilerService::testsFailed, [this](const QString &message) {
+        m_statusLabel->setText(tr("Test run failed"));
+        m_testPanel->setRunning(false);
+        m_testPanel->showMessage(message);
+        m_testDock->show();
+    });
+
+    // Assembly of the buffer, kept next to the editor like Compiler Explorer
+    m_assemblyPanel = new AssemblyPanel(this);
+    connect(m_assemblyPanel, &AssemblyPanel::sourceLineHovered, [this](int line) {
+        m_codeEditor->setLinkedLines(line > 0 ? QSet<int>{line} : QSet<int>());
+    });
+    connect(m_assemblyPanel, &AssemblyPanel::sourceLineActivated, [this](int line) {
+        m_codeEditor->goToLine(line);
+    });
+    connect(m_codeEditor, &CodeEditor::lineHovered, m_assemblyPanel, &AssemblyPanel::highlightSourceLine);
+
+    m_assemblyDock = new QDockWidget(tr("Assembly"), this);
+    m_assemblyDock->setObjectName("assemblyDock");
+    m_assemblyDock->setWidget(m_assemblyPanel);
+    addDockWidget(Qt::RightDockWidgetArea, m_assemblyDock);
+    m_assemblyDock->hide();
+    connect(m_assemblyDock, &QDockWidget::visibilityChanged, [this](bool visible) {
+        if (visible) {
+            scheduleAssembly();
+        } else {
+            m_assemblyGenerator->cancel();
+            m_codeEditor->setLinkedLines(QSet<int>());
+        }
+    });
+
+    connect(m_assemblyGenerator, &AssemblyGenerator::started, m_assemblyPanel, &AssemblyPanel::setBusy);
+    connect(m_assemblyGenerator, &AssemblyGenerator::finished,
+            [this](const QString &filePath, const AssemblyListing &listing) {
+        if (filePath == m_currentFilePath) {
+            m_assemblyPanel->setListing(listing);
+        }
+    });
+    connect(m_assemblyGenerator, &AssemblyGenerator::failed, [this](const QString &filePath, const QString &output) {
+        if (filePath == m_currentFilePath) {
+            m_assemblyPanel->showError(output);
+        }
+    });
+
+    // Editor markers are rebuilt at most every 100 ms during a flood
+    m_diagnosticsTimer = new QTimer(this);
+    m_diagnosticsTimer->setSingleShot(true);
+    m_diagnosticsTimer->setInterval(100);
+    connect(m_diagnosticsTimer, &QTimer::timeout, this, &MainWindow::showBuildDiagnostics);
+
+    connect(m_compilerService, &CompilerService::compilationStarted, [this]() {
+        m_problemsPanel->setRootPath(workspaceRoot());
+        m_problemsPanel->clear();
+        m_codeEditor->setDiagnostics("build", QVector<Diagnostic>());
+        // The build reports the same errors; the next edit brings these back
+        m_syntaxChecker->cancel();
+        m_codeEditor->setDiagnostics("syntax", QVector<Diagnostic>());
+    });
+    connect(m_compilerService, &CompilerService::diagnosticsFound,
+            [this](const QVector<Diagnostic> &diagnostics) {
+        m_problemsPanel->appendDiagnostics(diagnostics);
+        if (!m_diagnosticsTimer->isActive()) {
+            m_diagnosticsTimer->start();
+        }
+    });
+
+    // Quick open popup
+    m_quickOpenDialog = new QuickOpenDialog(this);
+    connect(m_quickOpenDialog, &QuickOpenDialog::fileSelected, [this](const QString &filePath) {
+        openLocation(filePath, 1);
+    });
+
+    // Workspace symbol popup, anchored to the editor
+    m_symbolSearchDialog = new SymbolSearchDialog(m_symbolIndex, m_codeEditor);
+    connect(m_symbolSearchDialog, &SymbolSearchDialog::symbolSelected,
+            this, &MainWindow::openLocation);
 }
 
 void MainWindow::createMenus()
@@ -94,6 +437,12 @@ void MainWindow::createMenus()
     QAction *openAction = fileMenu->addAction(tr("&Open..."), this, &MainWindow::openFile);
     openAction->setShortcut(QKeySequence::Open);
 
+    QAction *quickOpenAction = fileMenu->addAction(tr("&Quick Open..."), this, &MainWindow::quickOpen);
+    quickOpenAction->setShortcut(QKeySequence(Qt::CTRL | Qt::Key_P));
+
+    QAction *openFolderAction = fileMenu->addAction(tr("Open &Folder..."), this, &MainWindow::openFolder);
+    openFolderAction->setShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_O));
+
     QAction *saveAction = fileMenu->addAction(tr("&Save"), this, &MainWindow::saveFile);
     saveAction->setShortcut(QKeySequence::Save);
 
@@ -105,6 +454,19 @@ void MainWindow::createMenus()
     QAction *exitAction = fileMenu->addAction(tr("E&xit"), this, &QMainWindow::close);
     exitAction->setShortcut(QKeySequence::Quit);
 
+    // Search Menu
+    QMenu *searchMenu = menuBar()->addMenu(tr("&Search"));
+
+    QAction *findInFilesAction = searchMenu->addAction(tr("Find in &Files..."), this, &MainWindow::findInFiles);
+    findInFilesAction->setShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_F));
+
+    QAction *goToSymbolAction = searchMenu->addAction(tr("Go to &Symbol..."), this, &MainWindow::goToSymbol);
+    goToSymbolAction->setShortcut(QKeySequence(Qt::CTRL | Qt::Key_T));
+
+    searchMenu->addAction(tr("Go to &Definition"), [this]() {
+        goToDefinition(m_codeEditor->symbolUnderCursor(m_codeEditor->textCursor()));
+    })->setShortcut(QKeySequence(Qt::Key_F12));
+
     // Build Menu
     QMenu *buildMenu = menuBar()->addMenu(tr("&Build"));
 
@@ -117,6 +479,89 @@ void MainWindow::createMenus()
     QAction *compileRunAction = buildMenu->addAction(tr("Compile && Run"), this, &MainWindow::compileAndRun);
     compileRunAction->setShortcut(QKeySequence(Qt::Key_F5));
 
+    QAction *benchmarkAction = buildMenu->addAction(tr("Bench&mark"), this, &MainWindow::benchmarkCode);
+    benchmarkAction->setShortcut(QKeySequence(Qt::CTRL | Qt::ALT | Qt::Key_B));
+
+    QAction *profileAction = buildMenu->addAction(tr("Pro&file"), this, &MainWindow::profileCode);
+    profileAction->setShortcut(QKeySequence(Qt::CTRL | Qt::ALT | Qt::Key_P));
+
+    QAction *profileMemoryAction = buildMenu->addAction(tr("Profile &Memory"), this, &MainWindow::profileMemory);
+    profileMemoryAction->setShortcut(QKeySequence(Qt::CTRL | Qt::ALT | Qt::Key_M));
+
+    QAction *buildTimeAction = buildMenu->addAction(tr("&Why Is This Slow to Compile?"), this, &MainWindow::profileBuildTime);
+    buildTimeAction->setShortcut(QKeySequence(Qt::CTRL | Qt::ALT | Qt::Key_C));
+
+    buildMenu->addAction(tr("Run &Tests"), [this]() {
+        runTests();
+    })->setShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_T));
+    buildMenu->addAction(tr("Compare &Compilers..."), this, &MainWindow::compareCompilers);
+
+    QAction *buildProjectAction = buildMenu->addAction(tr("Build &Project"), this, &MainWindow::buildProject);
+    buildProjectAction->setShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_B));
+
+    QAction *buildRunProjectAction = buildMenu->addAction(tr("Build && Run Project"), this, &MainWindow::buildAndRunProject);
+    buildRunProjectAction->setShortcut(QKeySequence(Qt::CTRL | Qt::Key_F5));
+
+    QAction *stopAction = buildMenu->addAction(tr("S&top"), [this]() {
+        m_compilerService->scheduler()->cancelAll();
+    });
+    stopAction->setShortcut(QKeySequence(Qt::SHIFT | Qt::Key_F5));
+
+    QAction *watchAction = buildMenu->addAction(tr("&Watch && Run"));
+    watchAction->setCheckable(true);
+    watchAction->setShortcut(QKeySequence(Qt::CTRL | Qt::ALT | Qt::Key_W));
+    connect(watchAction, &QAction::toggled, [this, watchAction](bool checked) {
+        setWatchMode(checked);
+        if (checked && !m_watchMode->isActive()) {
+            watchAction->setChecked(false);     // nothing saved to watch
+        }
+    });
+
+    buildMenu->addSeparator();
+
+    QAction *cacheAction = buildMenu->addAction(tr("Use Compile &Cache"));
+    cacheAction->setCheckable(true);
+    cacheAction->setChecked(m_compilerService->isCacheEnabled());
+    connect(cacheAction, &QAction::toggled, [this](bool checked) {
+        m_compilerService->setCacheEnabled(checked);
+    });
+
+    QAction *syntaxAction = buildMenu->addAction(tr("Check Syntax While &Typing"));
+    syntaxAction->setCheckable(true);
+    syntaxAction->setChecked(m_syntaxChecker->isEnabled());
+    connect(syntaxAction, &QAction::toggled, m_syntaxChecker, &SyntaxChecker::setEnabled);
+
+    QAction *pchAction = buildMenu->addAction(tr("Use &Precompiled Headers"));
+    pchAction->setCheckable(true);
+    pchAction->setChecked(m_compilerService->isPchEnabled());
+    connect(pchAction, &QAction::toggled, [this](bool checked) {
+        m_compilerService->setPchEnabled(checked);
+    });
+
+    buildMenu->addAction(tr("Clear Compile Cache"), [this]() {
+        m_compilerService->clearCache();
+        m_statusLabel->setText(tr("Compile cache cleared"));
+    });
+
+    QMenu *standardMenu = buildMenu->addMenu(tr("Language &Standard"));
+    QActionGroup *standardGroup = new QActionGroup(standardMenu);
+    for (const QString &standard : {QString("c++17"), QString("c++20"), QString("c++23")}) {
+        QAction *action = standardMenu->addAction(standard.toUpper());
+        action->setCheckable(true);
+        action->setChecked(m_compilerService->languageStandard() == standard);
+        standardGroup->addAction(action);
+        connect(action, &QAction::triggered, [this, standard]() {
+            m_compilerService->setLanguageStandard(standard);
+            m_statusLabel->setText(tr("Language standard: %1").arg(standard));
+        });
+    }
+
+    buildMenu->addSeparator();
+    buildMenu->addAction(tr("Execution &Limits..."), this, &MainWindow::editExecutionLimits);
+    buildMenu->addAction(tr("Benchmark &Settings..."), this, &MainWindow::editBenchmarkOptions);
+    buildMenu->addAction(tr("PGO &Training Input..."), this, &MainWindow::editPgoTrainingInput);
+    buildMenu->addAction(tr("&Toolchains..."), this, &MainWindow::showToolchains);
+
     // View Menu
     QMenu *viewMenu = menuBar()->addMenu(tr("&View"));
 
@@ -128,6 +573,27 @@ void MainWindow::createMenus()
         m_aiChatPanel->setVisible(checked);
     });
 
+    QAction *toggleProblems = m_problemsDock->toggleViewAction();
+    toggleProblems->setShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_M));
+    viewMenu->addAction(toggleProblems);
+    viewMenu->addAction(m_hotspotDock->toggleViewAction());
+    viewMenu->addAction(m_heapDock->toggleViewAction());
+    viewMenu->addAction(m_buildTimeDock->toggleViewAction());
+    viewMenu->addAction(m_testDock->toggleViewAction());
+    QAction *toggleAssembly = m_assemblyDock->toggleViewAction();
+    toggleAssembly->setShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_A));
+    viewMenu->addAction(toggleAssembly);
+
+    viewMenu->addAction(tr("Performance &History..."), [this]() {
+        const QString program = m_compilerService->executablePath();
+        if (program.isEmpty()) {
+            m_statusLabel->setText(tr("Run or benchmark a program to see its history"));
+            return;
+        }
+        HistoryDialog dialog(program, m_compilerService->runHistory(program), this);
+        dialog.exec();
+    });
+
     // Help Menu
     QMenu *helpMenu = menuBar()->addMenu(tr("&Help"));
 
@@ -161,21 +627,35 @@ void MainWindow::createToolBar()
     mainToolBar->addWidget(compilerLabel);
 
     m_compilerSelector = new QComboBox(this);
-    m_compilerSelector->addItem("GCC (g++)", "g++");
-    m_compilerSelector->addItem("Clang (clang++)", "clang++");
-    m_compilerSelector->addItem("MSVC (cl)", "cl");
-    m_compilerSelector->addItem("MinGW (mingw-g++)", "mingw-g++");
     m_compilerSelector->setMinimumWidth(150);
+    m_compilerSelector->setSizeAdjustPolicy(QComboBox::AdjustToContents);
+    populateCompilerSelector(ToolchainProbe::cached());
     connect(m_compilerSelector, QOverload<int>::of(&QComboBox::currentIndexChanged), [this](int index) {
         QString compiler = m_compilerSelector->currentData().toString();
         m_compilerService->setCompiler(compiler);
+        scheduleAssembly();
     });
     mainToolBar->addWidget(m_compilerSelector);
 
+    mainToolBar->addWidget(new QLabel(tr(" Profile: "), this));
+    m_profileSelector = new QComboBox(this);
+    for (BuildProfile profile : BuildProfiles::all()) {
+        m_profileSelector->addItem(BuildProfiles::name(profile), BuildProfiles::name(profile));
+    }
+    m_profileSelector->setToolTip(tr("Build profile of the open folder, or of the current file when no folder is open"));
+    connect(m_profileSelector, QOverload<int>::of(&QComboBox::currentIndexChanged), [this](int) {
+        BuildProfiles::setProfileFor(buildProfileScope(),
+                                     BuildProfiles::fromName(m_profileSelector->currentData().toString()));
+        scheduleAssembly();
+    });
+    mainToolBar->addWidget(m_profileSelector);
+
     mainToolBar->addSeparator();
     mainToolBar->addAction(tr("Compile"), this, &MainWindow::compileCode);
     mainToolBar->addAction(tr("Run"), this, &MainWindow::runCode);
     mainToolBar->addAction(tr("▶ Build & Run"), this, &MainWindow::compileAndRun);
+    mainToolBar->addAction(tr("Benchmark"), this, &MainWindow::benchmarkCode);
+    mainToolBar->addAction(tr("Profile"), this, &MainWindow::profileCode);
 }
 
 void MainWindow::createStatusBar()
@@ -185,6 +665,41 @@ void MainWindow::createStatusBar()
 
     statusBar()->addWidget(m_statusLabel, 1);
     statusBar()->addPermanentWidget(m_cursorPositionLabel);
+
+    m_jobsLabel = new QLabel(this);
+    m_jobsLabel->setStyleSheet("color: #888;");
+    statusBar()->addPermanentWidget(m_jobsLabel);
+    JobScheduler *scheduler = m_compilerService->scheduler();
+    connect(scheduler, &JobScheduler::activeJobsChanged, this, &MainWindow::updateJobsLabel);
+    connect(scheduler, &JobScheduler::jobStarted, this, &MainWindow::updateJobsLabel);
+    connect(scheduler, &JobScheduler::jobProgress, this, &MainWindow::updateJobsLabel);
+    updateJobsLabel();
+}
+
+void MainWindow::updateJobsLabel()
+{
+    const QVector<JobScheduler::JobInfo> jobs = m_compilerService->scheduler()->activeJobs();
+    int queued = 0;
+    QStringList lines;
+    for (const JobScheduler::JobInfo &job : jobs) {
+        QString line = job.description;
+        if (job.state == JobScheduler::Queued) {
+            ++queued;
+            line += tr(" (queued)");
+        } else if (job.total > 0) {
+            line += QString(" (%1/%2)").arg(job.done).arg(job.total);
+        }
+        lines << line;
+    }
+
+    if (jobs.isEmpty()) {
+        m_jobsLabel->clear();
+    } else if (queued > 0) {
+        m_jobsLabel->setText(tr("%1 running, %2 queued").arg(jobs.size() - queued).arg(queued));
+    } else {
+        m_jobsLabel->setText(tr("%n job(s) running", "", jobs.size()));
+    }
+    m_jobsLabel->setToolTip(lines.isEmpty() ? QString() : lines.join('\n') + tr("\n\nShift+F5 stops all"));
 }
 
 void MainWindow::updateStatusBar()
@@ -205,21 +720,34 @@ void MainWindow::updateStatusBar()
     m_cursorPositionLabel->setText(tr("Line: %1, Col: %2").arg(line).arg(col));
 }
 
+bool MainWindow::maybeSave()
+{
+    if (!m_isModified) {
+        return true;
+    }
+
+    QMessageBox::StandardButton reply = QMessageBox::question(this,
+        tr("Save Changes?"),
+        tr("The document has been modified. Do you want to save changes?"),
+        QMessageBox::Save | QMessageBox::Discard | QMessageBox::Cancel);
+
+    if (reply == QMessageBox::Save) {
+        saveFile();
+    } else if (reply == QMessageBox::Cancel) {
+        return false;
+    }
+    return true;
+}
+
 void MainWindow::newFile()
 {
-    if (m_isModified) {
-        QMessageBox::StandardButton reply = QMessageBox::question(this,
-            tr("Save Changes?"),
-            tr("The document has been modified. Do you want to save changes?"),
-            QMessageBox::Save | QMessageBox::Discard | QMessageBox::Cancel);
-
-        if (reply == QMessageBox::Save) {
-            saveFile();
-        } else if (reply == QMessageBox::Cancel) {
-            return;
-        }
+    if (!maybeSave()) {
+        return;
     }
 
+    m_lspClient->closeDocument();
+    m_codeEditor->clearDiagnostics();
+    m_codeEditor->setSemanticTokens({});
     m_codeEditor->clear();
     m_currentFilePath.clear();
     m_isModified = false;
@@ -230,20 +758,30 @@ void MainWindow::openFile()
 {
     QString filePath = QFileDialog::getOpenFileName(this,
         tr("Open File"),
-        QString(),
+        workspaceRoot(),
         tr("C/C++ Files (*.c *.cpp *.cc *.cxx *.h *.hpp);;All Files (*)"));
 
     if (filePath.isEmpty()) {
         return;
     }
 
+    loadFile(filePath);
+}
+
+bool MainWindow::loadFile(const QString &filePath)
+{
     QFile file(filePath);
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
         QMessageBox::warning(this, tr("Error"),
             tr("Cannot open file: %1").arg(file.errorString()));
-        return;
+        return false;
     }
 
+    // Detach first so the server never sees the swap as an edit of the old file
+    m_lspClient->closeDocument();
+    m_codeEditor->clearDiagnostics();
+    m_codeEditor->setSemanticTokens({});
+
     QTextStream in(&file);
     m_codeEditor->setPlainText(in.readAll());
     file.close();
@@ -251,8 +789,172 @@ void MainWindow::openFile()
     m_currentFilePath = filePath;
     m_isModified = false;
     updateStatusBar();
+    showBuildDiagnostics();
+    showProfileAnnotations();
+    syncLanguageServer();
+    syncBuildProfile();
+    // setPlainText() scheduled a check under the previous file's path
+    scheduleSyntaxCheck();
+    scheduleAssembly();
 
     m_statusLabel->setText(tr("Opened: %1").arg(filePath));
+    return true;
+}
+
+void MainWindow::openLocation(const QString &filePath, int line, int column)
+{
+    if (QFileInfo(filePath) != QFileInfo(m_currentFilePath)) {
+        if (!maybeSave() || !loadFile(filePath)) {
+            return;
+        }
+    }
+    m_codeEditor->goToLine(line, column);
+}
+
+void MainWindow::openFolder()
+{
+    QString dirPath = QFileDialog::getExistingDirectory(this,
+        tr("Open Folder"), workspaceRoot());
+
+    if (dirPath.isEmpty()) {
+        return;
+    }
+
+    m_workspaceRoot = dirPath;
+    m_fileSearchPanel->setRootPath(dirPath);
+    ensureSymbolIndex();
+    syncBuildProfile();
+    m_statusLabel->setText(tr("Workspace: %1").arg(dirPath));
+}
+
+void MainWindow::quickOpen()
+{
+    m_quickOpenDialog->setRootPath(workspaceRoot());
+    m_quickOpenDialog->popup();
+}
+
+void MainWindow::ensureSymbolIndex()
+{
+    if (m_symbolIndex->rootPath() != workspaceRoot()) {
+        m_symbolIndex->setRootPath(workspaceRoot());
+    }
+}
+
+void MainWindow::syncLanguageServer()
+{
+    if (m_currentFilePath.isEmpty() || LspClient::findServer().isEmpty()) {
+        return;
+    }
+    if (m_lspClient->documentPath() == m_currentFilePath && m_lspClient->isRunning()) {
+        return;
+    }
+
+    // MSVC flags mean nothing to clangd; fall back to its defaults
+    QStringList fallbackFlags;
+    if (!m_compilerService->isMsvc()) {
+        fallbackFlags = m_compilerService->getCompilerFlags();
+    }
+    if (m_lspClient->start(workspaceRoot(), fallbackFlags)) {
+        m_lspClient->openDocument(m_currentFilePath, m_codeEditor->document());
+    }
+}
+
+void MainWindow::scheduleSyntaxCheck()
+{
+    // clangd already reports as-you-type diagnostics for the documents it serves
+    if (m_lspClient->isRunning() && m_lspClient->documentPath() == m_currentFilePath) {
+        return;
+    }
+    m_syntaxChecker->setCompiler(m_compilerService->getCompilerCommand(), m_compilerService->getCompilerFlags());
+    m_syntaxChecker->schedule(m_currentFilePath, m_codeEditor->document());
+}
+
+void MainWindow::scheduleAssembly()
+{
+    // Compiling on every pause only pays off while someone is looking
+    if (!m_assemblyDock->isVisible()) {
+        return;
+    }
+    if (m_compilerService->isMsvc()) {
+        m_assemblyPanel->showMessage(tr("The assembly view needs GCC or Clang"));
+        return;
+    }
+    const BuildProfile profile = BuildProfiles::profileFor(m_currentFilePath);
+    m_assemblyGenerator->setCompiler(m_compilerService->getCompilerCommand(),
+                                     m_compilerService->getCompilerFlags(profile));
+    m_assemblyGenerator->schedule(m_currentFilePath, m_codeEditor->document());
+}
+
+QString MainWindow::buildProfileScope() const
+{
+    return m_workspaceRoot.isEmpty() ? m_currentFilePath : m_workspaceRoot;
+}
+
+void MainWindow::syncBuildProfile()
+{
+    const QString scope = buildProfileScope();
+    const BuildProfile profile = BuildProfiles::profileFor(scope);
+    QSignalBlocker blocker(m_profileSelector);
+    m_profileSelector->setCurrentIndex(m_profileSelector->findData(BuildProfiles::name(profile)));
+    m_profileSelector->setEnabled(!scope.isEmpty());
+}
+
+void MainWindow::goToSymbol()
+{
+    ensureSymbolIndex();
+    m_symbolSearchDialog->popup(m_codeEditor->textCursor().selectedText());
+}
+
+void MainWindow::goToDefinition(const QString &symbol)
+{
+    if (symbol.isEmpty()) {
+        return;
+    }
+    ensureSymbolIndex();
+
+    const QVector<SymbolInfo> definitions = m_symbolIndex->findDefinitions(symbol);
+    if (definitions.isEmpty()) {
+        m_statusLabel->setText(m_symbolIndex->isIndexing()
+            ? tr("No definition of '%1' yet (indexing...)").arg(symbol)
+            : tr("No definition of '%1' found").arg(symbol));
+        return;
+    }
+    if (definitions.size() == 1) {
+        openLocation(definitions.first().filePath, definitions.first().line, definitions.first().column);
+        return;
+    }
+
+    // Several candidates: let the user pick at the cursor
+    QMenu menu(this);
+    const QDir root(workspaceRoot());
+    for (const SymbolInfo &definition : definitions) {
+        QAction *action = menu.addAction(QString("%1  —  %2:%3")
+            .arg(definition.name, root.relativeFilePath(definition.filePath))
+            .arg(definition.line));
+        connect(action, &QAction::triggered, [this, definition]() {
+            openLocation(definition.filePath, definition.line, definition.column);
+        });
+    }
+    menu.exec(m_codeEditor->viewport()->mapToGlobal(m_codeEditor->cursorRect().bottomLeft()));
+}
+
+QString MainWindow::workspaceRoot() const
+{
+    if (!m_workspaceRoot.isEmpty()) {
+        return m_workspaceRoot;
+    }
+    if (!m_currentFilePath.isEmpty()) {
+        return QFileInfo(m_currentFilePath).absolutePath();
+    }
+    return QDir::currentPath();
+}
+
+void MainWindow::findInFiles()
+{
+    m_fileSearchPanel->setRootPath(workspaceRoot());
+    m_searchDock->show();
+    m_searchDock->raise();
+    m_fileSearchPanel->focusSearch(m_codeEditor->textCursor().selectedText());
 }
 
 void MainWindow::saveFile()
@@ -274,6 +976,9 @@ void MainWindow::saveFile()
     file.close();
 
     m_isModified = false;
+    if (!m_symbolIndex->rootPath().isEmpty()) {
+        m_symbolIndex->refresh();
+    }
     updateStatusBar();
 
     m_statusLabel->setText(tr("Saved: %1").arg(m_currentFilePath));
@@ -290,8 +995,11 @@ void MainWindow::saveFileAs()
         return;
     }
 
+    m_lspClient->closeDocument();
     m_currentFilePath = filePath;
     saveFile();
+    syncLanguageServer();
+    syncBuildProfile();
 }
 
 void MainWindow::compileCode()
@@ -332,8 +1040,483 @@ void MainWindow::compileAndRun()
     m_compilerService->compileAndRun(m_currentFilePath);
 }
 
+void MainWindow::benchmarkCode()
+{
+    if (m_currentFilePath.isEmpty()) {
+        saveFileAs();
+        if (m_currentFilePath.isEmpty()) {
+            return;
+        }
+    } else if (m_isModified) {
+        saveFile();
+    }
+
+    m_statusLabel->setText(tr("Building..."));
+    m_compilerService->compileAndBenchmark(m_currentFilePath);
+}
+
+void MainWindow::profileCode()
+{
+    if (m_currentFilePath.isEmpty()) {
+        saveFileAs();
+        if (m_currentFilePath.isEmpty()) {
+            return;
+        }
+    } else if (m_isModified) {
+        saveFile();
+    }
+
+    m_statusLabel->setText(tr("Building..."));
+    m_compilerService->compileAndProfile(m_currentFilePath);
+}
+
+void MainWindow::compareCompilers()
+{
+    if (m_currentFilePath.isEmpty()) {
+        saveFileAs();
+        if (m_currentFilePath.isEmpty()) {
+            return;
+        }
+    } else if (m_isModified) {
+        saveFile();
+    }
+
+    // Non-modal, so a long matrix can run while editing continues
+    if (!m_matrixDialog) {
+        m_matrixDialog = new MatrixDialog(m_compilerService, this);
+    }
+    m_matrixDialog->setSourceFile(m_currentFilePath);
+    m_matrixDialog->show();
+    m_matrixDialog->raise();
+    m_matrixDialog->activateWindow();
+}
+
+void MainWindow::profileMemory()
+{
+    if (m_currentFilePath.isEmpty()) {
+        saveFileAs();
+        if (m_currentFilePath.isEmpty()) {
+            return;
+        }
+    } else if (m_isModified) {
+        saveFile();
+    }
+
+    m_statusLabel->setText(tr("Building..."));
+    m_compilerService->compileAndProfileMemory(m_currentFilePath);
+}
+
+void MainWindow::profileBuildTime()
+{
+    if (m_currentFilePath.isEmpty()) {
+        saveFileAs();
+        if (m_currentFilePath.isEmpty()) {
+            return;
+        }
+    } else if (m_isModified) {
+        saveFile();
+    }
+
+    m_statusLabel->setText(tr("Profiling compile..."));
+    m_compilerService->profileBuildTime(m_currentFilePath);
+}
+
+void MainWindow::runTests(const QStringList &onlyTests)
+{
+    if (m_currentFilePath.isEmpty()) {
+        saveFileAs();
+        if (m_currentFilePath.isEmpty()) {
+            return;
+        }
+    } else if (m_isModified) {
+        saveFile();
+    }
+
+    // Rebuilt first, so a fix is tested rather than the old binary
+    m_statusLabel->setText(tr("Building..."));
+    m_compilerService->compileAndRunTests(m_currentFilePath, onlyTests);
+}
+
+void MainWindow::setWatchMode(bool enabled)
+{
+    if (!enabled) {
+        m_watchMode->stop();
+        m_statusLabel->setText(tr("Watch mode off"));
+        return;
+    }
+    if (m_currentFilePath.isEmpty()) {
+        saveFileAs();
+        if (m_currentFilePath.isEmpty()) {
+            return;
+        }
+    } else if (m_isModified) {
+        saveFile();
+    }
+    // The target stays this file until watch mode is turned off
+    m_aiChatPanel->appendOutput(tr("Watching %1: every save rebuilds and reruns it")
+                                    .arg(QFileInfo(m_currentFilePath).fileName()), false);
+    m_watchMode->start(m_currentFilePath, workspaceRoot());
+}
+
+void MainWindow::showWatchRun(const QVector<OutputDiffLine> &diff, int lineCount, bool firstRun,
+                              const QString &output, const QString &status)
+{
+    // Enough to read what changed without flooding the console
+    const int maxShown = 200;
+    m_statusLabel->setText(tr("Execution finished"));
+    if (firstRun) {
+        m_aiChatPanel->appendOutput("Program output:", false);
+        m_aiChatPanel->appendStreamOutput(output, false);
+        m_aiChatPanel->appendOutput("\n" + status, false);
+        return;
+    }
+
+    int added = 0;
+    int removed = 0;
+    for (const OutputDiffLine &line : diff) {
+        added += line.kind == OutputDiffLine::Added;
+        removed += line.kind == OutputDiffLine::Removed;
+    }
+    if (added == 0 && removed == 0) {
+        m_aiChatPanel->appendOutput(tr("Output unchanged (%1 lines)").arg(lineCount), false);
+    } else {
+        m_aiChatPanel->appendOutput(tr("Output changed: %1 lines added, %2 removed, %3 lines in total")
+                                        .arg(added).arg(removed).arg(lineCount), false);
+        int shown = 0;
+        for (const OutputDiffLine &line : diff) {
+            if (line.kind == OutputDiffLine::Same) {
+                continue;
+            }
+            if (shown++ == maxShown) {
+                m_aiChatPanel->appendOutput(tr("... %1 more changed lines").arg(added + removed - maxShown), false);
+                break;
+            }
+            const bool isAdded = line.kind == OutputDiffLine::Added;
+            m_aiChatPanel->appendOutput(QString("%1%2| %3").arg(isAdded ? '+' : '-').arg(line.line, 5).arg(line.text),
+                                        !isAdded);
+        }
+    }
+    m_aiChatPanel->appendOutput(status, false);
+}
+
+bool MainWindow::saveBeforeBuild()
+{
+    // Project builds read from disk, so only the open buffer needs flushing
+    if (m_isModified && !m_currentFilePath.isEmpty()) {
+        saveFile();
+    }
+    return !m_isModified || m_currentFilePath.isEmpty();
+}
+
+void MainWindow::editExecutionLimits()
+{
+    ExecutionLimits limits = m_compilerService->executionLimits();
+
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("Execution Limits"));
+    QFormLayout *form = new QFormLayout(&dialog);
+
+    // 0 means unlimited for every field
+    QSpinBox *timeoutSpin = new QSpinBox(&dialog);
+    timeoutSpin->setRange(0, 3600);
+    timeoutSpin->setSuffix(tr(" s"));
+    timeoutSpin->setSpecialValueText(tr("Unlimited"));
+    timeoutSpin->setValue(limits.wallTimeoutMs / 1000);
+    form->addRow(tr("Wall-clock timeout:"), timeoutSpin);
+
+    QSpinBox *cpuSpin = new QSpinBox(&dialog);
+    cpuSpin->setRange(0, 3600);
+    cpuSpin->setSuffix(tr(" s"));
+    cpuSpin->setSpecialValueText(tr("Unlimited"));
+    cpuSpin->setValue(limits.cpuSeconds);
+    form->addRow(tr("CPU time limit:"), cpuSpin);
+
+    QSpinBox *memorySpin = new QSpinBox(&dialog);
+    memorySpin->setRange(0, 1024 * 1024);
+    memorySpin->setSuffix(tr(" MB"));
+    memorySpin->setSpecialValueText(tr("Unlimited"));
+    memorySpin->setValue(int(limits.memoryBytes / (1024 * 1024)));
+    form->addRow(tr("Address space limit:"), memorySpin);
+
+    QSpinBox *outputSpin = new QSpinBox(&dialog);
+    outputSpin->setRange(0, 1024 * 1024);
+    outputSpin->setSuffix(tr(" MB"));
+    outputSpin->setSpecialValueText(tr("Unlimited"));
+    outputSpin->setValue(int(limits.maxOutputBytes / (1024 * 1024)));
+    form->addRow(tr("Max output size:"), outputSpin);
+
+    QCheckBox *countersCheck = new QCheckBox(tr("Report hardware performance counters"), &dialog);
+    countersCheck->setToolTip(tr("Cycles, instructions, IPC, cache and branch misses via perf_event_open (Linux)"));
+    countersCheck->setChecked(limits.perfCounters);
+    form->addRow(countersCheck);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    form->addRow(buttons);
+
+    if (dialog.exec() != QDialog::Accepted) {
+        return;
+    }
+    limits.wallTimeoutMs = timeoutSpin->value() * 1000;
+    limits.cpuSeconds = cpuSpin->value();
+    limits.memoryBytes = qint64(memorySpin->value()) * 1024 * 1024;
+    limits.maxOutputBytes = qint64(outputSpin->value()) * 1024 * 1024;
+    limits.perfCounters = countersCheck->isChecked();
+    m_compilerService->setExecutionLimits(limits);
+}
+
+void MainWindow::populateCompilerSelector(const QVector<Toolchain> &toolchains)
+{
+    // Rebuilding the list must not count as the user picking a compiler
+    QSignalBlocker blocker(m_compilerSelector);
+    m_compilerSelector->clear();
+    for (const Toolchain &toolchain : toolchains) {
+        if (toolchain.isCompiler()) {
+            m_compilerSelector->addItem(toolchain.displayName(), toolchain.name);
+            m_compilerSelector->setItemData(m_compilerSelector->count() - 1, toolchain.path, Qt::ToolTipRole);
+        }
+    }
+    if (m_compilerSelector->count() == 0) {
+        // Nothing probed yet (first start) or nothing on PATH
+        m_compilerSelector->addItem("GCC (g++)", "g++");
+        m_compilerSelector->addItem("Clang (clang++)", "clang++");
+        m_compilerSelector->addItem("MSVC (cl)", "cl");
+    }
+
+    const QString current = m_compilerService->currentCompiler();
+    int index = m_compilerSelector->findData(current);
+    if (index < 0 && !current.isEmpty()) {
+        m_compilerSelector->addItem(tr("%1 (not found)").arg(current), current);
+        index = m_compilerSelector->count() - 1;
+    }
+    m_compilerSelector->setCurrentIndex(qMax(0, index));
+}
+
+void MainWindow::showToolchains()
+{
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("Toolchains"));
+    dialog.resize(900, 360);
+    QVBoxLayout *layout = new QVBoxLayout(&dialog);
+
+    QTableWidget *table = new QTableWidget(&dialog);
+    table->setColumnCount(6);
+    table->setHorizontalHeaderLabels({tr("Name"), tr("Kind"), tr("Version"), tr("Target"), tr("Sysroot"), tr("Path")});
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    table->verticalHeader()->hide();
+    table->horizontalHeader()->setStretchLastSection(true);
+    layout->addWidget(table, 1);
+
+    QLabel *status = new QLabel(&dialog);
+    status->setStyleSheet("color: #888;");
+    layout->addWidget(status);
+
+    auto fill = [table, status](const QVector<Toolchain> &toolchains) {
+        static const QStringList kinds = {"GCC", "Clang", "MSVC", "Linker"};
+        table->setRowCount(toolchains.size());
+        for (int row = 0; row < toolchains.size(); ++row) {
+            const Toolchain &toolchain = toolchains.at(row);
+            const QStringList cells = {toolchain.name, kinds.value(toolchain.kind), toolchain.version,
+                                       toolchain.target, toolchain.sysroot, toolchain.path};
+            for (int column = 0; column < cells.size(); ++column) {
+                QTableWidgetItem *item = new QTableWidgetItem(cells.at(column));
+                if (!toolchain.includePaths.isEmpty()) {
+                    item->setToolTip(tr("Include paths:\n%1").arg(toolchain.includePaths.join('\n')));
+                }
+                table->setItem(row, column, item);
+            }
+        }
+        table->resizeColumnsToContents();
+        status->setText(tr("%n toolchain(s) found on PATH", "", toolchains.size()));
+    };
+    fill(m_toolchainProbe->isRunning() || m_toolchainProbe->toolchains().isEmpty() ? ToolchainProbe::cached()
+                                                                                    : m_toolchainProbe->toolchains());
+    if (m_toolchainProbe->isRunning()) {
+        status->setText(tr("Scanning PATH..."));
+    }
+    connect(m_toolchainProbe, &ToolchainProbe::finished, &dialog, fill);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Close, &dialog);
+    QPushButton *rescan = buttons->addButton(tr("&Rescan"), QDialogButtonBox::ActionRole);
+    connect(rescan, &QPushButton::clicked, [this, status]() {
+        status->setText(tr("Scanning PATH..."));
+        m_toolchainProbe->start();
+    });
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    layout->addWidget(buttons);
+
+    dialog.exec();
+}
+
+void MainWindow::editBenchmarkOptions()
+{
+    BenchmarkOptions options = m_compilerService->benchmarkOptions();
+
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("Benchmark Settings"));
+    QFormLayout *form = new QFormLayout(&dialog);
+
+    QSpinBox *iterationsSpin = new QSpinBox(&dialog);
+    iterationsSpin->setRange(1, 10000);
+    iterationsSpin->setValue(options.iterations);
+    form->addRow(tr("Measured runs:"), iterationsSpin);
+
+    QSpinBox *warmupSpin = new QSpinBox(&dialog);
+    warmupSpin->setRange(0, 1000);
+    warmupSpin->setValue(options.warmups);
+    form->addRow(tr("Warmup runs:"), warmupSpin);
+
+    QSpinBox *cpuSpin = new QSpinBox(&dialog);
+    cpuSpin->setRange(-1, QThread::idealThreadCount() - 1);
+    cpuSpin->setSpecialValueText(tr("Not pinned"));
+    cpuSpin->setValue(options.pinCpu);
+    form->addRow(tr("Pin to CPU:"), cpuSpin);
+
+    QCheckBox *environmentCheck = new QCheckBox(tr("Run with a fixed, minimal environment"), &dialog);
+    environmentCheck->setChecked(options.fixedEnvironment);
+    form->addRow(environmentCheck);
+
+    QCheckBox *hashCheck = new QCheckBox(tr("Hash output to check runs agree (otherwise discard it)"), &dialog);
+    hashCheck->setChecked(options.hashOutput);
+    form->addRow(hashCheck);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    form->addRow(buttons);
+
+    if (dialog.exec() != QDialog::Accepted) {
+        return;
+    }
+    options.iterations = iterationsSpin->value();
+    options.warmups = warmupSpin->value();
+    options.pinCpu = cpuSpin->value();
+    options.fixedEnvironment = environmentCheck->isChecked();
+    options.hashOutput = hashCheck->isChecked();
+    m_compilerService->setBenchmarkOptions(options);
+}
+
+void MainWindow::editPgoTrainingInput()
+{
+    PgoTrainingInput training = PgoTrainingInput::load();
+
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("PGO Training Input"));
+    QFormLayout *form = new QFormLayout(&dialog);
+
+    QLineEdit *argumentsEdit = new QLineEdit(training.arguments, &dialog);
+    argumentsEdit->setPlaceholderText(tr("Command-line arguments for the training run"));
+    form->addRow(tr("Arguments:"), argumentsEdit);
+
+    QLineEdit *stdinEdit = new QLineEdit(training.stdinFile, &dialog);
+    stdinEdit->setPlaceholderText(tr("Optional file fed to standard input"));
+    QPushButton *browseButton = new QPushButton(tr("Browse..."), &dialog);
+    connect(browseButton, &QPushButton::clicked, [this, stdinEdit]() {
+        const QString path = QFileDialog::getOpenFileName(this, tr("Training Input"), workspaceRoot());
+        if (!path.isEmpty()) {
+            stdinEdit->setText(path);
+        }
+    });
+    QHBoxLayout *stdinLayout = new QHBoxLayout;
+    stdinLayout->addWidget(stdinEdit, 1);
+    stdinLayout->addWidget(browseButton);
+    form->addRow(tr("Standard input:"), stdinLayout);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    form->addRow(buttons);
+
+    if (dialog.exec() != QDialog::Accepted) {
+        return;
+    }
+    training.arguments = argumentsEdit->text();
+    training.stdinFile = stdinEdit->text();
+    training.save();
+}
+
+void MainWindow::buildProject()
+{
+    if (!saveBeforeBuild()) {
+        return;
+    }
+    m_statusLabel->setText(tr("Building project..."));
+    m_compilerService->buildProject(workspaceRoot());
+}
+
+void MainWindow::buildAndRunProject()
+{
+    if (!saveBeforeBuild()) {
+        return;
+    }
+    m_statusLabel->setText(tr("Building project..."));
+    m_compilerService->buildAndRunProject(workspaceRoot());
+}
+
+void MainWindow::showBuildDiagnostics()
+{
+    m_codeEditor->setDiagnostics("build", m_problemsPanel->diagnosticsForFile(m_currentFilePath));
+}
+
+void MainWindow::showProfileAnnotations()
+{
+    if (m_gutterAnnotations == BuildTimeAnnotations) {
+        // Each #include line shows its header's parse time, including what that header pulled in
+        const BuildTimeProfile &profile = m_buildTimePanel->profile();
+        QHash<int, LineAnnotation> annotations;
+        if (QFileInfo(profile.sourceFile) == QFileInfo(m_currentFilePath)) {
+            qint64 most = 0;
+            for (qint64 us : profile.includeLineUs) {
+                most = qMax(most, us);
+            }
+            for (auto it = profile.includeLineUs.constBegin(); it != profile.includeLineUs.constEnd(); ++it) {
+                annotations.insert(it.key(), {SampleStats::formatUs(it.value()), double(it.value()) / qMax<qint64>(1, most)});
+            }
+        }
+        m_codeEditor->setLineAnnotations(annotations);
+        return;
+    }
+
+    if (m_gutterAnnotations == HeapProfileAnnotations) {
+        const QHash<int, qint64> allocations = m_heapPanel->profile().lineAllocations(m_currentFilePath);
+        qint64 most = 0;
+        for (qint64 count : allocations) {
+            most = qMax(most, count);
+        }
+        QHash<int, LineAnnotation> annotations;
+        for (auto it = allocations.constBegin(); it != allocations.constEnd(); ++it) {
+            annotations.insert(it.key(), {HeapPanel::formatCount(it.value()) + "x", double(it.value()) / most});
+        }
+        m_codeEditor->setLineAnnotations(annotations);
+        return;
+    }
+
+    const QHash<int, double> percentages = m_hotspotPanel->result().linePercentages(m_currentFilePath);
+    double hottest = 0;
+    for (double percent : percentages) {
+        hottest = qMax(hottest, percent);
+    }
+
+    // Lines under 0.1% would only add noise to the gutter
+    QHash<int, LineAnnotation> annotations;
+    for (auto it = percentages.constBegin(); it != percentages.constEnd(); ++it) {
+        if (it.value() >= 0.1) {
+            annotations.insert(it.key(), {QString("%1%").arg(it.value(), 0, 'f', 1), it.value() / hottest});
+        }
+    }
+    m_codeEditor->setLineAnnotations(annotations);
+}
+
 void MainWindow::onCompilationFinished(bool success, const QString &output)
 {
+    showBuildDiagnostics();
+    if (m_problemsPanel->errorCount() > 0) {
+        m_problemsDock->show();
+        m_problemsDock->raise();
+    }
+
     if (success) {
         m_statusLabel->setText(tr("Compilation successful"));
         m_aiChatPanel->appendOutput("✓ Compilation successful\n" + output, false);
@@ -345,8 +1528,11 @@ void MainWindow::onCompilationFinished(bool success, const QString &output)
 
 void MainWindow::onExecutionFinished(const QString &output)
 {
+    if (m_watchMode->isWatchedRun()) {
+        return;     // showWatchRun reports it
+    }
     m_statusLabel->setText(tr("Execution finished"));
-    m_aiChatPanel->appendOutput("Program output:\n" + output, false);
+    m_aiChatPanel->appendOutput("\n" + output, false);
 }
 
 void MainWindow::onAIResponseReceived(const QString &response)
@@ -367,10 +1553,17 @@ void MainWindow::loadSettings()
     restoreGeometry(settings.value("geometry").toByteArray());
     restoreState(settings.value("windowState").toByteArray());
 
-    int compilerIndex = settings.value("compilerIndex", 0).toInt();
-    m_compilerSelector->setCurrentIndex(compilerIndex);
-
     m_mainSplitter->restoreState(settings.value("splitterState").toByteArray());
+
+    m_workspaceRoot = settings.value("workspaceRoot").toString();
+    if (!m_workspaceRoot.isEmpty() && !QFileInfo(m_workspaceRoot).isDir()) {
+        m_workspaceRoot.clear();
+    }
+    if (!m_workspaceRoot.isEmpty()) {
+        m_fileSearchPanel->setRootPath(m_workspaceRoot);
+        ensureSymbolIndex();
+    }
+    syncBuildProfile();
 }
 
 void MainWindow::saveSettings()
@@ -378,6 +1571,6 @@ void MainWindow::saveSettings()
     QSettings settings("AICodeEditor", "AICodeEditor");
     settings.setValue("geometry", saveGeometry());
     settings.setValue("windowState", saveState());
-    settings.setValue("compilerIndex", m_compilerSelector->currentIndex());
     settings.setValue("splitterState", m_mainSplitter->saveState());
+    settings.setValue("workspaceRoot", m_workspaceRoot);
 }
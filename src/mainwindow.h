@@ -7,10 +7,27 @@
 #include <QLabel>
 #include <QAction>
 #include <QToolBar>
+#include <QDockWidget>
+#include <QTimer>
 #include "codeeditor.h"
 #include "aichatpanel.h"
 #include "compilerservice.h"
 #include "aiservice.h"
+#include "filesearchpanel.h"
+#include "quickopendialog.h"
+#include "symbolindex.h"
+#include "symbolsearchdialog.h"
+#include "lspclient.h"
+#include "syntaxchecker.h"
+#include "toolchainprobe.h"
+#include "problemspanel.h"
+#include "hotspotpanel.h"
+#include "heappanel.h"
+#include "buildtimepanel.h"
+#include "testpanel.h"
+#include "assemblypanel.h"
+#include "matrixdialog.h"
+#include "watchmode.h"
 
 class MainWindow : public QMainWindow
 {
@@ -23,16 +40,34 @@ public:
 private slots:
     void newFile();
     void openFile();
+    void openFolder();
+    void quickOpen();
+    void findInFiles();
+    void goToSymbol();
+    void goToDefinition(const QString &symbol);
     void saveFile();
     void saveFileAs();
     void compileCode();
     void runCode();
     void compileAndRun();
+    void buildProject();
+    void buildAndRunProject();
+    void benchmarkCode();
+    void compareCompilers();
+    void profileCode();
+    void profileMemory();
+    void profileBuildTime();
+    void runTests(const QStringList &onlyTests = QStringList());
+    void editExecutionLimits();
+    void showToolchains();
+    void editBenchmarkOptions();
+    void editPgoTrainingInput();
     void onCompilationFinished(bool success, const QString &output);
     void onExecutionFinished(const QString &output);
     void onAIResponseReceived(const QString &response);
     void onAISuggestionsReceived(const QStringList &suggestions);
     void updateStatusBar();
+    void updateJobsLabel();
 
 private:
     void createMenus();
@@ -41,21 +76,68 @@ private:
     void setupUI();
     void loadSettings();
     void saveSettings();
+    bool maybeSave();
+    bool loadFile(const QString &filePath);
+    void openLocation(const QString &filePath, int line, int column = 0);
+    QString workspaceRoot() const;
+    void ensureSymbolIndex();
+    void syncLanguageServer();
+    void scheduleSyntaxCheck();
+    void scheduleAssembly();
+    void populateCompilerSelector(const QVector<Toolchain> &toolchains);
+    QString buildProfileScope() const;
+    void syncBuildProfile();
+    bool saveBeforeBuild();
+    void showBuildDiagnostics();
+    void showProfileAnnotations();
+    void setWatchMode(bool enabled);
+    void showWatchRun(const QVector<OutputDiffLine> &diff, int lineCount, bool firstRun,
+                      const QString &output, const QString &status);
 
     // UI Components
     QSplitter *m_mainSplitter;
     CodeEditor *m_codeEditor;
     AIChatPanel *m_aiChatPanel;
     QComboBox *m_compilerSelector;
+    QComboBox *m_profileSelector;
     QLabel *m_statusLabel;
     QLabel *m_cursorPositionLabel;
+    QLabel *m_jobsLabel;        // running and queued builds and runs
+    QDockWidget *m_searchDock;
+    FileSearchPanel *m_fileSearchPanel;
+    QDockWidget *m_problemsDock;
+    ProblemsPanel *m_problemsPanel;
+    QDockWidget *m_hotspotDock;
+    HotspotPanel *m_hotspotPanel;
+    QDockWidget *m_heapDock;
+    HeapPanel *m_heapPanel;
+    QDockWidget *m_buildTimeDock;
+    BuildTimePanel *m_buildTimePanel;
+    QDockWidget *m_testDock;
+    TestPanel *m_testPanel;
+    QDockWidget *m_assemblyDock;
+    AssemblyPanel *m_assemblyPanel;
+    // Which profile the gutter shows: the most recent one
+    enum GutterAnnotations { CpuProfileAnnotations, HeapProfileAnnotations, BuildTimeAnnotations };
+    GutterAnnotations m_gutterAnnotations;
+    QTimer *m_diagnosticsTimer;
+    QuickOpenDialog *m_quickOpenDialog;
+    MatrixDialog *m_matrixDialog;
+    SymbolSearchDialog *m_symbolSearchDialog;
 
     // Services
     CompilerService *m_compilerService;
     AIService *m_aiService;
+    SymbolIndex *m_symbolIndex;
+    LspClient *m_lspClient;
+    SyntaxChecker *m_syntaxChecker;
+    ToolchainProbe *m_toolchainProbe;
+    AssemblyGenerator *m_assemblyGenerator;
+    WatchMode *m_watchMode;
 
     // State
     QString m_currentFilePath;
+    QString m_workspaceRoot;
     bool m_isModified;
 };
 
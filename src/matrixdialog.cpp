@@ -0,0 +1,181 @@
+#include "matrixdialog.h"
+#include "compilerservice.h"
+#include "heappanel.h"
+#include <QDialogButtonBox>
+#include <QFileInfo>
+#include <QHeaderView>
+#include <QVBoxLayout>
+
+MatrixDialog::MatrixDialog(CompilerService *compilerService, QWidget *parent)
+    : QDialog(parent)
+    , m_compilerService(compilerService)
+{
+    setWindowTitle(tr("Compare Compilers"));
+    resize(1000, 520);
+    QVBoxLayout *layout = new QVBoxLayout(this);
+
+    QLabel *hint = new QLabel(tr("One configuration per line: a compiler followed by its flags. "
+                                 "All compile concurrently; the binaries are then benchmarked one at a "
+                                 "time with the Benchmark Settings and Execution Limits."), this);
+    hint->setWordWrap(true);
+    hint->setStyleSheet("color: #888;");
+    layout->addWidget(hint);
+
+    m_configurationsEdit = new QPlainTextEdit(this);
+    m_configurationsEdit->setFixedHeight(110);
+    QStringList lines;
+    for (const MatrixConfiguration &configuration : MatrixConfiguration::load()) {
+        lines << configuration.label();
+    }
+    m_configurationsEdit->setPlainText(lines.join('\n'));
+    layout->addWidget(m_configurationsEdit);
+
+    m_table = new QTableWidget(0, ColumnCount, this);
+    m_table->setHorizontalHeaderLabels({tr("Configuration"), tr("Status"), tr("Compile CPU"), tr("Binary"),
+                                        tr("Median"), tr("Min"), tr("Std Dev"), tr("CPU / Run"), tr("Peak RSS"),
+                                        tr("Relative"), tr("Output")});
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->verticalHeader()->hide();
+    m_table->horizontalHeader()->setStretchLastSection(true);
+    m_table->horizontalHeader()->resizeSection(ConfigurationColumn, 240);
+    layout->addWidget(m_table, 1);
+
+    m_statusLabel = new QLabel(this);
+    m_statusLabel->setStyleSheet("color: #888;");
+    layout->addWidget(m_statusLabel);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    m_runButton = buttons->addButton(tr("&Run"), QDialogButtonBox::ActionRole);
+    connect(m_runButton, &QPushButton::clicked, this, &MatrixDialog::startOrCancel);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    layout->addWidget(buttons);
+
+    m_runner = new MatrixRunner(this);
+    connect(m_runner, &MatrixRunner::progress, m_statusLabel, &QLabel::setText);
+    connect(m_runner, &MatrixRunner::resultChanged, this, &MatrixDialog::updateRow);
+    connect(m_runner, &MatrixRunner::finished, [this]() {
+        m_runButton->setText(tr("&Run"));
+        updateComparisons();
+    });
+}
+
+void MatrixDialog::setSourceFile(const QString &sourceFile)
+{
+    m_sourceFile = sourceFile;
+    setWindowTitle(tr("Compare Compilers - %1").arg(QFileInfo(sourceFile).fileName()));
+}
+
+void MatrixDialog::startOrCancel()
+{
+    if (m_runner->isRunning()) {
+        m_runner->cancel();
+        m_runButton->setText(tr("&Run"));
+        return;
+    }
+
+    QVector<MatrixConfiguration> configurations;
+    for (const QString &line : m_configurationsEdit->toPlainText().split('\n', Qt::SkipEmptyParts)) {
+        const MatrixConfiguration configuration = MatrixConfiguration::parse(line);
+        if (!configuration.compiler.isEmpty()) {
+            configurations << configuration;
+        }
+    }
+    if (configurations.isEmpty() || m_sourceFile.isEmpty()) {
+        m_statusLabel->setText(tr("Nothing to compare"));
+        return;
+    }
+    MatrixConfiguration::save(configurations);
+
+    m_table->setRowCount(0);
+    m_table->setRowCount(configurations.size());
+    m_runButton->setText(tr("&Stop"));
+    m_runner->start(m_sourceFile, configurations, m_compilerService->benchmarkOptions(),
+                    m_compilerService->executionLimits(), m_compilerService->languageStandard());
+}
+
+void MatrixDialog::setCell(int row, int column, const QString &text, const QString &toolTip)
+{
+    QTableWidgetItem *item = new QTableWidgetItem(text);
+    if (column != ConfigurationColumn && column != StatusColumn && column != OutputColumn) {
+        item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    }
+    item->setToolTip(toolTip);
+    m_table->setItem(row, column, item);
+}
+
+void MatrixDialog::updateRow(int index)
+{
+    const MatrixResult &result = m_runner->results().at(index);
+    setCell(index, ConfigurationColumn, result.configuration.label());
+
+    static const QStringList states = {tr("Pending"), tr("Compiling"), tr("Compiled"), tr("Compile failed"),
+                                       tr("Running"), tr("Finished"), tr("Run failed")};
+    setCell(index, StatusColumn, states.value(result.state), result.message);
+    if (result.state == MatrixResult::Pending || result.state == MatrixResult::Compiling) {
+        return;
+    }
+
+    // CPU time of the driver tree; the wall time depends on what else was compiling
+    const ResourceUsage &usage = result.compileUsage;
+    const double compileUs = usage.valid ? usage.userUs + usage.systemUs : usage.wallUs;
+    setCell(index, CompileColumn, SampleStats::formatUs(compileUs),
+            tr("Wall time %1 while compiling concurrently").arg(SampleStats::formatUs(usage.wallUs)));
+    if (result.state == MatrixResult::CompileFailed) {
+        return;
+    }
+    setCell(index, SizeColumn, HeapPanel::formatBytes(result.binaryBytes));
+    if (result.state != MatrixResult::Finished) {
+        return;
+    }
+
+    const BenchmarkResult &benchmark = result.benchmark;
+    const SampleStats wall = SampleStats::compute(benchmark.wallUs);
+    const SampleStats cpu = SampleStats::compute(benchmark.cpuUs);
+    setCell(index, MedianColumn, SampleStats::formatUs(wall.median),
+            tr("p95 %1, %2 runs").arg(SampleStats::formatUs(wall.p95)).arg(wall.count));
+    setCell(index, MinColumn, SampleStats::formatUs(wall.min));
+    setCell(index, StddevColumn, SampleStats::formatUs(wall.stddev));
+    setCell(index, CpuColumn, SampleStats::formatUs(cpu.median));
+    setCell(index, RssColumn, HeapPanel::formatBytes(benchmark.maxRssKb * 1024));
+}
+
+void MatrixDialog::updateComparisons()
+{
+    const QVector<MatrixResult> &results = m_runner->results();
+    double best = 0;
+    QByteArray referenceHash;
+    for (const MatrixResult &result : results) {
+        if (result.state == MatrixResult::Finished) {
+            const double median = SampleStats::compute(result.benchmark.wallUs).median;
+            best = best > 0 ? qMin(best, median) : median;
+            if (referenceHash.isEmpty()) {
+                referenceHash = result.benchmark.outputHash;
+            }
+        }
+    }
+
+    for (int row = 0; row < results.size(); ++row) {
+        const MatrixResult &result = results.at(row);
+        if (result.state != MatrixResult::Finished || best <= 0) {
+            continue;
+        }
+        const double ratio = SampleStats::compute(result.benchmark.wallUs).median / best;
+        setCell(row, RelativeColumn, QString("%1×").arg(ratio, 0, 'f', 2));
+        if (ratio <= 1.0) {
+            m_table->item(row, RelativeColumn)->setForeground(QColor(80, 200, 120));
+        }
+
+        // Different output means a configuration changed behaviour, e.g. via -ffast-math
+        if (!result.benchmark.options.hashOutput) {
+            setCell(row, OutputColumn, tr("not checked"));
+        } else if (!result.benchmark.outputStable) {
+            setCell(row, OutputColumn, tr("varies between runs"));
+        } else if (result.benchmark.outputHash == referenceHash) {
+            setCell(row, OutputColumn, tr("same"));
+        } else {
+            setCell(row, OutputColumn, tr("differs"), tr("stdout differs from the first configuration's"));
+            m_table->item(row, OutputColumn)->setForeground(QColor(244, 71, 71));
+        }
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef MATRIXDIALOG_H
+#define MATRIXDIALOG_H
+
+#include <QDialog>
+#include <QLabel>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QTableWidget>
+#include "matrixrunner.h"
+
+class CompilerService;
+
+// Build > Compare Compilers: edits the list of compiler/flag combinations,
+// runs the matrix on the current file and tabulates the results
+class MatrixDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit MatrixDialog(CompilerService *compilerService, QWidget *parent = nullptr);
+
+    void setSourceFile(const QString &sourceFile);
+
+private:
+    enum Column {
+        ConfigurationColumn, StatusColumn, CompileColumn, SizeColumn, MedianColumn,
+        MinColumn, StddevColumn, CpuColumn, RssColumn, RelativeColumn, OutputColumn, ColumnCount
+    };
+
+    void startOrCancel();
+    void updateRow(int index);
+    void updateComparisons();
+    void setCell(int row, int column, const QString &text, const QString &toolTip = QString());
+
+    CompilerService *m_compilerService;
+    MatrixRunner *m_runner;
+    QString m_sourceFile;
+    QPlainTextEdit *m_configurationsEdit;
+    QTableWidget *m_table;
+    QLabel *m_statusLabel;
+    QPushButton *m_runButton;
+};
+
+#endif // MATRIXDIALOG_H
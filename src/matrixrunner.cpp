@@ -0,0 +1,266 @@
+#include "matrixrunner.h"
+#include "compilerservice.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QThread>
+
+QString MatrixConfiguration::label() const
+{
+    return (QStringList{compiler} + flags).join(' ');
+}
+
+MatrixConfiguration MatrixConfiguration::parse(const QString &line)
+{
+    MatrixConfiguration configuration;
+    QStringList words = QProcess::splitCommand(line.trimmed());
+    if (!words.isEmpty()) {
+        configuration.compiler = words.takeFirst();
+        configuration.flags = words;
+    }
+    return configuration;
+}
+
+QVector<MatrixConfiguration> MatrixConfiguration::load()
+{
+    QSettings settings("AICodeEditor", "AICodeEditor");
+    QStringList lines = settings.value("matrixConfigurations").toStringList();
+    if (lines.isEmpty()) {
+        for (const QString &compiler : {QString("g++"), QString("clang++")}) {
+            if (!QStandardPaths::findExecutable(compiler).isEmpty()) {
+                lines << compiler + " -O2" << compiler + " -O3 -march=native";
+            }
+        }
+    }
+
+    QVector<MatrixConfiguration> configurations;
+    for (const QString &line : lines) {
+        const MatrixConfiguration configuration = parse(line);
+        if (!configuration.compiler.isEmpty()) {
+            configurations << configuration;
+        }
+    }
+    return configurations;
+}
+
+void MatrixConfiguration::save(const QVector<MatrixConfiguration> &configurations)
+{
+    QStringList lines;
+    for (const MatrixConfiguration &configuration : configurations) {
+        lines << configuration.label();
+    }
+    QSettings settings("AICodeEditor", "AICodeEditor");
+    settings.setValue("matrixConfigurations", lines);
+}
+
+MatrixRunner::MatrixRunner(QObject *parent)
+    : QObject(parent)
+    , m_outputDir(nullptr)
+    , m_nextCompile(0)
+    , m_runIndex(-1)
+    , m_running(false)
+{
+    m_benchmarkRunner = new BenchmarkRunner(this);
+    connect(m_benchmarkRunner, &BenchmarkRunner::progress, [this](int done, int total) {
+        emit progress(tr("Running %1 (%2/%3): %4/%5")
+                          .arg(m_results[m_runIndex].configuration.label())
+                          .arg(m_runIndex + 1).arg(m_results.size()).arg(done).arg(total));
+    });
+    connect(m_benchmarkRunner, &BenchmarkRunner::finished, [this](const BenchmarkResult &result) {
+        m_results[m_runIndex].state = MatrixResult::Finished;
+        m_results[m_runIndex].benchmark = result;
+        emit resultChanged(m_runIndex);
+        startNextRun();
+    });
+    connect(m_benchmarkRunner, &BenchmarkRunner::failed, [this](const QString &message) {
+        m_results[m_runIndex].state = MatrixResult::RunFailed;
+        m_results[m_runIndex].message = message;
+        emit resultChanged(m_runIndex);
+        startNextRun();
+    });
+}
+
+MatrixRunner::~MatrixRunner()
+{
+    cancel();
+    delete m_outputDir;
+}
+
+void MatrixRunner::start(const QString &sourceFile, const QVector<MatrixConfiguration> &configurations,
+                         const BenchmarkOptions &options, const ExecutionLimits &limits,
+                         const QString &languageStandard)
+{
+    cancel();
+    delete m_outputDir;
+    m_outputDir = new QTemporaryDir(QDir::tempPath() + "/aicodeeditor-matrix-XXXXXX");
+
+    m_sourceFile = QFileInfo(sourceFile).absoluteFilePath();
+    m_languageStandard = languageStandard;
+    m_options = options;
+    m_limits = limits;
+    m_results.clear();
+    for (const MatrixConfiguration &configuration : configurations) {
+        MatrixResult result;
+        result.configuration = configuration;
+        m_results << result;
+    }
+    m_nextCompile = 0;
+    m_runIndex = -1;
+    m_running = true;
+
+    emit progress(tr("Compiling %1 configurations...").arg(m_results.size()));
+    startCompiles();
+}
+
+void MatrixRunner::cancel()
+{
+    if (!m_running) {
+        return;
+    }
+    m_running = false;
+    for (CompileJob *job : qAsConst(m_jobs)) {
+        job->process->disconnect();
+        job->process->kill();
+        job->process->waitForFinished(1000);
+        job->monitor->finish(0);
+        delete job->process;
+        delete job->monitor;
+        delete job;
+    }
+    m_jobs.clear();
+    m_benchmarkRunner->cancel();
+    emit progress(tr("Cancelled"));
+}
+
+QString MatrixRunner::outputPath(int index) const
+{
+#ifdef Q_OS_WIN
+    return m_outputDir->filePath(QString("%1/program.exe").arg(index));
+#else
+    return m_outputDir->filePath(QString("%1/program").arg(index));
+#endif
+}
+
+QStringList MatrixRunner::compileArguments(const MatrixConfiguration &configuration, int index) const
+{
+    const bool hasStandard = configuration.flags.filter(QRegularExpression("^[-/]std[=:]")).size() > 0;
+    QStringList args;
+    if (QFileInfo(configuration.compiler).baseName() == "cl") {
+        args << "/nologo" << "/EHsc";
+        if (!hasStandard) {
+            args << CompilerService::standardFlag(m_languageStandard, true);
+        }
+        args << configuration.flags << m_sourceFile << "/Fe" + outputPath(index);
+        return args;
+    }
+    if (!hasStandard) {
+        args << CompilerService::standardFlag(m_languageStandard, false);
+    }
+    args << configuration.flags << m_sourceFile << "-o" << outputPath(index);
+    return args;
+}
+
+void MatrixRunner::startCompiles()
+{
+    // One compiler per core; the CPU time measured for each stays fair
+    const int maxJobs = qMax(1, QThread::idealThreadCount());
+    while (m_running && m_jobs.size() < maxJobs && m_nextCompile < m_results.size()) {
+        const int index = m_nextCompile++;
+        const QString dir = QFileInfo(outputPath(index)).absolutePath();
+        QDir().mkpath(dir);
+
+        CompileJob *job = new CompileJob;
+        job->index = index;
+        job->process = new QProcess;
+        job->monitor = new ExecutionMonitor;
+        job->process->setProcessChannelMode(QProcess::MergedChannels);
+        // cl drops its object files into the working directory
+        job->process->setWorkingDirectory(dir);
+        job->process->setProgram(m_results[index].configuration.compiler);
+        job->process->setArguments(compileArguments(m_results[index].configuration, index));
+        connect(job->process, &QProcess::started, [job]() {
+            job->monitor->started();
+        });
+        connect(job->process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+                [this, job](int exitCode, QProcess::ExitStatus exitStatus) {
+            onCompileFinished(job, exitCode, exitStatus);
+        });
+        connect(job->process, &QProcess::errorOccurred, [this, job](QProcess::ProcessError error) {
+            if (error == QProcess::FailedToStart) {
+                job->startError = job->process->errorString();
+                onCompileFinished(job, -1, QProcess::CrashExit);
+            }
+        });
+
+        ExecutionLimits compileLimits;
+        compileLimits.wallTimeoutMs = 0;
+        compileLimits.perfCounters = false;
+        // The output cap is for the programs under test; a large -g object is fine
+        compileLimits.maxOutputBytes = 0;
+        job->monitor->prepare(job->process, compileLimits);
+
+        m_jobs << job;
+        m_results[index].state = MatrixResult::Compiling;
+        emit resultChanged(index);
+        job->timer.start();
+        job->process->start();
+    }
+}
+
+void MatrixRunner::onCompileFinished(CompileJob *job, int exitCode, QProcess::ExitStatus exitStatus)
+{
+    MatrixResult &result = m_results[job->index];
+    result.compileUsage = job->monitor->finish(job->timer.nsecsElapsed() / 1000);
+    result.message = QString::fromLocal8Bit(job->process->readAll()).trimmed();
+    if (!job->startError.isEmpty()) {
+        result.message = tr("Could not start %1: %2").arg(result.configuration.compiler, job->startError);
+    }
+
+    const QFileInfo binary(outputPath(job->index));
+    if (exitStatus == QProcess::NormalExit && exitCode == 0 && binary.exists()) {
+        result.state = MatrixResult::Compiled;
+        result.binaryBytes = binary.size();
+    } else {
+        result.state = MatrixResult::CompileFailed;
+    }
+    emit resultChanged(job->index);
+
+    m_jobs.removeOne(job);
+    job->process->disconnect();
+    job->process->deleteLater();
+    delete job->monitor;
+    delete job;
+
+    startCompiles();
+    if (m_running && m_jobs.isEmpty() && m_nextCompile >= m_results.size()) {
+        startNextRun();
+    }
+}
+
+void MatrixRunner::startNextRun()
+{
+    if (!m_running) {
+        return;
+    }
+    // Strictly one at a time: concurrent runs would compete for cores and caches
+    while (++m_runIndex < m_results.size()) {
+        if (m_results[m_runIndex].state == MatrixResult::Compiled) {
+            m_results[m_runIndex].state = MatrixResult::Running;
+            emit resultChanged(m_runIndex);
+            m_benchmarkRunner->start(outputPath(m_runIndex), m_options, m_limits,
+                                     QFileInfo(m_sourceFile).absolutePath());
+            return;
+        }
+    }
+    finish();
+}
+
+void MatrixRunner::finish()
+{
+    m_running = false;
+    emit progress(tr("Finished"));
+    emit finished();
+}
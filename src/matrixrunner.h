@@ -0,0 +1,95 @@
+#ifndef MATRIXRUNNER_H
+#define MATRIXRUNNER_H
+
+#include <QObject>
+#include <QProcess>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QVector>
+#include "benchmarkrunner.h"
+#include "executionmonitor.h"
+
+class QTemporaryDir;
+
+// One compiler and its flags, e.g. "clang++ -O3 -march=native"
+struct MatrixConfiguration
+{
+    QString compiler;
+    QStringList flags;
+
+    QString label() const;
+    static MatrixConfiguration parse(const QString &line);
+
+    // The saved list, or g++/clang++ at -O2 and -O3 -march=native for those on PATH
+    static QVector<MatrixConfiguration> load();
+    static void save(const QVector<MatrixConfiguration> &configurations);
+};
+
+struct MatrixResult
+{
+    MatrixConfiguration configuration;
+    enum State { Pending, Compiling, Compiled, CompileFailed, Running, Finished, RunFailed };
+    State state = Pending;
+    QString message;                // compiler output or why the benchmark failed
+    ResourceUsage compileUsage;     // the compiler driver and everything it ran
+    qint64 binaryBytes = 0;
+    BenchmarkResult benchmark;
+};
+
+// Builds one source file with several compiler/flag combinations and
+// benchmarks each binary. Compiles run concurrently, one per core, and are
+// timed by the CPU time of the whole driver tree so they don't skew each
+// other. The binaries then run strictly one after another with the same
+// benchmark options, limits, working directory and environment.
+class MatrixRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MatrixRunner(QObject *parent = nullptr);
+    ~MatrixRunner();
+
+    // languageStandard applies to configurations whose flags don't pick one
+    void start(const QString &sourceFile, const QVector<MatrixConfiguration> &configurations,
+               const BenchmarkOptions &options, const ExecutionLimits &limits,
+               const QString &languageStandard);
+    void cancel();
+    bool isRunning() const { return m_running; }
+    const QVector<MatrixResult> &results() const { return m_results; }
+
+signals:
+    void resultChanged(int index);
+    void progress(const QString &description);
+    void finished();
+
+private:
+    struct CompileJob
+    {
+        int index;
+        QProcess *process;
+        ExecutionMonitor *monitor;
+        QElapsedTimer timer;
+        QString startError;
+    };
+
+    void startCompiles();
+    void onCompileFinished(CompileJob *job, int exitCode, QProcess::ExitStatus exitStatus);
+    void startNextRun();
+    void finish();
+    QString outputPath(int index) const;
+    QStringList compileArguments(const MatrixConfiguration &configuration, int index) const;
+
+    QString m_sourceFile;
+    QString m_languageStandard;
+    BenchmarkOptions m_options;
+    ExecutionLimits m_limits;
+    QVector<MatrixResult> m_results;
+    QList<CompileJob *> m_jobs;
+    QTemporaryDir *m_outputDir;
+    BenchmarkRunner *m_benchmarkRunner;
+    int m_nextCompile;
+    int m_runIndex;                 // configuration being benchmarked, -1 before the run phase
+    bool m_running;
+};
+
+#endif // MATRIXRUNNER_H
@@ -0,0 +1,208 @@
+#include "moduledeps.h"
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QStandardPaths>
+
+namespace {
+
+// Comments out, line breaks kept; string literals are copied untouched so a
+// "//" inside one doesn't swallow the rest of the line
+QString stripComments(const QString &text)
+{
+    QString result;
+    result.reserve(text.size());
+    for (int i = 0; i < text.size(); ++i) {
+        const QChar c = text.at(i);
+        const QChar next = i + 1 < text.size() ? text.at(i + 1) : QChar();
+        if (c == '/' && next == '/') {
+            while (i < text.size() && text.at(i) != '\n') {
+                ++i;
+            }
+            result += '\n';
+        } else if (c == '/' && next == '*') {
+            const int end = text.indexOf("*/", i + 2);
+            const int stop = end < 0 ? text.size() : end + 2;
+            result += QString(text.mid(i, stop - i).count('\n'), '\n');
+            i = stop - 1;
+        } else if (c == '"') {
+            int j = i + 1;
+            while (j < text.size() && text.at(j) != '"' && text.at(j) != '\n') {
+                j += text.at(j) == '\\' ? 2 : 1;
+            }
+            result += text.mid(i, j - i + 1);
+            i = j;
+        } else {
+            result += c;
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+bool ModuleDeps::hasUnresolvedHeaders() const
+{
+    for (const QString &header : headerUnits) {
+        if (header.startsWith('<') || header.startsWith('"')) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ModuleDeps::mayUseModules(const QByteArray &source)
+{
+    return source.contains("module") || source.contains("import");
+}
+
+ModuleDeps ModuleDeps::scanSource(const QString &text)
+{
+    static const QRegularExpression moduleRe(R"(^\s*(export\s+)?module\s+([\w.]+)(:[\w.]+)?\s*;)",
+                                             QRegularExpression::MultilineOption);
+    static const QRegularExpression importRe(R"(^\s*(?:export\s+)?import\s+([^;\s][^;]*?)\s*;)",
+                                             QRegularExpression::MultilineOption);
+
+    ModuleDeps deps;
+    const QString code = stripComments(text);
+
+    // "module;" opens the global module fragment and doesn't match; ":private" isn't a partition
+    QString moduleName;
+    const QRegularExpressionMatch module = moduleRe.match(code);
+    if (module.hasMatch()) {
+        moduleName = module.captured(2);
+        const QString partition = module.captured(3);
+        if (!partition.isEmpty()) {
+            deps.provides = moduleName + partition;
+        } else if (!module.captured(1).isEmpty()) {
+            deps.provides = moduleName;
+        } else {
+            deps.imports << moduleName;     // an implementation unit sees its interface
+        }
+    }
+
+    QRegularExpressionMatchIterator it = importRe.globalMatch(code);
+    while (it.hasNext()) {
+        const QString target = it.next().captured(1);
+        if (target.startsWith('<') || target.startsWith('"')) {
+            deps.headerUnits << target;
+        } else if (target.startsWith(':')) {
+            if (!moduleName.isEmpty()) {
+                deps.imports << moduleName + target;
+            }
+        } else {
+            deps.imports << target;
+        }
+    }
+    deps.imports.removeDuplicates();
+    deps.headerUnits.removeDuplicates();
+    return deps;
+}
+
+bool ModuleDeps::parseP1689(const QByteArray &json, ModuleDeps *deps)
+{
+    // {"rules": [{"provides": [{"logical-name": ...}], "requires": [{"logical-name": ...,
+    //   "lookup-method": "include-angle", "source-path": ...}]}]}
+    QJsonParseError error;
+    const QJsonDocument document = QJsonDocument::fromJson(json, &error);
+    if (error.error != QJsonParseError::NoError || !document.object().contains("rules")) {
+        return false;
+    }
+
+    *deps = ModuleDeps();
+    for (const QJsonValue &rule : document.object().value("rules").toArray()) {
+        const QJsonObject ruleObject = rule.toObject();
+        for (const QJsonValue &provided : ruleObject.value("provides").toArray()) {
+            deps->provides = provided.toObject().value("logical-name").toString();
+        }
+        for (const QJsonValue &required : ruleObject.value("requires").toArray()) {
+            const QJsonObject requirement = required.toObject();
+            const QString name = requirement.value("logical-name").toString();
+            const QString lookup = requirement.value("lookup-method").toString();
+            if (lookup.isEmpty() || lookup == "by-name") {
+                deps->imports << name;
+            } else if (requirement.contains("source-path")) {
+                deps->headerUnits << QDir::cleanPath(requirement.value("source-path").toString());
+            } else if (QFileInfo(name).isAbsolute()) {
+                deps->headerUnits << QDir::cleanPath(name);
+            } else {
+                deps->headerUnits << (lookup == "include-angle" ? "<" + name + ">" : "\"" + name + "\"");
+            }
+        }
+    }
+    deps->imports.removeDuplicates();
+    deps->headerUnits.removeDuplicates();
+    return true;
+}
+
+QString ModuleDeps::clangScanDepsFor(const QString &compilerCommand)
+{
+    // clang++-17 -> clang-scan-deps-17, installed side by side
+    static const QRegularExpression versionRe(R"(clang(?:\+\+)?(-[\d.]+)?(?:\.exe)?$)");
+    const QString suffix = versionRe.match(QFileInfo(compilerCommand).fileName()).captured(1);
+    const QString compilerPath = QStandardPaths::findExecutable(compilerCommand);
+
+    QStringList candidates;
+    if (!compilerPath.isEmpty()) {
+        const QString dir = QFileInfo(compilerPath).canonicalPath();
+        candidates << dir + "/clang-scan-deps" + suffix << dir + "/clang-scan-deps";
+    }
+    for (const QString &candidate : qAsConst(candidates)) {
+        if (QFileInfo(candidate).isExecutable()) {
+            return candidate;
+        }
+    }
+    const QString versioned = QStandardPaths::findExecutable("clang-scan-deps" + suffix);
+    return versioned.isEmpty() ? QStandardPaths::findExecutable("clang-scan-deps") : versioned;
+}
+
+QString ModuleDeps::resolveHeader(const QString &name, const QString &sourceDir, const QStringList &includeDirs)
+{
+    if (!name.startsWith('<') && !name.startsWith('"')) {
+        return QDir::cleanPath(name);
+    }
+    const QString header = name.mid(1, name.size() - 2);
+    QStringList dirs = includeDirs;
+    if (name.startsWith('"')) {
+        dirs.prepend(sourceDir);
+    }
+    for (const QString &dir : qAsConst(dirs)) {
+        const QFileInfo info(QDir(dir).filePath(header));
+        if (info.isFile()) {
+            return QDir::cleanPath(info.absoluteFilePath());
+        }
+    }
+    return QString();
+}
+
+bool ModuleDeps::standardSupportsModules(const QStringList &flags)
+{
+    // The last -std wins, as on the command line
+    QString standard;
+    for (const QString &flag : flags) {
+        if (flag.startsWith("-std=") || flag.startsWith("/std:")) {
+            standard = flag.mid(5);
+        }
+    }
+    static const QStringList modern = {"20", "2a", "23", "2b", "26", "2c", "latest"};
+    for (const QString &version : modern) {
+        if (standard.endsWith(version)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+QDataStream &operator<<(QDataStream &out, const ModuleDeps &deps)
+{
+    return out << deps.provides << deps.imports << deps.headerUnits;
+}
+
+QDataStream &operator>>(QDataStream &in, ModuleDeps &deps)
+{
+    return in >> deps.provides >> deps.imports >> deps.headerUnits;
+}
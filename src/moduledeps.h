@@ -0,0 +1,40 @@
+#ifndef MODULEDEPS_H
+#define MODULEDEPS_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+class QDataStream;
+
+// What a translation unit provides and imports in C++20 module terms, as
+// reported by a P1689 dependency scan (GCC 14's -fdeps-format, Clang's
+// clang-scan-deps) or, for compilers without one, read from its module and
+// import declarations.
+struct ModuleDeps
+{
+    QString provides;           // "geo" or "geo:shapes"; empty unless the unit builds a BMI
+    QStringList imports;        // named modules and partitions
+    QStringList headerUnits;    // absolute paths once resolved, "<vector>" / "\"util.h\"" before
+
+    bool usesModules() const { return !provides.isEmpty() || !imports.isEmpty() || !headerUnits.isEmpty(); }
+    bool hasUnresolvedHeaders() const;
+
+    // Cheap pre-filter: only sources that pass are scanned at all
+    static bool mayUseModules(const QByteArray &source);
+    // Module and import declarations outside comments; conditional
+    // compilation isn't evaluated, which is what the P1689 scan is for
+    static ModuleDeps scanSource(const QString &text);
+    static bool parseP1689(const QByteArray &json, ModuleDeps *deps);
+
+    // clang-scan-deps matching a Clang driver, e.g. clang-scan-deps-17 for clang++-17
+    static QString clangScanDepsFor(const QString &compilerCommand);
+    static QString resolveHeader(const QString &name, const QString &sourceDir, const QStringList &includeDirs);
+    // Modules need -std=c++20 or later (/std:c++20 for cl)
+    static bool standardSupportsModules(const QStringList &flags);
+};
+
+QDataStream &operator<<(QDataStream &out, const ModuleDeps &deps);
+QDataStream &operator>>(QDataStream &in, ModuleDeps &deps);
+
+#endif // MODULEDEPS_H
@@ -0,0 +1,324 @@
+#include "outputconsole.h"
+#include <QApplication>
+#include <QClipboard>
+#include <QContextMenuEvent>
+#include <QKeyEvent>
+#include <QMenu>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QScrollBar>
+#include <QTimer>
+
+namespace {
+
+// Longer lines are hard-wrapped so one runaway line can't eat the whole budget
+const int kMaxLineLength = 4096;
+const int kRefreshIntervalMs = 16;
+const int kTextMargin = 6;
+
+const QColor kNormalColor(152, 195, 121);   // #98c379
+const QColor kErrorColor(255, 107, 107);    // #ff6b6b
+
+} // namespace
+
+OutputBuffer::OutputBuffer(int maxLines, qint64 maxChars)
+    : m_head(0)
+    , m_count(0)
+    , m_chars(0)
+    , m_maxChars(maxChars)
+    , m_dropped(0)
+    , m_longestLine(0)
+    , m_lastLineOpen(false)
+{
+    m_lines.resize(qMax(1, maxLines));
+}
+
+void OutputBuffer::startLine(Kind kind)
+{
+    if (m_count == m_lines.size()) {
+        dropOldest();
+    }
+    Line &line = m_lines[slot(m_count)];
+    line.text = QString();
+    line.kind = kind;
+    ++m_count;
+    m_lastLineOpen = true;
+}
+
+void OutputBuffer::dropOldest()
+{
+    Line &line = m_lines[m_head];
+    m_chars -= line.text.size();
+    line.text = QString();      // release the memory now, not when the slot is reused
+    m_head = (m_head + 1) % m_lines.size();
+    --m_count;
+    ++m_dropped;
+}
+
+void OutputBuffer::append(const QString &text, Kind kind)
+{
+    int pos = 0;
+    while (pos < text.size()) {
+        if (text[pos] == '\n' && m_lastLineOpen && lineKind(m_count - 1) == kind) {
+            m_lastLineOpen = false;
+            ++pos;
+            continue;
+        }
+
+        // stdout and stderr interleave; never glue one onto the other's partial line
+        if (!m_lastLineOpen || lineKind(m_count - 1) != kind
+            || m_lines[slot(m_count - 1)].text.size() >= kMaxLineLength) {
+            startLine(kind);
+        }
+
+        QString &line = m_lines[slot(m_count - 1)].text;
+        int newline = text.indexOf('\n', pos);
+        const int end = newline < 0 ? text.size() : newline;
+        const int take = qMin(end - pos, kMaxLineLength - int(line.size()));
+
+        QStringView chunk = QStringView(text).mid(pos, take);
+        if (chunk.endsWith(QChar('\r'))) {
+            chunk.chop(1);
+        }
+        line.append(chunk);
+        m_chars += chunk.size();
+        m_longestLine = qMax(m_longestLine, int(line.size()));
+
+        pos += take;
+        if (pos == newline) {
+            m_lastLineOpen = false;
+            ++pos;
+        }
+    }
+
+    while (m_chars > m_maxChars && m_count > 1) {
+        dropOldest();
+    }
+}
+
+void OutputBuffer::endLine()
+{
+    m_lastLineOpen = false;
+}
+
+void OutputBuffer::clear()
+{
+    for (int i = 0; i < m_count; ++i) {
+        m_lines[slot(i)].text = QString();
+    }
+    m_head = 0;
+    m_count = 0;
+    m_chars = 0;
+    m_dropped = 0;
+    m_longestLine = 0;
+    m_lastLineOpen = false;
+}
+
+OutputConsole::OutputConsole(QWidget *parent)
+    : QAbstractScrollArea(parent)
+    , m_shownDropped(0)
+    , m_followTail(true)
+    , m_selectionAnchor(-1)
+    , m_selectionEnd(-1)
+{
+    QFont font("Consolas", 10);
+    font.setStyleHint(QFont::Monospace);
+    font.setFixedPitch(true);
+    setFont(font);
+    setFocusPolicy(Qt::StrongFocus);
+    viewport()->setCursor(Qt::IBeamCursor);
+
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setSingleShot(true);
+    m_refreshTimer->setInterval(kRefreshIntervalMs);
+    connect(m_refreshTimer, &QTimer::timeout, this, &OutputConsole::refresh);
+
+    connect(verticalScrollBar(), &QScrollBar::valueChanged, [this](int value) {
+        m_followTail = value >= verticalScrollBar()->maximum();
+    });
+}
+
+void OutputConsole::appendText(const QString &text, OutputBuffer::Kind kind)
+{
+    m_buffer.append(text, kind);
+    scheduleRefresh();
+}
+
+void OutputConsole::endLine()
+{
+    m_buffer.endLine();
+}
+
+void OutputConsole::clear()
+{
+    m_buffer.clear();
+    m_shownDropped = 0;
+    m_followTail = true;
+    m_selectionAnchor = m_selectionEnd = -1;
+    refresh();
+    emit droppedLinesChanged(0);
+}
+
+void OutputConsole::scheduleRefresh()
+{
+    if (!m_refreshTimer->isActive()) {
+        m_refreshTimer->start();
+    }
+}
+
+void OutputConsole::refresh()
+{
+    const bool follow = m_followTail;
+    const qint64 dropped = m_buffer.droppedLines();
+
+    updateScrollBars();
+
+    QScrollBar *bar = verticalScrollBar();
+    if (follow) {
+        bar->setValue(bar->maximum());
+    } else if (dropped != m_shownDropped) {
+        // Keep the lines the user is reading in place as older ones fall off
+        bar->setValue(int(qMax<qint64>(0, bar->value() - (dropped - m_shownDropped))));
+    }
+    m_followTail = follow || bar->value() >= bar->maximum();
+
+    if (dropped != m_shownDropped) {
+        m_shownDropped = dropped;
+        emit droppedLinesChanged(dropped);
+    }
+    viewport()->update();
+}
+
+void OutputConsole::updateScrollBars()
+{
+    const int lineHeight = fontMetrics().lineSpacing();
+    const int visibleLines = qMax(1, viewport()->height() / lineHeight);
+    verticalScrollBar()->setPageStep(visibleLines);
+    verticalScrollBar()->setRange(0, qMax(0, m_buffer.lineCount() - visibleLines));
+
+    const int contentWidth = m_buffer.longestLine() * fontMetrics().horizontalAdvance(QLatin1Char('M'))
+                             + 2 * kTextMargin;
+    horizontalScrollBar()->setPageStep(viewport()->width());
+    horizontalScrollBar()->setRange(0, qMax(0, contentWidth - viewport()->width()));
+}
+
+void OutputConsole::resizeEvent(QResizeEvent *event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    const bool follow = m_followTail;
+    updateScrollBars();
+    if (follow) {
+        verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+    }
+}
+
+void OutputConsole::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    QPainter painter(viewport());
+    painter.fillRect(viewport()->rect(), QColor(26, 26, 26));
+    painter.setFont(font());
+
+    const QFontMetrics metrics = fontMetrics();
+    const int lineHeight = metrics.lineSpacing();
+    const int first = verticalScrollBar()->value();
+    const int x = kTextMargin - horizontalScrollBar()->value();
+    const qint64 selectionFirst = qMin(m_selectionAnchor, m_selectionEnd);
+    const qint64 selectionLast = qMax(m_selectionAnchor, m_selectionEnd);
+
+    int y = 0;
+    for (int i = first; i < m_buffer.lineCount() && y < viewport()->height(); ++i, y += lineHeight) {
+        const qint64 absolute = m_buffer.droppedLines() + i;
+        if (m_selectionAnchor >= 0 && absolute >= selectionFirst && absolute <= selectionLast) {
+            painter.fillRect(0, y, viewport()->width(), lineHeight, QColor(38, 79, 120));
+        }
+        painter.setPen(m_buffer.lineKind(i) == OutputBuffer::Error ? kErrorColor : kNormalColor);
+        painter.drawText(x, y + metrics.ascent(), m_buffer.lineText(i));
+    }
+}
+
+int OutputConsole::lineAt(const QPoint &pos) const
+{
+    const int line = verticalScrollBar()->value() + pos.y() / fontMetrics().lineSpacing();
+    return qBound(0, line, qMax(0, m_buffer.lineCount() - 1));
+}
+
+void OutputConsole::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton && m_buffer.lineCount() > 0) {
+        const qint64 line = m_buffer.droppedLines() + lineAt(event->pos());
+        if (!(event->modifiers() & Qt::ShiftModifier) || m_selectionAnchor < 0) {
+            m_selectionAnchor = line;
+        }
+        m_selectionEnd = line;
+        viewport()->update();
+    }
+    QAbstractScrollArea::mousePressEvent(event);
+}
+
+void OutputConsole::mouseMoveEvent(QMouseEvent *event)
+{
+    if ((event->buttons() & Qt::LeftButton) && m_selectionAnchor >= 0) {
+        m_selectionEnd = m_buffer.droppedLines() + lineAt(event->pos());
+        viewport()->update();
+    }
+    QAbstractScrollArea::mouseMoveEvent(event);
+}
+
+QString OutputConsole::textOfLines(qint64 first, qint64 last) const
+{
+    // Lines that were dropped since they were selected are simply gone
+    const int from = int(qMax<qint64>(0, first - m_buffer.droppedLines()));
+    const int to = int(qMin<qint64>(m_buffer.lineCount() - 1, last - m_buffer.droppedLines()));
+    QStringList lines;
+    for (int i = from; i <= to; ++i) {
+        lines.append(m_buffer.lineText(i));
+    }
+    return lines.join('\n');
+}
+
+void OutputConsole::copySelection() const
+{
+    if (m_selectionAnchor < 0) {
+        return;
+    }
+    QApplication::clipboard()->setText(textOfLines(qMin(m_selectionAnchor, m_selectionEnd),
+                                                   qMax(m_selectionAnchor, m_selectionEnd)));
+}
+
+void OutputConsole::keyPressEvent(QKeyEvent *event)
+{
+    if (event->matches(QKeySequence::Copy)) {
+        copySelection();
+        return;
+    }
+    if (event->matches(QKeySequence::SelectAll)) {
+        m_selectionAnchor = m_buffer.droppedLines();
+        m_selectionEnd = m_buffer.droppedLines() + m_buffer.lineCount() - 1;
+        viewport()->update();
+        return;
+    }
+    if (event->key() == Qt::Key_End) {
+        verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+        return;
+    }
+    if (event->key() == Qt::Key_Home) {
+        verticalScrollBar()->setValue(0);
+        return;
+    }
+    QAbstractScrollArea::keyPressEvent(event);
+}
+
+void OutputConsole::contextMenuEvent(QContextMenuEvent *event)
+{
+    QMenu menu(this);
+    QAction *copyAction = menu.addAction(tr("Copy"), [this]() { copySelection(); });
+    copyAction->setEnabled(m_selectionAnchor >= 0);
+    menu.addAction(tr("Copy All"), [this]() {
+        QApplication::clipboard()->setText(textOfLines(m_buffer.droppedLines(),
+                                                       m_buffer.droppedLines() + m_buffer.lineCount() - 1));
+    });
+    menu.addSeparator();
+    menu.addAction(tr("Clear"), this, &OutputConsole::clear);
+    menu.exec(event->globalPos());
+}
@@ -0,0 +1,96 @@
+#ifndef OUTPUTCONSOLE_H
+#define OUTPUTCONSOLE_H
+
+#include <QAbstractScrollArea>
+#include <QString>
+#include <QVector>
+
+class QTimer;
+
+// Fixed-capacity ring of output lines. Once either the line or the character
+// budget is exceeded the oldest lines are dropped, so memory stays bounded
+// no matter how much a program prints.
+class OutputBuffer
+{
+public:
+    enum Kind : quint8 { Normal, Error };
+
+    explicit OutputBuffer(int maxLines = 200000, qint64 maxChars = 16 * 1024 * 1024);
+
+    // Text may hold partial lines; the next append continues them
+    void append(const QString &text, Kind kind);
+    void endLine();
+    void clear();
+
+    int lineCount() const { return m_count; }
+    const QString &lineText(int index) const { return m_lines[slot(index)].text; }
+    Kind lineKind(int index) const { return m_lines[slot(index)].kind; }
+    qint64 droppedLines() const { return m_dropped; }
+    int longestLine() const { return m_longestLine; }
+
+private:
+    struct Line
+    {
+        QString text;
+        Kind kind = Normal;
+    };
+
+    int slot(int index) const { return (m_head + index) % m_lines.size(); }
+    void startLine(Kind kind);
+    void dropOldest();
+
+    QVector<Line> m_lines;
+    int m_head;
+    int m_count;
+    qint64 m_chars;
+    qint64 m_maxChars;
+    qint64 m_dropped;
+    int m_longestLine;
+    bool m_lastLineOpen;
+};
+
+// Read-only console over an OutputBuffer. Only the visible rows are painted,
+// and repaints are coalesced to at most one per frame however fast output
+// arrives.
+class OutputConsole : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+public:
+    explicit OutputConsole(QWidget *parent = nullptr);
+
+    void appendText(const QString &text, OutputBuffer::Kind kind);
+    void endLine();
+    void clear();
+    qint64 droppedLines() const { return m_buffer.droppedLines(); }
+
+signals:
+    void droppedLinesChanged(qint64 droppedLines);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
+    void contextMenuEvent(QContextMenuEvent *event) override;
+
+private:
+    void scheduleRefresh();
+    void refresh();
+    void updateScrollBars();
+    int lineAt(const QPoint &pos) const;
+    void copySelection() const;
+    QString textOfLines(qint64 first, qint64 last) const;
+
+    OutputBuffer m_buffer;
+    QTimer *m_refreshTimer;
+    qint64 m_shownDropped;      // drops already compensated for in the scroll position
+    bool m_followTail;
+
+    // Selection in absolute line numbers (dropped lines included), -1 if none
+    qint64 m_selectionAnchor;
+    qint64 m_selectionEnd;
+};
+
+#endif // OUTPUTCONSOLE_H
@@ -0,0 +1,186 @@
+#include "pchcache.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QRegularExpression>
+#include <QSettings>
+#include <QStandardPaths>
+
+PchCache::PchCache(QObject *parent)
+    : QObject(parent)
+{
+    m_dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/pch";
+
+    QSettings settings("AICodeEditor", "AICodeEditor");
+    m_enabled = settings.value("precompiledHeaders", true).toBool();
+}
+
+PchCache::~PchCache()
+{
+    for (QProcess *process : qAsConst(m_building)) {
+        process->disconnect(this);
+        process->kill();
+        process->waitForFinished(1000);
+    }
+}
+
+void PchCache::setEnabled(bool enabled)
+{
+    m_enabled = enabled;
+    QSettings settings("AICodeEditor", "AICodeEditor");
+    settings.setValue("precompiledHeaders", enabled);
+}
+
+QStringList PchCache::stableIncludePrefix(const QString &sourceText)
+{
+    // Only <system> headers ahead of any other code are taken: they rarely
+    // change, and anything after a #define or user header could alter them
+    static const QRegularExpression includeRe("^#\\s*include\\s*<([^>]+)>\\s*(//.*)?$");
+
+    QStringList headers;
+    bool inComment = false;
+    const QStringList lines = sourceText.split('\n');
+    for (const QString &rawLine : lines) {
+        QString line = rawLine.trimmed();
+        if (inComment) {
+            const int end = line.indexOf("*/");
+            if (end < 0) {
+                continue;
+            }
+            inComment = false;
+            line = line.mid(end + 2).trimmed();
+        }
+        if (line.startsWith("/*")) {
+            const int end = line.indexOf("*/", 2);
+            if (end < 0) {
+                inComment = true;
+                continue;
+            }
+            line = line.mid(end + 2).trimmed();
+        }
+        if (line.isEmpty() || line.startsWith("//") || line == "#pragma once") {
+            continue;
+        }
+
+        const QRegularExpressionMatch match = includeRe.match(line);
+        if (!match.hasMatch()) {
+            break;
+        }
+        headers.append(match.captured(1).trimmed());
+    }
+    return headers;
+}
+
+QString PchCache::headerPath(const QString &key) const
+{
+    return m_dir + "/" + key + "/prefix.h";
+}
+
+QString PchCache::pchPath(const QString &key) const
+{
+    return headerPath(key) + (m_clang.value(key) ? ".pch" : ".gch");
+}
+
+QString PchCache::prepare(const QString &compilerPath, bool clang, const QStringList &flags,
+                          const QString &sourceFile)
+{
+    if (!m_enabled || compilerPath.isEmpty()) {
+        return QString();
+    }
+
+    QFile source(sourceFile);
+    if (!source.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return QString();
+    }
+    const QStringList headers = stableIncludePrefix(QString::fromUtf8(source.readAll()));
+    if (headers.isEmpty()) {
+        return QString();
+    }
+
+    // A PCH is only valid for the exact compiler binary and flags it was built with
+    const QFileInfo compiler(compilerPath);
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(compiler.canonicalFilePath().toUtf8());
+    hash.addData(QByteArray::number(compiler.size()));
+    hash.addData(QByteArray::number(compiler.lastModified().toMSecsSinceEpoch()));
+    hash.addData(flags.join('\n').toUtf8());
+    hash.addData(headers.join('\n').toUtf8());
+    const QString key = QString::fromLatin1(hash.result().toHex().left(24));
+    m_clang.insert(key, clang);
+
+    if (isReady(key) || m_building.contains(key) || m_failed.contains(key)) {
+        return key;
+    }
+
+    QDir().mkpath(m_dir + "/" + key);
+    QFile header(headerPath(key));
+    if (!header.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return QString();
+    }
+    for (const QString &name : headers) {
+        header.write(QString("#include <%1>\n").arg(name).toUtf8());
+    }
+    header.close();
+
+    const QString staging = pchPath(key) + ".tmp";
+    QStringList args = flags;
+    args << "-x" << "c++-header" << headerPath(key) << "-o" << staging;
+
+    QProcess *process = new QProcess(this);
+    process->setProcessChannelMode(QProcess::MergedChannels);
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+            [this, process, key, staging](int exitCode, QProcess::ExitStatus exitStatus) {
+        m_building.remove(key);
+        process->deleteLater();
+
+        bool success = exitStatus == QProcess::NormalExit && exitCode == 0;
+        if (success) {
+            QFile::remove(pchPath(key));
+            success = QFile::rename(staging, pchPath(key));
+        }
+        if (!success) {
+            QFile::remove(staging);
+            m_failed.insert(key);
+        }
+        emit headerBuilt(key, success);
+    });
+    connect(process, &QProcess::errorOccurred, this, [this, process, key](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            m_building.remove(key);
+            m_failed.insert(key);
+            process->deleteLater();
+        }
+    });
+    m_building.insert(key, process);
+    process->start(compilerPath, args);
+    return key;
+}
+
+bool PchCache::isReady(const QString &key) const
+{
+    return !key.isEmpty() && !m_building.contains(key) && QFileInfo::exists(pchPath(key));
+}
+
+QStringList PchCache::usageArguments(const QString &key) const
+{
+    if (!isReady(key)) {
+        return QStringList();
+    }
+    if (m_clang.value(key)) {
+        return {"-include-pch", pchPath(key)};
+    }
+    // GCC picks up prefix.h.gch next to the header; -Winvalid-pch explains a silent fallback
+    return {"-Winvalid-pch", "-include", headerPath(key)};
+}
+
+void PchCache::discard(const QString &key)
+{
+    if (key.isEmpty()) {
+        return;
+    }
+    QFile::remove(pchPath(key));
+    m_failed.remove(key);
+}
@@ -0,0 +1,50 @@
+#ifndef PCHCACHE_H
+#define PCHCACHE_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+
+class QProcess;
+
+// Precompiled headers for the leading block of system #includes in a
+// source file. Each distinct (compiler, flags, header list) combination is
+// built once into the cache location; compiles pick it up as soon as it is
+// ready. GCC (.gch) and Clang (.pch) only.
+class PchCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PchCache(QObject *parent = nullptr);
+    ~PchCache();
+
+    bool isEnabled() const { return m_enabled; }
+    void setEnabled(bool enabled);
+
+    // Key for the header set of sourceFile, or empty when the file has no
+    // stable include prefix. Starts a background build if the PCH is missing.
+    QString prepare(const QString &compilerPath, bool clang, const QStringList &flags,
+                    const QString &sourceFile);
+    bool isReady(const QString &key) const;
+    QStringList usageArguments(const QString &key) const;
+    void discard(const QString &key);
+
+    static QStringList stableIncludePrefix(const QString &sourceText);
+
+signals:
+    void headerBuilt(const QString &key, bool success);
+
+private:
+    QString headerPath(const QString &key) const;
+    QString pchPath(const QString &key) const;
+
+    QString m_dir;
+    bool m_enabled;
+    QHash<QString, bool> m_clang;              // key -> built by clang
+    QHash<QString, QProcess *> m_building;
+    QSet<QString> m_failed;                    // don't retry broken header sets every compile
+};
+
+#endif // PCHCACHE_H
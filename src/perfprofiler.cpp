@@ -0,0 +1,249 @@
+#include "perfprofiler.h"
+#include "guardedinvoke.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QPointer>
+#include <QRegularExpression>
+#include <QStandardPaths>
+#include <QThreadPool>
+#include <QTimer>
+#include <algorithm>
+
+namespace {
+
+// Samples per second; high enough for line-level detail on short runs
+const int kSampleFrequency = 999;
+
+} // namespace
+
+QHash<int, double> ProfileResult::linePercentages(const QString &filePath) const
+{
+    QHash<int, double> percentages;
+    if (totalSamples == 0) {
+        return percentages;
+    }
+    const QHash<int, int> lines = lineSamples.value(QDir::cleanPath(filePath));
+    for (auto it = lines.constBegin(); it != lines.constEnd(); ++it) {
+        percentages.insert(it.key(), 100.0 * it.value() / totalSamples);
+    }
+    return percentages;
+}
+
+PerfProfiler::PerfProfiler(QObject *parent)
+    : QObject(parent)
+    , m_recordProcess(nullptr)
+    , m_analyzing(false)
+    , m_timedOut(false)
+    , m_generation(0)
+{
+}
+
+PerfProfiler::~PerfProfiler()
+{
+    cancel();
+}
+
+bool PerfProfiler::isAvailable()
+{
+    return !QStandardPaths::findExecutable("perf").isEmpty();
+}
+
+void PerfProfiler::start(const QString &executable, int timeoutMs)
+{
+    cancel();
+
+    if (!isAvailable()) {
+        emit failed(tr("perf was not found on PATH; install linux-tools (perf) to profile"));
+        return;
+    }
+
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/perf";
+    QDir().mkpath(dir);
+    m_executable = executable;
+    m_dataFile = dir + "/perf.data";
+    QFile::remove(m_dataFile);
+    m_perfMessages.clear();
+    m_timedOut = false;
+    m_stdoutDecoder = QStringDecoder(QStringDecoder::System);
+    m_stderrDecoder = QStringDecoder(QStringDecoder::System);
+
+    m_recordProcess = new QProcess(this);
+    m_recordProcess->setWorkingDirectory(QFileInfo(executable).absolutePath());
+    connect(m_recordProcess, &QProcess::readyReadStandardOutput, [this]() {
+        emit output(m_stdoutDecoder.decode(m_recordProcess->readAllStandardOutput()), false);
+    });
+    connect(m_recordProcess, &QProcess::readyReadStandardError, [this]() {
+        const QString text = m_stderrDecoder.decode(m_recordProcess->readAllStandardError());
+        // perf's own complaints (paranoid level, missing events) share stderr with the program
+        m_perfMessages += text.right(4096);
+        emit output(text, true);
+    });
+    connect(m_recordProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &PerfProfiler::onRecordFinished);
+    connect(m_recordProcess, &QProcess::errorOccurred, [this](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            const QString message = tr("Failed to start perf: %1").arg(m_recordProcess->errorString());
+            m_recordProcess->deleteLater();
+            m_recordProcess = nullptr;
+            emit failed(message);
+        }
+    });
+
+    if (timeoutMs > 0) {
+        // SIGTERM lets perf flush perf.data; the program's samples so far still count
+        QPointer<QProcess> process(m_recordProcess);
+        QTimer::singleShot(timeoutMs, this, [this, process]() {
+            if (process && process == m_recordProcess) {
+                m_timedOut = true;
+                process->terminate();
+                QTimer::singleShot(2000, process, [process]() {
+                    process->kill();
+                });
+            }
+        });
+    }
+
+    m_recordProcess->start("perf", {"record", "-q", "-F", QString::number(kSampleFrequency),
+                                    "-o", m_dataFile, "--", executable});
+}
+
+void PerfProfiler::cancel()
+{
+    ++m_generation;
+    m_analyzing = false;
+    if (m_recordProcess) {
+        m_recordProcess->disconnect();
+        m_recordProcess->kill();
+        m_recordProcess->waitForFinished(1000);
+        m_recordProcess->deleteLater();
+        m_recordProcess = nullptr;
+    }
+}
+
+void PerfProfiler::onRecordFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    Q_UNUSED(exitStatus);
+    m_recordProcess->deleteLater();
+    m_recordProcess = nullptr;
+
+    const QFileInfo data(m_dataFile);
+    if (!data.exists() || data.size() == 0) {
+        emit failed(tr("perf record produced no data (exit code %1). %2\n"
+                       "If perf_event_paranoid blocks profiling, lower it with: "
+                       "sudo sysctl kernel.perf_event_paranoid=1")
+                        .arg(exitCode).arg(m_perfMessages.trimmed()));
+        return;
+    }
+    if (m_timedOut) {
+        emit output(tr("\n[Profile stopped at the execution timeout]\n"), true);
+    }
+    analyze();
+}
+
+void PerfProfiler::analyze()
+{
+    m_analyzing = true;
+    emit analyzing();
+
+    QPointer<PerfProfiler> guard(this);
+    const int generation = m_generation;
+    const QString dataFile = m_dataFile;
+    const QString executable = m_executable;
+    QThreadPool::globalInstance()->start([guard, generation, dataFile, executable]() {
+        QProcess script;
+        script.start("perf", {"script", "-i", dataFile, "-F", "ip,sym,dso,srcline", "--full-source-path"});
+        script.waitForFinished(-1);
+        const QByteArray text = script.readAllStandardOutput();
+        const QString errors = QString::fromLocal8Bit(script.readAllStandardError()).trimmed();
+        const bool ok = script.exitStatus() == QProcess::NormalExit && script.exitCode() == 0;
+        const ProfileResult result = ok ? parseScript(text, executable) : ProfileResult();
+
+        invokeIfAlive(guard, [guard, generation, ok, errors, result]() {
+            if (generation != guard->m_generation) {
+                return;
+            }
+            guard->m_analyzing = false;
+            if (!ok) {
+                emit guard->failed(tr("perf script failed: %1").arg(errors));
+            } else if (result.totalSamples == 0) {
+                emit guard->failed(tr("No samples were recorded; the program may have exited too quickly"));
+            } else {
+                emit guard->finished(result);
+            }
+        });
+    });
+}
+
+ProfileResult PerfProfiler::parseScript(const QByteArray &script, const QString &executable)
+{
+    ProfileResult result;
+    result.executable = executable;
+
+    // "    55d0c2a1b139 compute (/tmp/prog)" followed by "  /tmp/prog.cpp:7"
+    static const QRegularExpression sampleLine(R"(^\s*([0-9a-f]+)\s+(.*?)\s+\((.*)\)\s*$)");
+    static const QRegularExpression sourceLine(R"(^\s+(.+):(\d+)\s*$)");
+
+    struct FunctionStats
+    {
+        Hotspot hotspot;
+        QHash<QString, QHash<int, int>> lines;
+    };
+    QHash<QString, FunctionStats> functions;    // "symbol\tmodule" -> stats
+    QString currentFunction;
+    bool awaitingSource = false;
+
+    const QList<QByteArray> lines = script.split('\n');
+    for (const QByteArray &raw : lines) {
+        const QString line = QString::fromUtf8(raw);
+        const QRegularExpressionMatch sample = sampleLine.match(line);
+        if (sample.hasMatch()) {
+            const QString module = sample.captured(3);
+            const QString symbol = sample.captured(2).isEmpty() ? QStringLiteral("[unknown]") : sample.captured(2);
+            currentFunction = symbol + '\t' + module;
+            FunctionStats &stats = functions[currentFunction];
+            if (stats.hotspot.samples == 0) {
+                stats.hotspot.symbol = symbol;
+                stats.hotspot.module = QFileInfo(module).fileName();
+            }
+            ++stats.hotspot.samples;
+            ++result.totalSamples;
+            awaitingSource = true;
+            continue;
+        }
+        if (!awaitingSource) {
+            continue;
+        }
+        // Only the first source line belongs to the sample; more may follow for inlined frames
+        awaitingSource = false;
+        const QRegularExpressionMatch source = sourceLine.match(line);
+        if (!source.hasMatch() || source.captured(1).startsWith("??")) {
+            continue;
+        }
+        const QString filePath = QDir::cleanPath(source.captured(1));
+        const int lineNumber = source.captured(2).toInt();
+        if (lineNumber <= 0) {
+            continue;
+        }
+        ++result.lineSamples[filePath][lineNumber];
+        ++functions[currentFunction].lines[filePath][lineNumber];
+    }
+
+    for (FunctionStats &stats : functions) {
+        int best = 0;
+        for (auto file = stats.lines.constBegin(); file != stats.lines.constEnd(); ++file) {
+            for (auto it = file.value().constBegin(); it != file.value().constEnd(); ++it) {
+                if (it.value() > best) {
+                    best = it.value();
+                    stats.hotspot.filePath = file.key();
+                    stats.hotspot.line = it.key();
+                }
+            }
+        }
+        result.hotspots.append(stats.hotspot);
+    }
+    std::sort(result.hotspots.begin(), result.hotspots.end(), [](const Hotspot &a, const Hotspot &b) {
+        return a.samples > b.samples;
+    });
+    return result;
+}
@@ -0,0 +1,72 @@
+#ifndef PERFPROFILER_H
+#define PERFPROFILER_H
+
+#include <QObject>
+#include <QProcess>
+#include <QHash>
+#include <QString>
+#include <QStringDecoder>
+#include <QVector>
+
+struct Hotspot
+{
+    QString symbol;
+    QString module;                 // binary or library the function lives in
+    QString filePath;               // hottest source line of the function, if known
+    int line = 0;
+    int samples = 0;
+};
+
+struct ProfileResult
+{
+    QString executable;
+    int totalSamples = 0;
+    QHash<QString, QHash<int, int>> lineSamples;    // file -> 1-based line -> samples
+    QVector<Hotspot> hotspots;                      // sorted by samples, descending
+
+    // Percentage of all samples per line of one file
+    QHash<int, double> linePercentages(const QString &filePath) const;
+};
+
+// Runs a program under `perf record` and attributes the samples to
+// functions and source lines. perf resolves each address through the
+// binary's DWARF line table (`perf script -F srcline`); the text is parsed
+// and aggregated on a worker thread since large profiles take a while.
+class PerfProfiler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PerfProfiler(QObject *parent = nullptr);
+    ~PerfProfiler();
+
+    void start(const QString &executable, int timeoutMs);
+    void cancel();
+    bool isRunning() const { return m_recordProcess != nullptr || m_analyzing; }
+
+    static bool isAvailable();
+    // Parses `perf script -F ip,sym,dso,srcline` output
+    static ProfileResult parseScript(const QByteArray &script, const QString &executable);
+
+signals:
+    void output(const QString &text, bool isError);     // the program's own output
+    void analyzing();
+    void finished(const ProfileResult &result);
+    void failed(const QString &message);
+
+private:
+    void onRecordFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void analyze();
+
+    QString m_executable;
+    QString m_dataFile;
+    QProcess *m_recordProcess;
+    QStringDecoder m_stdoutDecoder;
+    QStringDecoder m_stderrDecoder;
+    QString m_perfMessages;
+    bool m_analyzing;
+    bool m_timedOut;
+    int m_generation;               // drops results of cancelled analyses
+};
+
+#endif // PERFPROFILER_H
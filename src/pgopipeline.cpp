@@ -0,0 +1,369 @@
+#include "pgopipeline.h"
+#include "compilecache.h"
+#include "diagnosticparser.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QTimer>
+
+namespace {
+
+// Pipelines kept for other files or earlier versions of this one
+const int kMaxCachedRuns = 16;
+
+QString executableName(const QString &name)
+{
+#ifdef Q_OS_WIN
+    return name + ".exe";
+#else
+    return name;
+#endif
+}
+
+} // namespace
+
+PgoTrainingInput PgoTrainingInput::load()
+{
+    QSettings settings("AICodeEditor", "AICodeEditor");
+    PgoTrainingInput training;
+    training.arguments = settings.value("pgoTrainingArguments").toString();
+    training.stdinFile = settings.value("pgoTrainingStdin").toString();
+    return training;
+}
+
+void PgoTrainingInput::save() const
+{
+    QSettings settings("AICodeEditor", "AICodeEditor");
+    settings.setValue("pgoTrainingArguments", arguments);
+    settings.setValue("pgoTrainingStdin", stdinFile);
+}
+
+PgoPipeline::PgoPipeline(QObject *parent)
+    : QObject(parent)
+    , m_clang(false)
+    , m_timeoutMs(0)
+    , m_stage(Idle)
+    , m_process(nullptr)
+    , m_diagnosticsReported(false)
+{
+    m_timeout = new QTimer(this);
+    m_timeout->setSingleShot(true);
+    connect(m_timeout, &QTimer::timeout, [this]() {
+        fail(tr("Training run exceeded the %1 ms timeout").arg(m_timeoutMs));
+    });
+}
+
+QString PgoPipeline::cacheKey(const QString &compilerPath) const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    const QFileInfo compiler(compilerPath);
+    hash.addData(compiler.canonicalFilePath().toUtf8());
+    hash.addData(QByteArray::number(compiler.lastModified().toMSecsSinceEpoch()));
+    hash.addData(m_flags.join('\n').toUtf8());
+    hash.addData(QFileInfo(m_sourceFile).absoluteFilePath().toUtf8());
+    QFile source(m_sourceFile);
+    if (source.open(QIODevice::ReadOnly)) {
+        hash.addData(source.readAll());
+    }
+    hash.addData(m_training.arguments.toUtf8());
+    QFile input(m_training.stdinFile);
+    if (!m_training.stdinFile.isEmpty() && input.open(QIODevice::ReadOnly)) {
+        hash.addData(input.readAll());
+    }
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+QByteArray PgoPipeline::inputsHash() const
+{
+    // Contents of everything the instrumented compile's depfile lists;
+    // empty when the depfile or one of its inputs can't be read
+    QFile depFile(artifact("program.d"));
+    if (!depFile.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    const QDir base(QFileInfo(m_sourceFile).absolutePath());
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for (const QString &dependency : CompileCache::parseDepFile(depFile.readAll())) {
+        QFile input(base.absoluteFilePath(dependency));
+        if (!input.open(QIODevice::ReadOnly)) {
+            return QByteArray();
+        }
+        hash.addData(dependency.toUtf8());
+        hash.addData(&input);
+    }
+    return hash.result().toHex();
+}
+
+QString PgoPipeline::artifact(const QString &name) const
+{
+    return m_dir + '/' + name;
+}
+
+void PgoPipeline::start(const QString &compilerCommand, bool clang, const QStringList &flags,
+                        const QString &sourceFile, const QString &outputPath,
+                        const PgoTrainingInput &training, int timeoutMs)
+{
+    cancel();
+
+    const QString compilerPath = QStandardPaths::findExecutable(compilerCommand);
+    m_compiler = compilerPath.isEmpty() ? compilerCommand : compilerPath;
+    m_clang = clang;
+    m_flags = flags;
+    m_sourceFile = sourceFile;
+    m_outputPath = outputPath;
+    m_training = training;
+    m_timeoutMs = timeoutMs;
+    m_output.clear();
+    m_diagnosticsReported = false;
+
+    const QString root = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/pgo";
+    const QString key = cacheKey(m_compiler);
+    m_dir = root + '/' + key.left(16);
+    QDir().mkpath(m_dir);
+    evictOldRuns(root, m_dir);
+
+    // The key only covers the main file; a changed header invalidates every stage
+    if (QFileInfo::exists(artifact(executableName("instrumented")))) {
+        QFile inputs(artifact("inputs"));
+        const QByteArray hash = inputsHash();
+        if (hash.isEmpty() || !inputs.open(QIODevice::ReadOnly) || inputs.readAll() != hash) {
+            inputs.close();
+            QDir(m_dir).removeRecursively();
+            QDir().mkpath(m_dir);
+        }
+    }
+
+    // Resume from the last stage whose artifacts are still there
+    if (QFileInfo::exists(artifact(executableName("optimized")))) {
+        m_stage = OptimizeLink;
+        // Stay asynchronous so callers see the same signal order as a real build
+        QTimer::singleShot(0, this, [this]() {
+            complete(tr("[PGO] Source, flags and training input unchanged; reusing the optimized build"));
+        });
+    } else if (QFileInfo::exists(artifact("trained"))) {
+        runStage(m_clang && !QFileInfo::exists(artifact("merged.profdata")) ? Merge : OptimizeCompile);
+    } else if (QFileInfo::exists(artifact(executableName("instrumented")))) {
+        runStage(Train);
+    } else {
+        runStage(InstrumentCompile);
+    }
+}
+
+void PgoPipeline::cancel()
+{
+    m_timeout->stop();
+    m_stage = Idle;
+    if (m_process) {
+        m_process->disconnect();
+        m_process->kill();
+        m_process->waitForFinished(1000);
+        m_process->deleteLater();
+        m_process = nullptr;
+    }
+}
+
+void PgoPipeline::runStage(Stage stage)
+{
+    m_stage = stage;
+    if (m_process) {
+        m_process->deleteLater();
+    }
+    m_process = new QProcess(this);
+    m_process->setWorkingDirectory(QFileInfo(m_sourceFile).absolutePath());
+    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &PgoPipeline::onStageFinished);
+    connect(m_process, &QProcess::errorOccurred, [this](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            fail(tr("Failed to start %1: %2").arg(m_process->program(), m_process->errorString()));
+        }
+    });
+
+    const QString profileDir = artifact("profile");
+    const QString object = artifact("program.o");
+    // Both builds compile to the same object path, which is what GCC names
+    // its .gcda files after
+    const QStringList generate = {"-fprofile-generate=" + profileDir};
+    const QStringList use = m_clang
+        ? QStringList{"-fprofile-use=" + artifact("merged.profdata"), "-Wno-profile-instr-unprofiled"}
+        : QStringList{"-fprofile-use=" + profileDir, "-Wno-missing-profile"};
+
+    QString program = m_compiler;
+    QStringList args;
+    switch (stage) {
+    case InstrumentCompile:
+        emit stageStarted(tr("PGO 1/4: building instrumented binary"));
+        args << m_flags << generate << "-c" << m_sourceFile << "-o" << object
+             << "-MMD" << "-MF" << artifact("program.d");
+        break;
+    case InstrumentLink:
+        args << m_flags << generate << object << "-o" << artifact(executableName("instrumented"));
+        break;
+    case Train:
+        emit stageStarted(tr("PGO 2/4: running training input"));
+        QDir(profileDir).removeRecursively();
+        QDir().mkpath(profileDir);
+        QFile::remove(artifact("merged.profdata"));
+        program = artifact(executableName("instrumented"));
+        args = QProcess::splitCommand(m_training.arguments);
+        m_process->setStandardInputFile(m_training.stdinFile.isEmpty() ? QProcess::nullDevice()
+                                                                       : m_training.stdinFile);
+        m_process->setStandardOutputFile(QProcess::nullDevice());
+        m_process->setStandardErrorFile(QProcess::nullDevice());
+        if (m_timeoutMs > 0) {
+            m_timeout->start(m_timeoutMs);
+        }
+        break;
+    case Merge: {
+        emit stageStarted(tr("PGO 3/4: merging profiles"));
+        // llvm-profdata usually sits next to the clang binary it matches
+        program = QFileInfo(QFileInfo(m_compiler).canonicalFilePath()).absolutePath() + "/llvm-profdata";
+        if (!QFileInfo::exists(program)) {
+            program = QStandardPaths::findExecutable("llvm-profdata");
+        }
+        if (program.isEmpty()) {
+            fail(tr("llvm-profdata not found; it is needed to merge Clang profiles"));
+            return;
+        }
+        args << "merge" << "-o" << artifact("merged.profdata");
+        for (const QFileInfo &raw : QDir(profileDir).entryInfoList({"*.profraw"}, QDir::Files)) {
+            args << raw.absoluteFilePath();
+        }
+        break;
+    }
+    case OptimizeCompile:
+        emit stageStarted(tr("PGO 4/4: building optimized binary"));
+        args << m_flags << use << "-c" << m_sourceFile << "-o" << object;
+        break;
+    case OptimizeLink:
+        args << m_flags << use << object << "-o" << artifact(executableName("optimized"));
+        break;
+    case Idle:
+        return;
+    }
+
+    if (stage != Train) {
+        m_process->setProcessChannelMode(QProcess::MergedChannels);
+    }
+    m_process->start(program, args);
+}
+
+void PgoPipeline::onStageFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    m_timeout->stop();
+    const bool success = exitStatus == QProcess::NormalExit && exitCode == 0;
+
+    if (m_stage != Train) {
+        const QString text = QString::fromLocal8Bit(m_process->readAll()).trimmed();
+        if (!text.isEmpty()) {
+            m_output += text + '\n';
+        }
+        if ((m_stage == InstrumentCompile || m_stage == OptimizeCompile) && !m_diagnosticsReported) {
+            m_diagnosticsReported = true;
+            const QVector<Diagnostic> diagnostics =
+                DiagnosticParser::parse(text, QFileInfo(m_sourceFile).absolutePath());
+            if (!diagnostics.isEmpty()) {
+                emit diagnosticsFound(diagnostics);
+            }
+        }
+    }
+
+    switch (m_stage) {
+    case InstrumentCompile:
+        if (success) {
+            QFile inputs(artifact("inputs"));
+            if (inputs.open(QIODevice::WriteOnly)) {
+                inputs.write(inputsHash());
+            }
+            runStage(InstrumentLink);
+        } else {
+            fail(tr("Instrumented build failed"));
+        }
+        break;
+    case InstrumentLink:
+        if (success) {
+            runStage(Train);
+        } else {
+            fail(tr("Linking the instrumented binary failed"));
+        }
+        break;
+    case Train:
+        if (!success) {
+            fail(tr("Training run failed (exit code %1); fix the training input under Build > PGO Training Input")
+                     .arg(exitCode));
+        } else if (QDir(artifact("profile")).isEmpty()) {
+            fail(tr("Training run produced no profile data"));
+        } else {
+            QFile marker(artifact("trained"));
+            marker.open(QIODevice::WriteOnly);
+            runStage(m_clang ? Merge : OptimizeCompile);
+        }
+        break;
+    case Merge:
+        if (success) {
+            runStage(OptimizeCompile);
+        } else {
+            fail(tr("Merging profiles failed"));
+        }
+        break;
+    case OptimizeCompile:
+        if (success) {
+            runStage(OptimizeLink);
+        } else {
+            fail(tr("Optimized build failed"));
+        }
+        break;
+    case OptimizeLink:
+        if (success) {
+            complete(tr("[PGO] Optimized with the training profile"));
+        } else {
+            fail(tr("Linking the optimized binary failed"));
+        }
+        break;
+    case Idle:
+        break;
+    }
+}
+
+void PgoPipeline::complete(const QString &note)
+{
+    if (m_stage == Idle) {
+        return;     // cancelled while a cached result was pending
+    }
+    QFile::remove(m_outputPath);
+    const bool copied = QFile::copy(artifact(executableName("optimized")), m_outputPath);
+    if (copied) {
+        QFile::setPermissions(m_outputPath, QFile::permissions(artifact(executableName("optimized"))));
+    }
+    m_stage = Idle;
+    emit finished(copied, (m_output + (copied ? note : tr("Could not copy the optimized binary to %1").arg(m_outputPath)))
+                              .trimmed());
+}
+
+void PgoPipeline::fail(const QString &message)
+{
+    if (m_stage == Idle) {
+        return;
+    }
+    if (m_stage == Train) {
+        // A partial profile must not be mistaken for a finished one
+        QDir(artifact("profile")).removeRecursively();
+    }
+    cancel();
+    emit finished(false, (m_output + "[PGO] " + message).trimmed());
+}
+
+void PgoPipeline::evictOldRuns(const QString &root, const QString &keep)
+{
+    QFileInfoList runs = QDir(root).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Time);
+    int kept = 0;
+    for (const QFileInfo &run : runs) {
+        if (run.absoluteFilePath() == QFileInfo(keep).absoluteFilePath() || ++kept < kMaxCachedRuns) {
+            continue;
+        }
+        QDir(run.absoluteFilePath()).removeRecursively();
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef PGOPIPELINE_H
+#define PGOPIPELINE_H
+
+#include <QObject>
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+#include "diagnostic.h"
+
+class QTimer;
+
+// Command line and stdin used for the PGO training run
+struct PgoTrainingInput
+{
+    QString arguments;
+    QString stdinFile;
+
+    static PgoTrainingInput load();
+    void save() const;
+};
+
+// One-click profile-guided optimization of a single source file:
+// build instrumented, run the training input, merge the profile (Clang)
+// and rebuild optimized. Each stage's artifacts are kept under a key of
+// the compiler, flags, source text and training input, so an unchanged
+// file resumes from the last finished stage, usually the final binary.
+// The headers the instrumented compile read are hashed too; if one has
+// changed since, the cached stages are discarded.
+class PgoPipeline : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PgoPipeline(QObject *parent = nullptr);
+
+    void start(const QString &compilerCommand, bool clang, const QStringList &flags,
+               const QString &sourceFile, const QString &outputPath,
+               const PgoTrainingInput &training, int timeoutMs);
+    void cancel();
+    bool isRunning() const { return m_stage != Idle; }
+
+signals:
+    void stageStarted(const QString &description);
+    void diagnosticsFound(const QVector<Diagnostic> &diagnostics);
+    void finished(bool success, const QString &output);
+
+private:
+    enum Stage
+    {
+        Idle,
+        InstrumentCompile,
+        InstrumentLink,
+        Train,
+        Merge,
+        OptimizeCompile,
+        OptimizeLink
+    };
+
+    QString cacheKey(const QString &compilerPath) const;
+    QByteArray inputsHash() const;
+    QString artifact(const QString &name) const;
+    void runStage(Stage stage);
+    void onStageFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void complete(const QString &note);
+    void fail(const QString &message);
+    static void evictOldRuns(const QString &root, const QString &keep);
+
+    QString m_compiler;
+    bool m_clang;
+    QStringList m_flags;
+    QString m_sourceFile;
+    QString m_outputPath;
+    PgoTrainingInput m_training;
+    int m_timeoutMs;
+
+    QString m_dir;
+    Stage m_stage;
+    QProcess *m_process;
+    QTimer *m_timeout;
+    QString m_output;
+    bool m_diagnosticsReported;
+};
+
+#endif // PGOPIPELINE_H
@@ -0,0 +1,194 @@
+#include "problemspanel.h"
+#include <QColor>
+#include <QDir>
+#include <QFileInfo>
+#include <QHeaderView>
+#include <QSortFilterProxyModel>
+#include <QVBoxLayout>
+
+ProblemModel::ProblemModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+void ProblemModel::appendDiagnostics(const QVector<Diagnostic> &diagnostics)
+{
+    if (diagnostics.isEmpty()) {
+        return;
+    }
+    beginInsertRows(QModelIndex(), m_diagnostics.size(), m_diagnostics.size() + diagnostics.size() - 1);
+    m_diagnostics += diagnostics;
+    endInsertRows();
+}
+
+void ProblemModel::clear()
+{
+    beginResetModel();
+    m_diagnostics.clear();
+    m_diagnostics.squeeze();
+    endResetModel();
+}
+
+int ProblemModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_diagnostics.size();
+}
+
+int ProblemModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant ProblemModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_diagnostics.size()) {
+        return QVariant();
+    }
+
+    const Diagnostic &diagnostic = m_diagnostics.at(index.row());
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case SeverityColumn:
+            return diagnostic.severity == Diagnostic::Error ? "error"
+                 : diagnostic.severity == Diagnostic::Warning ? "warning" : "note";
+        case FileColumn:
+            return m_rootPath.isEmpty()
+                ? QFileInfo(diagnostic.filePath).fileName()
+                : QDir(m_rootPath).relativeFilePath(diagnostic.filePath);
+        case LineColumn:
+            return diagnostic.line;
+        case MessageColumn:
+            return diagnostic.code.isEmpty()
+                ? diagnostic.message
+                : QString("%1 [%2]").arg(diagnostic.message, diagnostic.code);
+        }
+    }
+    // Sort by severity rank, and numerically by line
+    if (role == Qt::UserRole) {
+        switch (index.column()) {
+        case SeverityColumn: return int(diagnostic.severity);
+        case LineColumn: return diagnostic.line;
+        default: return data(index, Qt::DisplayRole);
+        }
+    }
+    if (role == Qt::ForegroundRole && index.column() == SeverityColumn) {
+        switch (diagnostic.severity) {
+        case Diagnostic::Error: return QColor(244, 71, 71);
+        case Diagnostic::Warning: return QColor(220, 180, 60);
+        case Diagnostic::Note: return QColor(90, 160, 220);
+        }
+    }
+    if (role == Qt::ToolTipRole) {
+        return QString("%1:%2:%3\n%4").arg(diagnostic.filePath).arg(diagnostic.line)
+                                      .arg(diagnostic.column).arg(diagnostic.message);
+    }
+    return QVariant();
+}
+
+QVariant ProblemModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    switch (section) {
+    case SeverityColumn: return tr("Severity");
+    case FileColumn: return tr("File");
+    case LineColumn: return tr("Line");
+    case MessageColumn: return tr("Message");
+    }
+    return QVariant();
+}
+
+ProblemsPanel::ProblemsPanel(QWidget *parent)
+    : QWidget(parent)
+    , m_errorCount(0)
+    , m_warningCount(0)
+{
+    m_model = new ProblemModel(this);
+    m_proxy = new QSortFilterProxyModel(this);
+    m_proxy->setSourceModel(m_model);
+    m_proxy->setSortRole(Qt::UserRole);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(8, 8, 8, 8);
+
+    m_view = new QTableView(this);
+    m_view->setModel(m_proxy);
+    m_view->setSortingEnabled(true);
+    m_view->sortByColumn(-1, Qt::AscendingOrder);   // compiler order until a header is clicked
+    m_view->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_view->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_view->setWordWrap(false);
+    m_view->setShowGrid(false);
+    m_view->verticalHeader()->hide();
+    // Fixed row heights keep the view from measuring every row of a large flood
+    m_view->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_view->verticalHeader()->setDefaultSectionSize(m_view->fontMetrics().height() + 6);
+    m_view->horizontalHeader()->setStretchLastSection(true);
+    m_view->horizontalHeader()->resizeSection(ProblemModel::SeverityColumn, 80);
+    m_view->horizontalHeader()->resizeSection(ProblemModel::FileColumn, 200);
+    m_view->horizontalHeader()->resizeSection(ProblemModel::LineColumn, 60);
+    m_view->setStyleSheet(R"(
+        QTableView {
+            background-color: #1e1e1e;
+            border: 1px solid #3d3d3d;
+            border-radius: 6px;
+        }
+        QTableView::item:selected {
+            background-color: #0078d7;
+        }
+    )");
+    connect(m_view, &QTableView::activated, [this](const QModelIndex &index) {
+        const Diagnostic &diagnostic = m_model->diagnosticAt(m_proxy->mapToSource(index).row());
+        emit problemActivated(diagnostic.filePath, diagnostic.line, qMax(0, diagnostic.column - 1));
+    });
+    layout->addWidget(m_view, 1);
+
+    m_summaryLabel = new QLabel(this);
+    m_summaryLabel->setStyleSheet("color: #888;");
+    layout->addWidget(m_summaryLabel);
+}
+
+void ProblemsPanel::setRootPath(const QString &rootPath)
+{
+    m_model->setRootPath(rootPath);
+}
+
+void ProblemsPanel::appendDiagnostics(const QVector<Diagnostic> &diagnostics)
+{
+    for (const Diagnostic &diagnostic : diagnostics) {
+        if (diagnostic.severity == Diagnostic::Error) {
+            ++m_errorCount;
+        } else if (diagnostic.severity == Diagnostic::Warning) {
+            ++m_warningCount;
+        }
+    }
+    m_model->appendDiagnostics(diagnostics);
+    updateSummary();
+}
+
+void ProblemsPanel::clear()
+{
+    m_model->clear();
+    m_errorCount = 0;
+    m_warningCount = 0;
+    updateSummary();
+}
+
+QVector<Diagnostic> ProblemsPanel::diagnosticsForFile(const QString &filePath) const
+{
+    QVector<Diagnostic> result;
+    const QString cleanPath = QDir::cleanPath(filePath);
+    for (const Diagnostic &diagnostic : m_model->diagnostics()) {
+        if (diagnostic.filePath == cleanPath) {
+            result.append(diagnostic);
+        }
+    }
+    return result;
+}
+
+void ProblemsPanel::updateSummary()
+{
+    m_summaryLabel->setText(tr("%1 errors, %2 warnings, %3 total")
+                                .arg(m_errorCount).arg(m_warningCount).arg(m_model->rowCount()));
+}
@@ -0,0 +1,64 @@
+#ifndef PROBLEMSPANEL_H
+#define PROBLEMSPANEL_H
+
+#include <QWidget>
+#include <QAbstractTableModel>
+#include <QTableView>
+#include <QLabel>
+#include "diagnostic.h"
+
+class QSortFilterProxyModel;
+
+class ProblemModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column { SeverityColumn, FileColumn, LineColumn, MessageColumn, ColumnCount };
+
+    explicit ProblemModel(QObject *parent = nullptr);
+
+    void setRootPath(const QString &rootPath) { m_rootPath = rootPath; }
+    void appendDiagnostics(const QVector<Diagnostic> &diagnostics);
+    void clear();
+    const Diagnostic &diagnosticAt(int row) const { return m_diagnostics.at(row); }
+    const QVector<Diagnostic> &diagnostics() const { return m_diagnostics; }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    QString m_rootPath;
+    QVector<Diagnostic> m_diagnostics;
+};
+
+class ProblemsPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit ProblemsPanel(QWidget *parent = nullptr);
+
+    void setRootPath(const QString &rootPath);
+    void appendDiagnostics(const QVector<Diagnostic> &diagnostics);
+    void clear();
+    QVector<Diagnostic> diagnosticsForFile(const QString &filePath) const;
+    int errorCount() const { return m_errorCount; }
+
+signals:
+    void problemActivated(const QString &filePath, int line, int column);
+
+private:
+    void updateSummary();
+
+    ProblemModel *m_model;
+    QSortFilterProxyModel *m_proxy;
+    QTableView *m_view;
+    QLabel *m_summaryLabel;
+    int m_errorCount;
+    int m_warningCount;
+};
+
+#endif // PROBLEMSPANEL_H
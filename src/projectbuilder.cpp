@@ -0,0 +1,881 @@
+#include "projectbuilder.h"
+#include "compilecache.h"
+#include "diagnosticparser.h"
+#include "filesearchservice.h"
+#include "toolchainprobe.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+#include <QThread>
+
+namespace {
+
+const quint32 kGraphMagic = 0x41494247;    // "AIBG"
+const quint32 kGraphVersion = 2;
+
+// Module interface units go by several extensions, none of them standard
+const QStringList kModuleSuffixes = {"cppm", "ixx", "mpp", "cxxm"};
+const QStringList kSourceSuffixes = QStringList{"c", "cpp", "cc", "cxx"} + kModuleSuffixes;
+
+qint64 modificationTime(const QString &path)
+{
+    const QFileInfo info(path);
+    return info.exists() ? info.lastModified().toMSecsSinceEpoch() : -1;
+}
+
+ModuleDeps scanFile(const QString &path)
+{
+    QFile file(path);
+    return file.open(QIODevice::ReadOnly) ? ModuleDeps::scanSource(QString::fromUtf8(file.readAll()))
+                                          : ModuleDeps();
+}
+
+QByteArray importsHashOf(QStringList keys)
+{
+    keys.sort();
+    return QCryptographicHash::hash(keys.join('\n').toUtf8(), QCryptographicHash::Sha1);
+}
+
+} // namespace
+
+ProjectBuilder::ProjectBuilder(QObject *parent)
+    : QObject(parent)
+    , m_msvc(false)
+    , m_clang(false)
+    , m_maxJobs(qMax(1, QThread::idealThreadCount()))
+    , m_building(false)
+    , m_failed(false)
+    , m_relink(false)
+    , m_totalJobs(0)
+    , m_finishedJobs(0)
+    , m_compiledObjects(0)
+    , m_linkProcess(nullptr)
+    , m_p1689(false)
+{
+}
+
+ProjectBuilder::~ProjectBuilder()
+{
+    cancel();
+}
+
+QString ProjectBuilder::executablePathFor(const QString &rootPath)
+{
+    const QString name = QDir(rootPath).dirName().isEmpty() ? "a" : QDir(rootPath).dirName();
+#ifdef Q_OS_WIN
+    return rootPath + "/" + name + ".exe";
+#else
+    return rootPath + "/" + name;
+#endif
+}
+
+QString ProjectBuilder::buildDir() const
+{
+    // Objects stay out of the workspace so they never show up in search or quick open
+    const QByteArray key = QCryptographicHash::hash(QDir::cleanPath(m_rootPath).toUtf8(),
+                                                    QCryptographicHash::Sha1).toHex().left(16);
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/builds/"
+           + QString::fromLatin1(key);
+}
+
+QString ProjectBuilder::objectPathFor(const QString &source) const
+{
+    // Mirror the source tree so a/util.cpp and b/util.cpp don't collide
+    const QString relative = QDir(m_rootPath).relativeFilePath(source);
+    return buildDir() + "/obj/" + relative + (m_msvc ? ".obj" : ".o");
+}
+
+void ProjectBuilder::build(const QString &rootPath, const QString &compilerCommand,
+                           const QByteArray &compilerIdentity, const QStringList &flags, bool msvc, bool clang)
+{
+    cancel();
+
+    m_rootPath = QDir::cleanPath(rootPath);
+    m_compiler = compilerCommand;
+    m_flags = flags;
+    m_msvc = msvc;
+    m_clang = clang;
+    m_building = true;
+    m_failed = false;
+    m_relink = false;
+    m_output.clear();
+    m_jobs.clear();
+    m_queue.clear();
+    m_objects.clear();
+    m_finishedJobs = 0;
+    m_compiledObjects = 0;
+    m_scanQueue.clear();
+    m_providers.clear();
+    m_bmis.clear();
+    m_bmiKeys.clear();
+    // GCC 14+ writes P1689 itself; Clang needs the matching clang-scan-deps
+    m_scanTool = clang ? ModuleDeps::clangScanDepsFor(compilerCommand) : compilerCommand;
+    m_p1689 = !msvc && !m_scanTool.isEmpty();
+
+    QCryptographicHash commandHash(QCryptographicHash::Sha1);
+    commandHash.addData(compilerCommand.toUtf8());
+    commandHash.addData(compilerIdentity);
+    commandHash.addData(flags.join('\n').toUtf8());
+    m_commandHash = commandHash.result();
+
+    loadGraph();
+
+    QStringList sources = FileSearchService::listWorkspaceFiles(m_rootPath, kSourceSuffixes);
+    sources.sort();
+    for (const QString &source : qAsConst(sources)) {
+        CompileJob job;
+        job.source = QDir::cleanPath(source);
+        job.object = objectPathFor(job.source);
+        job.depFile = job.object + (m_msvc ? ".json" : ".d");
+        job.stale = isStale(job);
+        // Module dependencies only change when the source does
+        if (!job.stale) {
+            job.modules = m_graph.value(job.object).modules;
+        } else if (QFileInfo(job.source).suffix() != "c") {
+            QFile file(job.source);
+            if (file.open(QIODevice::ReadOnly) && ModuleDeps::mayUseModules(file.readAll())) {
+                m_scanQueue.append(m_jobs.size());
+            }
+        }
+        m_objects.append(job.object);
+        m_jobs.append(job);
+    }
+
+    // Forget objects whose sources were deleted; header units are only
+    // known once modules are planned
+    const QString headerUnitDir = buildDir() + "/bmi/";
+    for (auto it = m_graph.begin(); it != m_graph.end();) {
+        if (!m_objects.contains(it.key()) && !it.key().startsWith(headerUnitDir)) {
+            QFile::remove(it.key());
+            it = m_graph.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    if (m_objects.isEmpty()) {
+        m_output = tr("No C/C++ sources found in %1").arg(m_rootPath);
+        finish(false);
+        return;
+    }
+
+    if (!m_scanQueue.isEmpty()) {
+        emit stageChanged(tr("Scanning module dependencies..."));
+    }
+    scanModules();
+}
+
+bool ProjectBuilder::isStale(const CompileJob &job) const
+{
+    const auto it = m_graph.constFind(job.object);
+    if (it == m_graph.constEnd() || it->commandHash != m_commandHash) {
+        return true;
+    }
+    const qint64 objectTime = modificationTime(job.object);
+    if (objectTime < 0) {
+        return true;
+    }
+    for (int i = 0; i < it->dependencies.size(); ++i) {
+        const qint64 mtime = modificationTime(it->dependencies[i]);
+        if (mtime < 0 || mtime != it->mtimes.value(i) || mtime > objectTime) {
+            return true;
+        }
+    }
+    return it->dependencies.isEmpty();
+}
+
+void ProjectBuilder::scanModules()
+{
+    while (!m_scanQueue.isEmpty() && m_scanning.size() < m_maxJobs) {
+        const int index = m_scanQueue.takeFirst();
+        CompileJob &job = m_jobs[index];
+        if (!m_p1689) {
+            job.modules = scanFile(job.source);
+            continue;
+        }
+
+        QDir().mkpath(QFileInfo(job.object).absolutePath());
+        QStringList args;
+        if (m_clang) {
+            args << "-format=p1689" << "--" << m_compiler << m_flags << "-c" << job.source << "-o" << job.object;
+        } else {
+            const QString ddi = job.object + ".ddi";
+            args = m_flags;
+            args << "-fmodules-ts" << "-E" << "-x" << "c++" << job.source
+                 << "-MT" << ddi << "-MD" << "-MF" << job.object + ".scan.d"
+                 << "-fdeps-format=p1689r5" << ("-fdeps-file=" + ddi) << ("-fdeps-target=" + job.object)
+                 << "-o" << job.object + ".i";
+        }
+
+        QProcess *process = new QProcess(this);
+        process->setWorkingDirectory(m_rootPath);
+        connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+                [this, process, index](int exitCode, QProcess::ExitStatus exitStatus) {
+            onScanFinished(process, index, exitCode, exitStatus);
+        });
+        connect(process, &QProcess::errorOccurred, this, [this, process, index](QProcess::ProcessError error) {
+            // Queued: start() reports this synchronously, in the middle of the loop above
+            if (error == QProcess::FailedToStart) {
+                QMetaObject::invokeMethod(this, [this, process, index]() {
+                    onScanFinished(process, index, -1, QProcess::CrashExit);
+                }, Qt::QueuedConnection);
+            }
+        });
+        m_scanning.insert(process, index);
+        process->start(m_scanTool, args);
+    }
+
+    if (m_scanning.isEmpty()) {
+        planModules();
+    }
+}
+
+void ProjectBuilder::onScanFinished(QProcess *process, int index, int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if (!m_scanning.remove(process)) {
+        return;
+    }
+    process->deleteLater();
+
+    CompileJob &job = m_jobs[index];
+    const QString ddi = job.object + ".ddi";
+    QByteArray json;
+    if (m_clang) {
+        json = process->readAllStandardOutput();
+    } else {
+        QFile file(ddi);
+        if (file.open(QIODevice::ReadOnly)) {
+            json = file.readAll();
+        }
+    }
+    for (const QString &temporary : {ddi, job.object + ".scan.d", job.object + ".i"}) {
+        QFile::remove(temporary);
+    }
+
+    const bool scanned = exitStatus == QProcess::NormalExit && exitCode == 0
+                         && ModuleDeps::parseP1689(json, &job.modules);
+    if (!scanned) {
+        // GCC before 14 has no -fdeps-format. A source that fails to
+        // preprocess gets its diagnostics from the compile instead.
+        if (process->error() == QProcess::FailedToStart
+            || (!m_clang && process->readAllStandardError().contains("fdeps"))) {
+            m_p1689 = false;
+        }
+        job.modules = scanFile(job.source);
+    }
+    scanModules();
+}
+
+QStringList ProjectBuilder::includeDirs() const
+{
+    // -I directories from the flags, then the compiler's default search list
+    // as the toolchain probe recorded it, so <vector> resolves to the header
+    // the compiler will read
+    QStringList dirs;
+    for (int i = 0; i < m_flags.size(); ++i) {
+        if (m_flags[i] == "-I" && i + 1 < m_flags.size()) {
+            dirs << QDir(m_rootPath).absoluteFilePath(m_flags[++i]);
+        } else if (m_flags[i].startsWith("-I")) {
+            dirs << QDir(m_rootPath).absoluteFilePath(m_flags[i].mid(2));
+        }
+    }
+    return dirs + ToolchainProbe::cachedFor(m_compiler).includePaths;
+}
+
+void ProjectBuilder::planModules()
+{
+    bool usesModules = false;
+    bool unresolved = false;
+    for (const CompileJob &job : qAsConst(m_jobs)) {
+        usesModules = usesModules || job.modules.usesModules();
+        unresolved = unresolved || job.modules.hasUnresolvedHeaders();
+    }
+    const QStringList searchDirs = unresolved ? includeDirs() : QStringList();
+
+    QStringList errors;
+    if (usesModules) {
+        if (m_msvc) {
+            m_output = tr("C++20 modules are only built with GCC or Clang.");
+            finish(false);
+            return;
+        }
+        if (!ModuleDeps::standardSupportsModules(m_flags)) {
+            m_output = tr("This project uses C++20 modules. Choose C++20 or later under "
+                          "Build > Language Standard.");
+            finish(false);
+            return;
+        }
+        const QDir base(m_rootPath);
+        const int sourceCount = m_jobs.size();
+        QVector<CompileJob> headerJobs;
+        QSet<QString> headers;
+        for (int i = 0; i < sourceCount; ++i) {
+            CompileJob &job = m_jobs[i];
+            const QString relative = base.relativeFilePath(job.source);
+            const QString sourceDir = QFileInfo(job.source).absolutePath();
+            for (QString &header : job.modules.headerUnits) {
+                const QString path = ModuleDeps::resolveHeader(header, sourceDir, searchDirs);
+                if (path.isEmpty()) {
+                    errors << tr("%1: cannot find header unit %2").arg(relative, header);
+                    if (ToolchainProbe::cachedFor(m_compiler).path.isEmpty()) {
+                        errors << tr("The include paths of %1 aren't known until Build > Toolchains... "
+                                     "has detected it.").arg(m_compiler);
+                    }
+                    continue;
+                }
+                header = path;
+                if (!headers.contains(path)) {
+                    headers.insert(path);
+                    const QString name = QString::fromLatin1(
+                        QCryptographicHash::hash(path.toUtf8(), QCryptographicHash::Sha1).toHex().left(16));
+                    CompileJob headerJob;
+                    headerJob.source = path;
+                    headerJob.headerUnit = true;
+                    headerJob.bmiOutput = buildDir() + "/bmi/" + name + (m_clang ? ".pcm" : ".gcm");
+                    headerJob.object = headerJob.bmiOutput;
+                    headerJob.depFile = headerJob.bmiOutput + ".d";
+                    headerJob.stale = isStale(headerJob);
+                    headerJobs.append(headerJob);
+                }
+            }
+
+            const QString &provides = job.modules.provides;
+            if (provides.isEmpty()) {
+                continue;
+            }
+            if (m_providers.contains(provides)) {
+                errors << tr("%1: module %2 is already provided by %3")
+                              .arg(relative, provides, base.relativeFilePath(m_jobs[m_providers[provides]].source));
+            } else {
+                m_providers.insert(provides, i);
+            }
+        }
+
+        for (int i = 0; i < sourceCount; ++i) {
+            for (const QString &name : qAsConst(m_jobs[i].modules.imports)) {
+                if (!m_providers.contains(name)) {
+                    errors << tr("%1: no source in the project provides module %2")
+                                  .arg(base.relativeFilePath(m_jobs[i].source), name);
+                }
+            }
+        }
+
+        QVector<int> visitState(sourceCount, 0);
+        for (int i = 0; i < sourceCount && errors.isEmpty(); ++i) {
+            QString error;
+            if (!collectClosure(i, visitState, &error)) {
+                errors << error;
+            }
+        }
+        m_jobs += headerJobs;
+    }
+
+    if (!errors.isEmpty()) {
+        errors.removeDuplicates();
+        m_output = errors.join('\n');
+        finish(false);
+        return;
+    }
+
+    // Module users are queued even when current: whether they are depends on
+    // the BMIs they import, which are only known once those are resolved
+    for (int i = 0; i < m_jobs.size(); ++i) {
+        const CompileJob &job = m_jobs[i];
+        if (job.stale || job.headerUnit || job.modules.usesModules()) {
+            m_queue.append(i);
+        }
+    }
+    m_totalJobs = m_queue.size();
+    emit progress(0, m_totalJobs);
+    if (m_queue.isEmpty()) {
+        link();
+    } else {
+        startJobs();
+    }
+}
+
+bool ProjectBuilder::collectClosure(int index, QVector<int> &visitState, QString *error)
+{
+    // 0 unvisited, 1 on the current path, 2 done
+    if (visitState[index] == 2) {
+        return true;
+    }
+    if (visitState[index] == 1) {
+        *error = tr("Module import cycle through %1").arg(m_jobs[index].modules.provides);
+        return false;
+    }
+    visitState[index] = 1;
+
+    QStringList modules;
+    QStringList headers = m_jobs[index].modules.headerUnits;
+    const QStringList imports = m_jobs[index].modules.imports;
+    for (const QString &name : imports) {
+        const int provider = m_providers.value(name);
+        if (!collectClosure(provider, visitState, error)) {
+            return false;
+        }
+        modules << name << m_jobs[provider].moduleClosure;
+        headers << m_jobs[provider].headerClosure;
+    }
+    modules.removeDuplicates();
+    headers.removeDuplicates();
+    m_jobs[index].moduleClosure = modules;
+    m_jobs[index].headerClosure = headers;
+    visitState[index] = 2;
+    return true;
+}
+
+bool ProjectBuilder::isReady(const CompileJob &job) const
+{
+    for (const QString &name : job.moduleClosure) {
+        if (!m_bmis.contains(name)) {
+            return false;
+        }
+    }
+    for (const QString &header : job.headerClosure) {
+        if (!m_bmis.contains(header)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+QStringList ProjectBuilder::importKeys(const CompileJob &job) const
+{
+    QStringList keys;
+    for (const QString &name : job.moduleClosure + job.headerClosure) {
+        keys << name + "=" + m_bmiKeys.value(name);
+    }
+    return keys;
+}
+
+bool ProjectBuilder::resolveWithoutCompile(int index)
+{
+    CompileJob &job = m_jobs[index];
+    const QStringList keys = importKeys(job);
+    const QByteArray importsHash = importsHashOf(keys);
+    ObjectRecord record = m_graph.value(job.object);
+    // What the job builds a BMI of, if anything
+    const QString name = job.headerUnit ? job.source : job.modules.provides;
+    if (name.isEmpty()) {
+        // Current unless it or a BMI it imports changed
+        return !job.stale && record.importsHash == importsHash;
+    }
+
+    // Unchanged since the last build: its BMI is in the cache or, with the
+    // cache off, still where the compile wrote it
+    const QString localBmi = job.headerUnit ? job.bmiOutput : job.object + (m_clang ? ".pcm" : ".gcm");
+    if (!job.stale && record.importsHash == importsHash && !record.bmiKey.isEmpty()
+        && !m_bmiCache.contains(record.bmiKey, m_clang, !job.headerUnit) && QFileInfo::exists(localBmi)) {
+        m_bmis.insert(name, localBmi);
+        m_bmiKeys.insert(name, record.bmiKey);
+        return true;
+    }
+
+    QString key;
+    if (!job.stale && record.importsHash == importsHash && m_bmiCache.contains(record.bmiKey, m_clang, !job.headerUnit)) {
+        key = record.bmiKey;
+    } else {
+        // Same content as an earlier build, e.g. after switching back to a
+        // branch. The inputs are the ones the last compile's depfile listed.
+        const QStringList inputs = record.dependencies.isEmpty() ? QStringList{job.source} : record.dependencies;
+        key = BmiCache::key(m_commandHash, name, inputs, keys);
+        if (!m_bmiCache.contains(key, m_clang, !job.headerUnit)) {
+            return false;
+        }
+        if (!job.headerUnit) {
+            QDir().mkpath(QFileInfo(job.object).absolutePath());
+            QFile::remove(job.object);
+            if (!QFile::copy(m_bmiCache.objectPath(key), job.object)) {
+                return false;
+            }
+            m_relink = true;
+        }
+        record.commandHash = m_commandHash;
+        record.dependencies = inputs;
+        record.mtimes.clear();
+        for (const QString &input : inputs) {
+            record.mtimes.append(modificationTime(input));
+        }
+        record.modules = job.modules;
+        record.bmiKey = key;
+        record.importsHash = importsHash;
+        m_graph.insert(job.object, record);
+    }
+    m_bmiCache.touch(key);
+    m_bmis.insert(name, m_bmiCache.bmiPath(key, m_clang));
+    m_bmiKeys.insert(name, key);
+    return true;
+}
+
+QString ProjectBuilder::writeModuleMapper(const CompileJob &job) const
+{
+    // GCC's module mapper: one "name bmi-path" line per module it may meet
+    const QString path = job.headerUnit ? QFileInfo(job.bmiOutput).absolutePath() + "/"
+                                              + QFileInfo(job.bmiOutput).completeBaseName() + ".map"
+                                        : job.object + ".map";
+    QStringList lines;
+    for (const QString &name : job.moduleClosure + job.headerClosure) {
+        lines << name + " " + m_bmis.value(name);
+    }
+    if (job.headerUnit) {
+        lines << job.source + " " + job.bmiOutput;
+    } else if (!job.modules.provides.isEmpty()) {
+        lines << job.modules.provides + " " + job.bmiOutput;
+    }
+
+    QSaveFile file(path);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(lines.join('\n').toUtf8() + "\n");
+        file.commit();
+    }
+    return path;
+}
+
+QStringList ProjectBuilder::compileArguments(CompileJob &job)
+{
+    QStringList args = m_flags;
+    if (m_msvc) {
+        args << "/nologo" << "/c" << job.source << ("/Fo" + job.object)
+             << "/sourceDependencies" << job.depFile;
+        return args;
+    }
+
+    if (job.headerUnit) {
+        QDir().mkpath(QFileInfo(job.bmiOutput).absolutePath());
+        if (m_clang) {
+            args << "-fmodule-header" << "-x" << "c++-header" << job.source << "--precompile" << "-o" << job.bmiOutput;
+        } else {
+            args << "-fmodules-ts" << ("-fmodule-mapper=" + writeModuleMapper(job))
+                 << "-fmodule-header" << "-x" << "c++-header" << job.source << "-c";
+        }
+        // The headers it pulls in are part of its cache key
+        args << "-MMD" << "-MF" << job.depFile;
+        return args;
+    }
+
+    QDir().mkpath(QFileInfo(job.object).absolutePath());
+    const bool provides = !job.modules.provides.isEmpty();
+    job.bmiOutput = provides ? job.object + (m_clang ? ".pcm" : ".gcm") : QString();
+    if (job.modules.usesModules()) {
+        if (m_clang) {
+            for (const QString &name : qAsConst(job.moduleClosure)) {
+                args << ("-fmodule-file=" + name + "=" + m_bmis.value(name));
+            }
+            for (const QString &header : qAsConst(job.headerClosure)) {
+                args << ("-fmodule-file=" + m_bmis.value(header));
+            }
+            if (provides) {
+                args << ("-fmodule-output=" + job.bmiOutput);
+            }
+        } else {
+            args << "-fmodules-ts" << ("-fmodule-mapper=" + writeModuleMapper(job));
+        }
+    }
+    // Neither driver knows the interface extensions
+    if (m_clang && provides) {
+        args << "-x" << "c++-module";
+    } else if (kModuleSuffixes.contains(QFileInfo(job.source).suffix())) {
+        args << "-x" << "c++";
+    }
+    args << "-c" << job.source << "-o" << job.object << "-MMD" << "-MF" << job.depFile;
+    return args;
+}
+
+void ProjectBuilder::startJobs()
+{
+    while (!m_failed && m_running.size() < m_maxJobs) {
+        // Queue order, skipping jobs whose imports aren't built yet
+        int position = -1;
+        for (int i = 0; i < m_queue.size() && position < 0; ++i) {
+            if (isReady(m_jobs[m_queue[i]])) {
+                position = i;
+            }
+        }
+        if (position < 0) {
+            break;
+        }
+        const int index = m_queue.takeAt(position);
+        if (resolveWithoutCompile(index)) {
+            ++m_finishedJobs;
+            emit progress(m_finishedJobs, m_totalJobs);
+            continue;
+        }
+
+        const QStringList args = compileArguments(m_jobs[index]);
+        QProcess *process = new QProcess(this);
+        process->setProcessChannelMode(QProcess::MergedChannels);
+        process->setWorkingDirectory(m_rootPath);
+        connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+                [this, process, index](int exitCode, QProcess::ExitStatus exitStatus) {
+            onJobFinished(process, index, exitCode, exitStatus);
+        });
+        connect(process, &QProcess::errorOccurred, this, [this, process, index](QProcess::ProcessError error) {
+            if (error == QProcess::FailedToStart) {
+                QMetaObject::invokeMethod(this, [this, process, index]() {
+                    onJobFinished(process, index, -1, QProcess::CrashExit);
+                }, Qt::QueuedConnection);
+            }
+        });
+        m_running.insert(process, index);
+        process->start(m_compiler, args);
+    }
+
+    if (m_running.isEmpty()) {
+        if (!m_failed && !m_queue.isEmpty()) {
+            m_failed = true;
+            m_output += tr("Some modules could not be built in any order.") + "\n";
+        }
+        saveGraph();
+        if (m_failed) {
+            finish(false);
+        } else {
+            link();
+        }
+    }
+}
+
+void ProjectBuilder::onJobFinished(QProcess *process, int index, int exitCode, QProcess::ExitStatus exitStatus)
+{
+    if (!m_running.remove(process)) {
+        return;
+    }
+    process->deleteLater();
+
+    const CompileJob &job = m_jobs[index];
+    const QString relative = QDir(m_rootPath).relativeFilePath(job.source);
+    QString text = QString::fromLocal8Bit(process->readAll()).trimmed();
+    if (m_msvc && text == QFileInfo(job.source).fileName()) {
+        text.clear();   // cl echoes the file name it compiled
+    }
+    if (process->error() == QProcess::FailedToStart) {
+        text = tr("Failed to start %1: %2").arg(m_compiler, process->errorString());
+    }
+
+    const QVector<Diagnostic> diagnostics = DiagnosticParser::parse(text, m_rootPath);
+    if (!diagnostics.isEmpty()) {
+        emit diagnosticsFound(diagnostics);
+    }
+
+    if (exitStatus == QProcess::NormalExit && exitCode == 0) {
+        const QStringList keys = importKeys(job);
+        ObjectRecord record;
+        record.commandHash = m_commandHash;
+        record.dependencies = readDependencies(job);
+        for (const QString &dependency : qAsConst(record.dependencies)) {
+            record.mtimes.append(modificationTime(dependency));
+        }
+        record.modules = job.modules;
+        record.importsHash = importsHashOf(keys);
+        const QString name = job.headerUnit ? job.source : job.modules.provides;
+        if (!name.isEmpty()) {
+            // Keyed on everything the depfile lists, so an edit to a header
+            // that a header unit includes produces a new BMI
+            const QString key = BmiCache::key(m_commandHash, name, record.dependencies, keys);
+            const bool cached = m_bmiCache.store(key, m_clang, job.bmiOutput,
+                                                 job.headerUnit ? QString() : job.object);
+            m_bmis.insert(name, cached ? m_bmiCache.bmiPath(key, m_clang) : job.bmiOutput);
+            m_bmiKeys.insert(name, key);
+            record.bmiKey = key;
+        }
+        m_graph.insert(job.object, record);
+        if (!job.headerUnit) {
+            m_relink = true;
+            ++m_compiledObjects;
+        }
+        if (!text.isEmpty()) {
+            m_output += relative + ":\n" + text + "\n";
+        }
+    } else {
+        // Keep going with what's running, but start nothing new
+        m_failed = true;
+        m_graph.remove(job.object);
+        m_output += tr("%1: compilation failed").arg(relative) + "\n" + text + "\n";
+    }
+
+    ++m_finishedJobs;
+    emit progress(m_finishedJobs, m_totalJobs);
+    startJobs();
+}
+
+QStringList ProjectBuilder::readDependencies(const CompileJob &job) const
+{
+    QStringList dependencies;
+    QFile file(job.depFile);
+    if (file.open(QIODevice::ReadOnly)) {
+        const QByteArray contents = file.readAll();
+        if (m_msvc) {
+            const QJsonObject data = QJsonDocument::fromJson(contents).object().value("Data").toObject();
+            dependencies.append(data.value("Source").toString());
+            for (const QJsonValue &include : data.value("Includes").toArray()) {
+                dependencies.append(include.toString());
+            }
+        } else {
+            dependencies = CompileCache::parseDepFile(contents);
+        }
+    }
+
+    const QDir base(m_rootPath);
+    for (QString &dependency : dependencies) {
+        dependency = QDir::cleanPath(base.absoluteFilePath(dependency));
+    }
+    if (!dependencies.contains(job.source)) {
+        dependencies.prepend(job.source);
+    }
+    return dependencies;
+}
+
+void ProjectBuilder::link()
+{
+    const QString executable = executablePathFor(m_rootPath);
+
+    QCryptographicHash linkHash(QCryptographicHash::Sha1);
+    linkHash.addData(m_commandHash);
+    linkHash.addData(m_objects.join('\n').toUtf8());
+    const QByteArray hash = linkHash.result();
+
+    // Nothing recompiled and the object set is unchanged: the binary is current
+    const qint64 executableTime = modificationTime(executable);
+    bool upToDate = !m_relink && hash == m_linkHash && executableTime >= 0;
+    for (int i = 0; upToDate && i < m_objects.size(); ++i) {
+        upToDate = modificationTime(m_objects[i]) <= executableTime;
+    }
+    if (upToDate) {
+        m_output += tr("%1 is up to date.").arg(QFileInfo(executable).fileName());
+        finish(true);
+        return;
+    }
+
+    QStringList args = m_flags;
+    args << m_objects;
+    if (m_msvc) {
+        args.prepend("/nologo");
+        args << ("/Fe" + executable);
+    } else {
+        args << "-o" << executable;
+    }
+
+    m_linkProcess = new QProcess(this);
+    m_linkProcess->setProcessChannelMode(QProcess::MergedChannels);
+    m_linkProcess->setWorkingDirectory(m_rootPath);
+    connect(m_linkProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+            [this, hash, executable](int exitCode, QProcess::ExitStatus exitStatus) {
+        const QString text = QString::fromLocal8Bit(m_linkProcess->readAll()).trimmed();
+        m_linkProcess->deleteLater();
+        m_linkProcess = nullptr;
+
+        const bool success = exitStatus == QProcess::NormalExit && exitCode == 0;
+        if (!text.isEmpty()) {
+            m_output += text + "\n";
+        }
+        if (success) {
+            m_linkHash = hash;
+            m_output += tr("Linked %1 (%2 of %3 objects rebuilt).")
+                            .arg(QFileInfo(executable).fileName())
+                            .arg(m_compiledObjects).arg(m_objects.size());
+        } else {
+            m_linkHash.clear();
+            m_output += tr("Link failed.");
+        }
+        saveGraph();
+        finish(success);
+    });
+    m_linkProcess->start(m_compiler, args);
+}
+
+void ProjectBuilder::finish(bool success)
+{
+    m_building = false;
+    emit finished(success, m_output.trimmed(), success ? executablePathFor(m_rootPath) : QString());
+}
+
+void ProjectBuilder::cancel()
+{
+    if (!m_building) {
+        return;
+    }
+    m_building = false;
+    m_queue.clear();
+    m_scanQueue.clear();
+
+    const QList<QProcess *> running = m_running.keys() + m_scanning.keys();
+    m_running.clear();
+    m_scanning.clear();
+    for (QProcess *process : running) {
+        process->disconnect(this);
+        process->kill();
+        process->waitForFinished(1000);
+        process->deleteLater();
+    }
+    if (m_linkProcess) {
+        m_linkProcess->disconnect(this);
+        m_linkProcess->kill();
+        m_linkProcess->waitForFinished(1000);
+        m_linkProcess->deleteLater();
+        m_linkProcess = nullptr;
+    }
+    // Objects that finished before the cancel are still valid
+    saveGraph();
+}
+
+void ProjectBuilder::loadGraph()
+{
+    m_graph.clear();
+    m_linkHash.clear();
+
+    QFile file(buildDir() + "/graph.bin");
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    QDataStream in(&file);
+    quint32 magic = 0;
+    quint32 version = 0;
+    in >> magic >> version;
+    if (magic != kGraphMagic || version != kGraphVersion) {
+        return;
+    }
+
+    qint32 count = 0;
+    in >> m_linkHash >> count;
+    for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString object;
+        ObjectRecord record;
+        in >> object >> record.commandHash >> record.dependencies >> record.mtimes >> record.modules
+           >> record.bmiKey >> record.importsHash;
+        if (record.dependencies.size() == record.mtimes.size()) {
+            m_graph.insert(object, record);
+        }
+    }
+    if (in.status() != QDataStream::Ok) {
+        m_graph.clear();
+        m_linkHash.clear();
+    }
+}
+
+void ProjectBuilder::saveGraph() const
+{
+    if (m_rootPath.isEmpty()) {
+        return;
+    }
+    QDir().mkpath(buildDir());
+    QSaveFile file(buildDir() + "/graph.bin");
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    QDataStream out(&file);
+    out << kGraphMagic << kGraphVersion << m_linkHash << qint32(m_graph.size());
+    for (auto it = m_graph.constBegin(); it != m_graph.constEnd(); ++it) {
+        out << it.key() << it->commandHash << it->dependencies << it->mtimes << it->modules << it->bmiKey
+            << it->importsHash;
+    }
+    file.commit();
+}
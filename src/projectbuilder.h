@@ -0,0 +1,132 @@
+#ifndef PROJECTBUILDER_H
+#define PROJECTBUILDER_H
+
+#include <QObject>
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QVector>
+#include "diagnostic.h"
+#include "moduledeps.h"
+#include "bmicache.h"
+
+// Builds every translation unit under a workspace into its own object file,
+// then links them into one executable. Header dependencies reported by the
+// compiler (-MMD depfiles, or /sourceDependencies for MSVC) are persisted,
+// so later builds only recompile objects whose inputs changed. Compiles run
+// in parallel, up to one process per core.
+//
+// Sources that declare or import C++20 modules are scanned for their module
+// dependencies first. Module interfaces and header units are then built
+// before anything that imports them. Their BMIs come from a content-hashed
+// BmiCache, so an interface whose content is unchanged is not rebuilt, and
+// neither are its importers.
+class ProjectBuilder : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ProjectBuilder(QObject *parent = nullptr);
+    ~ProjectBuilder();
+
+    // compilerIdentity tells compiler versions apart behind the same command,
+    // so BMIs from an older compiler aren't reused
+    void build(const QString &rootPath, const QString &compilerCommand, const QByteArray &compilerIdentity,
+               const QStringList &flags, bool msvc, bool clang);
+    void cancel();
+    bool isBuilding() const { return m_building; }
+
+    static QString executablePathFor(const QString &rootPath);
+
+    void setCacheEnabled(bool enabled) { m_bmiCache.setEnabled(enabled); }
+    void clearCache() { m_bmiCache.clear(); }
+
+signals:
+    void progress(int finishedJobs, int totalJobs);
+    void stageChanged(const QString &description);
+    void diagnosticsFound(const QVector<Diagnostic> &diagnostics);
+    void finished(bool success, const QString &output, const QString &executablePath);
+
+private:
+    struct ObjectRecord
+    {
+        QByteArray commandHash;
+        QStringList dependencies;
+        QVector<qint64> mtimes;     // ms since epoch, parallel to dependencies
+        ModuleDeps modules;
+        QString bmiKey;             // module interfaces: the BMI built with the object
+        QByteArray importsHash;     // keys of the BMIs it was compiled against
+    };
+
+    struct CompileJob
+    {
+        QString source;             // a header for header units
+        QString object;             // header units: the BMI, which is all they produce
+        QString depFile;
+        bool stale = true;
+        bool headerUnit = false;
+        ModuleDeps modules;
+        QStringList moduleClosure;  // every module it needs a BMI of, transitively
+        QStringList headerClosure;
+        QString bmiOutput;          // where the compile writes the BMI it provides
+    };
+
+    QString buildDir() const;
+    QString objectPathFor(const QString &source) const;
+    bool isStale(const CompileJob &job) const;
+    void scanModules();
+    void onScanFinished(QProcess *process, int index, int exitCode, QProcess::ExitStatus exitStatus);
+    QStringList includeDirs() const;
+    void planModules();
+    bool collectClosure(int index, QVector<int> &visitState, QString *error);
+    bool isReady(const CompileJob &job) const;
+    bool resolveWithoutCompile(int index);
+    QStringList importKeys(const CompileJob &job) const;
+    QStringList compileArguments(CompileJob &job);
+    QString writeModuleMapper(const CompileJob &job) const;
+    void startJobs();
+    void onJobFinished(QProcess *process, int index, int exitCode, QProcess::ExitStatus exitStatus);
+    QStringList readDependencies(const CompileJob &job) const;
+    void link();
+    void finish(bool success);
+    void loadGraph();
+    void saveGraph() const;
+
+    QString m_rootPath;
+    QString m_compiler;
+    QStringList m_flags;
+    bool m_msvc;
+    bool m_clang;
+    QByteArray m_commandHash;
+    int m_maxJobs;
+
+    bool m_building;
+    bool m_failed;
+    bool m_relink;
+    QVector<CompileJob> m_jobs;
+    QVector<int> m_queue;
+    QHash<QProcess *, int> m_running;
+    QStringList m_objects;
+    int m_totalJobs;
+    int m_finishedJobs;
+    int m_compiledObjects;
+    QString m_output;
+    QProcess *m_linkProcess;
+
+    // Module dependency scan and BMIs of the current build
+    QVector<int> m_scanQueue;
+    QHash<QProcess *, int> m_scanning;
+    bool m_p1689;               // the scanner speaks P1689; otherwise declarations are read
+    QString m_scanTool;         // clang-scan-deps, or the compiler itself for GCC
+    QHash<QString, int> m_providers;        // module name -> job
+    QHash<QString, QString> m_bmis;         // module name or header path -> built BMI
+    QHash<QString, QString> m_bmiKeys;
+    BmiCache m_bmiCache;
+
+    // Persisted dependency graph: object path -> inputs it was built from
+    QHash<QString, ObjectRecord> m_graph;
+    QByteArray m_linkHash;
+};
+
+#endif // PROJECTBUILDER_H
@@ -0,0 +1,188 @@
+#include "quickopendialog.h"
+#include "filesearchservice.h"
+#include "guardedinvoke.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QKeyEvent>
+#include <QPointer>
+#include <QThreadPool>
+#include <QVBoxLayout>
+
+namespace {
+
+const int kMaxResults = 50;
+const int kRescanSeconds = 30;
+
+} // namespace
+
+QuickOpenModel::QuickOpenModel(FuzzyFinder *finder, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_finder(finder)
+    , m_results(nullptr)
+{
+}
+
+void QuickOpenModel::setResults(const QVector<FuzzyFinder::Result> *results)
+{
+    beginResetModel();
+    m_results = results;
+    endResetModel();
+}
+
+int QuickOpenModel::rowCount(const QModelIndex &parent) const
+{
+    return (parent.isValid() || !m_results) ? 0 : m_results->size();
+}
+
+QVariant QuickOpenModel::data(const QModelIndex &index, int role) const
+{
+    if (!m_results || !index.isValid() || index.row() >= m_results->size()) {
+        return QVariant();
+    }
+    if (role == Qt::DisplayRole || role == Qt::ToolTipRole) {
+        return m_finder->pathAt(m_results->at(index.row()).index);
+    }
+    return QVariant();
+}
+
+QuickOpenDialog::QuickOpenDialog(QWidget *parent)
+    : QDialog(parent, Qt::Popup)
+    , m_scanning(false)
+{
+    setMinimumWidth(600);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(6, 6, 6, 6);
+
+    m_queryInput = new QLineEdit(this);
+    m_queryInput->setPlaceholderText("Go to file...");
+    m_queryInput->setMinimumHeight(32);
+    m_queryInput->installEventFilter(this);
+    connect(m_queryInput, &QLineEdit::textChanged, this, &QuickOpenDialog::updateResults);
+    connect(m_queryInput, &QLineEdit::returnPressed, this, &QuickOpenDialog::acceptCurrent);
+    layout->addWidget(m_queryInput);
+
+    m_model = new QuickOpenModel(&m_finder, this);
+
+    m_resultView = new QListView(this);
+    m_resultView->setModel(m_model);
+    m_resultView->setUniformItemSizes(true);
+    m_resultView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_resultView->setMinimumHeight(360);
+    connect(m_resultView, &QListView::activated, this, &QuickOpenDialog::acceptCurrent);
+    layout->addWidget(m_resultView);
+
+    m_statusLabel = new QLabel(this);
+    m_statusLabel->setStyleSheet("color: #888;");
+    layout->addWidget(m_statusLabel);
+}
+
+void QuickOpenDialog::setRootPath(const QString &rootPath)
+{
+    if (m_rootPath == rootPath) {
+        return;
+    }
+    m_rootPath = rootPath;
+    m_finder.clear();
+    m_model->setResults(nullptr);
+    m_lastScan = QDateTime();
+}
+
+void QuickOpenDialog::popup()
+{
+    if (QWidget *owner = parentWidget()) {
+        const QRect area = owner->geometry();
+        move(area.center().x() - width() / 2, area.top() + 80);
+    }
+
+    m_queryInput->clear();
+    show();
+    raise();
+    m_queryInput->setFocus();
+
+    if (!m_lastScan.isValid() || m_lastScan.secsTo(QDateTime::currentDateTime()) > kRescanSeconds) {
+        rescan();
+    }
+    updateResults();
+}
+
+void QuickOpenDialog::rescan()
+{
+    if (m_scanning || m_rootPath.isEmpty()) {
+        return;
+    }
+    m_scanning = true;
+    m_statusLabel->setText("Indexing workspace...");
+
+    QPointer<QuickOpenDialog> guard(this);
+    const QString rootPath = m_rootPath;
+    QThreadPool::globalInstance()->start([guard, rootPath]() {
+        QStringList files = FileSearchService::listWorkspaceFiles(rootPath);
+        const QDir root(rootPath);
+        for (QString &file : files) {
+            file = root.relativeFilePath(file);
+        }
+        invokeIfAlive(guard, [guard, rootPath, files]() {
+            guard->m_scanning = false;
+            if (rootPath != guard->m_rootPath) {
+                // The root moved while this scan ran; index the new one
+                guard->rescan();
+                return;
+            }
+            guard->m_lastScan = QDateTime::currentDateTime();
+            guard->m_finder.setPaths(files);
+            guard->updateResults();
+        });
+    });
+}
+
+void QuickOpenDialog::updateResults()
+{
+    QElapsedTimer timer;
+    timer.start();
+    const QVector<FuzzyFinder::Result> &results = m_finder.match(m_queryInput->text(), kMaxResults);
+    const qint64 elapsedUs = timer.nsecsElapsed() / 1000;
+
+    m_model->setResults(&results);
+    if (!results.isEmpty()) {
+        m_resultView->setCurrentIndex(m_model->index(0));
+    }
+
+    if (!m_scanning) {
+        m_statusLabel->setText(QString("%1 files, %2 µs").arg(m_finder.pathCount()).arg(elapsedUs));
+    }
+}
+
+void QuickOpenDialog::acceptCurrent()
+{
+    const QModelIndex current = m_resultView->currentIndex();
+    if (!current.isValid()) {
+        return;
+    }
+    const QString relativePath = m_model->data(current).toString();
+    hide();
+    emit fileSelected(QDir(m_rootPath).absoluteFilePath(relativePath));
+}
+
+bool QuickOpenDialog::eventFilter(QObject *watched, QEvent *event)
+{
+    // Let the arrow keys move through the list while typing
+    if (watched == m_queryInput && event->type() == QEvent::KeyPress) {
+        QKeyEvent *keyEvent = static_cast<QKeyEvent *>(event);
+        switch (keyEvent->key()) {
+        case Qt::Key_Up:
+        case Qt::Key_Down:
+        case Qt::Key_PageUp:
+        case Qt::Key_PageDown:
+            QCoreApplication::sendEvent(m_resultView, event);
+            return true;
+        case Qt::Key_Escape:
+            hide();
+            return true;
+        default:
+            break;
+        }
+    }
+    return QDialog::eventFilter(watched, event);
+}
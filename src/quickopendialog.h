@@ -0,0 +1,63 @@
+#ifndef QUICKOPENDIALOG_H
+#define QUICKOPENDIALOG_H
+
+#include <QDialog>
+#include <QAbstractListModel>
+#include <QLineEdit>
+#include <QListView>
+#include <QLabel>
+#include <QDateTime>
+#include "fuzzyfinder.h"
+
+class QuickOpenModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    explicit QuickOpenModel(FuzzyFinder *finder, QObject *parent = nullptr);
+
+    void setResults(const QVector<FuzzyFinder::Result> *results);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+private:
+    FuzzyFinder *m_finder;
+    const QVector<FuzzyFinder::Result> *m_results;
+};
+
+class QuickOpenDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit QuickOpenDialog(QWidget *parent = nullptr);
+
+    void setRootPath(const QString &rootPath);
+    void popup();
+
+signals:
+    void fileSelected(const QString &filePath);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private slots:
+    void updateResults();
+    void acceptCurrent();
+
+private:
+    void rescan();
+
+    FuzzyFinder m_finder;
+    QuickOpenModel *m_model;
+    QString m_rootPath;
+    QDateTime m_lastScan;
+    bool m_scanning;
+
+    QLineEdit *m_queryInput;
+    QListView *m_resultView;
+    QLabel *m_statusLabel;
+};
+
+#endif // QUICKOPENDIALOG_H
@@ -0,0 +1,216 @@
+#include "runhistory.h"
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPair>
+#include <QStandardPaths>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Fewer samples than this can't reach significance with the normal approximation
+const int kMinSamples = 5;
+const double kSignificance = 0.05;
+// Ignore significant but negligible shifts, e.g. from very stable timings
+const double kMinChange = 0.01;
+
+double median(QVector<double> samples)
+{
+    if (samples.isEmpty()) {
+        return 0;
+    }
+    std::sort(samples.begin(), samples.end());
+    const int middle = samples.size() / 2;
+    return samples.size() % 2 ? samples[middle] : (samples[middle - 1] + samples[middle]) / 2;
+}
+
+QJsonArray toJson(const QVector<double> &samples)
+{
+    QJsonArray array;
+    for (double sample : samples) {
+        array.append(sample);
+    }
+    return array;
+}
+
+QVector<double> fromJson(const QJsonArray &array)
+{
+    QVector<double> samples;
+    samples.reserve(array.size());
+    for (const QJsonValue &value : array) {
+        samples.append(value.toDouble());
+    }
+    return samples;
+}
+
+} // namespace
+
+double RunRecord::medianWallUs() const
+{
+    return median(wallUs);
+}
+
+QString RunComparison::describe() const
+{
+    const double change = (ratio - 1.0) * 100.0;
+    if (slower) {
+        return QString("Performance regression: median wall time %1% slower than the run of %2 (p = %3)")
+            .arg(change, 0, 'f', 1).arg(previous.timestamp.toString("yyyy-MM-dd hh:mm:ss")).arg(pValue, 0, 'g', 3);
+    }
+    if (faster) {
+        return QString("Performance improvement: median wall time %1% faster than the run of %2 (p = %3)")
+            .arg(-change, 0, 'f', 1).arg(previous.timestamp.toString("yyyy-MM-dd hh:mm:ss")).arg(pValue, 0, 'g', 3);
+    }
+    return QString("No significant change from the run of %1 (%2%3%, p = %4)")
+        .arg(previous.timestamp.toString("yyyy-MM-dd hh:mm:ss"))
+        .arg(change >= 0 ? QString("+") : QString()).arg(change, 0, 'f', 1).arg(pValue, 0, 'g', 3);
+}
+
+RunHistory::RunHistory()
+    : m_loaded(false)
+{
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(dir);
+    m_path = dir + "/run-history.jsonl";
+}
+
+void RunHistory::load() const
+{
+    if (m_loaded) {
+        return;
+    }
+    m_loaded = true;
+
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    while (!file.atEnd()) {
+        const QJsonObject object = QJsonDocument::fromJson(file.readLine()).object();
+        if (object.isEmpty()) {
+            continue;   // torn write from a crash; the rest of the log is still usable
+        }
+        RunRecord record;
+        record.timestamp = QDateTime::fromString(object["time"].toString(), Qt::ISODateWithMs);
+        record.kind = object["kind"].toString();
+        record.program = object["program"].toString();
+        record.source = object["source"].toString();
+        record.sourceHash = object["sourceHash"].toString();
+        record.compiler = object["compiler"].toString();
+        for (const QJsonValue &flag : object["flags"].toArray()) {
+            record.flags.append(flag.toString());
+        }
+        record.wallUs = fromJson(object["wallUs"].toArray());
+        record.cpuUs = fromJson(object["cpuUs"].toArray());
+        record.maxRssKb = object["maxRssKb"].toInteger();
+        m_records[record.program].append(record);
+    }
+}
+
+RunComparison RunHistory::record(const RunRecord &record)
+{
+    load();
+
+    RunComparison comparison;
+    QVector<RunRecord> &records = m_records[record.program];
+    // Compare with the latest record that has enough samples to test against
+    for (int i = records.size() - 1; i >= 0 && record.wallUs.size() >= kMinSamples; --i) {
+        if (records[i].wallUs.size() >= kMinSamples) {
+            comparison.comparable = true;
+            comparison.previous = records[i];
+            break;
+        }
+    }
+    if (comparison.comparable) {
+        const double before = comparison.previous.medianWallUs();
+        comparison.ratio = before > 0 ? record.medianWallUs() / before : 1.0;
+        const double slowerP = mannWhitneyGreater(comparison.previous.wallUs, record.wallUs);
+        const double fasterP = mannWhitneyGreater(record.wallUs, comparison.previous.wallUs);
+        comparison.pValue = qMin(slowerP, fasterP);
+        comparison.slower = slowerP < kSignificance && comparison.ratio > 1.0 + kMinChange;
+        comparison.faster = fasterP < kSignificance && comparison.ratio < 1.0 - kMinChange;
+    }
+    records.append(record);
+
+    QJsonArray flags;
+    for (const QString &flag : record.flags) {
+        flags.append(flag);
+    }
+    QJsonObject object;
+    object["time"] = record.timestamp.toString(Qt::ISODateWithMs);
+    object["kind"] = record.kind;
+    object["program"] = record.program;
+    object["source"] = record.source;
+    object["sourceHash"] = record.sourceHash;
+    object["compiler"] = record.compiler;
+    object["flags"] = flags;
+    object["wallUs"] = toJson(record.wallUs);
+    object["cpuUs"] = toJson(record.cpuUs);
+    object["maxRssKb"] = record.maxRssKb;
+
+    QFile file(m_path);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        file.write(QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n');
+    }
+    return comparison;
+}
+
+QVector<RunRecord> RunHistory::recordsFor(const QString &program) const
+{
+    load();
+    return m_records.value(program);
+}
+
+double RunHistory::mannWhitneyGreater(const QVector<double> &before, const QVector<double> &after)
+{
+    const int n1 = before.size();
+    const int n2 = after.size();
+    if (n1 == 0 || n2 == 0) {
+        return 1.0;
+    }
+
+    // Rank the pooled samples, giving ties their average rank
+    QVector<QPair<double, bool>> pooled;     // value, belongs to "after"
+    pooled.reserve(n1 + n2);
+    for (double value : before) {
+        pooled.append({value, false});
+    }
+    for (double value : after) {
+        pooled.append({value, true});
+    }
+    std::sort(pooled.begin(), pooled.end(), [](const QPair<double, bool> &a, const QPair<double, bool> &b) {
+        return a.first < b.first;
+    });
+
+    const int n = n1 + n2;
+    double rankSumAfter = 0;
+    double tieTerm = 0;
+    for (int i = 0; i < n;) {
+        int j = i;
+        while (j < n && pooled[j].first == pooled[i].first) {
+            ++j;
+        }
+        const double averageRank = (i + 1 + j) / 2.0;
+        for (int k = i; k < j; ++k) {
+            if (pooled[k].second) {
+                rankSumAfter += averageRank;
+            }
+        }
+        const double t = j - i;
+        tieTerm += t * t * t - t;
+        i = j;
+    }
+
+    const double u = rankSumAfter - n2 * (n2 + 1) / 2.0;
+    const double mean = n1 * double(n2) / 2.0;
+    const double variance = n1 * double(n2) / 12.0 * ((n + 1) - tieTerm / (double(n) * (n - 1)));
+    if (variance <= 0) {
+        return 1.0;     // every sample identical
+    }
+    // Continuity correction, then the upper tail of the standard normal
+    const double z = (u - mean - 0.5) / std::sqrt(variance);
+    return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
@@ -0,0 +1,64 @@
+#ifndef RUNHISTORY_H
+#define RUNHISTORY_H
+
+#include <QString>
+#include <QStringList>
+#include <QDateTime>
+#include <QHash>
+#include <QVector>
+
+struct RunRecord
+{
+    QDateTime timestamp;
+    QString kind;                   // "run" or "benchmark"
+    QString program;                // executable path, groups records of one program
+    QString source;
+    QString sourceHash;             // SHA-1 of the source text, empty for projects
+    QString compiler;
+    QStringList flags;
+    QVector<double> wallUs;
+    QVector<double> cpuUs;
+    qint64 maxRssKb = 0;
+
+    double medianWallUs() const;
+};
+
+// Outcome of comparing a new record against the previous one of a program
+struct RunComparison
+{
+    bool comparable = false;        // both sides have enough samples to test
+    bool slower = false;            // statistically significant slowdown
+    bool faster = false;            // statistically significant speedup
+    double pValue = 1.0;
+    double ratio = 1.0;             // new median / old median
+    RunRecord previous;
+
+    QString describe() const;
+};
+
+// Append-only log of timed runs, one JSON object per line, so every edit's
+// effect on a program's speed stays visible without exporting anything. New
+// records are compared with the program's previous one by a Mann-Whitney U
+// test over their wall-time samples.
+class RunHistory
+{
+public:
+    RunHistory();
+
+    RunComparison record(const RunRecord &record);
+    QVector<RunRecord> recordsFor(const QString &program) const;
+    QString historyFile() const { return m_path; }
+
+    // One-sided p-value for "after is stochastically larger than before",
+    // using the normal approximation with tie correction
+    static double mannWhitneyGreater(const QVector<double> &before, const QVector<double> &after);
+
+private:
+    void load() const;
+
+    QString m_path;
+    mutable bool m_loaded;
+    mutable QHash<QString, QVector<RunRecord>> m_records;
+};
+
+#endif // RUNHISTORY_H
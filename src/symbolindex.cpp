@@ -0,0 +1,1203 @@
+#include "symbolindex.h"
+#include "filesearchservice.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QStandardPaths>
+#include <QThread>
+#include <QThreadPool>
+#include <atomic>
+#include <cstring>
+
+namespace {
+
+const char kIndexMagic[8] = {'A', 'I', 'C', 'E', 'S', 'Y', 'M', 'S'};
+const quint32 kIndexVersion = 1;
+const qint64 kMaxIndexedFileSize = 16 * 1024 * 1024;
+const int kMaxStatementTokens = 96;
+
+// On-disk layout: header, file table, symbol table, string pool. Records
+// are fixed-size and naturally aligned so the mapped file is read in place.
+struct IndexHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 fileCount;
+    quint32 symbolCount;
+    quint32 stringBytes;
+};
+static_assert(sizeof(IndexHeader) == 24, "unexpected IndexHeader padding");
+
+struct FileRecord
+{
+    quint32 pathOffset;
+    quint32 pathLength;
+    qint64 modified;
+    qint64 size;
+    quint8 hash[16];
+    quint32 firstSymbol;
+    quint32 symbolCount;
+};
+static_assert(sizeof(FileRecord) == 48, "unexpected FileRecord padding");
+
+struct SymbolRecord
+{
+    quint32 nameOffset;
+    quint16 nameLength;
+    quint8 kind;
+    quint8 reserved;
+    quint32 line;
+    quint32 column;
+    quint32 fileIndex;
+};
+static_assert(sizeof(SymbolRecord) == 20, "unexpected SymbolRecord padding");
+
+struct IndexView
+{
+    const uchar *data = nullptr;
+    qint64 size = 0;
+
+    bool open(const uchar *mapped, qint64 mappedSize)
+    {
+        data = nullptr;
+        size = 0;
+        if (!mapped || mappedSize < qint64(sizeof(IndexHeader))) {
+            return false;
+        }
+        const IndexHeader *h = reinterpret_cast<const IndexHeader *>(mapped);
+        if (std::memcmp(h->magic, kIndexMagic, sizeof(kIndexMagic)) != 0 || h->version != kIndexVersion) {
+            return false;
+        }
+        const qint64 expected = qint64(sizeof(IndexHeader))
+            + qint64(h->fileCount) * qint64(sizeof(FileRecord))
+            + qint64(h->symbolCount) * qint64(sizeof(SymbolRecord))
+            + qint64(h->stringBytes);
+        if (expected != mappedSize) {
+            return false;
+        }
+
+        data = mapped;
+        size = mappedSize;
+
+        // Reject tables that point outside the file before anyone reads them
+        for (quint32 i = 0; i < h->fileCount; ++i) {
+            const FileRecord &f = files()[i];
+            if (quint64(f.pathOffset) + f.pathLength > h->stringBytes
+                || quint64(f.firstSymbol) + f.symbolCount > h->symbolCount) {
+                data = nullptr;
+                size = 0;
+                return false;
+            }
+        }
+        for (quint32 i = 0; i < h->symbolCount; ++i) {
+            const SymbolRecord &s = symbols()[i];
+            if (quint64(s.nameOffset) + s.nameLength > h->stringBytes || s.fileIndex >= h->fileCount) {
+                data = nullptr;
+                size = 0;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool isValid() const { return data != nullptr; }
+    const IndexHeader *header() const { return reinterpret_cast<const IndexHeader *>(data); }
+    quint32 fileCount() const { return isValid() ? header()->fileCount : 0; }
+    quint32 symbolCount() const { return isValid() ? header()->symbolCount : 0; }
+
+    const FileRecord *files() const
+    {
+        return reinterpret_cast<const FileRecord *>(data + sizeof(IndexHeader));
+    }
+    const SymbolRecord *symbols() const
+    {
+        return reinterpret_cast<const SymbolRecord *>(
+            data + sizeof(IndexHeader) + header()->fileCount * sizeof(FileRecord));
+    }
+    const char *strings() const
+    {
+        return reinterpret_cast<const char *>(symbols() + header()->symbolCount);
+    }
+    QString string(quint32 offset, quint32 length) const
+    {
+        return QString::fromUtf8(strings() + offset, int(length));
+    }
+};
+
+struct ParsedSymbol
+{
+    QByteArray name;
+    SymbolKind kind;
+    int line;
+    int column;
+};
+
+class IndexWriter
+{
+public:
+    void beginFile(const QByteArray &path, qint64 modified, qint64 size, const QByteArray &hash)
+    {
+        std::memset(&m_file, 0, sizeof(m_file));
+        m_file.pathOffset = addString(path.constData(), path.size());
+        m_file.pathLength = quint32(path.size());
+        m_file.modified = modified;
+        m_file.size = size;
+        std::memcpy(m_file.hash, hash.constData(), size_t(qMin(hash.size(), 16)));
+        m_file.firstSymbol = m_symbolCount;
+    }
+
+    void addSymbol(const char *name, int length, SymbolKind kind, int line, int column)
+    {
+        SymbolRecord record;
+        std::memset(&record, 0, sizeof(record));
+        record.nameLength = quint16(qMin(length, 0xffff));
+        record.nameOffset = addString(name, record.nameLength);
+        record.kind = quint8(kind);
+        record.line = quint32(line);
+        record.column = quint32(column);
+        record.fileIndex = m_fileCount;
+        m_symbols.append(reinterpret_cast<const char *>(&record), sizeof(record));
+        ++m_symbolCount;
+    }
+
+    void endFile()
+    {
+        m_file.symbolCount = m_symbolCount - m_file.firstSymbol;
+        m_files.append(reinterpret_cast<const char *>(&m_file), sizeof(m_file));
+        ++m_fileCount;
+    }
+
+    bool write(const QString &path) const
+    {
+        IndexHeader header;
+        std::memcpy(header.magic, kIndexMagic, sizeof(kIndexMagic));
+        header.version = kIndexVersion;
+        header.fileCount = m_fileCount;
+        header.symbolCount = m_symbolCount;
+        header.stringBytes = quint32(m_strings.size());
+
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            return false;
+        }
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(m_files);
+        file.write(m_symbols);
+        file.write(m_strings);
+        return file.flush() && file.error() == QFile::NoError;
+    }
+
+private:
+    quint32 addString(const char *data, int length)
+    {
+        const quint32 offset = quint32(m_strings.size());
+        m_strings.append(data, length);
+        return offset;
+    }
+
+    FileRecord m_file;
+    QByteArray m_files;
+    QByteArray m_symbols;
+    QByteArray m_strings;
+    quint32 m_fileCount = 0;
+    quint32 m_symbolCount = 0;
+};
+
+// Lightweight declaration scanner: tokenizes C/C++ (skipping comments,
+// literals and preprocessor lines) and classifies statements at namespace
+// and class scope. It does not need the code to compile, only to be
+// roughly balanced.
+class SymbolExtractor
+{
+public:
+    SymbolExtractor(const char *begin, const char *end, QVector<ParsedSymbol> &out)
+        : m_p(begin), m_end(end), m_lineStart(begin), m_out(out)
+    {
+    }
+
+    void run();
+
+private:
+    struct Token
+    {
+        const char *text;
+        int length;
+        int line;
+        int column;
+        bool identifier;
+    };
+
+    enum class ScopeType { Transparent, Class, Opaque, Inline };
+
+    struct Scope
+    {
+        ScopeType type;
+        QByteArray name;
+        bool typedefPending;
+        Token typedefToken;
+    };
+
+    void newline();
+    void skipBlockComment();
+    void skipLiteral(char quote);
+    void skipRawString();
+    void handleDirective();
+    void handleToken(const Token &token);
+    void openBrace();
+    void closeBrace();
+    void endStatement();
+
+    int skipTemplatePrefix() const;
+    bool indexable() const { return m_opaqueDepth == 0; }
+    bool inClassScope() const { return !m_scopes.isEmpty() && m_scopes.last().type == ScopeType::Class; }
+    QByteArray qualifiedPrefix() const;
+    QByteArray qualifiedNameAt(int index) const;
+    int declaratorNameBefore(int start, int end) const;
+    void add(const QByteArray &name, const Token &at, SymbolKind kind);
+
+    static bool is(const Token &token, const char *word);
+    static bool isKeyword(const Token &token);
+    Token makeToken(const char *start, int length, bool identifier) const;
+
+    const char *m_p;
+    const char *m_end;
+    const char *m_lineStart;
+    int m_line = 1;
+    int m_parenDepth = 0;
+    int m_opaqueDepth = 0;
+    QVector<Token> m_statement;
+    QVector<Scope> m_scopes;
+    QVector<ParsedSymbol> &m_out;
+};
+
+inline bool isIdentStart(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || (uchar(c) >= 0x80);
+}
+
+inline bool isIdentChar(char c)
+{
+    return isIdentStart(c) || (c >= '0' && c <= '9');
+}
+
+bool SymbolExtractor::is(const Token &token, const char *word)
+{
+    const int length = int(std::strlen(word));
+    return token.length == length && std::memcmp(token.text, word, size_t(length)) == 0;
+}
+
+bool SymbolExtractor::isKeyword(const Token &token)
+{
+    static const char *const keywords[] = {
+        "if", "for", "while", "switch", "return", "sizeof", "decltype", "alignas",
+        "alignof", "catch", "const", "volatile", "noexcept", "throw", "new", "delete",
+        "static_assert", "__attribute__", "__declspec", "defined", "do", "else",
+        "case", "default", "static", "inline", "constexpr", "extern", "virtual",
+        "explicit", "override", "final", "typename", "template", "mutable", "auto",
+        "void", "int", "char", "bool", "float", "double", "long", "short",
+        "unsigned", "signed", "struct", "class", "union", "enum", "operator"
+    };
+    if (!token.identifier) {
+        return true;
+    }
+    for (const char *keyword : keywords) {
+        if (is(token, keyword)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+SymbolExtractor::Token SymbolExtractor::makeToken(const char *start, int length, bool identifier) const
+{
+    return Token{start, length, m_line, int(start - m_lineStart), identifier};
+}
+
+void SymbolExtractor::newline()
+{
+    ++m_line;
+    ++m_p;
+    m_lineStart = m_p;
+}
+
+void SymbolExtractor::skipBlockComment()
+{
+    m_p += 2;
+    while (m_p < m_end) {
+        if (*m_p == '\n') {
+            newline();
+        } else if (*m_p == '*' && m_p + 1 < m_end && m_p[1] == '/') {
+            m_p += 2;
+            return;
+        } else {
+            ++m_p;
+        }
+    }
+}
+
+void SymbolExtractor::skipLiteral(char quote)
+{
+    ++m_p;
+    while (m_p < m_end && *m_p != quote) {
+        if (*m_p == '\n') {
+            return; // unterminated; resync at the newline
+        }
+        if (*m_p == '\\' && m_p + 1 < m_end) {
+            if (m_p[1] == '\n') {
+                ++m_p;
+                newline();
+                continue;
+            }
+            ++m_p;
+        }
+        ++m_p;
+    }
+    if (m_p < m_end) {
+        ++m_p;
+    }
+}
+
+void SymbolExtractor::skipRawString()
+{
+    // R"delim( ... )delim"
+    const char *open = m_p + 1;
+    const char *paren = open;
+    while (paren < m_end && *paren != '(' && *paren != '\n' && paren - open <= 16) {
+        ++paren;
+    }
+    if (paren >= m_end || *paren != '(') {
+        skipLiteral('"');
+        return;
+    }
+    QByteArray terminator = ")" + QByteArray(open, int(paren - open)) + "\"";
+    m_p = paren + 1;
+    while (m_p < m_end) {
+        if (*m_p == '\n') {
+            newline();
+        } else if (*m_p == ')' && m_end - m_p >= terminator.size()
+                   && std::memcmp(m_p, terminator.constData(), size_t(terminator.size())) == 0) {
+            m_p += terminator.size();
+            return;
+        } else {
+            ++m_p;
+        }
+    }
+}
+
+void SymbolExtractor::handleDirective()
+{
+    ++m_p;
+    while (m_p < m_end && (*m_p == ' ' || *m_p == '\t')) {
+        ++m_p;
+    }
+    const char *word = m_p;
+    while (m_p < m_end && isIdentChar(*m_p)) {
+        ++m_p;
+    }
+
+    if (m_p - word == 6 && std::memcmp(word, "define", 6) == 0) {
+        while (m_p < m_end && (*m_p == ' ' || *m_p == '\t')) {
+            ++m_p;
+        }
+        const char *name = m_p;
+        while (m_p < m_end && isIdentChar(*m_p)) {
+            ++m_p;
+        }
+        if (m_p > name) {
+            add(QByteArray(name, int(m_p - name)), makeToken(name, int(m_p - name), true), SymbolKind::Macro);
+        }
+    }
+
+    // Skip the rest of the directive, honouring line continuations
+    while (m_p < m_end && *m_p != '\n') {
+        if (*m_p == '\\' && m_p + 1 < m_end && m_p[1] == '\n') {
+            ++m_p;
+            newline();
+        } else if (*m_p == '\\' && m_p + 2 < m_end && m_p[1] == '\r' && m_p[2] == '\n') {
+            m_p += 2;
+            newline();
+        } else if (*m_p == '/' && m_p + 1 < m_end && m_p[1] == '*') {
+            skipBlockComment();
+        } else {
+            ++m_p;
+        }
+    }
+}
+
+void SymbolExtractor::run()
+{
+    bool atLineStart = true;
+    while (m_p < m_end) {
+        const char c = *m_p;
+        if (c == '\n') {
+            newline();
+            atLineStart = true;
+            continue;
+        }
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v') {
+            ++m_p;
+            continue;
+        }
+        if (c == '/' && m_p + 1 < m_end && m_p[1] == '/') {
+            while (m_p < m_end && *m_p != '\n') {
+                ++m_p;
+            }
+            continue;
+        }
+        if (c == '/' && m_p + 1 < m_end && m_p[1] == '*') {
+            skipBlockComment();
+            continue;
+        }
+        if (c == '#' && atLineStart) {
+            handleDirective();
+            continue;
+        }
+        atLineStart = false;
+
+        if (c == '"' || c == '\'') {
+            const Token token = makeToken(m_p, 1, false);
+            skipLiteral(c);
+            handleToken(token);
+            continue;
+        }
+        if (isIdentStart(c)) {
+            const char *start = m_p;
+            while (m_p < m_end && isIdentChar(*m_p)) {
+                ++m_p;
+            }
+            if (m_p < m_end && *m_p == '"' && m_p[-1] == 'R' && m_p - start <= 3) {
+                const Token token = makeToken(start, 1, false);
+                skipRawString();
+                handleToken(token);
+                continue;
+            }
+            handleToken(makeToken(start, int(m_p - start), true));
+            continue;
+        }
+        if (c >= '0' && c <= '9') {
+            while (m_p < m_end && (isIdentChar(*m_p) || *m_p == '.'
+                   || (*m_p == '\'' && m_p + 1 < m_end && isIdentChar(m_p[1])))) {
+                ++m_p;
+            }
+            continue;
+        }
+        if (c == ':' && m_p + 1 < m_end && m_p[1] == ':') {
+            handleToken(makeToken(m_p, 2, false));
+            m_p += 2;
+            continue;
+        }
+        handleToken(makeToken(m_p, 1, false));
+        ++m_p;
+    }
+}
+
+void SymbolExtractor::handleToken(const Token &token)
+{
+    if (!indexable()) {
+        if (is(token, "{")) {
+            m_scopes.append(Scope{ScopeType::Opaque, QByteArray(), false, token});
+            ++m_opaqueDepth;
+        } else if (is(token, "}")) {
+            closeBrace();
+        }
+        return;
+    }
+
+    if (is(token, "(")) {
+        ++m_parenDepth;
+    } else if (is(token, ")")) {
+        m_parenDepth = qMax(0, m_parenDepth - 1);
+    } else if (is(token, "{")) {
+        if (m_parenDepth > 0) {
+            // Braced argument inside a declaration; the statement continues
+            m_scopes.append(Scope{ScopeType::Inline, QByteArray(), false, token});
+            ++m_opaqueDepth;
+            return;
+        }
+        openBrace();
+        m_statement.clear();
+        return;
+    } else if (is(token, "}")) {
+        closeBrace();
+        return;
+    } else if (is(token, ";") && m_parenDepth == 0) {
+        endStatement();
+        m_statement.clear();
+        return;
+    } else if (is(token, ":") && m_statement.size() == 1
+               && (is(m_statement[0], "public") || is(m_statement[0], "private")
+                   || is(m_statement[0], "protected"))) {
+        m_statement.clear();
+        return;
+    }
+
+    if (m_statement.size() < kMaxStatementTokens) {
+        m_statement.append(token);
+    }
+}
+
+int SymbolExtractor::skipTemplatePrefix() const
+{
+    int i = 0;
+    while (i < m_statement.size() && is(m_statement[i], "template")) {
+        ++i;
+        if (i >= m_statement.size() || !is(m_statement[i], "<")) {
+            return i;
+        }
+        int depth = 0;
+        for (; i < m_statement.size(); ++i) {
+            if (is(m_statement[i], "<")) {
+                ++depth;
+            } else if (is(m_statement[i], ">") && --depth == 0) {
+                ++i;
+                break;
+            }
+        }
+    }
+    return i;
+}
+
+QByteArray SymbolExtractor::qualifiedPrefix() const
+{
+    QByteArray prefix;
+    for (const Scope &scope : m_scopes) {
+        if (!scope.name.isEmpty()) {
+            prefix += scope.name + "::";
+        }
+    }
+    return prefix;
+}
+
+QByteArray SymbolExtractor::qualifiedNameAt(int index) const
+{
+    QByteArray name(m_statement[index].text, m_statement[index].length);
+    int i = index;
+    if (i > 0 && is(m_statement[i - 1], "~")) {
+        name.prepend('~');
+        --i;
+    }
+    while (i >= 2 && is(m_statement[i - 1], "::") && m_statement[i - 2].identifier) {
+        name.prepend("::");
+        name.prepend(QByteArray(m_statement[i - 2].text, m_statement[i - 2].length));
+        i -= 2;
+    }
+    return name;
+}
+
+// Last identifier of a declarator, ignoring template arguments, array
+// bounds and qualified type names (e.g. "std::vector<int> values[4]")
+int SymbolExtractor::declaratorNameBefore(int start, int end) const
+{
+    int found = -1;
+    int angle = 0;
+    int square = 0;
+    for (int i = start; i < end; ++i) {
+        const Token &t = m_statement[i];
+        if (is(t, "<")) ++angle;
+        else if (is(t, ">")) angle = qMax(0, angle - 1);
+        else if (is(t, "[")) ++square;
+        else if (is(t, "]")) square = qMax(0, square - 1);
+        else if (t.identifier && angle == 0 && square == 0 && !isKeyword(t)
+                 && !(i + 1 < end && is(m_statement[i + 1], "::"))) {
+            found = i;
+        }
+    }
+    return found;
+}
+
+void SymbolExtractor::add(const QByteArray &name, const Token &at, SymbolKind kind)
+{
+    m_out.append(ParsedSymbol{kind == SymbolKind::Macro ? name : qualifiedPrefix() + name,
+                              kind, at.line, at.column});
+}
+
+void SymbolExtractor::openBrace()
+{
+    const int start = skipTemplatePrefix();
+    const int size = m_statement.size();
+    Scope scope{ScopeType::Opaque, QByteArray(), false, Token{nullptr, 0, 0, 0, false}};
+
+    if (start >= size) {
+        m_scopes.append(scope);
+        ++m_opaqueDepth;
+        return;
+    }
+
+    const Token &first = m_statement[start];
+    if (is(first, "namespace") || (is(first, "extern") && size - start <= 2)) {
+        scope.type = ScopeType::Transparent;
+        if (is(first, "namespace") && start + 1 < size && m_statement[start + 1].identifier) {
+            scope.name = QByteArray(m_statement[start + 1].text, m_statement[start + 1].length);
+        }
+        m_scopes.append(scope);
+        return;
+    }
+
+    int keyIndex = start;
+    if (is(first, "typedef") && start + 1 < size) {
+        keyIndex = start + 1;
+        scope.typedefPending = true;
+        scope.typedefToken = first;
+    }
+    const Token &key = m_statement[keyIndex];
+    SymbolKind typeKind = SymbolKind::Class;
+    bool isType = true;
+    if (is(key, "class")) typeKind = SymbolKind::Class;
+    else if (is(key, "struct")) typeKind = SymbolKind::Struct;
+    else if (is(key, "union")) typeKind = SymbolKind::Union;
+    else if (is(key, "enum")) typeKind = SymbolKind::Enum;
+    else isType = false;
+
+    int firstParen = -1;
+    int firstAssign = -1;
+    bool hasOperator = false;
+    for (int i = start; i < size; ++i) {
+        if (firstParen < 0 && is(m_statement[i], "(")) firstParen = i;
+        if (firstAssign < 0 && is(m_statement[i], "=")) firstAssign = i;
+        if (firstParen < 0 && is(m_statement[i], "operator")) hasOperator = true;
+    }
+
+    // "struct Foo *make() {" is a function returning a struct
+    if (isType && firstParen > keyIndex + 1) {
+        const Token &beforeParen = m_statement[firstParen - 1];
+        if (beforeParen.identifier && !is(beforeParen, "alignas") && !is(beforeParen, "__declspec")
+            && !is(beforeParen, "__attribute__") && !is(beforeParen, "decltype")) {
+            isType = false;
+        }
+    }
+
+    if (isType) {
+        int nameIndex = -1;
+        int parens = 0;
+        for (int i = keyIndex + 1; i < size; ++i) {
+            const Token &t = m_statement[i];
+            if (is(t, "(")) ++parens;
+            else if (is(t, ")")) --parens;
+            else if (is(t, ":") || is(t, "{")) break;
+            else if (parens == 0 && t.identifier && !is(t, "class") && !is(t, "struct")
+                     && !is(t, "final") && !is(t, "alignas") && !is(t, "__attribute__")
+                     && !is(t, "__declspec")) {
+                nameIndex = i;
+            }
+        }
+        if (nameIndex >= 0) {
+            const QByteArray name(m_statement[nameIndex].text, m_statement[nameIndex].length);
+            add(name, m_statement[nameIndex], typeKind);
+            if (typeKind != SymbolKind::Enum) {
+                scope.type = ScopeType::Class;
+                scope.name = name;
+                m_scopes.append(scope);
+                return;
+            }
+        } else if (typeKind != SymbolKind::Enum) {
+            // Anonymous struct/union: its members belong to the enclosing scope
+            scope.type = ScopeType::Class;
+            m_scopes.append(scope);
+            return;
+        }
+        m_scopes.append(scope);
+        ++m_opaqueDepth;
+        return;
+    }
+
+    if (firstParen > start && (hasOperator || firstAssign < 0 || firstAssign > firstParen)) {
+        // Function definition: the name sits right before the first '('
+        int operatorIndex = -1;
+        for (int i = start; i < firstParen; ++i) {
+            if (is(m_statement[i], "operator")) {
+                operatorIndex = i;
+                break;
+            }
+        }
+        if (operatorIndex >= 0) {
+            QByteArray name = "operator";
+            int end = firstParen;
+            if (end == operatorIndex + 1 && end + 1 < size && is(m_statement[end + 1], ")")) {
+                name += "()";
+            }
+            for (int i = operatorIndex + 1; i < end; ++i) {
+                name += QByteArray(m_statement[i].text, m_statement[i].length);
+            }
+            if (operatorIndex >= 2 && is(m_statement[operatorIndex - 1], "::")) {
+                name.prepend(qualifiedNameAt(operatorIndex - 2) + "::");
+            }
+            add(name, m_statement[operatorIndex], SymbolKind::Function);
+        } else {
+            const Token &nameToken = m_statement[firstParen - 1];
+            if (nameToken.identifier && !isKeyword(nameToken)) {
+                add(qualifiedNameAt(firstParen - 1), nameToken, SymbolKind::Function);
+            }
+        }
+    } else if (!inClassScope() && size - start >= 2) {
+        // Brace-initialized global: "int table[] = {...}" or "Foo foo{...}"
+        const int end = firstAssign >= 0 ? firstAssign : size;
+        const int nameIndex = declaratorNameBefore(start, end);
+        if (nameIndex > start) {
+            add(QByteArray(m_statement[nameIndex].text, m_statement[nameIndex].length),
+                m_statement[nameIndex], SymbolKind::Global);
+        }
+    }
+
+    m_scopes.append(scope);
+    ++m_opaqueDepth;
+}
+
+void SymbolExtractor::closeBrace()
+{
+    if (m_scopes.isEmpty()) {
+        m_statement.clear();
+        m_parenDepth = 0;
+        return;
+    }
+
+    const Scope scope = m_scopes.takeLast();
+    if (scope.type == ScopeType::Opaque || scope.type == ScopeType::Inline) {
+        --m_opaqueDepth;
+    }
+    if (scope.type == ScopeType::Inline) {
+        return;
+    }
+
+    m_statement.clear();
+    m_parenDepth = 0;
+
+    // "typedef struct {...} Name;" - let the trailing name become a typedef
+    if (scope.typedefPending) {
+        m_statement.append(scope.typedefToken);
+    }
+}
+
+void SymbolExtractor::endStatement()
+{
+    const int start = skipTemplatePrefix();
+    const int size = m_statement.size();
+    if (start >= size) {
+        return;
+    }
+
+    const Token &first = m_statement[start];
+    if (is(first, "typedef")) {
+        // Function pointer typedefs name the identifier after "(*"
+        for (int i = start + 1; i + 2 < size; ++i) {
+            if (is(m_statement[i], "(") && is(m_statement[i + 1], "*") && m_statement[i + 2].identifier) {
+                add(QByteArray(m_statement[i + 2].text, m_statement[i + 2].length),
+                    m_statement[i + 2], SymbolKind::Typedef);
+                return;
+            }
+        }
+        const int nameIndex = declaratorNameBefore(start + 1, size);
+        if (nameIndex > start) {
+            add(QByteArray(m_statement[nameIndex].text, m_statement[nameIndex].length),
+                m_statement[nameIndex], SymbolKind::Typedef);
+        }
+        return;
+    }
+
+    if (is(first, "using")) {
+        if (start + 2 < size && m_statement[start + 1].identifier && is(m_statement[start + 2], "=")) {
+            add(QByteArray(m_statement[start + 1].text, m_statement[start + 1].length),
+                m_statement[start + 1], SymbolKind::Typedef);
+        }
+        return;
+    }
+
+    if (inClassScope() || size - start < 2) {
+        return;
+    }
+
+    static const char *const nonDefinitions[] = {
+        "extern", "friend", "return", "static_assert", "namespace", "class", "struct",
+        "union", "enum", "template", "goto", "break", "continue", "asm", "__asm__"
+    };
+    for (const char *word : nonDefinitions) {
+        if (is(first, word)) {
+            return;
+        }
+    }
+
+    int firstAssign = -1;
+    for (int i = start; i < size; ++i) {
+        if (is(m_statement[i], "=")) {
+            firstAssign = i;
+            break;
+        }
+        if (is(m_statement[i], "(")) {
+            return; // prototype, or too ambiguous to call a variable
+        }
+    }
+
+    const int nameIndex = declaratorNameBefore(start, firstAssign >= 0 ? firstAssign : size);
+    if (nameIndex > start) {
+        add(QByteArray(m_statement[nameIndex].text, m_statement[nameIndex].length),
+            m_statement[nameIndex], SymbolKind::Global);
+    }
+}
+
+QByteArray contentHash(const char *data, qint64 size)
+{
+    return QCryptographicHash::hash(QByteArray::fromRawData(data, int(size)), QCryptographicHash::Md5);
+}
+
+} // namespace
+
+struct SymbolIndex::UpdateJob
+{
+    QString rootPath;
+    QString indexPath;
+    std::atomic<bool> cancelled{false};
+};
+
+SymbolIndex::SymbolIndex(QObject *parent)
+    : QObject(parent)
+    , m_data(nullptr)
+    , m_dataSize(0)
+    , m_generation(0)
+    , m_indexing(false)
+    , m_refreshPending(false)
+{
+    m_pool = new QThreadPool(this);
+    m_pool->setMaxThreadCount(1);
+}
+
+SymbolIndex::~SymbolIndex()
+{
+    if (m_job) {
+        m_job->cancelled = true;
+    }
+    m_pool->waitForDone();
+    unmapIndex();
+}
+
+QString SymbolIndex::kindName(SymbolKind kind)
+{
+    switch (kind) {
+    case SymbolKind::Function: return "function";
+    case SymbolKind::Class: return "class";
+    case SymbolKind::Struct: return "struct";
+    case SymbolKind::Union: return "union";
+    case SymbolKind::Enum: return "enum";
+    case SymbolKind::Macro: return "macro";
+    case SymbolKind::Global: return "variable";
+    case SymbolKind::Typedef: return "typedef";
+    }
+    return QString();
+}
+
+QString SymbolIndex::indexPathFor(const QString &rootPath)
+{
+    const QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/symbols";
+    QDir().mkpath(cacheDir);
+    const QByteArray key = QCryptographicHash::hash(QDir::cleanPath(rootPath).toUtf8(),
+                                                    QCryptographicHash::Sha1).toHex().left(16);
+    return cacheDir + "/" + QString::fromLatin1(key) + ".idx";
+}
+
+void SymbolIndex::setRootPath(const QString &rootPath)
+{
+    if (m_rootPath == rootPath) {
+        return;
+    }
+
+    if (m_job) {
+        m_job->cancelled = true;
+        m_job.reset();
+    }
+    unmapIndex();
+    m_rootPath = rootPath;
+    m_indexPath = indexPathFor(rootPath);
+    m_refreshPending = false;
+    m_indexing = false;
+
+    // Serve queries from the persisted index right away
+    mapIndex();
+    ++m_generation;
+
+    startUpdate();
+}
+
+void SymbolIndex::refresh()
+{
+    if (m_rootPath.isEmpty()) {
+        return;
+    }
+    if (m_indexing) {
+        m_refreshPending = true;
+        return;
+    }
+    startUpdate();
+}
+
+void SymbolIndex::startUpdate()
+{
+    auto job = std::make_shared<UpdateJob>();
+    job->rootPath = m_rootPath;
+    job->indexPath = m_indexPath;
+    m_job = job;
+    m_indexing = true;
+    emit indexingStarted();
+
+    m_pool->start([this, job]() { runUpdate(job); });
+}
+
+void SymbolIndex::mapIndex()
+{
+    m_indexFile.setFileName(m_indexPath);
+    if (!m_indexFile.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    const qint64 size = m_indexFile.size();
+    uchar *mapped = size > 0 ? m_indexFile.map(0, size) : nullptr;
+    IndexView view;
+    if (!view.open(mapped, size)) {
+        if (mapped) {
+            m_indexFile.unmap(mapped);
+        }
+        m_indexFile.close();
+        return;
+    }
+    m_data = mapped;
+    m_dataSize = size;
+}
+
+void SymbolIndex::unmapIndex()
+{
+    if (m_data) {
+        m_indexFile.unmap(const_cast<uchar *>(m_data));
+        m_data = nullptr;
+        m_dataSize = 0;
+    }
+    if (m_indexFile.isOpen()) {
+        m_indexFile.close();
+    }
+}
+
+void SymbolIndex::installIndex(const QString &newIndexPath)
+{
+    // The mapping has to go before the file can be replaced on Windows
+    unmapIndex();
+    QFile::remove(m_indexPath);
+    QFile::rename(newIndexPath, m_indexPath);
+    mapIndex();
+    ++m_generation;
+}
+
+int SymbolIndex::symbolCount() const
+{
+    IndexView view;
+    view.data = m_data;
+    return int(view.symbolCount());
+}
+
+SymbolInfo SymbolIndex::symbolAt(int index) const
+{
+    IndexView view;
+    view.data = m_data;
+    SymbolInfo info;
+    if (index < 0 || quint32(index) >= view.symbolCount()) {
+        return info;
+    }
+    const SymbolRecord &s = view.symbols()[index];
+    const FileRecord &f = view.files()[s.fileIndex];
+    info.name = view.string(s.nameOffset, s.nameLength);
+    info.kind = SymbolKind(s.kind);
+    info.filePath = view.string(f.pathOffset, f.pathLength);
+    info.line = int(s.line);
+    info.column = int(s.column);
+    return info;
+}
+
+QVector<SymbolInfo> SymbolIndex::findDefinitions(const QString &name) const
+{
+    QVector<SymbolInfo> result;
+    IndexView view;
+    view.data = m_data;
+    if (!view.isValid() || name.isEmpty()) {
+        return result;
+    }
+
+    const QByteArray needle = name.toUtf8();
+    const QByteArray qualifiedSuffix = "::" + needle;
+    const SymbolRecord *symbols = view.symbols();
+    const char *strings = view.strings();
+    const quint32 count = view.symbolCount();
+
+    for (quint32 i = 0; i < count; ++i) {
+        const SymbolRecord &s = symbols[i];
+        const char *text = strings + s.nameOffset;
+        const bool exact = s.nameLength == needle.size()
+            && std::memcmp(text, needle.constData(), size_t(needle.size())) == 0;
+        const bool qualified = s.nameLength > qualifiedSuffix.size()
+            && std::memcmp(text + s.nameLength - qualifiedSuffix.size(), qualifiedSuffix.constData(),
+                           size_t(qualifiedSuffix.size())) == 0;
+        if (exact || qualified) {
+            result.append(symbolAt(int(i)));
+        }
+    }
+    return result;
+}
+
+void SymbolIndex::runUpdate(std::shared_ptr<UpdateJob> job)
+{
+    struct Candidate
+    {
+        QString path;
+        qint64 modified = 0;
+        qint64 size = 0;
+        int oldIndex = -1;
+        bool unchanged = false;     // same size and mtime as the stored record
+        bool reuseSymbols = false;  // same content hash as the stored record
+        bool skipped = false;
+        QByteArray hash;
+        QVector<ParsedSymbol> symbols;
+    };
+
+    // Previous index, read-only
+    QFile oldFile(job->indexPath);
+    IndexView old;
+    uchar *oldMapped = nullptr;
+    if (oldFile.open(QIODevice::ReadOnly) && oldFile.size() > 0) {
+        oldMapped = oldFile.map(0, oldFile.size());
+        old.open(oldMapped, oldFile.size());
+    }
+
+    QHash<QString, int> oldByPath;
+    for (quint32 i = 0; i < old.fileCount(); ++i) {
+        const FileRecord &f = old.files()[i];
+        oldByPath.insert(old.string(f.pathOffset, f.pathLength), int(i));
+    }
+
+    static const QStringList suffixes = {
+        "c", "cc", "cpp", "cxx", "c++", "h", "hh", "hpp", "hxx", "inl", "ipp", "tpp"
+    };
+    const QStringList paths = FileSearchService::listWorkspaceFiles(job->rootPath, suffixes);
+
+    QVector<Candidate> candidates(paths.size());
+    QVector<int> toCheck;
+    for (int i = 0; i < paths.size(); ++i) {
+        Candidate &c = candidates[i];
+        const QFileInfo fi(paths[i]);
+        c.path = fi.absoluteFilePath();
+        c.modified = fi.lastModified().toMSecsSinceEpoch();
+        c.size = fi.size();
+        c.oldIndex = oldByPath.value(c.path, -1);
+        if (c.oldIndex >= 0) {
+            const FileRecord &f = old.files()[c.oldIndex];
+            c.unchanged = f.modified == c.modified && f.size == c.size;
+        }
+        if (!c.unchanged) {
+            toCheck.append(i);
+        }
+    }
+
+    // Hash and, if needed, parse changed files on all cores
+    std::atomic<int> done{0};
+    {
+        QThreadPool parsePool;
+        parsePool.setMaxThreadCount(QThread::idealThreadCount());
+        const int chunk = 16;
+        for (int begin = 0; begin < toCheck.size(); begin += chunk) {
+            const int end = qMin(begin + chunk, int(toCheck.size()));
+            parsePool.start([&, begin, end]() {
+                for (int k = begin; k < end && !job->cancelled; ++k) {
+                    Candidate &c = candidates[toCheck[k]];
+                    QFile file(c.path);
+                    uchar *data = nullptr;
+                    if (c.size > 0 && c.size <= kMaxIndexedFileSize && file.open(QIODevice::ReadOnly)) {
+                        data = file.map(0, c.size);
+                    }
+                    const char *text = reinterpret_cast<const char *>(data);
+                    if (!data || FileSearchService::looksBinary(text, c.size)) {
+                        c.skipped = c.size != 0;
+                        ++done;
+                        continue;
+                    }
+                    c.hash = contentHash(text, c.size);
+                    if (c.oldIndex >= 0
+                        && std::memcmp(old.files()[c.oldIndex].hash, c.hash.constData(), 16) == 0) {
+                        c.reuseSymbols = true;
+                    } else {
+                        SymbolExtractor(text, text + c.size, c.symbols).run();
+                    }
+                    file.unmap(data);
+                    ++done;
+                }
+            });
+        }
+
+        while (!parsePool.waitForDone(100)) {
+            const int progress = done;
+            const int total = toCheck.size();
+            QMetaObject::invokeMethod(this, [this, job, progress, total]() {
+                if (job == m_job) {
+                    emit indexingProgress(progress, total);
+                }
+            }, Qt::QueuedConnection);
+        }
+    }
+
+    int reparsed = 0;
+    for (int index : qAsConst(toCheck)) {
+        if (!candidates[index].reuseSymbols && !candidates[index].skipped) {
+            ++reparsed;
+        }
+    }
+
+    const bool changed = !toCheck.isEmpty() || paths.size() != int(old.fileCount());
+    QString newIndexPath;
+    if (changed && !job->cancelled) {
+        IndexWriter writer;
+        for (const Candidate &c : qAsConst(candidates)) {
+            // Skipped (binary/huge) files are kept with no symbols so that the
+            // next run sees them as unchanged instead of probing them again
+            const bool fromOld = c.unchanged || c.reuseSymbols;
+            const QByteArray hash = c.unchanged
+                ? QByteArray(reinterpret_cast<const char *>(old.files()[c.oldIndex].hash), 16)
+                : c.hash;
+            writer.beginFile(c.path.toUtf8(), c.modified, c.size, hash);
+            if (fromOld) {
+                const FileRecord &f = old.files()[c.oldIndex];
+                for (quint32 s = f.firstSymbol; s < f.firstSymbol + f.symbolCount; ++s) {
+                    const SymbolRecord &r = old.symbols()[s];
+                    writer.addSymbol(old.strings() + r.nameOffset, r.nameLength,
+                                     SymbolKind(r.kind), int(r.line), int(r.column));
+                }
+            } else {
+                for (const ParsedSymbol &symbol : c.symbols) {
+                    writer.addSymbol(symbol.name.constData(), symbol.name.size(),
+                                     symbol.kind, symbol.line, symbol.column);
+                }
+            }
+            writer.endFile();
+        }
+
+        newIndexPath = job->indexPath + ".new";
+        if (!writer.write(newIndexPath)) {
+            newIndexPath.clear();
+        }
+    }
+
+    if (oldMapped) {
+        oldFile.unmap(oldMapped);
+    }
+    oldFile.close();
+
+    const int fileCount = paths.size();
+    QMetaObject::invokeMethod(this, [this, job, newIndexPath, fileCount, reparsed]() {
+        if (job != m_job) {
+            return;
+        }
+        m_job.reset();
+        m_indexing = false;
+        if (!newIndexPath.isEmpty()) {
+            installIndex(newIndexPath);
+        }
+        emit indexingFinished(fileCount, reparsed);
+
+        if (m_refreshPending) {
+            m_refreshPending = false;
+            startUpdate();
+        }
+    }, Qt::QueuedConnection);
+}
@@ -0,0 +1,84 @@
+#ifndef SYMBOLINDEX_H
+#define SYMBOLINDEX_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QFile>
+#include <memory>
+
+class QThreadPool;
+
+enum class SymbolKind : quint8
+{
+    Function,
+    Class,
+    Struct,
+    Union,
+    Enum,
+    Macro,
+    Global,
+    Typedef
+};
+
+struct SymbolInfo
+{
+    QString name;
+    SymbolKind kind = SymbolKind::Function;
+    QString filePath;
+    int line = 0;       // 1-based
+    int column = 0;     // 0-based
+};
+
+// Workspace-wide index of top-level C/C++ definitions. The index lives in
+// a flat binary file under the cache directory that is memory-mapped and
+// queried in place; files are re-parsed only when their size/mtime changed
+// and their content hash no longer matches.
+class SymbolIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SymbolIndex(QObject *parent = nullptr);
+    ~SymbolIndex();
+
+    void setRootPath(const QString &rootPath);
+    QString rootPath() const { return m_rootPath; }
+    void refresh();
+    bool isIndexing() const { return m_indexing; }
+
+    int symbolCount() const;
+    SymbolInfo symbolAt(int index) const;
+    QVector<SymbolInfo> findDefinitions(const QString &name) const;
+    quint64 generation() const { return m_generation; }
+
+    static QString kindName(SymbolKind kind);
+
+signals:
+    void indexingStarted();
+    void indexingProgress(int done, int total);
+    void indexingFinished(int fileCount, int reparsedCount);
+
+private:
+    struct UpdateJob;
+
+    static QString indexPathFor(const QString &rootPath);
+    void startUpdate();
+    void runUpdate(std::shared_ptr<UpdateJob> job);
+    void mapIndex();
+    void unmapIndex();
+    void installIndex(const QString &newIndexPath);
+
+    QThreadPool *m_pool;
+    QString m_rootPath;
+    QString m_indexPath;
+    QFile m_indexFile;
+    const uchar *m_data;
+    qint64 m_dataSize;
+    quint64 m_generation;
+    bool m_indexing;
+    bool m_refreshPending;
+    std::shared_ptr<UpdateJob> m_job;
+};
+
+#endif // SYMBOLINDEX_H
@@ -0,0 +1,182 @@
+#include "symbolsearchdialog.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QKeyEvent>
+#include <QVBoxLayout>
+
+namespace {
+
+const int kMaxResults = 100;
+
+} // namespace
+
+SymbolSearchModel::SymbolSearchModel(FuzzyFinder *finder, SymbolIndex *index, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_finder(finder)
+    , m_index(index)
+    , m_results(nullptr)
+{
+}
+
+void SymbolSearchModel::setResults(const QVector<FuzzyFinder::Result> *results)
+{
+    beginResetModel();
+    m_results = results;
+    endResetModel();
+}
+
+SymbolInfo SymbolSearchModel::symbolAt(int row) const
+{
+    if (!m_results || row < 0 || row >= m_results->size()) {
+        return SymbolInfo();
+    }
+    // The finder was fed the index's symbols in order, so indices match
+    return m_index->symbolAt(m_results->at(row).index);
+}
+
+int SymbolSearchModel::rowCount(const QModelIndex &parent) const
+{
+    return (parent.isValid() || !m_results) ? 0 : m_results->size();
+}
+
+QVariant SymbolSearchModel::data(const QModelIndex &index, int role) const
+{
+    if (!m_results || !index.isValid() || index.row() >= m_results->size()) {
+        return QVariant();
+    }
+    const SymbolInfo symbol = symbolAt(index.row());
+    if (role == Qt::DisplayRole) {
+        QString location = m_index->rootPath().isEmpty()
+            ? symbol.filePath
+            : QDir(m_index->rootPath()).relativeFilePath(symbol.filePath);
+        return QString("%1    [%2]  %3:%4")
+            .arg(symbol.name, SymbolIndex::kindName(symbol.kind), location)
+            .arg(symbol.line);
+    }
+    if (role == Qt::ToolTipRole) {
+        return symbol.filePath;
+    }
+    return QVariant();
+}
+
+SymbolSearchDialog::SymbolSearchDialog(SymbolIndex *index, QWidget *parent)
+    : QDialog(parent, Qt::Popup)
+    , m_index(index)
+    , m_builtGeneration(0)
+{
+    setMinimumWidth(640);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(6, 6, 6, 6);
+
+    m_queryInput = new QLineEdit(this);
+    m_queryInput->setPlaceholderText("Go to symbol...");
+    m_queryInput->setMinimumHeight(32);
+    m_queryInput->installEventFilter(this);
+    connect(m_queryInput, &QLineEdit::textChanged, this, &SymbolSearchDialog::updateResults);
+    connect(m_queryInput, &QLineEdit::returnPressed, this, &SymbolSearchDialog::acceptCurrent);
+    layout->addWidget(m_queryInput);
+
+    m_model = new SymbolSearchModel(&m_finder, m_index, this);
+
+    m_resultView = new QListView(this);
+    m_resultView->setModel(m_model);
+    m_resultView->setUniformItemSizes(true);
+    m_resultView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_resultView->setMinimumHeight(360);
+    connect(m_resultView, &QListView::activated, this, &SymbolSearchDialog::acceptCurrent);
+    layout->addWidget(m_resultView);
+
+    m_statusLabel = new QLabel(this);
+    m_statusLabel->setStyleSheet("color: #888;");
+    layout->addWidget(m_statusLabel);
+
+    // Rebuild the matcher whenever a new index generation is installed
+    connect(m_index, &SymbolIndex::indexingFinished, [this]() {
+        if (isVisible()) {
+            rebuild();
+            updateResults();
+        }
+    });
+}
+
+void SymbolSearchDialog::rebuild()
+{
+    if (m_builtGeneration == m_index->generation() && m_finder.pathCount() == m_index->symbolCount()) {
+        return;
+    }
+
+    m_model->setResults(nullptr);
+    const int count = m_index->symbolCount();
+    QStringList names;
+    names.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        names.append(m_index->symbolAt(i).name);
+    }
+    m_finder.setPaths(names);
+    m_builtGeneration = m_index->generation();
+}
+
+void SymbolSearchDialog::popup(const QString &initialText)
+{
+    if (QWidget *owner = parentWidget()) {
+        const QPoint topCenter = owner->mapToGlobal(QPoint(owner->width() / 2, 0));
+        move(topCenter.x() - width() / 2, topCenter.y() + 8);
+    }
+
+    rebuild();
+    m_queryInput->setText(initialText);
+    m_queryInput->selectAll();
+    show();
+    raise();
+    m_queryInput->setFocus();
+    updateResults();
+}
+
+void SymbolSearchDialog::updateResults()
+{
+    const QVector<FuzzyFinder::Result> &results = m_finder.match(m_queryInput->text(), kMaxResults);
+    m_model->setResults(&results);
+    if (!results.isEmpty()) {
+        m_resultView->setCurrentIndex(m_model->index(0));
+    }
+
+    m_statusLabel->setText(m_index->isIndexing()
+        ? QString("%1 symbols (indexing...)").arg(m_finder.pathCount())
+        : QString("%1 symbols").arg(m_finder.pathCount()));
+}
+
+void SymbolSearchDialog::acceptCurrent()
+{
+    const QModelIndex current = m_resultView->currentIndex();
+    if (!current.isValid()) {
+        return;
+    }
+    const SymbolInfo symbol = m_model->symbolAt(current.row());
+    hide();
+    if (!symbol.filePath.isEmpty()) {
+        emit symbolSelected(symbol.filePath, symbol.line, symbol.column);
+    }
+}
+
+bool SymbolSearchDialog::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == m_queryInput && event->type() == QEvent::KeyPress) {
+        QKeyEvent *keyEvent = static_cast<QKeyEvent *>(event);
+        switch (keyEvent->key()) {
+        case Qt::Key_Up:
+        case Qt::Key_Down:
+        case Qt::Key_PageUp:
+        case Qt::Key_PageDown:
+            QCoreApplication::sendEvent(m_resultView, event);
+            return true;
+        case Qt::Key_Escape:
+            hide();
+            return true;
+        default:
+            break;
+        }
+    }
+    return QDialog::eventFilter(watched, event);
+}
@@ -0,0 +1,63 @@
+#ifndef SYMBOLSEARCHDIALOG_H
+#define SYMBOLSEARCHDIALOG_H
+
+#include <QDialog>
+#include <QAbstractListModel>
+#include <QLineEdit>
+#include <QListView>
+#include <QLabel>
+#include "fuzzyfinder.h"
+#include "symbolindex.h"
+
+class SymbolSearchModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    SymbolSearchModel(FuzzyFinder *finder, SymbolIndex *index, QObject *parent = nullptr);
+
+    void setResults(const QVector<FuzzyFinder::Result> *results);
+    SymbolInfo symbolAt(int row) const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+private:
+    FuzzyFinder *m_finder;
+    SymbolIndex *m_index;
+    const QVector<FuzzyFinder::Result> *m_results;
+};
+
+class SymbolSearchDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    SymbolSearchDialog(SymbolIndex *index, QWidget *parent = nullptr);
+
+    void popup(const QString &initialText = QString());
+
+signals:
+    void symbolSelected(const QString &filePath, int line, int column);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private slots:
+    void updateResults();
+    void acceptCurrent();
+
+private:
+    void rebuild();
+
+    SymbolIndex *m_index;
+    FuzzyFinder m_finder;
+    SymbolSearchModel *m_model;
+    quint64 m_builtGeneration;
+
+    QLineEdit *m_queryInput;
+    QListView *m_resultView;
+    QLabel *m_statusLabel;
+};
+
+#endif // SYMBOLSEARCHDIALOG_H
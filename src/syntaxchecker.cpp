@@ -0,0 +1,163 @@
+#include "syntaxchecker.h"
+#include "diagnosticparser.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QSettings>
+#include <QTextDocument>
+#include <QTimer>
+
+namespace {
+
+const int kMinDebounceMs = 250;
+const int kMaxDebounceMs = 2000;
+// A check running longer than this is abandoned; results that late only distract
+const int kLatencyBudgetMs = 3000;
+const double kAverageWeight = 0.3;
+
+bool isCheckable(const QString &filePath)
+{
+    if (filePath.isEmpty()) {
+        return true;        // an unsaved buffer
+    }
+    static const QStringList suffixes = {"cpp", "cc", "cxx", "c++", "cp"};
+    return suffixes.contains(QFileInfo(filePath).suffix().toLower());
+}
+
+} // namespace
+
+SyntaxChecker::SyntaxChecker(QObject *parent)
+    : QObject(parent)
+    , m_process(nullptr)
+    , m_averageMs(kMinDebounceMs)
+{
+    QSettings settings("AICodeEditor", "AICodeEditor");
+    m_enabled = settings.value("syntaxCheckEnabled", true).toBool();
+
+    m_debounce = new QTimer(this);
+    m_debounce->setSingleShot(true);
+    connect(m_debounce, &QTimer::timeout, this, &SyntaxChecker::startCheck);
+
+    m_budget = new QTimer(this);
+    m_budget->setSingleShot(true);
+    m_budget->setInterval(kLatencyBudgetMs);
+    connect(m_budget, &QTimer::timeout, [this]() {
+        // Count it as twice the budget so the pause backs off quickly
+        stopProcess();
+        recordDuration(2.0 * kLatencyBudgetMs);
+    });
+}
+
+SyntaxChecker::~SyntaxChecker()
+{
+    stopProcess();
+}
+
+void SyntaxChecker::setEnabled(bool enabled)
+{
+    m_enabled = enabled;
+    QSettings settings("AICodeEditor", "AICodeEditor");
+    settings.setValue("syntaxCheckEnabled", enabled);
+    if (!enabled) {
+        cancel();
+        emit checked(m_filePath, QVector<Diagnostic>());
+    }
+}
+
+void SyntaxChecker::setCompiler(const QString &command, const QStringList &flags)
+{
+    m_command = command;
+    m_flags = flags;
+}
+
+int SyntaxChecker::debounceMs() const
+{
+    return qBound(kMinDebounceMs, int(m_averageMs * 1.5), kMaxDebounceMs);
+}
+
+void SyntaxChecker::schedule(const QString &filePath, QTextDocument *document)
+{
+    if (!m_enabled || m_command.isEmpty() || m_command == "cl" || !isCheckable(filePath)) {
+        return;
+    }
+    stopProcess();
+    m_filePath = filePath;
+    m_document = document;
+    m_debounce->start(debounceMs());
+}
+
+void SyntaxChecker::cancel()
+{
+    m_debounce->stop();
+    stopProcess();
+}
+
+void SyntaxChecker::stopProcess()
+{
+    m_budget->stop();
+    if (m_process) {
+        m_process->disconnect();
+        m_process->kill();
+        m_process->waitForFinished(1000);
+        m_process->deleteLater();
+        m_process = nullptr;
+    }
+}
+
+void SyntaxChecker::startCheck()
+{
+    if (!m_document) {
+        return;
+    }
+    const QByteArray source = m_document->toPlainText().toUtf8();
+    const QString dir = m_filePath.isEmpty() ? QDir::homePath() : QFileInfo(m_filePath).absolutePath();
+
+    m_process = new QProcess(this);
+    m_process->setProcessChannelMode(QProcess::MergedChannels);
+    // Quoted includes of stdin resolve against the working directory
+    m_process->setWorkingDirectory(dir);
+    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &SyntaxChecker::onCheckFinished);
+    connect(m_process, &QProcess::errorOccurred, [this](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            stopProcess();
+        }
+    });
+
+    QStringList args = m_flags;
+    args << DiagnosticParser::gccFlags() << "-iquote" << dir << "-fsyntax-only" << "-x" << "c++" << "-";
+    m_checkTimer.start();
+    m_budget->start();
+    m_process->start(m_command, args);
+    m_process->write(source);
+    m_process->closeWriteChannel();
+}
+
+void SyntaxChecker::onCheckFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    Q_UNUSED(exitCode);
+    m_budget->stop();
+    recordDuration(m_checkTimer.nsecsElapsed() / 1e6);
+
+    const QString output = QString::fromLocal8Bit(m_process->readAll());
+    m_process->deleteLater();
+    m_process = nullptr;
+    if (exitStatus != QProcess::NormalExit) {
+        return;
+    }
+
+    // Only what the compiler says about the buffer itself, renamed back from <stdin>
+    const QString workingDir = m_filePath.isEmpty() ? QDir::homePath() : QFileInfo(m_filePath).absolutePath();
+    QVector<Diagnostic> diagnostics;
+    for (Diagnostic diagnostic : DiagnosticParser::parse(output, workingDir)) {
+        if (QFileInfo(diagnostic.filePath).fileName() == "<stdin>") {
+            diagnostic.filePath = m_filePath;
+            diagnostics.append(diagnostic);
+        }
+    }
+    emit checked(m_filePath, diagnostics);
+}
+
+void SyntaxChecker::recordDuration(double ms)
+{
+    m_averageMs = (1.0 - kAverageWeight) * m_averageMs + kAverageWeight * ms;
+}
@@ -0,0 +1,62 @@
+#ifndef SYNTAXCHECKER_H
+#define SYNTAXCHECKER_H
+
+#include <QObject>
+#include <QPointer>
+#include <QProcess>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QVector>
+#include "diagnostic.h"
+
+class QTextDocument;
+class QTimer;
+
+// Checks the editor buffer with `-fsyntax-only -x c++ -` while the user
+// types. A check starts after a typing pause and reads a snapshot of the
+// buffer from stdin; any new edit kills it. The pause follows a moving
+// average of recent check times, and a check over the latency budget is
+// abandoned and backs the pause off, so slow machines never queue work.
+class SyntaxChecker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SyntaxChecker(QObject *parent = nullptr);
+    ~SyntaxChecker();
+
+    bool isEnabled() const { return m_enabled; }
+    void setEnabled(bool enabled);
+
+    // GCC or Clang only; cl can't read source from stdin
+    void setCompiler(const QString &command, const QStringList &flags);
+
+    // The buffer changed: cancels a running check and restarts the pause
+    void schedule(const QString &filePath, QTextDocument *document);
+    void cancel();
+
+    int debounceMs() const;
+
+signals:
+    void checked(const QString &filePath, const QVector<Diagnostic> &diagnostics);
+
+private:
+    void startCheck();
+    void onCheckFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void recordDuration(double ms);
+    void stopProcess();
+
+    bool m_enabled;
+    QString m_command;
+    QStringList m_flags;
+    QString m_filePath;
+    QPointer<QTextDocument> m_document;
+
+    QTimer *m_debounce;
+    QTimer *m_budget;
+    QProcess *m_process;
+    QElapsedTimer m_checkTimer;
+    double m_averageMs;             // moving average of check durations
+};
+
+#endif // SYNTAXCHECKER_H
@@ -1,4 +1,6 @@
 #include "syntaxhighlighter.h"
+#include <QTextDocument>
+#include <QTextBlock>
 
 SyntaxHighlighter::SyntaxHighlighter(QTextDocument *parent)
     : QSyntaxHighlighter(parent)
@@ -102,6 +104,42 @@ SyntaxHighlighter::SyntaxHighlighter(QTextDocument *parent)
     m_multiLineCommentFormat.setForeground(QColor(106, 153, 85));  // VS Code green
     m_commentStartExpression = QRegularExpression("/\\*");
     m_commentEndExpression = QRegularExpression("\\*/");
+
+    // Semantic token colors
+    m_macroFormat.setForeground(QColor(189, 99, 197));       // VS Code purple
+    m_enumMemberFormat.setForeground(QColor(79, 193, 255));  // VS Code light blue
+    m_fieldFormat.setForeground(QColor(156, 220, 254));      // VS Code pale blue
+    m_parameterFormat.setForeground(QColor(156, 220, 254));
+    m_parameterFormat.setFontItalic(true);
+}
+
+void SyntaxHighlighter::setSemanticTokens(const QHash<int, QVector<SemanticToken>> &tokensByLine)
+{
+    QVector<int> changedLines;
+    for (auto it = tokensByLine.constBegin(); it != tokensByLine.constEnd(); ++it) {
+        if (m_semanticTokens.value(it.key()) != it.value()) {
+            changedLines.append(it.key());
+        }
+    }
+    for (auto it = m_semanticTokens.constBegin(); it != m_semanticTokens.constEnd(); ++it) {
+        if (!tokensByLine.contains(it.key())) {
+            changedLines.append(it.key());
+        }
+    }
+
+    m_semanticTokens = tokensByLine;
+
+    // Only re-run the lines whose tokens actually changed
+    if (changedLines.size() > 500) {
+        rehighlight();
+        return;
+    }
+    for (int line : qAsConst(changedLines)) {
+        QTextBlock block = document()->findBlockByNumber(line);
+        if (block.isValid()) {
+            rehighlightBlock(block);
+        }
+    }
 }
 
 void SyntaxHighlighter::highlightBlock(const QString &text)
@@ -115,6 +153,40 @@ void SyntaxHighlighter::highlightBlock(const QString &text)
         }
     }
 
+    // Semantic tokens override the regex guesses
+    const auto tokens = m_semanticTokens.constFind(currentBlock().blockNumber());
+    if (tokens != m_semanticTokens.constEnd()) {
+        for (const SemanticToken &token : tokens.value()) {
+            const QTextCharFormat *format = nullptr;
+            switch (token.kind) {
+            case SemanticKind::Type:
+            case SemanticKind::Namespace:
+                format = &m_typeFormat;
+                break;
+            case SemanticKind::Function:
+                format = &m_functionFormat;
+                break;
+            case SemanticKind::Macro:
+                format = &m_macroFormat;
+                break;
+            case SemanticKind::EnumMember:
+                format = &m_enumMemberFormat;
+                break;
+            case SemanticKind::Field:
+                format = &m_fieldFormat;
+                break;
+            case SemanticKind::Parameter:
+                format = &m_parameterFormat;
+                break;
+            default:
+                break;
+            }
+            if (format) {
+                setFormat(token.start, token.length, *format);
+            }
+        }
+    }
+
     // Handle multi-line comments
     setCurrentBlockState(0);
 
@@ -5,6 +5,32 @@
 #include <QTextCharFormat>
 #include <QRegularExpression>
 #include <QVector>
+#include <QHash>
+
+enum class SemanticKind : quint8
+{
+    Type,
+    Function,
+    Macro,
+    Namespace,
+    EnumMember,
+    Field,
+    Parameter,
+    Variable,
+    Other
+};
+
+struct SemanticToken
+{
+    int start;
+    int length;
+    SemanticKind kind;
+
+    bool operator==(const SemanticToken &other) const
+    {
+        return start == other.start && length == other.length && kind == other.kind;
+    }
+};
 
 class SyntaxHighlighter : public QSyntaxHighlighter
 {
@@ -13,6 +39,9 @@ class SyntaxHighlighter : public QSyntaxHighlighter
 public:
     explicit SyntaxHighlighter(QTextDocument *parent = nullptr);
 
+    // Per-line tokens from a language server, layered over the regex rules
+    void setSemanticTokens(const QHash<int, QVector<SemanticToken>> &tokensByLine);
+
 protected:
     void highlightBlock(const QString &text) override;
 
@@ -37,6 +66,12 @@ private:
     QTextCharFormat m_numberFormat;
     QTextCharFormat m_functionFormat;
     QTextCharFormat m_operatorFormat;
+    QTextCharFormat m_macroFormat;
+    QTextCharFormat m_enumMemberFormat;
+    QTextCharFormat m_fieldFormat;
+    QTextCharFormat m_parameterFormat;
+
+    QHash<int, QVector<SemanticToken>> m_semanticTokens;
 };
 
 #endif // SYNTAXHIGHLIGHTER_H
@@ -0,0 +1,393 @@
+#include "testpanel.h"
+#include "benchmarkrunner.h"
+#include <QColor>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QSplitter>
+#include <QVBoxLayout>
+
+namespace {
+
+QString stateName(TestCase::State state)
+{
+    switch (state) {
+    case TestCase::NotRun: return QObject::tr("Not run");
+    case TestCase::Queued: return QObject::tr("Queued");
+    case TestCase::Running: return QObject::tr("Running");
+    case TestCase::Passed: return QObject::tr("Passed");
+    case TestCase::Failed: return QObject::tr("Failed");
+    case TestCase::Skipped: return QObject::tr("Skipped");
+    case TestCase::TimedOut: return QObject::tr("Timed out");
+    case TestCase::Crashed: return QObject::tr("Crashed");
+    }
+    return QString();
+}
+
+QColor stateColor(TestCase::State state)
+{
+    switch (state) {
+    case TestCase::Passed: return QColor(80, 200, 120);
+    case TestCase::Failed:
+    case TestCase::TimedOut:
+    case TestCase::Crashed:
+        return QColor(244, 71, 71);
+    case TestCase::Running: return QColor(90, 160, 220);
+    default: return QColor(136, 136, 136);
+    }
+}
+
+} // namespace
+
+TestResultModel::TestResultModel(QObject *parent)
+    : QAbstractItemModel(parent)
+{
+}
+
+void TestResultModel::setTests(const QVector<TestCase> &tests)
+{
+    beginResetModel();
+    m_tests = tests;
+    m_groups.clear();
+    m_positions.clear();
+    m_stateCounts.clear();
+
+    QHash<QString, int> groupByName;
+    for (int i = 0; i < m_tests.size(); ++i) {
+        const TestCase &test = m_tests.at(i);
+        const QString name = test.suite.isEmpty() ? tr("Test cases") : test.suite;
+        int group = groupByName.value(name, -1);
+        if (group < 0) {
+            group = m_groups.size();
+            groupByName.insert(name, group);
+            m_groups << Group{name, {}};
+        }
+        m_positions << qMakePair(group, int(m_groups[group].tests.size()));
+        m_groups[group].tests << i;
+        ++m_stateCounts[test.state];
+    }
+    endResetModel();
+}
+
+void TestResultModel::updateTest(int index, const TestCase &test)
+{
+    if (index < 0 || index >= m_tests.size()) {
+        return;
+    }
+    --m_stateCounts[m_tests.at(index).state];
+    ++m_stateCounts[test.state];
+    m_tests[index] = test;
+
+    const QPair<int, int> position = m_positions.at(index);
+    const QModelIndex group = this->index(position.first, 0);
+    emit dataChanged(this->index(position.second, 0, group), this->index(position.second, ColumnCount - 1, group));
+    emit dataChanged(group, this->index(position.first, ColumnCount - 1));
+}
+
+void TestResultModel::clearUnfinished()
+{
+    for (int i = 0; i < m_tests.size(); ++i) {
+        const TestCase::State state = m_tests.at(i).state;
+        if (state == TestCase::Queued || state == TestCase::Running) {
+            TestCase test = m_tests.at(i);
+            test.state = TestCase::NotRun;
+            updateTest(i, test);
+        }
+    }
+}
+
+const TestCase *TestResultModel::testAt(const QModelIndex &index) const
+{
+    if (!index.isValid() || index.internalId() == 0) {
+        return nullptr;
+    }
+    const Group &group = m_groups.at(int(index.internalId()) - 1);
+    return &m_tests.at(group.tests.at(index.row()));
+}
+
+QModelIndex TestResultModel::groupIndexOf(int testIndex) const
+{
+    if (testIndex < 0 || testIndex >= m_positions.size()) {
+        return QModelIndex();
+    }
+    return index(m_positions.at(testIndex).first, 0);
+}
+
+QStringList TestResultModel::failedTests() const
+{
+    QStringList names;
+    for (const TestCase &test : m_tests) {
+        if (test.isFailure()) {
+            names << test.name;
+        }
+    }
+    return names;
+}
+
+QModelIndex TestResultModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (column < 0 || column >= ColumnCount || row < 0) {
+        return QModelIndex();
+    }
+    // internalId 0 marks a group, otherwise it is the test's group + 1
+    if (!parent.isValid()) {
+        return row < m_groups.size() ? createIndex(row, column, quintptr(0)) : QModelIndex();
+    }
+    if (parent.internalId() != 0 || row >= m_groups.at(parent.row()).tests.size()) {
+        return QModelIndex();
+    }
+    return createIndex(row, column, quintptr(parent.row() + 1));
+}
+
+QModelIndex TestResultModel::parent(const QModelIndex &child) const
+{
+    if (!child.isValid() || child.internalId() == 0) {
+        return QModelIndex();
+    }
+    return createIndex(int(child.internalId()) - 1, 0, quintptr(0));
+}
+
+int TestResultModel::rowCount(const QModelIndex &parent) const
+{
+    if (!parent.isValid()) {
+        return m_groups.size();
+    }
+    if (parent.internalId() == 0 && parent.column() == 0) {
+        return m_groups.at(parent.row()).tests.size();
+    }
+    return 0;
+}
+
+int TestResultModel::columnCount(const QModelIndex &) const
+{
+    return ColumnCount;
+}
+
+QVariant TestResultModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid()) {
+        return QVariant();
+    }
+    if (index.internalId() == 0) {
+        return groupData(index.row(), index.column(), role);
+    }
+
+    const TestCase &test = *testAt(index);
+    if (role == Qt::DisplayRole) {
+        switch (index.column()) {
+        case NameColumn:
+            return test.suite.isEmpty() ? test.name : test.name.mid(test.suite.size() + 1);
+        case StatusColumn: return stateName(test.state);
+        case TimeColumn:
+            return test.state == TestCase::Passed || test.isFailure() ? SampleStats::formatUs(test.durationUs)
+                                                                      : QString();
+        }
+    }
+    if (role == Qt::ForegroundRole && index.column() == StatusColumn) {
+        return stateColor(test.state);
+    }
+    if (role == Qt::TextAlignmentRole && index.column() == TimeColumn) {
+        return int(Qt::AlignRight | Qt::AlignVCenter);
+    }
+    if (role == Qt::ToolTipRole && index.column() == NameColumn) {
+        return test.filePath.isEmpty() ? test.name : QString("%1\n%2:%3").arg(test.name, test.filePath).arg(test.line);
+    }
+    return QVariant();
+}
+
+QVariant TestResultModel::groupData(int row, int column, int role) const
+{
+    const Group &group = m_groups.at(row);
+    int passed = 0;
+    int failed = 0;
+    int pending = 0;
+    qint64 durationUs = 0;
+    for (int index : group.tests) {
+        const TestCase &test = m_tests.at(index);
+        passed += test.state == TestCase::Passed;
+        failed += test.isFailure();
+        pending += test.state == TestCase::Queued || test.state == TestCase::Running;
+        durationUs += test.durationUs;
+    }
+    const TestCase::State state = failed > 0 ? TestCase::Failed
+                                  : pending > 0 ? TestCase::Running
+                                  : passed > 0 ? TestCase::Passed : TestCase::NotRun;
+
+    if (role == Qt::DisplayRole) {
+        switch (column) {
+        case NameColumn: return QString("%1 (%2)").arg(group.name).arg(group.tests.size());
+        case StatusColumn:
+            return failed > 0 ? tr("%1 failed").arg(failed) : tr("%1/%2 passed").arg(passed).arg(group.tests.size());
+        case TimeColumn: return durationUs > 0 ? SampleStats::formatUs(durationUs) : QString();
+        }
+    }
+    if (role == Qt::ForegroundRole && column == StatusColumn) {
+        return stateColor(state);
+    }
+    if (role == Qt::TextAlignmentRole && column == TimeColumn) {
+        return int(Qt::AlignRight | Qt::AlignVCenter);
+    }
+    return QVariant();
+}
+
+QVariant TestResultModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    switch (section) {
+    case NameColumn: return tr("Test");
+    case StatusColumn: return tr("Result");
+    case TimeColumn: return tr("Time");
+    }
+    return QVariant();
+}
+
+TestPanel::TestPanel(QWidget *parent)
+    : QWidget(parent)
+    , m_running(false)
+{
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(8, 8, 8, 8);
+
+    QHBoxLayout *header = new QHBoxLayout;
+    m_summaryLabel = new QLabel(tr("Run Build > Run Tests to run a GoogleTest, Catch2 or doctest binary"), this);
+    m_summaryLabel->setStyleSheet("color: #888;");
+    m_summaryLabel->setWordWrap(true);
+    header->addWidget(m_summaryLabel, 1);
+
+    m_runAllButton = new QPushButton(tr("Run All"), this);
+    m_runFailedButton = new QPushButton(tr("Run Failed"), this);
+    m_stopButton = new QPushButton(tr("Stop"), this);
+    m_runFailedButton->setEnabled(false);
+    m_stopButton->setEnabled(false);
+    connect(m_runAllButton, &QPushButton::clicked, this, &TestPanel::runAllRequested);
+    connect(m_runFailedButton, &QPushButton::clicked, [this]() {
+        emit runFailedRequested(failedTests());
+    });
+    connect(m_stopButton, &QPushButton::clicked, this, &TestPanel::stopRequested);
+    header->addWidget(m_runAllButton);
+    header->addWidget(m_runFailedButton);
+    header->addWidget(m_stopButton);
+    layout->addLayout(header);
+
+    QSplitter *splitter = new QSplitter(Qt::Horizontal, this);
+    m_model = new TestResultModel(this);
+    m_view = new QTreeView(splitter);
+    m_view->setModel(m_model);
+    // Fixed-height rows let the view skip measuring suites with thousands of cases
+    m_view->setUniformRowHeights(true);
+    m_view->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_view->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_view->header()->setStretchLastSection(false);
+    m_view->header()->setSectionResizeMode(TestResultModel::NameColumn, QHeaderView::Stretch);
+    m_view->header()->resizeSection(TestResultModel::StatusColumn, 110);
+    m_view->header()->resizeSection(TestResultModel::TimeColumn, 80);
+    m_view->setStyleSheet(R"(
+        QTreeView {
+            background-color: #1e1e1e;
+            border: 1px solid #3d3d3d;
+            border-radius: 6px;
+        }
+        QTreeView::item:selected {
+            background-color: #0078d7;
+        }
+    )");
+    connect(m_view->selectionModel(), &QItemSelectionModel::currentChanged,
+            [this](const QModelIndex &current) { showOutput(current); });
+    connect(m_view, &QTreeView::activated, [this](const QModelIndex &index) {
+        const TestCase *test = m_model->testAt(index);
+        if (test && !test->filePath.isEmpty()) {
+            emit locationActivated(test->filePath, test->line);
+        }
+    });
+
+    m_outputView = new QPlainTextEdit(splitter);
+    m_outputView->setReadOnly(true);
+    m_outputView->setLineWrapMode(QPlainTextEdit::NoWrap);
+    m_outputView->setFont(QFont("Consolas", 10));
+    m_outputView->setPlaceholderText(tr("Select a test to see its output"));
+
+    splitter->setStretchFactor(0, 3);
+    splitter->setStretchFactor(1, 2);
+    layout->addWidget(splitter, 1);
+}
+
+void TestPanel::setTests(const QVector<TestCase> &tests)
+{
+    m_model->setTests(tests);
+    m_outputView->clear();
+    // One group is all there is for Catch2 and doctest; otherwise show suites with failures
+    for (int row = 0; row < m_model->rowCount(); ++row) {
+        const QModelIndex group = m_model->index(row, 0);
+        bool failed = m_model->rowCount() == 1;
+        for (int i = 0; !failed && i < m_model->rowCount(group); ++i) {
+            failed = m_model->testAt(m_model->index(i, 0, group))->isFailure();
+        }
+        m_view->setExpanded(group, failed);
+    }
+    updateSummary();
+}
+
+void TestPanel::updateTest(int index, const TestCase &test)
+{
+    m_model->updateTest(index, test);
+    if (test.isFailure()) {
+        m_view->expand(m_model->groupIndexOf(index));
+    }
+    const TestCase *selected = m_model->testAt(m_view->currentIndex());
+    if (selected && selected->name == test.name) {
+        showOutput(m_view->currentIndex());
+    }
+    updateSummary();
+}
+
+void TestPanel::setRunning(bool running)
+{
+    m_running = running;
+    if (!running) {
+        m_model->clearUnfinished();
+    }
+    m_runAllButton->setEnabled(!running);
+    m_stopButton->setEnabled(running);
+    updateSummary();
+}
+
+void TestPanel::showMessage(const QString &message)
+{
+    m_summaryLabel->setText(message);
+}
+
+void TestPanel::updateSummary()
+{
+    const int passed = m_model->count(TestCase::Passed);
+    const int failed = m_model->count(TestCase::Failed) + m_model->count(TestCase::TimedOut)
+                       + m_model->count(TestCase::Crashed);
+    const int skipped = m_model->count(TestCase::Skipped);
+    const int pending = m_model->count(TestCase::Queued) + m_model->count(TestCase::Running);
+
+    QStringList parts;
+    parts << tr("%1 passed").arg(passed) << tr("%1 failed").arg(failed);
+    if (skipped > 0) {
+        parts << tr("%1 skipped").arg(skipped);
+    }
+    if (pending > 0) {
+        parts << tr("%1 to go").arg(pending);
+    }
+    m_summaryLabel->setText(parts.join(", "));
+    m_summaryLabel->setStyleSheet(failed > 0 ? "color: #f44747;" : "color: #888;");
+    m_runFailedButton->setEnabled(!m_running && failed > 0);
+}
+
+void TestPanel::showOutput(const QModelIndex &index)
+{
+    const TestCase *test = m_model->testAt(index);
+    if (!test) {
+        m_outputView->clear();
+        return;
+    }
+    QString text = test->name + " - " + stateName(test->state);
+    if (!test->filePath.isEmpty()) {
+        text += QString("\n%1:%2").arg(test->filePath).arg(test->line);
+    }
+    m_outputView->setPlainText(text + "\n\n" + test->output);
+}
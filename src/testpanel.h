@@ -0,0 +1,89 @@
+#ifndef TESTPANEL_H
+#define TESTPANEL_H
+
+#include <QWidget>
+#include <QAbstractItemModel>
+#include <QLabel>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QTreeView>
+#include "testrunner.h"
+
+// Test cases grouped by GoogleTest suite (one group for Catch2/doctest).
+// Results arrive one case at a time, so updates touch a single row and its
+// group, and per-state counts are kept incrementally.
+class TestResultModel : public QAbstractItemModel
+{
+    Q_OBJECT
+
+public:
+    enum Column { NameColumn, StatusColumn, TimeColumn, ColumnCount };
+
+    explicit TestResultModel(QObject *parent = nullptr);
+
+    void setTests(const QVector<TestCase> &tests);
+    void updateTest(int index, const TestCase &test);
+    void clearUnfinished();     // queued and running cases of a stopped run
+    const TestCase *testAt(const QModelIndex &index) const;
+    QModelIndex groupIndexOf(int testIndex) const;
+    int count(TestCase::State state) const { return m_stateCounts.value(state); }
+    QStringList failedTests() const;
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    struct Group
+    {
+        QString name;
+        QVector<int> tests;
+    };
+
+    QVariant groupData(int row, int column, int role) const;
+
+    QVector<TestCase> m_tests;
+    QVector<Group> m_groups;
+    QVector<QPair<int, int>> m_positions;       // test -> (group, row)
+    QHash<int, int> m_stateCounts;
+};
+
+// Build > Run Tests: discovered cases with live results, the selected
+// case's output, and buttons to re-run all or only the failures
+class TestPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit TestPanel(QWidget *parent = nullptr);
+
+    void setTests(const QVector<TestCase> &tests);
+    void updateTest(int index, const TestCase &test);
+    void setRunning(bool running);
+    void showMessage(const QString &message);
+    QStringList failedTests() const { return m_model->failedTests(); }
+
+signals:
+    void runAllRequested();
+    void runFailedRequested(const QStringList &tests);
+    void stopRequested();
+    void locationActivated(const QString &filePath, int line);
+
+private:
+    void updateSummary();
+    void showOutput(const QModelIndex &index);
+
+    TestResultModel *m_model;
+    QTreeView *m_view;
+    QPlainTextEdit *m_outputView;
+    QLabel *m_summaryLabel;
+    QPushButton *m_runAllButton;
+    QPushButton *m_runFailedButton;
+    QPushButton *m_stopButton;
+    bool m_running;
+};
+
+#endif // TESTPANEL_H
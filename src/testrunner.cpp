@@ -0,0 +1,610 @@
+#include "testrunner.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QPointer>
+#include <QRegularExpression>
+#include <QThread>
+#include <QTimer>
+
+namespace {
+
+// Cases per process. Small batches keep every core busy until the end;
+// one process per case would spend more time starting than testing.
+const int kMaxBatch = 32;
+
+// Listing runs the binary too, so it gets a generous timeout of its own
+const int kListTimeoutMs = 30000;
+
+QString escapeCatchName(const QString &name)
+{
+    // Test spec syntax: ',' separates names, '[' starts a tag, '*' and '~' are operators
+    QString escaped;
+    for (const QChar c : name) {
+        if (QStringLiteral("\\,[]*~\"").contains(c)) {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+} // namespace
+
+TestRunner::TestRunner(QObject *parent)
+    : QObject(parent)
+    , m_framework(UnknownFramework)
+    , m_timeoutMs(0)
+    , m_catchFallback(false)
+    , m_listProcess(nullptr)
+    , m_total(0)
+    , m_done(0)
+    , m_passed(0)
+    , m_failedCount(0)
+{
+}
+
+TestRunner::~TestRunner()
+{
+    cancel();
+}
+
+TestRunner::Framework TestRunner::detect(const QString &executable)
+{
+    QFile file(executable);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return UnknownFramework;
+    }
+    const uchar *data = file.map(0, file.size());
+    const QByteArray bytes = data ? QByteArray::fromRawData(reinterpret_cast<const char *>(data), file.size())
+                                  : file.readAll();
+
+    // Option names from each framework's built-in --help text
+    if (bytes.contains("gtest_list_tests")) {
+        return GoogleTest;
+    }
+    if (bytes.contains("list-test-cases") && bytes.contains("doctest")) {
+        return Doctest;
+    }
+    if (bytes.contains("list-test-names-only") || (bytes.contains("list-tests") && bytes.contains("Catch"))) {
+        return Catch2;
+    }
+    return UnknownFramework;
+}
+
+QStringList TestRunner::linkFlags(const QString &sourceFile)
+{
+    QFile file(sourceFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    // gtest_main only supplies main() when the file doesn't define one
+    const QByteArray source = file.readAll();
+    if (source.contains("gmock/gmock.h")) {
+        return {"-lgtest_main", "-lgmock", "-lgtest", "-pthread"};
+    }
+    if (source.contains("gtest/gtest.h")) {
+        return {"-lgtest_main", "-lgtest", "-pthread"};
+    }
+    return {};
+}
+
+QStringList TestRunner::failedTests() const
+{
+    QStringList names;
+    for (const TestCase &test : m_tests) {
+        if (test.isFailure()) {
+            names << test.name;
+        }
+    }
+    return names;
+}
+
+void TestRunner::start(const QString &executable, const QStringList &onlyTests, int perTestTimeoutMs)
+{
+    cancel();
+
+    const Framework framework = detect(executable);
+    if (framework == UnknownFramework) {
+        emit failed(tr("%1 is not a GoogleTest, Catch2 or doctest binary").arg(QFileInfo(executable).fileName()));
+        return;
+    }
+    // Earlier results only mean something for the same binary
+    if (executable != m_executable) {
+        m_tests.clear();
+    }
+    m_executable = executable;
+    m_framework = framework;
+    m_onlyTests = onlyTests;
+    m_timeoutMs = perTestTimeoutMs;
+    m_catchFallback = false;
+
+    switch (framework) {
+    case GoogleTest: list({"--gtest_list_tests"}); break;
+    case Catch2: list({"--list-test-names-only"}); break;
+    case Doctest: list({"--list-test-cases"}); break;
+    case UnknownFramework: break;
+    }
+}
+
+void TestRunner::list(const QStringList &listArguments)
+{
+    m_listProcess = new QProcess(this);
+    m_listProcess->setWorkingDirectory(QFileInfo(m_executable).absolutePath());
+    connect(m_listProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &TestRunner::onListFinished);
+    connect(m_listProcess, &QProcess::errorOccurred, [this](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            const QString message = tr("Failed to start %1: %2").arg(m_executable, m_listProcess->errorString());
+            m_listProcess->deleteLater();
+            m_listProcess = nullptr;
+            emit failed(message);
+        }
+    });
+
+    QPointer<QProcess> process(m_listProcess);
+    QTimer::singleShot(kListTimeoutMs, this, [process]() {
+        if (process) {
+            process->kill();
+        }
+    });
+    m_listProcess->setStandardInputFile(QProcess::nullDevice());
+    m_listProcess->start(m_executable, listArguments);
+}
+
+void TestRunner::onListFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    Q_UNUSED(exitCode);     // Catch2 v2 exits with the number of tests listed
+    const QString text = QString::fromLocal8Bit(m_listProcess->readAllStandardOutput());
+    const QString errors = QString::fromLocal8Bit(m_listProcess->readAllStandardError()).trimmed();
+    m_listProcess->deleteLater();
+    m_listProcess = nullptr;
+
+    QStringList names = exitStatus == QProcess::NormalExit ? parseList(text) : QStringList();
+    if (names.isEmpty() && m_framework == Catch2 && !m_catchFallback) {
+        // Catch2 v3 dropped --list-test-names-only; quiet listing prints just the names
+        m_catchFallback = true;
+        list({"--list-tests", "--verbosity", "quiet"});
+        return;
+    }
+    if (names.isEmpty()) {
+        emit failed(tr("%1 listed no test cases. %2").arg(QFileInfo(m_executable).fileName(), errors));
+        return;
+    }
+
+    QHash<QString, TestCase> previous;
+    for (const TestCase &test : m_tests) {
+        previous.insert(test.name, test);
+    }
+    const QSet<QString> only(m_onlyTests.begin(), m_onlyTests.end());
+    m_tests.clear();
+    m_indexByName.clear();
+    m_queue.clear();
+    for (const QString &name : names) {
+        if (m_indexByName.contains(name)) {
+            continue;
+        }
+        TestCase test = previous.value(name);
+        test.name = name;
+        if (m_framework == GoogleTest) {
+            test.suite = name.section('.', 0, 0);
+        }
+        if (only.isEmpty() || only.contains(name)) {
+            test = TestCase{name, test.suite};
+            test.state = TestCase::Queued;
+            m_queue << m_tests.size();
+        }
+        m_indexByName.insert(name, m_tests.size());
+        m_tests << test;
+    }
+
+    m_total = m_queue.size();
+    m_done = 0;
+    m_passed = 0;
+    m_failedCount = 0;
+    emit discovered(m_tests);
+    emit progress(0, m_total);
+    if (m_queue.isEmpty()) {
+        emit finished(0, 0);
+        return;
+    }
+    startWorkers();
+}
+
+QStringList TestRunner::parseList(const QString &text) const
+{
+    QStringList names;
+    const QStringList lines = text.split('\n');
+    if (m_framework == GoogleTest) {
+        // "Suite." then indented "Test", parameterised ones with "  # GetParam() = ..."
+        QString suite;
+        for (QString line : lines) {
+            line.remove('\r');
+            const int comment = line.indexOf("  #");
+            if (comment >= 0) {
+                line.truncate(comment);
+            }
+            if (line.trimmed().isEmpty()) {
+                continue;
+            }
+            if (!line.startsWith(' ')) {
+                // Anything else unindented is main()'s own chatter
+                suite = line.endsWith('.') ? line : QString();
+            } else if (!suite.isEmpty()) {
+                names << suite + line.trimmed();
+            }
+        }
+        return names;
+    }
+
+    for (const QString &raw : lines) {
+        const QString line = raw.trimmed();
+        // doctest frames its list with "[doctest] ..." and "====" lines
+        if (line.isEmpty() || line.startsWith("[doctest]") || line.startsWith("====")) {
+            continue;
+        }
+        names << line;
+    }
+    return names;
+}
+
+void TestRunner::startWorkers()
+{
+    const int maxWorkers = qMax(1, QThread::idealThreadCount());
+    while (!m_queue.isEmpty() && m_workers.size() < maxWorkers) {
+        const int batchSize = qBound(1, int(m_queue.size() / (maxWorkers * 4)), kMaxBatch);
+        Worker *worker = new Worker;
+        worker->batch = m_queue.mid(0, batchSize);
+        m_queue.remove(0, batchSize);
+
+        worker->process = new QProcess;
+        worker->process->setWorkingDirectory(QFileInfo(m_executable).absolutePath());
+        worker->timeout = new QTimer;
+        worker->timeout->setSingleShot(true);
+        connect(worker->timeout, &QTimer::timeout, [worker]() {
+            worker->timedOut = true;
+            worker->process->kill();
+        });
+        connect(worker->process, &QProcess::readyReadStandardOutput, [this, worker]() {
+            readOutput(worker);
+        });
+        connect(worker->process, &QProcess::readyReadStandardError, [this, worker]() {
+            const QString text = QString::fromLocal8Bit(worker->process->readAllStandardError());
+            if (worker->current >= 0) {
+                m_tests[worker->current].output += text;
+            } else {
+                worker->stray += text.right(4096);
+            }
+        });
+        connect(worker->process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+                [this, worker](int exitCode, QProcess::ExitStatus exitStatus) {
+            onWorkerFinished(worker, exitCode, exitStatus);
+        });
+        connect(worker->process, &QProcess::errorOccurred, [this, worker](QProcess::ProcessError error) {
+            if (error == QProcess::FailedToStart) {
+                worker->stray = worker->process->errorString();
+                onWorkerFinished(worker, -1, QProcess::CrashExit);
+            }
+        });
+
+        m_workers << worker;
+        // Also covers a hang before the first case starts
+        if (m_timeoutMs > 0) {
+            worker->timeout->start(m_timeoutMs);
+        }
+        // start() may fail synchronously and free the worker, so it comes last
+        worker->process->setStandardInputFile(QProcess::nullDevice());
+        worker->process->start(m_executable, runArguments(worker->batch));
+    }
+}
+
+QStringList TestRunner::runArguments(const QVector<int> &batch) const
+{
+    QStringList names;
+    for (int index : batch) {
+        names << m_tests.at(index).name;
+    }
+    switch (m_framework) {
+    case GoogleTest:
+        return {"--gtest_filter=" + names.join(':'), "--gtest_color=no"};
+    case Catch2: {
+        QStringList escaped;
+        for (const QString &name : names) {
+            escaped << escapeCatchName(name);
+        }
+        return {escaped.join(','), "--reporter", "xml"};
+    }
+    case Doctest:
+        return {"--test-case=" + names.replaceInStrings(",", "\\,").join(','), "--reporters=xml", "--no-version"};
+    case UnknownFramework:
+        break;
+    }
+    return {};
+}
+
+void TestRunner::readOutput(Worker *worker)
+{
+    worker->pending += worker->process->readAllStandardOutput();
+    int newline;
+    while ((newline = worker->pending.indexOf('\n')) >= 0) {
+        QString line = QString::fromLocal8Bit(worker->pending.left(newline));
+        worker->pending.remove(0, newline + 1);
+        line.remove('\r');
+        parseLine(worker, line);
+    }
+}
+
+void TestRunner::parseLine(Worker *worker, const QString &line)
+{
+    if (m_framework == GoogleTest) {
+        parseConsoleLine(worker, line);
+    } else {
+        parseXmlLine(worker, line);
+    }
+}
+
+void TestRunner::parseConsoleLine(Worker *worker, const QString &line)
+{
+    static const QRegularExpression runPattern(R"(^\[ RUN      \] (\S+))");
+    static const QRegularExpression endPattern(R"(^\[\s+(OK|FAILED|SKIPPED)\s+\] ([^\s,]+))");
+    // "test.cpp:12: Failure" from GCC/Clang builds, "test.cpp(12): error: ..." from MSVC ones
+    static const QRegularExpression failurePattern(R"(^(.+?)(?::(\d+):|\((\d+)\):) (?:Failure|error))");
+
+    const QRegularExpressionMatch run = runPattern.match(line);
+    if (run.hasMatch()) {
+        const int index = m_indexByName.value(run.captured(1), -1);
+        if (index >= 0) {
+            beginTest(worker, index);
+        }
+        return;
+    }
+    if (worker->current < 0) {
+        return;
+    }
+
+    // The summary repeats "[  FAILED  ]" lines after the cases, so match the running one
+    const QRegularExpressionMatch end = endPattern.match(line);
+    if (end.hasMatch() && end.captured(2) == m_tests.at(worker->current).name) {
+        const QString result = end.captured(1);
+        endTest(worker, result == "OK" ? TestCase::Passed
+                        : result == "SKIPPED" ? TestCase::Skipped : TestCase::Failed);
+        return;
+    }
+
+    m_tests[worker->current].output += line + '\n';
+    const QRegularExpressionMatch failure = failurePattern.match(line);
+    if (failure.hasMatch()) {
+        const QString lineNumber = failure.captured(2).isEmpty() ? failure.captured(3) : failure.captured(2);
+        setFailureLocation(worker, failure.captured(1), lineNumber.toInt());
+    }
+}
+
+void TestRunner::parseXmlLine(Worker *worker, const QString &line)
+{
+    // Catch2 and doctest write one element per line: <TestCase name filename
+    // line>, failed <Expression>s with <Original>/<Expanded>, then an overall
+    // result. The tests' own stdout lands in between, unescaped, so this
+    // reads tags line by line rather than as a strict XML document.
+    static const QRegularExpression tagPattern(R"(^\s*<(/?)(\w+)((?:\s+[\w:-]+="[^"]*")*)\s*(/?)>(.*)$)");
+    static const QRegularExpression attributePattern(R"(([\w:-]+)="([^"]*)")");
+    static const QSet<QString> knownTags = {
+        "TestCase", "Expression", "Original", "Expanded", "Exception", "FatalErrorCondition", "Failure",
+        "Info", "Warning", "Text", "StdOut", "StdErr", "Section", "OverallResult", "OverallResults",
+        "OverallResultsAsserts", "OverallResultsCases", "Catch", "Catch2TestRun", "Group", "doctest",
+        "TestSuite", "Options", "SubCase", "Message"};
+
+    const QRegularExpressionMatch tag = tagPattern.match(line);
+    const QString name = tag.captured(2);
+    if (!tag.hasMatch() || !knownTags.contains(name)) {
+        if (worker->current >= 0 && !line.startsWith("<?xml")) {
+            const QString text = line.trimmed();
+            m_tests[worker->current].output += worker->inText ? text : line + '\n';
+        }
+        return;
+    }
+
+    QHash<QString, QString> attributes;
+    QRegularExpressionMatchIterator it = attributePattern.globalMatch(tag.captured(3));
+    while (it.hasNext()) {
+        const QRegularExpressionMatch attribute = it.next();
+        QString value = attribute.captured(2);
+        value.replace("&quot;", "\"").replace("&apos;", "'").replace("&lt;", "<").replace("&gt;", ">")
+             .replace("&amp;", "&");
+        attributes.insert(attribute.captured(1), value);
+    }
+    const bool closing = !tag.captured(1).isEmpty();
+    const bool selfClosing = !tag.captured(4).isEmpty();
+
+    if (!closing && name == "TestCase") {
+        const int index = m_indexByName.value(attributes.value("name"), -1);
+        if (index >= 0) {
+            beginTest(worker, index);
+            TestCase &test = m_tests[index];
+            test.filePath = QDir(QFileInfo(m_executable).absolutePath()).absoluteFilePath(attributes.value("filename"));
+            test.line = attributes.value("line").toInt();
+        }
+        return;
+    }
+    if (worker->current < 0) {
+        return;
+    }
+
+    TestCase &test = m_tests[worker->current];
+    if (closing) {
+        if (name == "TestCase") {
+            endTest(worker, worker->currentFailed ? TestCase::Failed : TestCase::Passed);
+        } else if (worker->inText) {
+            test.output += '\n';
+            worker->inText = false;
+        }
+    } else if ((name == "Expression" && attributes.value("success") == "false") || name == "Exception"
+               || name == "FatalErrorCondition" || name == "Failure") {
+        worker->currentFailed = true;
+        const QString file = attributes.value("filename");
+        const int lineNumber = attributes.value("line").toInt();
+        if (!file.isEmpty()) {
+            setFailureLocation(worker, file, lineNumber);
+            test.output += QString("%1:%2: ").arg(file).arg(lineNumber);
+        }
+        test.output += attributes.value("type", name) + '\n';
+        worker->inText = name != "Expression" && !selfClosing;
+    } else if (name == "Original" || name == "Expanded" || name == "Info" || name == "Warning"
+               || name == "Text" || name == "StdOut" || name == "StdErr") {
+        test.output += "  " + name + ": ";
+        worker->inText = !selfClosing;
+    } else if (name == "OverallResult" && attributes.value("success") == "false") {
+        worker->currentFailed = true;       // Catch2
+    } else if (name == "OverallResultsAsserts" && attributes.value("test_case_success") == "false") {
+        worker->currentFailed = true;       // doctest
+    }
+
+    // Output the test printed without a newline ends up after the tag
+    const QString rest = tag.captured(5);
+    if (!rest.trimmed().isEmpty()) {
+        test.output += rest + '\n';
+    }
+}
+
+void TestRunner::beginTest(Worker *worker, int index)
+{
+    if (worker->current >= 0) {
+        endTest(worker, TestCase::Failed);
+    }
+    worker->current = index;
+    worker->started.insert(index);
+    worker->currentFailed = false;
+    worker->failureLocated = false;
+    worker->testTimer.start();
+    if (m_timeoutMs > 0) {
+        worker->timeout->start(m_timeoutMs);
+    }
+
+    TestCase &test = m_tests[index];
+    test.state = TestCase::Running;
+    test.output.clear();
+    test.durationUs = 0;
+    emit testChanged(index, test);
+}
+
+void TestRunner::endTest(Worker *worker, TestCase::State state)
+{
+    const int index = worker->current;
+    worker->current = -1;
+    TestCase &test = m_tests[index];
+    test.state = state;
+    test.durationUs = worker->testTimer.nsecsElapsed() / 1000;
+    if (test.isFailure()) {
+        ++m_failedCount;
+    } else if (state == TestCase::Passed) {
+        ++m_passed;
+    }
+    ++m_done;
+    // Until the next case starts or the process exits
+    if (m_timeoutMs > 0) {
+        worker->timeout->start(m_timeoutMs);
+    }
+    emit testChanged(index, test);
+    emit progress(m_done, m_total);
+}
+
+void TestRunner::setFailureLocation(Worker *worker, const QString &filePath, int line)
+{
+    // The first failure is the one worth jumping to
+    if (worker->failureLocated || worker->current < 0) {
+        return;
+    }
+    worker->failureLocated = true;
+    TestCase &test = m_tests[worker->current];
+    test.filePath = QDir(QFileInfo(m_executable).absolutePath()).absoluteFilePath(filePath);
+    test.line = line;
+}
+
+void TestRunner::onWorkerFinished(Worker *worker, int exitCode, QProcess::ExitStatus exitStatus)
+{
+    readOutput(worker);
+    if (!worker->pending.isEmpty()) {
+        parseLine(worker, QString::fromLocal8Bit(worker->pending));
+    }
+    worker->timeout->stop();
+
+    // A case still running took the process down with it
+    const bool diedInTest = worker->current >= 0;
+    if (diedInTest) {
+        TestCase &test = m_tests[worker->current];
+        if (worker->timedOut) {
+            test.output += tr("\n[Killed after the per-test timeout of %1 s]\n").arg(m_timeoutMs / 1000.0);
+            endTest(worker, TestCase::TimedOut);
+        } else if (exitStatus == QProcess::CrashExit) {
+            test.output += tr("\n[Crashed]\n");
+            endTest(worker, TestCase::Crashed);
+        } else {
+            test.output += tr("\n[The test binary exited with code %1 during this test]\n").arg(exitCode);
+            endTest(worker, TestCase::Failed);
+        }
+    }
+
+    QVector<int> unstarted;
+    for (int index : qAsConst(worker->batch)) {
+        if (!worker->started.contains(index)) {
+            unstarted << index;
+        }
+    }
+    if (diedInTest) {
+        // The rest of the batch deserves a process of its own
+        m_queue = unstarted + m_queue;
+    } else {
+        const bool crashed = exitStatus == QProcess::CrashExit || worker->timedOut;
+        for (int index : qAsConst(unstarted)) {
+            TestCase &test = m_tests[index];
+            worker->current = index;
+            worker->testTimer.start();
+            if (crashed) {
+                // Before any case started, e.g. in a static initialiser
+                test.output = tr("[The test binary failed before running this test]\n") + worker->stray;
+                endTest(worker, worker->timedOut ? TestCase::TimedOut : TestCase::Crashed);
+            } else {
+                test.output = tr("[Not run: the test binary skipped it]\n") + worker->stray;
+                endTest(worker, TestCase::Skipped);
+            }
+        }
+    }
+
+    m_workers.removeOne(worker);
+    worker->process->disconnect();
+    worker->process->deleteLater();
+    delete worker->timeout;
+    delete worker;
+
+    startWorkers();
+    if (m_workers.isEmpty() && m_queue.isEmpty()) {
+        emit finished(m_passed, m_failedCount);
+    }
+}
+
+void TestRunner::cancel()
+{
+    if (m_listProcess) {
+        m_listProcess->disconnect();
+        m_listProcess->kill();
+        m_listProcess->waitForFinished(1000);
+        m_listProcess->deleteLater();
+        m_listProcess = nullptr;
+    }
+    for (Worker *worker : qAsConst(m_workers)) {
+        worker->process->disconnect();
+        worker->process->kill();
+        worker->process->waitForFinished(1000);
+        delete worker->process;
+        delete worker->timeout;
+        delete worker;
+    }
+    m_workers.clear();
+    m_queue.clear();
+
+    // What never got to finish has no result
+    for (TestCase &test : m_tests) {
+        if (test.state == TestCase::Queued || test.state == TestCase::Running) {
+            test.state = TestCase::NotRun;
+        }
+    }
+}
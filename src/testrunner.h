@@ -0,0 +1,116 @@
+#ifndef TESTRUNNER_H
+#define TESTRUNNER_H
+
+#include <QObject>
+#include <QProcess>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+
+class QTimer;
+
+struct TestCase
+{
+    enum State { NotRun, Queued, Running, Passed, Failed, Skipped, TimedOut, Crashed };
+
+    QString name;                   // as the framework lists it, e.g. "Suite.Test/0"
+    QString suite;                  // GoogleTest suite, otherwise empty
+    State state = NotRun;
+    qint64 durationUs = 0;
+    QString output;                 // what the test printed and why it failed
+    QString filePath;               // first failure, or where the test is defined
+    int line = 0;
+
+    bool isFailure() const { return state == Failed || state == TimedOut || state == Crashed; }
+};
+
+// Runs the test cases of a GoogleTest, Catch2 or doctest binary in
+// parallel. The cases are listed with the framework's own option
+// (--gtest_list_tests, --list-test-names-only / --list-tests,
+// --list-test-cases), then handed out in small batches to one process per
+// core through the framework's name filter. Each process's output is
+// parsed line by line as it streams (GoogleTest's console output, the
+// Catch2/doctest XML reporters), so every case gets its own timeout: a case that hangs or
+// crashes takes down only its process, and the rest of that batch is
+// handed out again.
+class TestRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Framework { UnknownFramework, GoogleTest, Catch2, Doctest };
+
+    explicit TestRunner(QObject *parent = nullptr);
+    ~TestRunner();
+
+    // onlyTests restricts the run, e.g. to the previous failures; cases not
+    // run keep their last result if the binary is the same
+    void start(const QString &executable, const QStringList &onlyTests, int perTestTimeoutMs);
+    void cancel();
+    bool isRunning() const { return m_listProcess != nullptr || !m_workers.isEmpty(); }
+
+    const QVector<TestCase> &tests() const { return m_tests; }
+    QStringList failedTests() const;
+
+    // Looks for each framework's marks in the binary without running it
+    static Framework detect(const QString &executable);
+    // GoogleTest isn't header-only: the libraries a source that includes it links against
+    static QStringList linkFlags(const QString &sourceFile);
+
+signals:
+    void discovered(const QVector<TestCase> &tests);
+    void testChanged(int index, const TestCase &test);
+    void progress(int finishedTests, int totalTests);
+    void finished(int passed, int failed);
+    void failed(const QString &message);
+
+private:
+    struct Worker
+    {
+        QProcess *process = nullptr;
+        QTimer *timeout = nullptr;
+        QVector<int> batch;
+        QSet<int> started;
+        int current = -1;           // test running right now
+        bool currentFailed = false;
+        bool failureLocated = false;
+        QElapsedTimer testTimer;
+        QByteArray pending;         // an unfinished line
+        bool inText = false;        // Catch2/doctest: inside an element whose text is reported
+        QString stray;              // stderr while no test was running
+        bool timedOut = false;
+    };
+
+    void list(const QStringList &listArguments);
+    void onListFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    QStringList parseList(const QString &text) const;
+    void startWorkers();
+    QStringList runArguments(const QVector<int> &batch) const;
+    void readOutput(Worker *worker);
+    void parseLine(Worker *worker, const QString &line);
+    void parseConsoleLine(Worker *worker, const QString &line);
+    void parseXmlLine(Worker *worker, const QString &line);
+    void beginTest(Worker *worker, int index);
+    void endTest(Worker *worker, TestCase::State state);
+    void onWorkerFinished(Worker *worker, int exitCode, QProcess::ExitStatus exitStatus);
+    void setFailureLocation(Worker *worker, const QString &filePath, int line);
+
+    QString m_executable;
+    Framework m_framework;
+    QStringList m_onlyTests;
+    int m_timeoutMs;
+    bool m_catchFallback;           // Catch2 v3 rejected --list-test-names-only
+    QProcess *m_listProcess;
+    QVector<TestCase> m_tests;
+    QHash<QString, int> m_indexByName;
+    QVector<int> m_queue;
+    QList<Worker *> m_workers;
+    int m_total;
+    int m_done;
+    int m_passed;
+    int m_failedCount;
+};
+
+#endif // TESTRUNNER_H
@@ -0,0 +1,283 @@
+#include "toolchainprobe.h"
+#include "guardedinvoke.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPointer>
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QRegularExpression>
+#include <QSet>
+#include <QStandardPaths>
+#include <QThreadPool>
+
+namespace {
+
+const int kProbeTimeoutMs = 5000;
+const int kCacheVersion = 1;
+
+// "g++", "g++-13", "clang++-17", "x86_64-w64-mingw32-g++-posix", ...
+const QRegularExpression kCompilerName(R"(^(?:.+-)?(g\+\+|clang\+\+)(?:-(?:\d+(?:\.\d+)*|posix|win32))?$)");
+const QRegularExpression kLinkerName(R"(^(?:mold|ld\.mold|ld\.lld|lld)(?:-\d+(?:\.\d+)*)?$)");
+
+QString runTool(const QString &program, const QStringList &args)
+{
+    QProcess process;
+    process.setProcessChannelMode(QProcess::MergedChannels);
+    process.start(program, args);
+    process.closeWriteChannel();
+    if (!process.waitForFinished(kProbeTimeoutMs)) {
+        process.kill();
+        process.waitForFinished(1000);
+        return QString();
+    }
+    return QString::fromLocal8Bit(process.readAll());
+}
+
+// Lines between "#include <...> search starts here:" and "End of search list."
+QStringList parseIncludePaths(const QString &verboseOutput)
+{
+    QStringList paths;
+    bool inList = false;
+    for (const QString &line : verboseOutput.split('\n')) {
+        if (line.startsWith("#include <...> search starts here:")) {
+            inList = true;
+        } else if (line.startsWith("End of search list.")) {
+            break;
+        } else if (inList) {
+            // macOS marks framework directories with a suffix
+            paths << QDir::cleanPath(line.trimmed().remove(" (framework directory)"));
+        }
+    }
+    return paths;
+}
+
+QString commandName(const QFileInfo &file)
+{
+#ifdef Q_OS_WIN
+    if (file.suffix().compare("exe", Qt::CaseInsensitive) == 0) {
+        return file.completeBaseName();
+    }
+#endif
+    return file.fileName();
+}
+
+} // namespace
+
+QString Toolchain::displayName() const
+{
+    switch (kind) {
+    case Gcc: return QString("GCC %1 (%2)").arg(version, name);
+    case Clang: return QString("Clang %1 (%2)").arg(version, name);
+    case Msvc: return QString("MSVC %1 (%2)").arg(version, name);
+    case Linker: return QString("%1 %2").arg(name, version);
+    }
+    return name;
+}
+
+QJsonObject Toolchain::toJson() const
+{
+    QJsonObject object;
+    object["kind"] = int(kind);
+    object["name"] = name;
+    object["path"] = path;
+    object["modified"] = QString::number(modified);
+    object["version"] = version;
+    object["target"] = target;
+    object["sysroot"] = sysroot;
+    object["includePaths"] = QJsonArray::fromStringList(includePaths);
+    return object;
+}
+
+Toolchain Toolchain::fromJson(const QJsonObject &object)
+{
+    Toolchain toolchain;
+    toolchain.kind = Kind(object["kind"].toInt());
+    toolchain.name = object["name"].toString();
+    toolchain.path = object["path"].toString();
+    toolchain.modified = object["modified"].toString().toLongLong();
+    toolchain.version = object["version"].toString();
+    toolchain.target = object["target"].toString();
+    toolchain.sysroot = object["sysroot"].toString();
+    for (const QJsonValue &value : object["includePaths"].toArray()) {
+        toolchain.includePaths << value.toString();
+    }
+    return toolchain;
+}
+
+ToolchainProbe::ToolchainProbe(QObject *parent)
+    : QObject(parent)
+    , m_running(false)
+{
+}
+
+QString ToolchainProbe::cachePath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/toolchains.json";
+}
+
+QVector<Toolchain> ToolchainProbe::cached()
+{
+    QVector<Toolchain> toolchains;
+    QFile file(cachePath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return toolchains;
+    }
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root["version"].toInt() != kCacheVersion) {
+        return toolchains;
+    }
+    for (const QJsonValue &value : root["toolchains"].toArray()) {
+        toolchains << Toolchain::fromJson(value.toObject());
+    }
+    return toolchains;
+}
+
+Toolchain ToolchainProbe::cachedFor(const QString &command)
+{
+    const QString path = QStandardPaths::findExecutable(command);
+    if (path.isEmpty()) {
+        return Toolchain();
+    }
+    const QFileInfo entry(path);
+    const qint64 modified = QFileInfo(entry.canonicalFilePath()).lastModified().toMSecsSinceEpoch();
+    for (const Toolchain &toolchain : cached()) {
+        if (toolchain.path == entry.absoluteFilePath() && toolchain.modified == modified) {
+            return toolchain;
+        }
+    }
+    return Toolchain();
+}
+
+void ToolchainProbe::saveCache(const QVector<Toolchain> &toolchains)
+{
+    QJsonArray array;
+    for (const Toolchain &toolchain : toolchains) {
+        array << toolchain.toJson();
+    }
+    QJsonObject root;
+    root["version"] = kCacheVersion;
+    root["toolchains"] = array;
+
+    QDir().mkpath(QFileInfo(cachePath()).absolutePath());
+    QFile file(cachePath());
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    }
+}
+
+void ToolchainProbe::start()
+{
+    if (m_running) {
+        return;
+    }
+    m_running = true;
+
+    QPointer<ToolchainProbe> guard(this);
+    QThreadPool::globalInstance()->start([guard]() {
+        const QVector<Toolchain> toolchains = discover();
+        invokeIfAlive(guard, [guard, toolchains]() {
+            guard->m_toolchains = toolchains;
+            guard->m_running = false;
+            emit guard->finished(toolchains);
+        });
+    });
+}
+
+QVector<Toolchain> ToolchainProbe::discover()
+{
+    QHash<QString, Toolchain> previous;
+    for (const Toolchain &toolchain : cached()) {
+        previous.insert(toolchain.path, toolchain);
+    }
+
+    QVector<Toolchain> toolchains;
+    QSet<QString> seen;             // g++ and g++-13 are often the same binary
+    const QStringList dirs = QProcessEnvironment::systemEnvironment().value("PATH")
+                                 .split(QDir::listSeparator(), Qt::SkipEmptyParts);
+    for (const QString &dir : dirs) {
+        // Name order puts "g++" ahead of "g++-13", so the plain name wins
+        const QFileInfoList entries = QDir(dir).entryInfoList(QDir::Files | QDir::Executable, QDir::Name);
+        for (const QFileInfo &entry : entries) {
+            const QString name = commandName(entry);
+            Toolchain candidate;
+            const QRegularExpressionMatch compiler = kCompilerName.match(name);
+            if (compiler.hasMatch()) {
+                candidate.kind = compiler.captured(1) == "clang++" ? Toolchain::Clang : Toolchain::Gcc;
+            } else if (kLinkerName.match(name).hasMatch()) {
+                candidate.kind = Toolchain::Linker;
+            } else if (name.compare("cl", Qt::CaseInsensitive) == 0) {
+                candidate.kind = Toolchain::Msvc;
+            } else {
+                continue;
+            }
+
+            const QString canonical = entry.canonicalFilePath();
+            // A ccache-style wrapper serves several compilers from one binary
+            static const QStringList wrappers = {"ccache", "sccache", "distcc", "icecc"};
+            const QString key = wrappers.contains(QFileInfo(canonical).fileName()) ? entry.absoluteFilePath()
+                                                                                   : canonical;
+            if (canonical.isEmpty() || seen.contains(key)) {
+                continue;
+            }
+            seen.insert(key);
+
+            // Probe through the PATH entry: a ccache wrapper resolves to ccache itself
+            candidate.name = name;
+            candidate.path = entry.absoluteFilePath();
+            candidate.modified = QFileInfo(canonical).lastModified().toMSecsSinceEpoch();
+
+            const Toolchain known = previous.value(candidate.path);
+            Toolchain toolchain;
+            if (!known.path.isEmpty() && known.modified == candidate.modified && known.kind == candidate.kind) {
+                toolchain = known;
+                toolchain.name = name;
+            } else {
+                toolchain = probe(candidate);
+            }
+            if (!toolchain.version.isEmpty()) {
+                toolchains << toolchain;
+            }
+        }
+    }
+
+    saveCache(toolchains);
+    return toolchains;
+}
+
+Toolchain ToolchainProbe::probe(const Toolchain &candidate)
+{
+    Toolchain toolchain = candidate;
+
+    if (toolchain.kind == Toolchain::Msvc) {
+        // cl prints its banner, including version and target, when run bare
+        static const QRegularExpression banner(R"(Version\s+([\d.]+)\s+for\s+(\S+))");
+        const QRegularExpressionMatch match = banner.match(runTool(toolchain.path, {}));
+        toolchain.version = match.captured(1);
+        toolchain.target = match.captured(2);
+        return toolchain;
+    }
+
+    static const QRegularExpression versionNumber(R"((\d+\.\d+(?:\.\d+)?))");
+    const QString versionOutput = runTool(toolchain.path, {"--version"});
+    toolchain.version = versionNumber.match(versionOutput.section('\n', 0, 0)).captured(1);
+    if (toolchain.kind == Toolchain::Linker || toolchain.version.isEmpty()) {
+        return toolchain;
+    }
+
+    toolchain.target = runTool(toolchain.path, {"-dumpmachine"}).trimmed();
+    toolchain.includePaths = parseIncludePaths(runTool(toolchain.path, {"-E", "-x", "c++", "-v", "-"}));
+    if (toolchain.kind == Toolchain::Gcc) {
+        toolchain.sysroot = runTool(toolchain.path, {"-print-sysroot"}).trimmed();
+    } else {
+        // Clang has no -print-sysroot; a configured default shows up in -v
+        static const QRegularExpression sysrootArg(R"re((?:-isysroot"?\s+"?|--sysroot=)([^"\s]+))re");
+        toolchain.sysroot = sysrootArg.match(runTool(toolchain.path, {"-###", "-x", "c++", "-c", "-"})).captured(1);
+    }
+    return toolchain;
+}
@@ -0,0 +1,65 @@
+#ifndef TOOLCHAINPROBE_H
+#define TOOLCHAINPROBE_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class QJsonObject;
+
+struct Toolchain
+{
+    enum Kind { Gcc, Clang, Msvc, Linker };
+
+    Kind kind = Gcc;
+    QString name;                   // command as found on PATH, e.g. "clang++-17"
+    QString path;                   // resolved binary
+    qint64 modified = 0;            // binary mtime, part of the cache key
+    QString version;
+    QString target;                 // e.g. "x86_64-linux-gnu"
+    QString sysroot;
+    QStringList includePaths;       // default #include <...> search list
+
+    bool isCompiler() const { return kind != Linker; }
+    QString displayName() const;
+
+    QJsonObject toJson() const;
+    static Toolchain fromJson(const QJsonObject &object);
+};
+
+// Finds the g++/clang++ versions, cl, and mold/lld linkers on PATH and asks
+// each for its version, target, sysroot and include paths. Probing runs on
+// a worker thread; results are cached by binary path and mtime, so later
+// startups only stat files and spawn nothing unless a toolchain changed.
+class ToolchainProbe : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ToolchainProbe(QObject *parent = nullptr);
+
+    void start();
+    bool isRunning() const { return m_running; }
+    QVector<Toolchain> toolchains() const { return m_toolchains; }
+
+    // Last probe's results, read from the cache without running anything
+    static QVector<Toolchain> cached();
+    // The cached entry for the binary a command resolves to; empty when
+    // that binary wasn't probed or has changed since
+    static Toolchain cachedFor(const QString &command);
+
+signals:
+    void finished(const QVector<Toolchain> &toolchains);
+
+private:
+    static QVector<Toolchain> discover();
+    static Toolchain probe(const Toolchain &candidate);
+    static QString cachePath();
+    static void saveCache(const QVector<Toolchain> &toolchains);
+
+    QVector<Toolchain> m_toolchains;
+    bool m_running;
+};
+
+#endif // TOOLCHAINPROBE_H
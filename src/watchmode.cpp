@@ -0,0 +1,260 @@
+#include "watchmode.h"
+#include "compilerservice.h"
+#include "filesearchservice.h"
+#include "guardedinvoke.h"
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QPointer>
+#include <QThreadPool>
+#include <QTimer>
+
+namespace {
+
+// Long enough to fold an editor's save-all or a checkout into one rebuild
+const int kDebounceMs = 300;
+// Compiles write the executable and depfiles next to the source, which
+// shows up as directory changes; rescans wait for them to settle
+const int kRescanMs = 1000;
+// inotify watches are a per-user kernel resource shared with other tools
+const int kMaxWatchedFiles = 4000;
+// Bounds the diff table, 4 bytes per cell
+const qint64 kMaxDiffCells = 4 * 1000 * 1000;
+// A program printing without end shouldn't make the comparison the bottleneck
+const int kMaxCapturedChars = 8 * 1024 * 1024;
+
+QStringList splitLines(const QString &text)
+{
+    QStringList lines = text.split('\n');
+    if (!lines.isEmpty() && lines.last().isEmpty()) {
+        lines.removeLast();
+    }
+    for (QString &line : lines) {
+        if (line.endsWith('\r')) {
+            line.chop(1);
+        }
+    }
+    return lines;
+}
+
+} // namespace
+
+WatchMode::WatchMode(CompilerService *compilerService, QObject *parent)
+    : QObject(parent)
+    , m_compilerService(compilerService)
+    , m_generation(0)
+    , m_capturing(false)
+    , m_hasPrevious(false)
+{
+    m_watcher = new QFileSystemWatcher(this);
+    connect(m_watcher, &QFileSystemWatcher::fileChanged, this, &WatchMode::onPathChanged);
+    // Files created, deleted or replaced by an atomic save
+    QTimer *rescanTimer = new QTimer(this);
+    rescanTimer->setSingleShot(true);
+    rescanTimer->setInterval(kRescanMs);
+    connect(rescanTimer, &QTimer::timeout, this, &WatchMode::scan);
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, rescanTimer, QOverload<>::of(&QTimer::start));
+
+    m_debounceTimer = new QTimer(this);
+    m_debounceTimer->setSingleShot(true);
+    m_debounceTimer->setInterval(kDebounceMs);
+    connect(m_debounceTimer, &QTimer::timeout, this, &WatchMode::rebuild);
+
+    connect(m_compilerService, &CompilerService::executionStarted, [this]() {
+        m_capturing = isActive() && m_compilerService->runSource() == m_sourceFile;
+        m_output.clear();
+    });
+    connect(m_compilerService, &CompilerService::executionOutput, [this](const QString &text, bool) {
+        if (m_capturing && m_output.size() < kMaxCapturedChars) {
+            m_output += text;
+        }
+    });
+    connect(m_compilerService, &CompilerService::executionFinished, [this](const QString &status) {
+        // Still set afterwards, so MainWindow's handler of this signal sees it
+        if (!m_capturing) {
+            return;
+        }
+        // A run superseded by the next rebuild is half an output; keep the last complete one
+        if (status.contains("[Process killed: cancelled]")) {
+            return;
+        }
+        const bool firstRun = !m_hasPrevious;
+        const QVector<OutputDiffLine> lines = firstRun ? QVector<OutputDiffLine>() : diff(m_previousOutput, m_output);
+        emit runCompared(lines, splitLines(m_output).size(), firstRun, m_output, status);
+        m_previousOutput = m_output;
+        m_hasPrevious = true;
+        m_output.clear();
+    });
+}
+
+void WatchMode::start(const QString &sourceFile, const QString &rootPath)
+{
+    stop();
+    m_sourceFile = sourceFile;
+    m_rootPath = rootPath;
+    scan();
+    rebuild();
+}
+
+void WatchMode::stop()
+{
+    ++m_generation;
+    m_debounceTimer->stop();
+    if (!m_watcher->files().isEmpty()) {
+        m_watcher->removePaths(m_watcher->files());
+    }
+    if (!m_watcher->directories().isEmpty()) {
+        m_watcher->removePaths(m_watcher->directories());
+    }
+    m_sourceFile.clear();
+    m_changed.clear();
+    m_capturing = false;
+    m_previousOutput.clear();
+    m_hasPrevious = false;
+}
+
+void WatchMode::scan()
+{
+    if (!isActive()) {
+        return;
+    }
+    const int generation = ++m_generation;
+    const QString rootPath = m_rootPath;
+    QPointer<WatchMode> guard(this);
+    QThreadPool::globalInstance()->start([guard, generation, rootPath]() {
+        static const QStringList suffixes = {
+            "c", "cc", "cpp", "cxx", "c++", "h", "hh", "hpp", "hxx", "inl", "ipp", "tpp"
+        };
+        const QStringList files = FileSearchService::listWorkspaceFiles(rootPath, suffixes);
+        invokeIfAlive(guard, [guard, files, generation]() {
+            guard->applyScan(files, generation);
+        });
+    });
+}
+
+void WatchMode::applyScan(const QStringList &files, int generation)
+{
+    if (generation != m_generation) {
+        return;
+    }
+
+    // The target first, so a huge workspace never crowds it out
+    QSet<QString> wantedFiles{QFileInfo(m_sourceFile).absoluteFilePath()};
+    QSet<QString> wantedDirs{QFileInfo(m_rootPath).absoluteFilePath()};
+    for (const QString &file : files) {
+        if (wantedFiles.size() >= kMaxWatchedFiles) {
+            break;
+        }
+        const QFileInfo info(file);
+        wantedFiles.insert(info.absoluteFilePath());
+        wantedDirs.insert(info.absolutePath());
+    }
+
+    // Only the difference, so nothing goes unwatched in between
+    QStringList stale;
+    const QStringList watched = m_watcher->files() + m_watcher->directories();
+    for (const QString &path : watched) {
+        if (!wantedFiles.contains(path) && !wantedDirs.contains(path)) {
+            stale << path;
+        }
+    }
+    if (!stale.isEmpty()) {
+        m_watcher->removePaths(stale);
+    }
+    const QSet<QString> watchedSet(watched.begin(), watched.end());
+    QStringList added;
+    for (const QString &path : wantedFiles + wantedDirs) {
+        if (!watchedSet.contains(path)) {
+            added << path;
+        }
+    }
+    if (!added.isEmpty()) {
+        m_watcher->addPaths(added);
+    }
+    emit watching(m_watcher->files().size());
+}
+
+void WatchMode::onPathChanged(const QString &path)
+{
+    if (!isActive()) {
+        return;
+    }
+    // Editors that save by renaming a temporary over the file drop the watch
+    if (QFileInfo::exists(path) && !m_watcher->files().contains(path)) {
+        m_watcher->addPath(path);
+    }
+    m_changed.insert(path);
+    m_debounceTimer->start();
+}
+
+void WatchMode::rebuild()
+{
+    if (!isActive()) {
+        return;
+    }
+    emit triggered(QStringList(m_changed.begin(), m_changed.end()));
+    m_changed.clear();
+    // Supersedes a build or run of the previous change still in flight
+    m_compilerService->compileAndRun(m_sourceFile);
+}
+
+QVector<OutputDiffLine> WatchMode::diff(const QString &previous, const QString &current)
+{
+    const QStringList a = splitLines(previous);
+    const QStringList b = splitLines(current);
+    QVector<OutputDiffLine> result;
+
+    int prefix = 0;
+    while (prefix < a.size() && prefix < b.size() && a.at(prefix) == b.at(prefix)) {
+        ++prefix;
+    }
+    int suffix = 0;
+    while (suffix < a.size() - prefix && suffix < b.size() - prefix
+           && a.at(a.size() - 1 - suffix) == b.at(b.size() - 1 - suffix)) {
+        ++suffix;
+    }
+    for (int i = 0; i < prefix; ++i) {
+        result << OutputDiffLine{OutputDiffLine::Same, i + 1, b.at(i)};
+    }
+
+    const int n = a.size() - prefix - suffix;
+    const int m = b.size() - prefix - suffix;
+    if (qint64(n + 1) * (m + 1) > kMaxDiffCells) {
+        for (int i = 0; i < n; ++i) {
+            result << OutputDiffLine{OutputDiffLine::Removed, prefix + i + 1, a.at(prefix + i)};
+        }
+        for (int j = 0; j < m; ++j) {
+            result << OutputDiffLine{OutputDiffLine::Added, prefix + j + 1, b.at(prefix + j)};
+        }
+    } else {
+        // lcs[i][j]: longest common subsequence of the middles' tails from i and j
+        QVector<int> lcs((n + 1) * (m + 1), 0);
+        auto at = [&lcs, m](int i, int j) -> int & { return lcs[i * (m + 1) + j]; };
+        for (int i = n - 1; i >= 0; --i) {
+            for (int j = m - 1; j >= 0; --j) {
+                at(i, j) = a.at(prefix + i) == b.at(prefix + j) ? at(i + 1, j + 1) + 1
+                                                                 : qMax(at(i + 1, j), at(i, j + 1));
+            }
+        }
+        int i = 0;
+        int j = 0;
+        while (i < n || j < m) {
+            if (i < n && j < m && a.at(prefix + i) == b.at(prefix + j)) {
+                result << OutputDiffLine{OutputDiffLine::Same, prefix + j + 1, b.at(prefix + j)};
+                ++i;
+                ++j;
+            } else if (i < n && (j == m || at(i + 1, j) >= at(i, j + 1))) {
+                // Removals first on a tie, like diff -u
+                result << OutputDiffLine{OutputDiffLine::Removed, prefix + i + 1, a.at(prefix + i)};
+                ++i;
+            } else {
+                result << OutputDiffLine{OutputDiffLine::Added, prefix + j + 1, b.at(prefix + j)};
+                ++j;
+            }
+        }
+    }
+
+    for (int k = suffix; k > 0; --k) {
+        result << OutputDiffLine{OutputDiffLine::Same, b.size() - k + 1, b.at(b.size() - k)};
+    }
+    return result;
+}
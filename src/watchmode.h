@@ -0,0 +1,74 @@
+#ifndef WATCHMODE_H
+#define WATCHMODE_H
+
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+
+class CompilerService;
+class QFileSystemWatcher;
+class QTimer;
+
+struct OutputDiffLine
+{
+    enum Kind { Same, Added, Removed };
+
+    Kind kind = Same;
+    int line = 0;           // 1-based, in the run the text comes from
+    QString text;
+};
+
+// Build > Watch & Run: every change to a C/C++ file under the workspace,
+// whether saved here or by another tool, rebuilds and reruns the target.
+// Bursts of changes (a save-all, a git checkout) are debounced into one
+// rebuild, and a rebuild submitted while the last one is still building or
+// running supersedes it in the job scheduler. Each run's output is compared
+// with the previous one, so only what changed needs reading.
+class WatchMode : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit WatchMode(CompilerService *compilerService, QObject *parent = nullptr);
+
+    void start(const QString &sourceFile, const QString &rootPath);
+    void stop();
+    bool isActive() const { return !m_sourceFile.isEmpty(); }
+    QString sourceFile() const { return m_sourceFile; }
+    // The current or last run is of the watched file; a run of another
+    // file started while watching isn't compared
+    bool isWatchedRun() const { return m_capturing; }
+
+    // Line diff of two outputs; long unrelated stretches fall back to
+    // removing the old lines and adding the new ones
+    static QVector<OutputDiffLine> diff(const QString &previous, const QString &current);
+
+signals:
+    void watching(int fileCount);
+    void triggered(const QStringList &changedFiles);
+    // First run of a session has nothing to compare with; diff is empty then
+    void runCompared(const QVector<OutputDiffLine> &diff, int lineCount, bool firstRun,
+                     const QString &output, const QString &status);
+
+private:
+    void scan();
+    void applyScan(const QStringList &files, int generation);
+    void onPathChanged(const QString &path);
+    void rebuild();
+
+    CompilerService *m_compilerService;
+    QFileSystemWatcher *m_watcher;
+    QTimer *m_debounceTimer;
+    QString m_sourceFile;
+    QString m_rootPath;
+    QSet<QString> m_changed;
+    int m_generation;
+
+    bool m_capturing;       // the current or last run is of the watched target
+    QString m_output;
+    QString m_previousOutput;
+    bool m_hasPrevious;
+};
+
+#endif // WATCHMODE_H